@@ -26,6 +26,7 @@
  *  -# @ref file_system_support
  *  -# @ref rci_support
  *  -# @ref max_msg_transactions
+ *  -# @ref msg_receive_window
  *  -# @ref network_tcp_start
  *  -# @ref network_udp_start
  *  -# @ref network_sms_start
@@ -1661,6 +1662,77 @@
  *
  * @endcode
  *
+ * @section msg_receive_window Message Receive Window
+ *
+ * Return the receive window used for data service and file system messages received from Device Cloud.
+ * This callback is optional; when it is not recognized the initial window is four times the typical
+ * TCP payload and the maximum window is 32 times the typical TCP payload.
+ *
+ * Every session starts with the initial window, which is also advertised to Device Cloud. While the
+ * application keeps up with the data, the window of the session doubles with every acknowledgement
+ * up to the amount the application consumed in two seconds, never exceeding the maximum. It is
+ * halved whenever the application returns busy for the session's data.
+ *
+ * @note If @ref CONNECTOR_MSG_RECV_WINDOW_MAX configuration is defined in @ref connector_config.h, this callback
+ * will not be called. See @ref connector_config_data_options
+ *
+ * @htmlonly
+ * <table class="apitable">
+ * <tr> <th colspan="2" class="title">Arguments</th> </tr>
+ * <tr><th class="subtitle">Name</th> <th class="subtitle">Description</th></tr>
+ * <tr>
+ * <th>class_id</th>
+ * <td>@endhtmlonly @ref connector_class_id_config @htmlonly</td>
+ * </tr>
+ * <tr>
+ * <th>request_id</th>
+ * <td>@endhtmlonly @ref connector_request_id_config_msg_receive_window @htmlonly</td>
+ * </tr>
+ * <tr>
+ * <th>data</th>
+ * <td> Pointer to @endhtmlonly connector_config_msg_receive_window_t @htmlonly:
+ *          <dl>
+ *              <dt><i>initial</i></dt><dd>Preset to the default. Callback writes the initial window in bytes.
+ *                                         It must be larger than the largest message packet.</dd>
+ *              <dt><i>maximum</i></dt><dd>Preset to the default. Callback writes the maximum window in bytes.
+ *                                         It must not be smaller than <i>initial</i>; use the same value to disable
+ *                                         window adaptation.</dd>
+ *          </dl>
+ * </td>
+ * </tr>
+ * <tr> <th colspan="2" class="title">Return Values</th> </tr>
+ * <tr><th class="subtitle">Values</th> <th class="subtitle">Description</th></tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_continue @htmlonly</td>
+ * <td>Callback successfully returned the receive window</td>
+ * </tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_abort @htmlonly</td>
+ * <td>Callback aborted Cloud Connector</td>
+ * </tr>
+ * </table>
+ * @endhtmlonly
+ *
+ * Example:
+ *
+ * @code
+ *
+ * connector_callback_status_t app_connector_callback(connector_class_id_t const class_id,
+ *                                                   connector_request_id_t const request_id
+ *                                                   void * const data)
+ * {
+ *
+ *     if (class_id == connector_class_id_config && request_id.config_request == connector_request_id_config_msg_receive_window)
+ *     {
+ *         connector_config_msg_receive_window_t * const receive_window = data;
+ *
+ *         receive_window->maximum = 128 * 1024;
+ *     }
+ *     return connector_callback_continue;
+ * }
+ *
+ * @endcode
+ *
  * @section network_tcp_start  Start network TCP
  *
  * Return @ref connector_config_connect_type_t to automatic or manual start TCP transport.
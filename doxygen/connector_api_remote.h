@@ -355,6 +355,17 @@ typedef struct {
                                         Note: this string cannot be altered until next callback call.
                                       */
       connector_element_value_t * element_value; /**< Pointer to memory where callback writes the element value */
+#if (defined CONNECTOR_RCI_GROUP_PROCESS)
+      connector_element_value_t const * element_values; /**< With @ref CONNECTOR_RCI_GROUP_PROCESS, the @ref connector_request_id_remote_config_group_start
+                                                           callback of a query may point this to the values of all elements of the group
+                                                           instance, indexed by element id. No @ref connector_request_id_remote_config_group_process
+                                                           callbacks are then made for the group instance. */
+#endif
+#if (defined CONNECTOR_RCI_CACHE)
+      unsigned long cache_ttl;        /**< With @ref CONNECTOR_RCI_CACHE, the @ref connector_request_id_remote_config_group_start
+                                           callback of a query may set how many seconds the response for the group instance
+                                           can be served from the cache. It is preset to CONNECTOR_RCI_CACHE_DEFAULT_TTL, 0 disables caching. */
+#endif
   } response;                        /**< Callback writes compare_matches to skip response for the group/element, error hint if error is encountered or the value of the element */
 } connector_remote_config_t;
 /**
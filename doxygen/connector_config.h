@@ -82,6 +82,82 @@
  */
 #define CONNECTOR_FIRMWARE_SERVICE
 
+/**
+ * When defined, firmware image blocks are written in the background instead of inside the
+ * connector_request_id_firmware_download_data callback. Cloud Connector keeps up to this many
+ * blocks in its own buffers, so the callback may return after starting the write and the
+ * download keeps receiving while the flash is busy. The application reports each write with
+ * @ref connector_initiate_firmware_write_complete, and a block is only acknowledged to Device
+ * Cloud once it and every block before it are written. Reception is held when all buffers are
+ * in use. The writes may be reported from the thread that writes the flash, see
+ * @ref CONNECTOR_MEMORY_BARRIER.
+ *
+ * Each buffer takes a receive packet of Cloud Connector's data. Not defined by default.
+ *
+ * @code
+ * #define CONNECTOR_FIRMWARE_PIPELINE_BLOCKS 4
+ * @endcode
+ *
+ * @see @ref connector_firmware_write_complete_t
+ */
+#define CONNECTOR_FIRMWARE_PIPELINE_BLOCKS 4
+
+/**
+ * Memory barrier used where the application reports something to Cloud Connector from another
+ * thread, such as @ref connector_initiate_firmware_write_complete. It must keep the stores and
+ * loads before it from being reordered with the ones after it. Defaults to __sync_synchronize()
+ * with GCC and compatible compilers; other compilers need it defined for such reports to be safe
+ * on processors that reorder memory accesses.
+ *
+ * @code
+ * #define CONNECTOR_MEMORY_BARRIER()  __sync_synchronize()
+ * @endcode
+ */
+#define CONNECTOR_MEMORY_BARRIER()  __sync_synchronize()
+
+/**
+ * Atomic compare and swap used where several application threads may report something to
+ * Cloud Connector at once, such as @ref connector_initiate_streaming_cli_ready. It must store
+ * new_value to the unsigned int at ptr only if it still holds old_value, and evaluate to
+ * non-zero when it did. Defaults to __sync_bool_compare_and_swap() with GCC and compatible
+ * compilers; other compilers need it defined to use @ref CONNECTOR_STREAMING_CLI_NOTIFY_READY
+ * or @ref CONNECTOR_RCI_CACHE.
+ *
+ * @code
+ * #define CONNECTOR_COMPARE_AND_SWAP(ptr, old_value, new_value)  __sync_bool_compare_and_swap((ptr), (old_value), (new_value))
+ * @endcode
+ */
+#define CONNECTOR_COMPARE_AND_SWAP(ptr, old_value, new_value)  __sync_bool_compare_and_swap((ptr), (old_value), (new_value))
+
+/**
+ * When defined, streaming CLI sessions are only polled for output after the application
+ * reported them with @ref connector_initiate_streaming_cli_ready, instead of every session
+ * being polled on every step. A session is also polled once when it starts and after each
+ * send completes, and is polled again while the poll callback returns busy. A report for a
+ * session still running a command is kept until the session moves on. The report may be
+ * made from any thread, see @ref CONNECTOR_COMPARE_AND_SWAP; it returns connector_service_busy
+ * when Cloud Connector has not yet collected as many earlier reports as there are sessions.
+ * Not defined by default.
+ *
+ * @code
+ * #define CONNECTOR_STREAMING_CLI_NOTIFY_READY
+ * @endcode
+ */
+#define CONNECTOR_STREAMING_CLI_NOTIFY_READY
+
+/**
+ * When defined, limits how much streaming CLI output each step starts sending, in bytes.
+ * Every send transaction counts as a full receive window of Device Cloud, and the first one of
+ * a step is always started. Sessions left over are polled first on the next step, so a busy
+ * session cannot keep the others waiting. Not defined by default, in which case every session
+ * is polled once per step.
+ *
+ * @code
+ * #define CONNECTOR_STREAMING_CLI_POLL_BUDGET 16384
+ * @endcode
+ */
+#define CONNECTOR_STREAMING_CLI_POLL_BUDGET 16384
+
 /**
  * When defined, Cloud Connector includes the @ref zlib "compression" support used with the
  * @ref data_service.
@@ -111,6 +187,65 @@
  */
 #define CONNECTOR_COMPRESSION
 
+/**
+ * zlib compression level (1-9) used when @ref CONNECTOR_COMPRESSION is defined. Defaults to 6.
+ *
+ * @see @ref CONNECTOR_COMPRESSION_WINDOW_BITS
+ * @see @ref CONNECTOR_COMPRESSION_MEM_LEVEL
+ */
+#define CONNECTOR_COMPRESSION_LEVEL 6
+
+/**
+ * zlib window size (9-15, as a power of two) used to compress outgoing messages when
+ * @ref CONNECTOR_COMPRESSION is defined. Defaults to 15. Together with
+ * @ref CONNECTOR_COMPRESSION_MEM_LEVEL it sets the memory that zlib allocates for each
+ * compressing session: (1 << (windowBits + 2)) + (1 << (memLevel + 9)) bytes, about 256 KB
+ * with the defaults and about 4 KB with 9 and 1.
+ *
+ * @see @ref CONNECTOR_COMPRESSION_STREAM_POOL_SIZE
+ */
+#define CONNECTOR_COMPRESSION_WINDOW_BITS 15
+
+/**
+ * zlib memory level (1-9) used to compress outgoing messages when @ref CONNECTOR_COMPRESSION
+ * is defined. Defaults to 8.
+ *
+ * @see @ref CONNECTOR_COMPRESSION_WINDOW_BITS
+ */
+#define CONNECTOR_COMPRESSION_MEM_LEVEL 8
+
+/**
+ * Number of compression and of decompression streams (0-255) that are kept allocated after a
+ * messaging session ends and are reset with deflateReset() and inflateReset() for the next
+ * sessions, instead of being freed and set up again for every session. Sessions that find
+ * no free stream in the pool set up their own as before. The pooled streams are released
+ * when the messaging facility is removed.
+ *
+ * Defaults to 0, which keeps no streams between sessions.
+ *
+ * @see @ref CONNECTOR_COMPRESSION_WINDOW_BITS
+ */
+#define CONNECTOR_COMPRESSION_STREAM_POOL_SIZE 0
+
+/**
+ * When defined, messaging sessions are compressed with a preset zlib dictionary of common
+ * XML, RCI, JSON and data point CSV strings, which makes small payloads compress much
+ * better. Decompression uses the same dictionary when the peer asks for it.
+ *
+ * Not defined by default. To enable it, add this line in connector_config.h:
+ *
+ * @code
+ * #define CONNECTOR_COMPRESSION_DICTIONARY
+ * @endcode
+ *
+ * @note The zlib header carries the Adler-32 id of the dictionary, and Device Cloud must have
+ * the same dictionary to decompress the data. Only enable this when your Device Cloud server
+ * supports it.
+ *
+ * @see @ref CONNECTOR_COMPRESSION
+ */
+#define CONNECTOR_COMPRESSION_DICTIONARY
+
 /**
  * If defined, Cloud Connector includes the @ref data_service.
  * To disable the @ref data_service feature, comment this line out in connector_config.h:
@@ -130,6 +265,38 @@
  */
 #define CONNECTOR_DATA_SERVICE
 
+/**
+ * If defined, the application can call connector_register_device_request_target() to route the
+ * device requests of a target straight to its own @ref connector_device_request_handler_t.
+ * Targets are found by hash, so dispatch does not slow down as targets are added, and requests
+ * for targets that are not registered still go to the application callback. The table is not
+ * locked, so targets are registered before connector_run() starts or from the thread running it.
+ *
+ * Requires @ref CONNECTOR_DATA_SERVICE.
+ *
+ * @code
+ * #define CONNECTOR_DEVICE_REQUEST_TARGETS
+ * @endcode
+ *
+ * @see @ref CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE
+ * @see @ref CONNECTOR_DEVICE_REQUEST_TARGET_CONTEXTS
+ */
+#define CONNECTOR_DEVICE_REQUEST_TARGETS
+
+/**
+ * Number of slots in the target table when @ref CONNECTOR_DEVICE_REQUEST_TARGETS is defined.
+ * Must be a power of 2 and at least 4. Up to three quarters of the slots can be registered, 192
+ * targets with the default of 256.
+ */
+#define CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE  256
+
+/**
+ * Number of TCP device requests to registered targets whose state is kept in Cloud Connector's data
+ * instead of being allocated when @ref CONNECTOR_DEVICE_REQUEST_TARGETS is defined. Further requests
+ * allocate their state as usual. Must be between 1 and 16. Defaults to 4.
+ */
+#define CONNECTOR_DEVICE_REQUEST_TARGET_CONTEXTS    4
+
 /**
 * If defined, Cloud Connector includes the @ref data_point.
 * To disable the @ref data_point feature, comment this line out in connector_config.h:
@@ -149,6 +316,37 @@
 */
 #define CONNECTOR_DATA_POINTS
 
+/**
+ * Maximum number of @ref data_point requests (@ref connector_initiate_data_point and
+ * @ref connector_initiate_data_point_binary) that can be queued per transport while
+ * previous requests are still in progress. Queued requests are started as soon as the
+ * transport accepts a new send data session, so several uploads can run at the same time.
+ *
+ * The default is @ref CONNECTOR_MSG_MAX_TRANSACTION when it is defined and non-zero,
+ * otherwise 1. Must be between 1 and 255.
+ *
+ * @see @ref data_point
+ * @see @ref CONNECTOR_MSG_MAX_TRANSACTION
+ */
+#define CONNECTOR_DATA_POINTS_MAX_PENDING 4
+
+/**
+ * If defined, @ref connector_request_data_point_t gains a <b><i>format</i></b> member that lets the
+ * application upload numeric streams in the compact @ref columnar_format instead of CSV.
+ * Time stamps and integer values are delta coded, so regularly sampled streams shrink to a
+ * few bytes per point and no text conversion is done while the message is generated.
+ *
+ * This is disabled by default. To enable it, add this line in connector_config.h:
+ *
+ * @code
+ * #define CONNECTOR_DATA_POINTS_COLUMNAR
+ * @endcode
+ *
+ * @see @ref data_point
+ * @see @ref columnar_format
+ */
+#define CONNECTOR_DATA_POINTS_COLUMNAR
+
 /**
  * If defined, Cloud Connector includes the @ref file_system.
  * To enable the @ref file_system feature, uncomment this line in connector_config.h:
@@ -200,6 +398,60 @@
  */
 #define CONNECTOR_NO_MALLOC_RCI_MAXIMUM_CONTENT_LENGTH    256
 
+/**
+ * If defined, the @ref rci_group_start callback of a query may return the values of all elements of a group
+ * instance at once through response.element_values, and Cloud Connector serializes them without calling
+ * @ref rci_group_query for each element. Groups which leave element_values NULL are processed one element
+ * at a time as before. Elements inside lists are always queried one at a time.
+ *
+ * @code
+ * #define CONNECTOR_RCI_GROUP_PROCESS
+ * @endcode
+ *
+ * @see @ref CONNECTOR_RCI_SERVICE
+ * @see @ref rci_group_start
+ */
+#define CONNECTOR_RCI_GROUP_PROCESS
+
+/**
+ * If defined, Cloud Connector keeps the serialized response of queried group instances and answers
+ * repeated queries for the same group instance, command and attributes without calling the application.
+ * A group instance is cached only when the whole instance is queried and the @ref rci_group_start callback
+ * leaves a non-zero response.cache_ttl, which is the number of seconds the response stays valid.
+ * Variable groups and responses with errors are never cached.
+ *
+ * Cached responses of a group are dropped when the group is set, or by calling @ref connector_initiate_action
+ * with @ref connector_initiate_rci_cache_invalidate. That call only records the request, so it can be made from
+ * any thread, see @ref CONNECTOR_COMPARE_AND_SWAP; the responses are dropped by the thread running connector_run()
+ * before it answers the next query. Hit and miss counters are returned by connector_get_rci_cache_statistics().
+ *
+ * @code
+ * #define CONNECTOR_RCI_CACHE
+ * @endcode
+ *
+ * @see @ref CONNECTOR_RCI_CACHE_ENTRIES
+ * @see @ref CONNECTOR_RCI_CACHE_ENTRY_SIZE
+ * @see @ref CONNECTOR_RCI_CACHE_DEFAULT_TTL
+ */
+#define CONNECTOR_RCI_CACHE
+
+/**
+ * Number of group instance responses kept when @ref CONNECTOR_RCI_CACHE is defined. Defaults to 8.
+ */
+#define CONNECTOR_RCI_CACHE_ENTRIES     8
+
+/**
+ * Largest group instance response in bytes kept when @ref CONNECTOR_RCI_CACHE is defined. Larger responses are not cached.
+ * The cache takes @ref CONNECTOR_RCI_CACHE_ENTRIES times this many bytes of Cloud Connector's data. Defaults to 512.
+ */
+#define CONNECTOR_RCI_CACHE_ENTRY_SIZE  512
+
+/**
+ * Value response.cache_ttl is preset to before each @ref rci_group_start callback of a query when
+ * @ref CONNECTOR_RCI_CACHE is defined. Defaults to 0, so only groups whose callback sets a TTL are cached.
+ */
+#define CONNECTOR_RCI_CACHE_DEFAULT_TTL 0
+
 /**
 * If defined, Cloud Connector includes the @ref cli_support.
 * To disable the @ref cli_support feature, comment this line out in connector_config.h:
@@ -254,6 +506,9 @@
  *
  * @note If using @ref rci_support, then @ref CONNECTOR_NO_MALLOC_RCI_MAXIMUM_CONTENT_LENGTH must be defined.
  *
+ * Define @ref CONNECTOR_NO_MALLOC_POOL as well to take the buffers from a pool of
+ * size classes instead, which removes the limits of 32.
+ *
  * To enable no dynamic RAM feature, uncomment this line in connector_config.h:
  *
  * @code
@@ -281,6 +536,106 @@
  */
 #define CONNECTOR_NO_MALLOC_MAX_SEND_SESSIONS 1
 
+/**
+ * When defined together with @ref CONNECTOR_NO_MALLOC, every buffer Cloud Connector needs, except
+ * its own connector_data_t, is taken from a single static pool divided into the size classes listed
+ * in @ref CONNECTOR_NO_MALLOC_POOL_CLASSES. A request is served by the smallest class with a free
+ * block large enough for it. Allocation and release take constant time.
+ *
+ * Without it each kind of buffer has its own static array sized for the worst case, and
+ * @ref CONNECTOR_MSG_MAX_TRANSACTION, @ref CONNECTOR_NO_MALLOC_MAX_SEND_SESSIONS and the number of
+ * SM and streaming CLI sessions are limited to 32.
+ *
+ * connector_get_pool_statistics() reports the usage and high water mark of each class, the
+ * allocations it served for exhausted smaller classes and the allocations that failed because
+ * it and every larger class were exhausted.
+ * When @ref CONNECTOR_DEBUG is defined, a failed allocation also prints every class
+ * with these counters and the bytes left unused inside allocated blocks.
+ *
+ * @see @ref CONNECTOR_NO_MALLOC_POOL_CLASSES
+ */
+#define CONNECTOR_NO_MALLOC_POOL
+
+/**
+ * Size classes of the @ref CONNECTOR_NO_MALLOC_POOL, in ascending block size. The macro takes
+ * the name of another macro and invokes it once per class with the block size in bytes and
+ * the number of blocks:
+ *
+ * @code
+ * #define CONNECTOR_NO_MALLOC_POOL_CLASSES(pool_class) \
+ *     pool_class(64, 16) \
+ *     pool_class(512, 8) \
+ *     pool_class(2048, 4)
+ * @endcode
+ *
+ * Must be defined when @ref CONNECTOR_NO_MALLOC_POOL is defined. Block sizes are rounded up to
+ * the platform's alignment.
+ */
+#define CONNECTOR_NO_MALLOC_POOL_CLASSES(pool_class)   pool_class(64, 16) pool_class(512, 8) pool_class(2048, 4)
+
+/**
+ * Number of slots in the table used to look up active messaging sessions
+ * over @ref CONNECTOR_TRANSPORT_TCP "TCP transport". Must be a power of 2.
+ *
+ * The default is 16 when @ref CONNECTOR_MSG_MAX_TRANSACTION is defined and
+ * less or equal to 4, otherwise 64. Up to three quarters of the slots are used;
+ * additional sessions still work but are looked up with a linear search.
+ *
+ * @see @ref CONNECTOR_MSG_MAX_TRANSACTION
+ */
+#define CONNECTOR_MSG_SESSION_TABLE_SIZE 64
+
+/**
+ * Number of messaging acknowledgements over @ref CONNECTOR_TRANSPORT_TCP "TCP transport" that are
+ * collected and sent together. Acknowledgements are held back while packets keep arriving, so
+ * acknowledgements of different sessions go out in one send. Valid range is 1 to 255; 1 sends
+ * every acknowledgement on its own.
+ *
+ * The default is 4.
+ *
+ * @see @ref msg_receive_window
+ */
+#define CONNECTOR_MSG_ACK_BATCH_SIZE 4
+
+/**
+ * Number of EDP packets which can be queued for sending over
+ * @ref CONNECTOR_TRANSPORT_TCP "TCP transport" at the same time, including the one being sent.
+ * When more than one packet is queued they are passed together to the @ref send_iov callback.
+ *
+ * The default is 4. Must be between 1 and 255; 1 sends one packet at a time.
+ *
+ * @see @ref send_iov
+ */
+#define CONNECTOR_TCP_SEND_QUEUE_SIZE 4
+
+/**
+ * When defined, Cloud Connector reads up to this many bytes from the
+ * @ref CONNECTOR_TRANSPORT_TCP "TCP transport" in one @ref receive callback and takes the
+ * EDP packets from them, instead of reading each packet header and payload separately. Packets
+ * already read are passed to the facilities before the network is read again.
+ *
+ * Not defined by default. Must be at least 4; a size of @ref MSG_MAX_RECV_PACKET_SIZE or more
+ * lets a full packet arrive in one read.
+ *
+ * @see @ref receive
+ */
+#define CONNECTOR_TCP_RECEIVE_BUFFER_SIZE 4096
+
+/**
+ * When defined, the EDP handshake messages which follow the MT version exchange (keepalive
+ * parameters, protocol version, identity verification, Device ID, Device Cloud URL, password,
+ * vendor ID, device type and discovery complete) are built one after the other in the send buffer and
+ * passed to the @ref send callback together. The protocol version response is read after discovery
+ * complete is sent, so the connection takes two round trips to Device Cloud instead of three.
+ * Facility discovery messages and provisioning are still sent one at a time.
+ *
+ * Not defined by default. In debug builds the time, sends and receives spent in each handshake
+ * phase are printed once the connection is established.
+ *
+ * @see @ref send
+ */
+#define CONNECTOR_TCP_HANDSHAKE_FLIGHT
+
 /**
  * If defined, Cloud Connector includes the TCP transport.
  * To disable this feature, comment this line out in connector_config.h:
@@ -430,6 +785,56 @@
 */
 #define CONNECTOR_SM_SMS_RX_TIMEOUT                    (30 * 60)
 
+/**
+* If defined, the CRC16 of short messaging segments is calculated one bit at a time
+* instead of with the 512-byte lookup table. Use it on memory constrained builds.
+* Cannot be defined together with @ref CONNECTOR_SM_CRC16_SLICE_BY_8.
+*
+* @code
+* #define CONNECTOR_SM_CRC16_BITWISE
+* @endcode
+*
+* @see @ref CONNECTOR_SM_CRC16_SLICE_BY_8
+*/
+#define CONNECTOR_SM_CRC16_BITWISE
+
+/**
+* If defined, the CRC16 of short messaging segments is calculated eight bytes at a time.
+* This is faster for multipart transfers but adds another 3584 bytes of lookup tables.
+* Cannot be defined together with @ref CONNECTOR_SM_CRC16_BITWISE.
+*
+* @code
+* #define CONNECTOR_SM_CRC16_SLICE_BY_8
+* @endcode
+*
+* @see @ref CONNECTOR_SM_CRC16_BITWISE
+*/
+#define CONNECTOR_SM_CRC16_SLICE_BY_8
+
+/**
+* When CONNECTOR_SM_ENCRYPTION is defined, the number of received short message request IDs
+* which are kept in a journal before the duplicate request tracking data is stored.
+*
+* The default is 1, which stores the tracking data for every received request. When greater than 1,
+* Cloud Connector stores only the small connector_sm_encryption_data_type_tracking_journal object for
+* each request and stores connector_sm_encryption_data_type_tracking when the journal is full,
+* @ref CONNECTOR_SM_TRACKING_FLUSH_INTERVAL_IN_SECONDS expires or the transport is stopped.
+* The journal is replayed at start up, so duplicate requests are still rejected after a reset.
+* Must be between 1 and 255.
+*
+* @see @ref CONNECTOR_SM_TRACKING_FLUSH_INTERVAL_IN_SECONDS
+*/
+#define CONNECTOR_SM_TRACKING_FLUSH_COUNT              16
+
+/**
+* Maximum time, in seconds, that received short message request IDs stay in the journal before the
+* duplicate request tracking data is stored. Only used when @ref CONNECTOR_SM_TRACKING_FLUSH_COUNT
+* is greater than 1. The default is 0, which stores it only when the journal is full or the transport is stopped.
+*
+* @see @ref CONNECTOR_SM_TRACKING_FLUSH_COUNT
+*/
+#define CONNECTOR_SM_TRACKING_FLUSH_INTERVAL_IN_SECONDS 60
+
 /**
  * When defined, the Cloud Connector compilation will expect the C99 stdint.h header file,
  * even though we're setup for an C89 environment.
@@ -462,6 +867,20 @@
  */
 #define CONNECTOR_SUPPORTS_64_BIT_INTEGERS
 
+/**
+ * When defined, float and double data points (and native locations) are written to the CSV
+ * upload with the shortest digits that read back as the same value, e.g. 20.5 instead of
+ * 20.500000 and 1.5e-07 instead of 0.000000. Values outside 1e-4 to 1e15 use exponent
+ * notation, and infinities and NaN are written as Infinity and NaN.
+ *
+ * When not defined, values keep the fixed 6 fractional digits format.
+ *
+ * Requires @ref CONNECTOR_SUPPORTS_FLOATING_POINT and @ref CONNECTOR_SUPPORTS_64_BIT_INTEGERS.
+ *
+ * @see @ref data_point
+ */
+#define CONNECTOR_SHORTEST_DOUBLE_FORMAT
+
 /**
  * Sets the outbound packets' maximum size in UDP transport (it has no effect on SM/SMS or EDP/TCP).
  * This change only has effect if no multipacket messaging is enabled (@ref CONNECTOR_SM_MULTIPART).
@@ -557,6 +976,11 @@
  * See @endhtmlonly @ref max_msg_transactions @htmlonly</td>
  * </tr>
  * <tr>
+ * <td>@endhtmlonly @ref CONNECTOR_MSG_RECV_WINDOW_MAX @htmlonly </td>
+ * <td>Maximum receive window for data service receiving message.
+ * See @endhtmlonly @ref msg_receive_window @htmlonly</td>
+ * </tr>
+ * <tr>
  * <td>@endhtmlonly @ref CONNECTOR_CONNECTION_TYPE @htmlonly </td>
  * <td> @endhtmlonly @ref connector_connection_type_lan @htmlonly for LAN connection or
  * @endhtmlonly @ref connector_connection_type_wan @htmlonly WAN connection.
@@ -708,6 +1132,15 @@
  */
 #define CONNECTOR_MSG_MAX_TRANSACTION                  1
 
+/**
+ * When defined, this hardcodes the maximum of the @ref msg_receive_window instead of calling the
+ * @ref connector_request_id_config_msg_receive_window @ref connector_callback_t "callback". The
+ * initial window is the default one. It must not be smaller than the default initial window.
+ *
+ * @see @ref msg_receive_window
+ */
+#define CONNECTOR_MSG_RECV_WINDOW_MAX                  (32 * 1460)
+
 /**
  * When defined, this string hardcode for the @ref connection_type instead of the application framework
  * function @ref app_get_connection_type() (called via the @ref connector_request_id_config_connection_type @ref connector_callback_t "callback" in config.c).
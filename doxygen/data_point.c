@@ -76,7 +76,7 @@
  * </tr>
  * <tr>
  *   <th>@endhtmlonly @ref connector_service_busy @htmlonly</th>
- *   <td>Previous binary data point is not yet processed</td>
+ *   <td>@endhtmlonly @ref CONNECTOR_DATA_POINTS_MAX_PENDING @htmlonly data point requests are already queued on this transport</td>
  * </tr>
  * </table>
  * @endhtmlonly
@@ -268,6 +268,8 @@
  *        <li><b><i>request_id</i></b>, pointer to where to store the session's Request ID. This value is saved by Cloud Connector after a successful connector_initiate_action()
  *                                      and might be used for @endhtmlonly @ref initiate_session_cancel "canceling the session" @htmlonly. <b>Only valid for SM</b>. Set to NULL if cancel is not going to be used. </li>
  *        <li><b><i>timeout_in_seconds</i></b>, outgoing sessions timeout in seconds. <b>Only valid for SM</b>. Use SM_WAIT_FOREVER to wait forever for the complete request/response </li>
+ *        <li><b><i>format</i></b>, connector_data_point_format_csv or connector_data_point_format_columnar, see @endhtmlonly @ref columnar_format @htmlonly.
+ *                                   <b>Only present when</b> @endhtmlonly @ref CONNECTOR_DATA_POINTS_COLUMNAR @htmlonly <b>is defined</b>. </li>
  *      </ul>
  *    </td>
  * </tr>
@@ -279,11 +281,11 @@
  * </tr>
  * <tr>
  *   <th>@endhtmlonly @ref connector_invalid_data @htmlonly</th>
- *   <td>One or more input is not valid</td>
+ *   <td>One or more input is not valid, or a stream cannot be sent in the requested format</td>
  * </tr>
  * <tr>
  *   <th>@endhtmlonly @ref connector_service_busy @htmlonly</th>
- *   <td>Previous multiple data request is not yet processed</td>
+ *   <td>@endhtmlonly @ref CONNECTOR_DATA_POINTS_MAX_PENDING @htmlonly data point requests are already queued on this transport</td>
  * </tr>
  * </table>
  * @endhtmlonly
@@ -296,6 +298,38 @@
  *
  * An example of sending data points to different streams is shown @ref data_point_sample.
  *
+ * @subsection columnar_format Columnar format
+ *
+ * When @ref CONNECTOR_DATA_POINTS_COLUMNAR is defined and <b><i>format</i></b> is set to
+ * connector_data_point_format_columnar, the streams are uploaded to a path ending in ".dpc" instead of ".csv"
+ * and are encoded column by column. Every stream must be an integer, long, float or double stream
+ * (long, float and double need @ref CONNECTOR_SUPPORTS_64_BIT_INTEGERS and @ref CONNECTOR_SUPPORTS_FLOATING_POINT),
+ * hold native values, have no description and either use the cloud time for every point or a
+ * local epoch time for every point. Location and quality are not sent.
+ *
+ * All varints below are unsigned LEB128 (7 bits per byte, least significant group first) and a
+ * signed delta is zigzag mapped ((d << 1) ^ (d >> (bits - 1))) in the width of its column before
+ * it is stored as a varint:
+ *
+ * @code
+ *   "DPC" 0x01                               magic and version
+ *   for each stream:
+ *     varint length, stream_id
+ *     varint length, unit                    (0 if NULL)
+ *     varint length, forward_to              (0 if NULL)
+ *     uint8 type                             connector_data_point_type_t value
+ *     uint8 flags                            0x01 = time column present
+ *     varint point count
+ *     time column, if present:               for each point,
+ *       zigzag varint seconds delta            from the previous point (first point from 0)
+ *       varint milliseconds
+ *     value column:                          for each point,
+ *       integer, long:                         zigzag varint delta from the previous value (first from 0)
+ *       float, double:                         big endian IEEE754
+ * @endcode
+ *
+ * Device Cloud must understand the ".dpc" upload for this format to be used.
+ *
  * @subsection data_point_response  Data Point response
  *
  * After calling connector_initiate_action(), Cloud Connector will prepare and send data point request
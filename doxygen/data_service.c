@@ -201,6 +201,10 @@
  *       <li><b><i>bytes_available</i></b>, the maximum number of bytes the user can copy to the buffer </li>
  *       <li><b><i>bytes_used</i></b>, the number of bytes filled, cannot be more than the bytes_available </li>
  *       <li><b><i>more_data</i></b>, set to connector_true if more data to send, the callback will be called again in that case </li>
+ *       <li><b><i>external_buffer</i></b>, NULL on entry. Set it to point to bytes_used bytes of the application's memory to have them
+ *           sent without being copied to buffer. The memory must stay valid and unchanged until the send completes. The next callback
+ *           for this request, data, response or status, is only made once it has been sent or taken off the send queue. Over TCP the
+ *           data is passed to the @ref send_iov callback, or compressed, straight from there; other transports still copy it.</li>
  *     </ul>
  *   </td>
  * </tr>
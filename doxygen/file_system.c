@@ -123,6 +123,9 @@
  *  -# Cloud Connector calls the callback to @ref file_system_close "close a file" or @ref file_system_closedir "close a directory", 
  *     if there is an open file or directory.
  *  -# Cloud Connector cancels the session.
+ *
+ * When the session error comes while response data is being sent, these callbacks are made once that data has been sent
+ * or taken off the send queue.
  * <br /><br />
  *
  * @section file_system_large_files Large File Support
@@ -389,6 +392,11 @@
  *      <li><b><i>bytes_available</i></b> - [IN] Size of the memory buffer</li>
  *      <br />
  *      <li><b><i>bytes_used</i></b> - [OUT] Number of bytes retrieved from the file and placed in the memory buffer</li>
+ *      <br />
+ *      <li><b><i>external_buffer</i></b> - [OUT] NULL on entry. Set it to point to bytes_used bytes of the application's memory,
+ *          for example a memory mapped region of the file, to have them sent without being copied to buffer. The memory must
+ *          stay valid and unchanged until the next read or close callback for the file. Those are only made once the data has been
+ *          sent or taken off the send queue, so a mapping can be released in the close callback.</li>
  *   </ul>
  * </td>
  * </tr> 
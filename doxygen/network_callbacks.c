@@ -9,6 +9,7 @@
  *
  *  -# @ref open
  *  -# @ref send
+ *  -# @ref send_iov
  *  -# @ref receive
  *  -# @ref close
  * <br /><br />
@@ -181,6 +182,75 @@
  * @endhtmlonly
  * <br /><br />
  *
+ * @section send_iov Vectored Send
+ *
+ * Optional callback called to send several queued packets to Device Cloud in one call
+ * (for example with writev()). It is only used for @ref connector_class_id_network_tcp when more than one
+ * packet is waiting in the send queue, see @ref CONNECTOR_TCP_SEND_QUEUE_SIZE. This function must not block.
+ * The buffers must be sent in order and the number of bytes actually sent could be less than the
+ * total number of bytes requested.
+ *
+ * If the callback returns @ref connector_callback_unrecognized, Cloud Connector sends one packet at a time
+ * with @ref send for the rest of the connection.
+ *
+ * This callback is trapped in application.c, in the @b Sample section of @ref AppStructure "Public Application Framework"
+ * and implemented in the @b Platform function:
+ * <ul>
+ *   <li> app_network_tcp_send_iov() in network_tcp.c</li>
+ * </ul>
+ * <br />
+ *
+ * @htmlonly
+ * <table class="apitable">
+ * <tr> <th colspan="2" class="title">Arguments</th> </tr>
+ * <tr><th class="subtitle">Name</th> <th class="subtitle">Description</th></tr>
+ * <tr>
+ * <th>class_id</th>
+ * <td>@endhtmlonly @ref connector_class_id_network_tcp @htmlonly</td>
+ * </tr>
+ * <tr>
+ * <th>request_id</th>
+ * <td>@endhtmlonly @ref connector_request_id_network_send_iov @htmlonly</td>
+ * </tr>
+ * <tr>
+ * <th>data</th>
+ * <td>Pointer to @endhtmlonly @ref connector_network_send_iov_t "connector_network_send_iov_t" @htmlonly structure
+ *        <ul>
+ *          <li><b><i>handle</i></b> - [In] @endhtmlonly @ref connector_network_handle_t "Network handle" @htmlonly </li>
+ *          <li><b><i>iov</i></b> - [In] Array of buffers to send </li>
+ *          <li><b><i>iov_count</i></b> - [In] Number of buffers in the array </li>
+ *          <li><b><i>bytes_available</i></b> - [In] Total number of bytes to send </li>
+ *          <li><b><i>bytes_used</i></b> - [OUT] Number of bytes sent </li>
+ *        </ul>
+ * </td>
+ * </tr>
+ * <tr> <th colspan="2" class="title">Return Values</th> </tr>
+ * <tr><th class="subtitle">Values</th> <th class="subtitle">Description</th></tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_continue @htmlonly</td>
+ * <td>Callback successfully sent data to Device Cloud</td>
+ * </tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_busy @htmlonly</td>
+ * <td>Callback could not send data due to temporary unavailability of resources. It needs to be called again to send data</td>
+ * </tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_unrecognized @htmlonly</td>
+ * <td>Vectored send is not supported. Cloud Connector uses @endhtmlonly @ref send @htmlonly instead</td>
+ * </tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_error @htmlonly</td>
+ * <td>Callback was unable to send data due to irrecoverable communications error.
+ *     Cloud Connector will @endhtmlonly @ref close "close" @htmlonly the network handle</td>
+ * </tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_abort @htmlonly</td>
+ * <td>Callback aborted Cloud Connector</td>
+ * </tr>
+ * </table>
+ * @endhtmlonly
+ * <br /><br />
+ *
  * @section receive Receive
  *
  * Callback called to receive a specified number of data bytes from
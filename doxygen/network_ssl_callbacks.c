@@ -56,6 +56,8 @@
  *        <ul>
  *          <li><b><i>device_cloud_url</i></b> - [IN] Pointer to cloud URL that callback will make connection to on @endhtmlonly @ref CONNECTOR_SSL_PORT @htmlonly for secure communication </li>
  *          <li><b><i>handle</i></b> - [OUT] Returned @endhtmlonly @ref connector_network_handle_t "network handle" @htmlonly which is used throughout network callbacks </li>
+ *          <li><b><i>wait_for_receive</i></b> - [OUT] Set to connector_true when returning @endhtmlonly @ref connector_callback_busy @htmlonly while the TLS handshake waits to read,
+ *              so @endhtmlonly @ref connector_get_wait_set "connector_get_wait_set()" @htmlonly reports the handle for receiving instead of sending </li>
  *        </ul>
  * </td>
  * </tr>
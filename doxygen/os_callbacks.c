@@ -12,6 +12,8 @@
  *  -# @ref uptime
  *  -# @ref yield
  *  -# @ref reboot
+ *  -# @ref wakeup
+ *  -# @ref uptime_in_ms
  * <br /><br />
  *
  * @section malloc malloc
@@ -400,6 +402,94 @@
  * }
  *
  * @endcode
+ * <br />
+ *
+ * @section wakeup Wakeup
+ *
+ * Optional callback called by connector_initiate_action() when a request is accepted. It lets an
+ * application which sleeps on the handles and timeout reported by connector_get_wait_set() return to
+ * connector_step() right away. It is called from the thread calling connector_initiate_action(), so
+ * it must be thread safe and must not block. Returning @ref connector_callback_unrecognized stops further calls.
+ *
+ * This callback is trapped in application.c, in the @b Sample section of @ref AppStructure "Public Application Framework"
+ * and implemented in the @b Platform function app_os_wakeup() in os.c, which writes to a pipe
+ * watched by app_os_wait().
+ *
+ * @htmlonly
+ * <table class="apitable">
+ * <tr> <th colspan="2" class="title">Arguments</th> </tr>
+ * <tr><th class="subtitle">Name</th> <th class="subtitle">Description</th></tr>
+ * <tr>
+ * <th>class_id</th>
+ * <td>@endhtmlonly @ref connector_class_id_operating_system @htmlonly</td>
+ * </tr>
+ * <tr>
+ * <th>request_id</th>
+ * <td>@endhtmlonly @ref connector_request_id_os_wakeup @htmlonly</td>
+ * </tr>
+ * <tr>
+ * <th>data</th>
+ * <td> N/A </td>
+ * </tr>
+ * <tr> <th colspan="2" class="title">Return Values</th> </tr>
+ * <tr><th class="subtitle">Values</th> <th class="subtitle">Description</th></tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_continue @htmlonly</td>
+ * <td>Callback woke up the waiting thread</td>
+ * </tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_unrecognized @htmlonly</td>
+ * <td>Not supported, Cloud Connector will not call it again</td>
+ * </tr>
+ * </table>
+ * @endhtmlonly
+ * <br />
+ *
+ * @section uptime_in_ms System Uptime in Milliseconds
+ *
+ * Optional callback used by debug builds to time each phase of the EDP handshake. Without it the
+ * phases are timed with the seconds of the @ref uptime callback. The time must not go backwards and may
+ * wrap around. Returning @ref connector_callback_unrecognized stops further calls.
+ *
+ * This callback is trapped in application.c, in the @b Sample section of @ref AppStructure "Public Application Framework"
+ * and implemented in the @b Platform function app_os_get_system_time_in_ms() in os.c.
+ *
+ * @htmlonly
+ * <table class="apitable">
+ * <tr> <th colspan="2" class="title">Arguments</th> </tr>
+ * <tr><th class="subtitle">Name</th> <th class="subtitle">Description</th></tr>
+ * <tr>
+ * <th>class_id</th>
+ * <td>@endhtmlonly @ref connector_class_id_operating_system @htmlonly</td>
+ * </tr>
+ * <tr>
+ * <th>request_id</th>
+ * <td>@endhtmlonly @ref connector_request_id_os_system_up_time_in_ms @htmlonly</td>
+ * </tr>
+ * <tr>
+ *     <th>data</th>
+ *     <td>Pointer to @endhtmlonly @ref connector_os_system_up_time_t "connector_os_system_up_time_t" @htmlonly structure
+ *        <ul>
+ *          <li><b><i>sys_uptime</i></b> - [OUT] Returned system up time in milliseconds </li>
+ *        </ul>
+ *      </td>
+ * </tr>
+ * <tr> <th colspan="2" class="title">Return Values</th> </tr>
+ * <tr><th class="subtitle">Values</th> <th class="subtitle">Description</th></tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_continue @htmlonly</td>
+ * <td>Callback successfully returned the system time</td>
+ * </tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_unrecognized @htmlonly</td>
+ * <td>Not supported, Cloud Connector will not call it again</td>
+ * </tr>
+ * <tr>
+ * <td>@endhtmlonly @ref connector_callback_abort @htmlonly</td>
+ * <td>Error occurred and callback aborted Cloud Connector</td>
+ * </tr>
+ * </table>
+ * @endhtmlonly
  *
  * @htmlinclude terminate.html
  */
@@ -313,6 +313,21 @@
  *                    This string cannot be altered until next callback call.
  *                    Note: This must be set to NULL for no hint string when error_id is set.</dd>
  *             <dt><i>element_value</i></dt><dd>Not applicable</dd>
+ *             <dt><i>element_values</i></dt>
+ *             <dd> - Only available when @endhtmlonly @ref CONNECTOR_RCI_GROUP_PROCESS @htmlonly is defined and
+ *                    action is @endhtmlonly @ref connector_remote_action_query.@htmlonly
+ *                    Callback may point this to an array of @endhtmlonly @ref connector_element_value_t @htmlonly
+ *                    holding the value of every element of the group instance, indexed by element id.
+ *                    Cloud Connector then serializes the requested elements from the array and does not call
+ *                    @endhtmlonly @ref rci_group_query @htmlonly for them. The array and any strings it points to
+ *                    must remain valid until @endhtmlonly @ref rci_group_end @htmlonly is called.
+ *                    Leave it NULL to be called for each element.</dd>
+ *             <dt><i>cache_ttl</i></dt>
+ *             <dd> - Only available when @endhtmlonly @ref CONNECTOR_RCI_CACHE @htmlonly is defined and
+ *                    action is @endhtmlonly @ref connector_remote_action_query.@htmlonly
+ *                    Number of seconds the response for this group instance may be served from the cache.
+ *                    While it is, later queries for the instance are answered without calling the group callbacks.
+ *                    Preset to @endhtmlonly @ref CONNECTOR_RCI_CACHE_DEFAULT_TTL.@htmlonly</dd>
  *         </dl></dd>
  *     </dl>
  * </td></tr>
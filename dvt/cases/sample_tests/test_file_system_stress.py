@@ -0,0 +1,118 @@
+import os
+import shutil
+import tempfile
+import threading
+import base64
+import hashlib
+
+import xml.dom.minidom
+
+import ic_testcase
+from ..utils import getText
+
+SESSIONS = 4
+FILE_SIZE = 256 * 1024
+LS_FILES = 20
+
+class FileSystemStressTestCase(ic_testcase.TestCase):
+
+    def test_concurrent_get_put_ls(self):
+
+        """ Runs get_file, put_file and ls requests at the same time and
+        checks that every one of them returns the right data.
+        """
+        work_dir = tempfile.mkdtemp()
+        errors = []
+
+        try:
+            get_files = []
+            for i in xrange(SESSIONS):
+                path = os.path.join(work_dir, "get%d" % i)
+                data = os.urandom(FILE_SIZE)
+                f = open(path, "wb")
+                f.write(data)
+                f.close()
+                get_files.append((path, data))
+
+            put_files = [(os.path.join(work_dir, "put%d" % i), os.urandom(FILE_SIZE))
+                         for i in xrange(SESSIONS)]
+
+            ls_dir = os.path.join(work_dir, "ls")
+            os.mkdir(ls_dir)
+            ls_hashes = {}
+            for i in xrange(LS_FILES):
+                path = os.path.join(ls_dir, "f%d" % i)
+                data = os.urandom(FILE_SIZE / 4)
+                f = open(path, "wb")
+                f.write(data)
+                f.close()
+                ls_hashes[path] = hashlib.md5(data).hexdigest().upper()
+
+            threads = []
+            for path, data in get_files:
+                threads.append(threading.Thread(target=self.check_get, args=(path, data, errors)))
+            for path, data in put_files:
+                threads.append(threading.Thread(target=self.check_put, args=(path, data, errors)))
+            for i in xrange(SESSIONS):
+                threads.append(threading.Thread(target=self.check_ls, args=(ls_dir, ls_hashes, errors)))
+
+            self.log.info("Starting %d file system requests to device id %s." % (len(threads), self.device_id))
+            for thread in threads:
+                thread.start()
+            for thread in threads:
+                thread.join()
+
+            self.assertEqual([], errors, "%d of %d requests failed: %s" % (len(errors), len(threads), errors))
+        finally:
+            shutil.rmtree(work_dir)
+
+    def send_request(self, command):
+        request = \
+            """<sci_request version="1.0">
+              <file_system>
+                <targets>
+                  <device id="%s"/>
+                </targets>
+                <commands>
+                %s
+                </commands>
+              </file_system>
+            </sci_request>""" % (self.device_id, command)
+
+        response = self.session.post('http://%s/ws/sci' % self.hostname, data=request)
+        return xml.dom.minidom.parseString(response.content)
+
+    def check_get(self, path, data, errors):
+        try:
+            dom = self.send_request('<get_file path="%s"/>' % path)
+            get_data = dom.getElementsByTagName("get_file")
+            recv_data = base64.b64decode(getText(get_data[0].getElementsByTagName("data")[0]))
+            if recv_data != data:
+                errors.append("get_file %s returned %d bytes that do not match" % (path, len(recv_data)))
+        except Exception, e:
+            errors.append("get_file %s: %s" % (path, e))
+
+    def check_put(self, path, data, errors):
+        try:
+            self.send_request('<put_file path="%s" offset="0" truncate="true"><data>%s</data></put_file>'
+                              % (path, base64.encodestring(data)))
+            f = open(path, "rb")
+            written = f.read()
+            f.close()
+            if written != data:
+                errors.append("put_file %s wrote %d bytes that do not match" % (path, len(written)))
+        except Exception, e:
+            errors.append("put_file %s: %s" % (path, e))
+
+    def check_ls(self, path, hashes, errors):
+        try:
+            dom = self.send_request('<ls path="%s" hash="md5"/>' % path)
+            listed = dict((f.getAttribute("path"), f.getAttribute("hash").upper())
+                          for f in dom.getElementsByTagName("file"))
+            if listed != hashes:
+                errors.append("ls %s returned %d files, %d expected" % (path, len(listed), len(hashes)))
+        except Exception, e:
+            errors.append("ls %s: %s" % (path, e))
+
+if __name__ == '__main__':
+    unittest.main()
@@ -153,11 +153,13 @@ PLATFORM = template"""
         subs['PLATFORM_SRCS'] += ' $(PLATFORM_DIR)/network_dns.c'
         subs['PLATFORM_SRCS'] += ' $(PLATFORM_DIR)/network_tcp_ssl.c'
         subs['PLATFORM_SRCS'] += ' $(PLATFORM_DIR)/network_udp.c'
-        subs['LIBS'] += ' -lssl -lcrypto'
+        subs['LIBS'] += ' -lssl -lcrypto -lresolv'
     elif sample not in LINK_SAMPLES:
         if 'network.c' not in app_src:
             if 'network_dns.c' not in app_src:
                 subs['PLATFORM_SRCS'] += ' $(PLATFORM_DIR)/network_dns.c'
+                # network_dns.c reads the time to live of the DNS records.
+                subs['LIBS'] += ' -lresolv'
             if 'network_tcp.c' not in app_src:
                 subs['PLATFORM_SRCS'] += ' $(PLATFORM_DIR)/network_tcp.c'
             if 'network_udp.c' not in app_src:
@@ -195,6 +197,14 @@ LIBS += -lcrypto
 CFLAGS+= -DAPP_ENABLE_MD5=true
 endif"""
 
+    if sample == 'file_system' and mode == 'run':
+        # Run the file system callbacks on worker threads, the stress test
+        # sends get, put and ls requests at the same time.
+        subs['LIBS'] += """
+
+APP_FILE_SYSTEM_WORKER_THREADS ?= 4
+CFLAGS += -DAPP_FILE_SYSTEM_WORKER_THREADS=$(APP_FILE_SYSTEM_WORKER_THREADS)"""
+
     if sample == 'ic_timing':
         subs['LIBS'] += ' -lrt' 
 
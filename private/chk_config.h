@@ -56,6 +56,10 @@
 
 #endif
 
+#if (defined CONNECTOR_NO_MALLOC_POOL) && !(defined CONNECTOR_NO_MALLOC)
+    #error "CONNECTOR_NO_MALLOC_POOL requires CONNECTOR_NO_MALLOC"
+#endif
+
 #if (defined CONNECTOR_NO_MALLOC_RCI_MAXIMUM_CONTENT_LENGTH)
 #if CONNECTOR_NO_MALLOC_RCI_MAXIMUM_CONTENT_LENGTH > SIZE_MAX
     #error "Invalid CONNECTOR_NO_MALLOC_RCI_MAXIMUM_CONTENT_LENGTH, it must be lower than SIZE_MAX"
@@ -82,6 +86,63 @@
 #endif
 #endif
 
+#if (defined CONNECTOR_SM_CRC16_BITWISE) && (defined CONNECTOR_SM_CRC16_SLICE_BY_8)
+    #error "Only one of CONNECTOR_SM_CRC16_BITWISE and CONNECTOR_SM_CRC16_SLICE_BY_8 may be defined"
+#endif
+
+#if (defined CONNECTOR_RCI_CACHE)
+#if !(defined CONNECTOR_RCI_SERVICE)
+    #error "You must define CONNECTOR_RCI_SERVICE in order to use CONNECTOR_RCI_CACHE"
+#endif
+#if (CONNECTOR_RCI_CACHE_ENTRIES < 1) || (CONNECTOR_RCI_CACHE_ENTRIES > 255)
+    #error "CONNECTOR_RCI_CACHE_ENTRIES must be in the range of 1-255"
+#endif
+#if (CONNECTOR_RCI_CACHE_ENTRY_SIZE < 16)
+    #error "CONNECTOR_RCI_CACHE_ENTRY_SIZE must be at least 16"
+#endif
+#if !(defined CONNECTOR_COMPARE_AND_SWAP)
+    #error "You must define CONNECTOR_COMPARE_AND_SWAP in order to use CONNECTOR_RCI_CACHE"
+#endif
+#endif
+
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+#if !(defined CONNECTOR_DATA_SERVICE)
+    #error "You must define CONNECTOR_DATA_SERVICE in order to use CONNECTOR_DEVICE_REQUEST_TARGETS"
+#endif
+#if (CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE < 4) || ((CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE & (CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE - 1)) != 0)
+    #error "CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE must be a power of 2 and at least 4"
+#endif
+#if (CONNECTOR_DEVICE_REQUEST_TARGET_CONTEXTS < 1) || (CONNECTOR_DEVICE_REQUEST_TARGET_CONTEXTS > 16)
+    #error "CONNECTOR_DEVICE_REQUEST_TARGET_CONTEXTS must be in the range of 1-16"
+#endif
+#endif
+
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+#if !(defined CONNECTOR_FIRMWARE_SERVICE)
+    #error "You must define CONNECTOR_FIRMWARE_SERVICE in order to use CONNECTOR_FIRMWARE_PIPELINE_BLOCKS"
+#endif
+#if (CONNECTOR_FIRMWARE_PIPELINE_BLOCKS < 1) || (CONNECTOR_FIRMWARE_PIPELINE_BLOCKS > 255)
+    #error "CONNECTOR_FIRMWARE_PIPELINE_BLOCKS must be in the range of 1-255"
+#endif
+#endif
+
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+#if !(defined CONNECTOR_STREAMING_CLI_SERVICE)
+    #error "You must define CONNECTOR_STREAMING_CLI_SERVICE in order to use CONNECTOR_STREAMING_CLI_NOTIFY_READY"
+#endif
+#if !(defined CONNECTOR_COMPARE_AND_SWAP)
+    #error "You must define CONNECTOR_COMPARE_AND_SWAP in order to use CONNECTOR_STREAMING_CLI_NOTIFY_READY"
+#endif
+#endif
+
+#if (defined CONNECTOR_STREAMING_CLI_POLL_BUDGET) && !(defined CONNECTOR_STREAMING_CLI_SERVICE)
+    #error "You must define CONNECTOR_STREAMING_CLI_SERVICE in order to use CONNECTOR_STREAMING_CLI_POLL_BUDGET"
+#endif
+
+#if (defined CONNECTOR_SHORTEST_DOUBLE_FORMAT) && !(defined CONNECTOR_SUPPORTS_64_BIT_INTEGERS)
+    #error "You must define CONNECTOR_SUPPORTS_64_BIT_INTEGERS in order to use CONNECTOR_SHORTEST_DOUBLE_FORMAT"
+#endif
+
 #if (defined CONNECTOR_SM_MAX_DATA_POINTS_SEGMENTS) && (CONNECTOR_SM_MAX_DATA_POINTS_SEGMENTS > 1) && (!defined CONNECTOR_SM_MULTIPART)
     #error "You must define CONNECTOR_SM_MULTIPART in order to set CONNECTOR_SM_MAX_DATA_POINTS_SEGMENTS bigger than 1"
 #endif
@@ -98,13 +159,16 @@
 #endif
 
 #if ! (defined CONNECTOR_COMPRESSION_LEVEL)
-#define CONNECTOR_COMPRESSION_LEVEL Z_DEFAULT_COMPRESSION
+#define CONNECTOR_COMPRESSION_LEVEL 6
 #endif
 #if ! (defined CONNECTOR_COMPRESSION_WINDOW_BITS)
-#define CONNECTOR_COMPRESSION_WINDOW_BITS MAX_MEM_LEVEL
+#define CONNECTOR_COMPRESSION_WINDOW_BITS MAX_WBITS
 #endif
 #if ! (defined CONNECTOR_COMPRESSION_MEM_LEVEL)
-#define CONNECTOR_COMPRESSION_MEM_LEVEL MAX_WBITS
+#define CONNECTOR_COMPRESSION_MEM_LEVEL 8
+#endif
+#if ! (defined CONNECTOR_COMPRESSION_STREAM_POOL_SIZE)
+#define CONNECTOR_COMPRESSION_STREAM_POOL_SIZE 0
 #endif
 
 #if (CONNECTOR_COMPRESSION_LEVEL < 1) || (CONNECTOR_COMPRESSION_LEVEL > 9) || (CONNECTOR_COMPRESSION_LEVEL == Z_DEFAULT_COMPRESSION)
@@ -116,5 +180,8 @@
 #if (CONNECTOR_COMPRESSION_MEM_LEVEL < 1) || (CONNECTOR_COMPRESSION_MEM_LEVEL > 9)
 #error "CONNECTOR_COMPRESSION_MEM_LEVEL must be in the range of 1-9"
 #endif
+#if (CONNECTOR_COMPRESSION_STREAM_POOL_SIZE < 0) || (CONNECTOR_COMPRESSION_STREAM_POOL_SIZE > 255)
+#error "CONNECTOR_COMPRESSION_STREAM_POOL_SIZE must be in the range of 0-255"
+#endif
 
 #endif
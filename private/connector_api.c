@@ -86,6 +86,37 @@ STATIC uint32_t idle_time(connector_data_t * const connector_ptr, connector_netw
     return (now - last);
 }
 
+/* Longest wait reported by connector_get_wait_set() when no timer is running */
+#define WAIT_SET_MAX_TIMEOUT_IN_SECONDS     60
+/* Wait reported while sessions are active, they may be waiting on a busy application callback */
+#define WAIT_SET_ACTIVE_TIMEOUT_IN_MS       100
+/* Wait reported for a deadline already due, the system time is in whole seconds so it may not be seen as passed yet */
+#define WAIT_SET_DUE_TIMEOUT_IN_MS          10
+
+STATIC void wait_set_timeout(connector_wait_set_t * const wait_set, unsigned long const timeout_in_milliseconds)
+{
+    if (timeout_in_milliseconds < wait_set->timeout_in_milliseconds)
+    {
+        wait_set->timeout_in_milliseconds = timeout_in_milliseconds;
+    }
+}
+
+STATIC void wait_set_deadline(connector_wait_set_t * const wait_set, unsigned long const now, unsigned long const deadline)
+{
+    if (deadline <= now)
+    {
+        wait_set_timeout(wait_set, WAIT_SET_DUE_TIMEOUT_IN_MS);
+    }
+    else if ((deadline - now) < WAIT_SET_MAX_TIMEOUT_IN_SECONDS)
+    {
+        wait_set_timeout(wait_set, (deadline - now) * 1000);
+    }
+}
+
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+#include "connector_data_service_target.h"
+#endif
+
 #if (defined CONNECTOR_DATA_POINTS)
 #include "connector_data_point.h"
 #endif
@@ -99,8 +130,12 @@ STATIC uint32_t idle_time(connector_data_t * const connector_ptr, connector_netw
 #endif
 
 #ifdef CONNECTOR_NO_MALLOC
+#if (defined CONNECTOR_NO_MALLOC_POOL)
+#include "connector_static_pool.h"
+#else
 #include "connector_static_buffer.h"
 #endif
+#endif
 
 #define DEVICE_ID_LENGTH 16
 
@@ -382,6 +417,9 @@ connector_handle_t connector_init(connector_callback_t const callback, void * co
         encryption_data->current.valid &=
             sm_configuration_load(connector_handle, connector_transport_sms, connector_sm_encryption_data_type_tracking,
                 &connector_handle->sm_sms.request.tracking, sizeof connector_handle->sm_sms.request.tracking);
+#if (defined SM_TRACKING_WRITE_BACK)
+        sm_load_tracking_journal(connector_handle, connector_transport_sms);
+#endif
 #endif
 #if (defined CONNECTOR_TRANSPORT_UDP)
         encryption_data->current.valid &=
@@ -391,6 +429,9 @@ connector_handle_t connector_init(connector_callback_t const callback, void * co
         encryption_data->current.valid &=
             sm_configuration_load(connector_handle, connector_transport_udp, connector_sm_encryption_data_type_tracking,
                 &connector_handle->sm_udp.request.tracking, sizeof connector_handle->sm_udp.request.tracking);
+#if (defined SM_TRACKING_WRITE_BACK)
+        sm_load_tracking_journal(connector_handle, connector_transport_udp);
+#endif
 #endif
 
         /* if our previous key is not valid, that's okay -- we may drop some messages in flight, but we don't need a new key */
@@ -464,9 +505,6 @@ connector_handle_t connector_init(connector_callback_t const callback, void * co
 #if (defined CONNECTOR_MULTIPLE_TRANSPORTS)
     connector_handle->first_running_network = (connector_network_type_t) 0;
 #endif
-#if (defined CONNECTOR_DATA_POINTS)
-    connector_handle->process_csv = connector_true;
-#endif
 
     goto done;
 
@@ -631,6 +669,117 @@ connector_status_t connector_run(connector_handle_t const handle)
     return rc;
 }
 
+connector_status_t connector_get_wait_set(connector_handle_t const handle, connector_wait_set_t * const wait_set)
+{
+    connector_status_t result = connector_init_error;
+    connector_data_t * const connector_ptr = (connector_data_t *)handle;
+    unsigned long now;
+
+    ASSERT_GOTO(handle != NULL, done);
+
+    if (wait_set == NULL)
+    {
+        result = connector_invalid_data;
+        goto done;
+    }
+
+    result = get_system_time(connector_ptr, &now);
+    COND_ELSE_GOTO(result == connector_working, done);
+
+    wait_set->timeout_in_milliseconds = WAIT_SET_MAX_TIMEOUT_IN_SECONDS * 1000;
+
+    if (connector_ptr->stop.state != connector_state_running)
+    {
+        wait_set_timeout(wait_set, WAIT_SET_ACTIVE_TIMEOUT_IN_MS);
+    }
+
+#if (defined CONNECTOR_TRANSPORT_TCP)
+    edp_get_wait_set(connector_ptr, &wait_set->tcp, wait_set, now);
+#endif
+#if (defined CONNECTOR_TRANSPORT_UDP)
+    sm_get_wait_set(connector_ptr, &connector_ptr->sm_udp, &wait_set->udp, wait_set, now);
+#endif
+#if (defined CONNECTOR_TRANSPORT_SMS)
+    sm_get_wait_set(connector_ptr, &connector_ptr->sm_sms, &wait_set->sms, wait_set, now);
+#endif
+
+    result = connector_success;
+
+done:
+    return result;
+}
+
+#if (defined CONNECTOR_RCI_CACHE)
+connector_status_t connector_get_rci_cache_statistics(connector_handle_t const handle, connector_rci_cache_statistics_t * const statistics)
+{
+    connector_status_t result = connector_init_error;
+    connector_data_t const * const connector_ptr = (connector_data_t *)handle;
+
+    ASSERT_GOTO(handle != NULL, done);
+
+    if (statistics == NULL)
+    {
+        result = connector_invalid_data;
+        goto done;
+    }
+
+    statistics->hits = connector_ptr->rci_cache.hits;
+    statistics->misses = connector_ptr->rci_cache.misses;
+    result = connector_success;
+
+done:
+    return result;
+}
+#endif
+
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+connector_status_t connector_register_device_request_target(connector_handle_t const handle, char const * const target,
+                                                            connector_device_request_handler_t const handler, void * const context)
+{
+    connector_status_t result = connector_init_error;
+    connector_data_t * const connector_ptr = (connector_data_t *)handle;
+
+    ASSERT_GOTO(handle != NULL, done);
+
+    if (target == NULL)
+    {
+        result = connector_invalid_data;
+        goto done;
+    }
+
+    result = ds_register_target(&connector_ptr->ds_targets, target, handler, context);
+
+done:
+    return result;
+}
+#endif
+
+#if (defined CONNECTOR_NO_MALLOC_POOL)
+connector_status_t connector_get_pool_statistics(connector_handle_t const handle, unsigned int const size_class, connector_pool_statistics_t * const statistics)
+{
+    connector_status_t result = connector_init_error;
+
+    ASSERT_GOTO(handle == &connector_static_pool.connector_data, done);
+
+    if (statistics == NULL || size_class >= POOL_CLASS_COUNT)
+    {
+        result = connector_invalid_data;
+        goto done;
+    }
+
+    statistics->block_size = pool_class_config[size_class].block_size;
+    statistics->block_count = pool_class_config[size_class].block_count;
+    statistics->used = connector_static_pool.size_class[size_class].used;
+    statistics->high_water = connector_static_pool.size_class[size_class].high_water;
+    statistics->failures = connector_static_pool.size_class[size_class].failures;
+    statistics->spills = connector_static_pool.size_class[size_class].spills;
+    result = connector_success;
+
+done:
+    return result;
+}
+#endif
+
 connector_status_t connector_initiate_action(connector_handle_t const handle, connector_initiate_request_t const request, void const * const request_data)
 {
     connector_status_t result = connector_init_error;
@@ -659,6 +808,36 @@ connector_status_t connector_initiate_action(connector_handle_t const handle, co
         result = connector_success;
         break;
 
+#if (defined CONNECTOR_RCI_CACHE)
+    case connector_initiate_rci_cache_invalidate:
+        rci_cache_request_invalidate(&connector_ptr->rci_cache, request_data);
+        result = connector_success;
+        /* nothing to wake up, the next query applies it */
+        goto error;
+#endif
+
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+    case connector_initiate_firmware_write_complete:
+        if (request_data == NULL)
+        {
+            result = connector_invalid_data;
+            goto error;
+        }
+        result = fw_pipeline_write_complete(connector_ptr, request_data);
+        goto error;
+#endif
+
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+    case connector_initiate_streaming_cli_ready:
+        if (request_data == NULL)
+        {
+            result = connector_invalid_data;
+            goto error;
+        }
+        result = streaming_cli_service_notify_ready(request_data);
+        goto error;
+#endif
+
    default:
 
         if (request_data == NULL)
@@ -732,6 +911,9 @@ connector_status_t connector_initiate_action(connector_handle_t const handle, co
     }
 
 done:
+    if (result == connector_success)
+        wakeup_process(connector_ptr);
+
 #if (defined CONNECTOR_TRANSPORT_TCP)
     if (transport == connector_transport_tcp || transport == connector_transport_all)
         register_activity(connector_ptr, connector_network_tcp);
@@ -20,6 +20,9 @@
 #if (defined CONNECTOR_DATA_POINTS)
 
 #include "connector_data_point_csv_generator.h"
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+#include "connector_data_point_columnar_generator.h"
+#endif
 
 typedef struct
 {
@@ -35,6 +38,10 @@ typedef struct
     {
         dp_content_type_binary,
         dp_content_type_csv
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+        ,
+        dp_content_type_columnar
+#endif
     } type;
 
     union
@@ -45,6 +52,14 @@ typedef struct
             csv_process_data_t process_data;
         } csv;
 
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+        struct
+        {
+            connector_request_data_point_t const * dp_request;
+            columnar_process_data_t process_data;
+        } columnar;
+#endif
+
 
         struct
         {
@@ -62,20 +77,88 @@ static size_t const internal_dp4d_path_strlen = sizeof internal_dp4d_path - 1;
 static char const dp4d_path_prefix[] = "DataPoint/";
 static size_t const dp4d_path_prefix_strlen = sizeof dp4d_path_prefix - 1;
 
-static connector_request_data_point_t const * data_point_pending = NULL;
-static connector_request_data_point_binary_t const * data_point_binary_pending = NULL;
+#if !(defined CONNECTOR_DATA_POINTS_MAX_PENDING)
+#if (defined CONNECTOR_MSG_MAX_TRANSACTION) && (CONNECTOR_MSG_MAX_TRANSACTION > 0)
+#define CONNECTOR_DATA_POINTS_MAX_PENDING   CONNECTOR_MSG_MAX_TRANSACTION
+#else
+#define CONNECTOR_DATA_POINTS_MAX_PENDING   1
+#endif
+#endif
 
-STATIC connector_status_t dp_initiate_data_point(connector_request_data_point_t const * const dp_ptr)
+#if (CONNECTOR_DATA_POINTS_MAX_PENDING < 1) || (CONNECTOR_DATA_POINTS_MAX_PENDING > 255)
+#error "CONNECTOR_DATA_POINTS_MAX_PENDING must be between 1-255"
+#endif
+
+typedef struct
+{
+    enum
+    {
+        dp_pending_csv,
+        dp_pending_binary
+    } type;
+
+    union
+    {
+        connector_request_data_point_t const * dp_request;
+        connector_request_data_point_binary_t const * bp_request;
+    } request;
+
+} dp_pending_request_t;
+
+typedef struct
+{
+    dp_pending_request_t entry[CONNECTOR_DATA_POINTS_MAX_PENDING];
+    unsigned int count;
+} dp_pending_queue_t;
+
+static dp_pending_queue_t dp_pending_queue[connector_transport_all];
+
+STATIC connector_status_t dp_enqueue_request(connector_transport_t const transport, dp_pending_request_t const * const pending)
 {
     connector_status_t result = connector_invalid_data;
+    dp_pending_queue_t * queue;
 
-    ASSERT_GOTO(dp_ptr != NULL, error);
+    if (transport >= connector_transport_all)
+    {
+        connector_debug_line("dp_enqueue_request: invalid transport [%d]", transport);
+        goto done;
+    }
 
-    if (data_point_pending != NULL)
+    queue = &dp_pending_queue[transport];
+    if (queue->count >= CONNECTOR_DATA_POINTS_MAX_PENDING)
     {
         result = connector_service_busy;
-        goto error;
+        goto done;
+    }
+
+    queue->entry[queue->count] = *pending;
+    queue->count++;
+    result = connector_success;
+
+done:
+    return result;
+}
+
+STATIC void dp_remove_request(dp_pending_queue_t * const queue, unsigned int const index)
+{
+    ASSERT(index < queue->count);
+
+    queue->count--;
+#if (CONNECTOR_DATA_POINTS_MAX_PENDING > 1)
+    if (index < queue->count)
+    {
+        memmove(&queue->entry[index], &queue->entry[index + 1], (queue->count - index) * sizeof queue->entry[0]);
     }
+#else
+    UNUSED_PARAMETER(index);
+#endif
+}
+
+STATIC connector_status_t dp_initiate_data_point(connector_request_data_point_t const * const dp_ptr)
+{
+    connector_status_t result = connector_invalid_data;
+
+    ASSERT_GOTO(dp_ptr != NULL, error);
 
     if (dp_ptr->stream == NULL)
     {
@@ -88,8 +171,37 @@ STATIC connector_status_t dp_initiate_data_point(connector_request_data_point_t
         goto error;
     }
 
-    data_point_pending = dp_ptr;
-    result = connector_success;
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+    switch (dp_ptr->format)
+    {
+        case connector_data_point_format_csv:
+            break;
+
+        case connector_data_point_format_columnar:
+        {
+            connector_data_stream_t const * stream;
+
+            for (stream = dp_ptr->stream; stream != NULL; stream = stream->next)
+            {
+                if (!dp_columnar_supported(stream))
+                    goto error;
+            }
+            break;
+        }
+
+        default:
+            connector_debug_line("dp_initiate_data_point: invalid format [%d]", dp_ptr->format);
+            goto error;
+    }
+#endif
+
+    {
+        dp_pending_request_t pending;
+
+        pending.type = dp_pending_csv;
+        pending.request.dp_request = dp_ptr;
+        result = dp_enqueue_request(dp_ptr->transport, &pending);
+    }
 
 error:
     return result;
@@ -101,12 +213,6 @@ STATIC connector_status_t dp_initiate_data_point_binary(connector_request_data_p
 
     ASSERT_GOTO(bp_ptr != NULL, error);
 
-    if (data_point_binary_pending != NULL)
-    {
-        result = connector_service_busy;
-        goto error;
-    }
-
     if (bp_ptr->path == NULL)
     {
         connector_debug_line("dp_initiate_data_point_binary: NULL data point path");
@@ -119,8 +225,13 @@ STATIC connector_status_t dp_initiate_data_point_binary(connector_request_data_p
         goto error;
     }
 
-    data_point_binary_pending = bp_ptr;
-    result = connector_success;
+    {
+        dp_pending_request_t pending;
+
+        pending.type = dp_pending_binary;
+        pending.request.bp_request = bp_ptr;
+        result = dp_enqueue_request(bp_ptr->transport, &pending);
+    }
 
 error:
     return result;
@@ -195,37 +306,52 @@ STATIC connector_status_t dp_inform_status(connector_data_t * const connector_pt
 }
 
 #if (defined CONNECTOR_SHORT_MESSAGE)
-STATIC connector_status_t dp_cancel_session(connector_data_t * const connector_ptr, void const * const session, uint32_t const * const request_id)
+STATIC connector_status_t dp_cancel_session(connector_data_t * const connector_ptr, connector_transport_t const transport, void const * const session, uint32_t const * const request_id)
 {
     connector_status_t status = connector_working;
     connector_bool_t cancel_all = connector_bool(request_id == NULL);
+    dp_pending_queue_t * const queue = &dp_pending_queue[transport];
+    unsigned int index = 0;
 
-    if (data_point_binary_pending != NULL)
+    while (index < queue->count)
     {
-        if (cancel_all || (data_point_binary_pending->request_id != NULL && *data_point_binary_pending->request_id == *request_id))
+        dp_pending_request_t const * const pending = &queue->entry[index];
+        uint32_t const * pending_id;
+        connector_request_id_data_point_t status_request;
+        connector_transport_t pending_transport;
+        void * user_context;
+
+        switch (pending->type)
         {
-            if (session == NULL)
-            {
-                status = dp_inform_status(connector_ptr, connector_request_id_data_point_binary_status, data_point_binary_pending->transport, data_point_binary_pending->user_context, connector_session_error_cancel);
-                if (status != connector_working)
-                  goto done;
-            }
-            data_point_binary_pending = NULL;
+            case dp_pending_binary:
+                pending_id = pending->request.bp_request->request_id;
+                status_request = connector_request_id_data_point_binary_status;
+                pending_transport = pending->request.bp_request->transport;
+                user_context = pending->request.bp_request->user_context;
+                break;
+
+            case dp_pending_csv:
+            default:
+                pending_id = pending->request.dp_request->request_id;
+                status_request = connector_request_id_data_point_status;
+                pending_transport = pending->request.dp_request->transport;
+                user_context = pending->request.dp_request->user_context;
+                break;
         }
-    }
 
-    if (data_point_pending != NULL)
-    {
-        if (cancel_all || (data_point_pending->request_id != NULL && *data_point_pending->request_id == *request_id))
+        if (cancel_all || (pending_id != NULL && *pending_id == *request_id))
         {
             if (session == NULL)
             {
-                status = dp_inform_status(connector_ptr, connector_request_id_data_point_status, data_point_pending->transport, data_point_pending->user_context, connector_session_error_cancel);
+                status = dp_inform_status(connector_ptr, status_request, pending_transport, user_context, connector_session_error_cancel);
                 if (status != connector_working)
                   goto done;
             }
-            data_point_pending = NULL;
+            dp_remove_request(queue, index);
+            continue;
         }
+
+        index++;
     }
 done:
     return status;
@@ -356,6 +482,36 @@ done:
     return result;
 }
 
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+STATIC connector_status_t dp_process_columnar(connector_data_t * const connector_ptr, connector_request_data_point_t const * const dp_ptr)
+{
+    connector_status_t result = connector_idle;
+    data_point_info_t * const dp_info = dp_create_dp_info(connector_ptr, &result);
+
+    if (dp_info == NULL) goto done;
+
+    dp_info->type = dp_content_type_columnar;
+    dp_info->data.columnar.dp_request = dp_ptr;
+    dp_init_columnar(&dp_info->data.columnar.process_data, dp_ptr->stream);
+
+    result = dp_fill_file_path(dp_info, NULL, ".dpc");
+    if (result != connector_working) goto error;
+    result = dp_send_message(connector_ptr, dp_info, dp_ptr->transport, dp_ptr->response_required, dp_ptr->request_id, dp_ptr->timeout_in_seconds);
+    if (result == connector_working) goto done;
+
+error:
+    if (result != connector_pending)
+        result = dp_inform_status(connector_ptr, connector_request_id_data_point_status, dp_ptr->transport,
+                                  dp_ptr->user_context, connector_session_error_format);
+
+    if (free_data_buffer(connector_ptr, named_buffer_id(data_point_block), dp_info) != connector_working)
+        result = connector_abort;
+
+done:
+    return result;
+}
+#endif
+
 STATIC connector_status_t dp_process_binary(connector_data_t * const connector_ptr, connector_request_data_point_binary_t const * const bp_ptr)
 {
     connector_status_t result = connector_idle;
@@ -388,33 +544,46 @@ done:
 STATIC connector_status_t dp_process_request(connector_data_t * const connector_ptr, connector_transport_t const transport)
 {
     connector_status_t result = connector_idle;
+    dp_pending_queue_t * const queue = &dp_pending_queue[transport];
+    connector_bool_t started = connector_false;
 
-    if (connector_ptr->process_csv)
+    /* Start as many queued requests as the data service accepts; each one runs in its own session */
+    while (queue->count > 0)
     {
-        if ((data_point_pending != NULL) && (data_point_pending->transport == transport))
+        dp_pending_request_t const * const pending = &queue->entry[0];
+
+        switch (pending->type)
         {
-            result = dp_process_csv(connector_ptr, data_point_pending);
-            if (result != connector_pending)
-            {
-                connector_ptr->process_csv = connector_false;
-                data_point_pending = NULL;
-                goto done;
-            }
+            case dp_pending_csv:
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+                if (pending->request.dp_request->format == connector_data_point_format_columnar)
+                {
+                    result = dp_process_columnar(connector_ptr, pending->request.dp_request);
+                    break;
+                }
+#endif
+                result = dp_process_csv(connector_ptr, pending->request.dp_request);
+                break;
+
+            case dp_pending_binary:
+                result = dp_process_binary(connector_ptr, pending->request.bp_request);
+                break;
         }
-    }
-    else
-    {
-        connector_ptr->process_csv = connector_true;
-    }
 
-    if ((data_point_binary_pending != NULL) && (data_point_binary_pending->transport == transport))
-    {
-        result = dp_process_binary(connector_ptr, data_point_binary_pending);
-        if (result != connector_pending)
-            data_point_binary_pending = NULL;
+        if (result == connector_pending)
+        {
+            /* Out of sessions or buffers: keep the rest queued and let the active sessions progress */
+            result = started ? connector_working : connector_idle;
+            break;
+        }
+
+        dp_remove_request(queue, 0);
+        if (result != connector_working)
+            break;
+
+        started = connector_true;
     }
 
-done:
     return result;
 }
 
@@ -438,7 +607,8 @@ STATIC connector_callback_status_t dp_handle_data_callback(connector_data_servic
                 data_ptr->more_data = connector_false;
             }
 
-            memcpy(data_ptr->buffer, dp_info->data.binary.current_bp, data_ptr->bytes_used);
+            /* the point stays valid until the response or status callback, which follow the send, so it is sent from there */
+            data_ptr->external_buffer = dp_info->data.binary.current_bp;
             dp_info->data.binary.current_bp += data_ptr->bytes_used;
             dp_info->data.binary.bytes_to_send -= data_ptr->bytes_used;
             break;
@@ -454,6 +624,20 @@ STATIC connector_callback_status_t dp_handle_data_callback(connector_data_servic
             data_ptr->more_data = connector_bool(dp_info->data.csv.process_data.current_data_point != NULL);
             break;
         }
+
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+        case dp_content_type_columnar:
+        {
+            buffer_info_t buffer_info;
+
+            buffer_info.buffer = (char *)data_ptr->buffer;
+            buffer_info.bytes_available = data_ptr->bytes_available;
+            buffer_info.bytes_written = 0;
+            data_ptr->bytes_used = dp_generate_columnar(&dp_info->data.columnar.process_data, &buffer_info);
+            data_ptr->more_data = dp_columnar_more_data(&dp_info->data.columnar.process_data);
+            break;
+        }
+#endif
     }
 
     status = connector_callback_continue;
@@ -481,6 +665,13 @@ STATIC connector_callback_status_t dp_handle_response_callback(connector_data_t
             user_data.user_context = dp_info->data.csv.dp_request->user_context;
             request_id.data_point_request = connector_request_id_data_point_response;
             break;
+
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+        case dp_content_type_columnar:
+            user_data.user_context = dp_info->data.columnar.dp_request->user_context;
+            request_id.data_point_request = connector_request_id_data_point_response;
+            break;
+#endif
     }
 
     user_data.transport = data_ptr->transport;
@@ -532,6 +723,13 @@ STATIC connector_callback_status_t dp_handle_status_callback(connector_data_t *
             user_data.user_context = dp_info->data.csv.dp_request->user_context;
             request_id.data_point_request = connector_request_id_data_point_status;
             break;
+
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+        case dp_content_type_columnar:
+            user_data.user_context = dp_info->data.columnar.dp_request->user_context;
+            request_id.data_point_request = connector_request_id_data_point_status;
+            break;
+#endif
     }
 
     user_data.transport = data_ptr->transport;
@@ -596,6 +794,22 @@ STATIC connector_callback_status_t dp_handle_length_callback(connector_data_t *
             data_ptr->total_bytes = dp_generate_csv(&aux_process_data, &buffer_info);
             break;
         }
+
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+        case dp_content_type_columnar:
+        {
+            buffer_info_t buffer_info;
+            columnar_process_data_t aux_process_data;
+
+            buffer_info.buffer = NULL;
+            buffer_info.bytes_available = SIZE_MAX;
+            buffer_info.bytes_written = 0;
+            aux_process_data = dp_info->data.columnar.process_data;
+
+            data_ptr->total_bytes = dp_generate_columnar(&aux_process_data, &buffer_info);
+            break;
+        }
+#endif
     }
 
     status = connector_callback_continue;
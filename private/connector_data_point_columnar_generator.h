@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+#ifndef _CONNECTOR_DATA_POINT_COLUMNAR_GENERATOR_H_
+#define _CONNECTOR_DATA_POINT_COLUMNAR_GENERATOR_H_
+
+/************************************************************************
+** Columnar data point format, documented in doxygen/data_point.c:    **
+**                                                                     **
+**   "DPC" version                                                     **
+**   per stream:                                                       **
+**     varint length + stream_id, varint length + unit,                **
+**     varint length + forward_to, type, flags, varint point count     **
+**     time column  (if DPC_FLAG_TIME): zigzag varint seconds delta,   **
+**                                      varint milliseconds            **
+**     value column: integer/long zigzag varint delta,                 **
+**                   float/double big endian IEEE754                   **
+************************************************************************/
+#define DPC_VERSION             1
+#define DPC_FLAG_TIME           0x01
+
+#define DPC_ITEM_MAX_BYTES      12  /* type + flags + count, or the largest varint */
+
+typedef enum {
+    columnar_header,
+    columnar_stream,
+    columnar_time,
+    columnar_value,
+    columnar_finished
+} columnar_field_t;
+
+typedef enum {
+    columnar_state_stream_id_length,
+    columnar_state_stream_id,
+    columnar_state_unit_length,
+    columnar_state_unit,
+    columnar_state_forward_to_length,
+    columnar_state_forward_to,
+    columnar_state_type_flags_count
+} columnar_stream_state_t;
+
+typedef struct {
+    connector_data_stream_t const * current_data_stream;
+    connector_data_point_t const * current_data_point;
+    columnar_field_t current_field;
+    columnar_stream_state_t stream_state;
+    connector_bool_t has_time;
+
+    struct {
+        uint8_t bytes[DPC_ITEM_MAX_BYTES];
+        uint8_t const * next_byte;
+        size_t bytes_left;
+    } item;
+
+    uint32_t previous_seconds;
+    largest_uint_t previous_value;
+} columnar_process_data_t;
+
+STATIC size_t columnar_store_varint(uint8_t * const bytes, largest_uint_t value)
+{
+    size_t length = 0;
+
+    while (value >= 0x80)
+    {
+        bytes[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = (uint8_t)value;
+
+    return length;
+}
+
+/* signed delta of two values in the same width, as an unsigned varint */
+STATIC largest_uint_t columnar_zigzag(largest_uint_t const delta, unsigned int const bits)
+{
+    largest_uint_t const sign = (delta >> (bits - 1)) & 1;
+    largest_uint_t zigzag = (delta << 1) ^ (0 - sign);
+
+    if (bits < sizeof zigzag * CHAR_BIT)
+        zigzag &= (((largest_uint_t)1) << bits) - 1;
+
+    return zigzag;
+}
+
+STATIC void columnar_set_string_item(columnar_process_data_t * const process_data, char const * const string, connector_bool_t const length_only)
+{
+    size_t const length = (string == NULL) ? 0 : strlen(string);
+
+    if (length_only)
+    {
+        process_data->item.next_byte = process_data->item.bytes;
+        process_data->item.bytes_left = columnar_store_varint(process_data->item.bytes, length);
+    }
+    else
+    {
+        process_data->item.next_byte = (uint8_t const *)string;
+        process_data->item.bytes_left = length;
+    }
+}
+
+STATIC void columnar_next_stream_item(columnar_process_data_t * const process_data)
+{
+    connector_data_stream_t const * const stream = process_data->current_data_stream;
+
+    switch (process_data->stream_state)
+    {
+        case columnar_state_stream_id_length:
+        case columnar_state_stream_id:
+            columnar_set_string_item(process_data, stream->stream_id, connector_bool(process_data->stream_state == columnar_state_stream_id_length));
+            break;
+
+        case columnar_state_unit_length:
+        case columnar_state_unit:
+            columnar_set_string_item(process_data, stream->unit, connector_bool(process_data->stream_state == columnar_state_unit_length));
+            break;
+
+        case columnar_state_forward_to_length:
+        case columnar_state_forward_to:
+            columnar_set_string_item(process_data, stream->forward_to, connector_bool(process_data->stream_state == columnar_state_forward_to_length));
+            break;
+
+        case columnar_state_type_flags_count:
+        {
+            connector_data_point_t const * point;
+            largest_uint_t count = 0;
+            uint8_t * const bytes = process_data->item.bytes;
+
+            for (point = stream->point; point != NULL; point = point->next)
+                count++;
+
+            process_data->has_time = connector_bool(stream->point->time.source != connector_time_cloud);
+            bytes[0] = (uint8_t)stream->type;
+            bytes[1] = process_data->has_time ? DPC_FLAG_TIME : 0;
+            process_data->item.next_byte = bytes;
+            process_data->item.bytes_left = 2 + columnar_store_varint(&bytes[2], count);
+
+            process_data->current_data_point = stream->point;
+            process_data->current_field = process_data->has_time ? columnar_time : columnar_value;
+            process_data->previous_seconds = 0;
+            process_data->previous_value = 0;
+            goto done;
+        }
+    }
+
+    process_data->stream_state++;
+
+done:
+    return;
+}
+
+STATIC void columnar_next_time_item(columnar_process_data_t * const process_data)
+{
+    connector_data_point_t const * const point = process_data->current_data_point;
+    uint8_t * const bytes = process_data->item.bytes;
+    uint32_t seconds = 0;
+    uint32_t milliseconds = 0;
+    size_t length;
+
+    switch (point->time.source)
+    {
+        case connector_time_local_epoch_fractional:
+            seconds = point->time.value.since_epoch_fractional.seconds;
+            milliseconds = point->time.value.since_epoch_fractional.milliseconds;
+            break;
+
+#if (defined CONNECTOR_SUPPORTS_64_BIT_INTEGERS)
+        case connector_time_local_epoch_whole:
+            seconds = (uint32_t)(point->time.value.since_epoch_whole.milliseconds / 1000);
+            milliseconds = (uint32_t)(point->time.value.since_epoch_whole.milliseconds % 1000);
+            break;
+#endif
+
+        default:
+            ASSERT(connector_false);
+            break;
+    }
+
+    length = columnar_store_varint(bytes, columnar_zigzag((largest_uint_t)(uint32_t)(seconds - process_data->previous_seconds), 32));
+    length += columnar_store_varint(&bytes[length], milliseconds);
+    process_data->previous_seconds = seconds;
+
+    process_data->item.next_byte = bytes;
+    process_data->item.bytes_left = length;
+
+    process_data->current_data_point = point->next;
+    if (process_data->current_data_point == NULL)
+    {
+        process_data->current_data_point = process_data->current_data_stream->point;
+        process_data->current_field = columnar_value;
+    }
+}
+
+#if (defined CONNECTOR_SUPPORTS_FLOATING_POINT)
+STATIC size_t columnar_store_ieee754(uint8_t * const bytes, void const * const value, size_t const length)
+{
+    memcpy(bytes, value, length);
+
+#if (defined CONNECTOR_LITTLE_ENDIAN)
+    {
+        size_t i;
+
+        for (i = 0; i < length / 2; i++)
+        {
+            uint8_t const byte = bytes[i];
+
+            bytes[i] = bytes[length - 1 - i];
+            bytes[length - 1 - i] = byte;
+        }
+    }
+#endif
+
+    return length;
+}
+#endif
+
+STATIC void columnar_next_value_item(columnar_process_data_t * const process_data)
+{
+    connector_data_point_t const * const point = process_data->current_data_point;
+    connector_data_stream_t const * const stream = process_data->current_data_stream;
+    uint8_t * const bytes = process_data->item.bytes;
+    size_t length = 0;
+
+    switch (stream->type)
+    {
+        case connector_data_point_type_integer:
+        {
+            uint32_t const value = (uint32_t)point->data.element.native.int_value;
+
+            length = columnar_store_varint(bytes, columnar_zigzag((uint32_t)(value - (uint32_t)process_data->previous_value), 32));
+            process_data->previous_value = value;
+            break;
+        }
+
+#if (defined CONNECTOR_SUPPORTS_64_BIT_INTEGERS)
+        case connector_data_point_type_long:
+        {
+            uint64_t const value = (uint64_t)point->data.element.native.long_value;
+
+            length = columnar_store_varint(bytes, columnar_zigzag(value - process_data->previous_value, 64));
+            process_data->previous_value = value;
+            break;
+        }
+#endif
+
+#if (defined CONNECTOR_SUPPORTS_FLOATING_POINT)
+        case connector_data_point_type_float:
+            length = columnar_store_ieee754(bytes, &point->data.element.native.float_value, sizeof point->data.element.native.float_value);
+            break;
+
+        case connector_data_point_type_double:
+            length = columnar_store_ieee754(bytes, &point->data.element.native.double_value, sizeof point->data.element.native.double_value);
+            break;
+#endif
+
+        default:
+            ASSERT(connector_false);
+            break;
+    }
+
+    process_data->item.next_byte = bytes;
+    process_data->item.bytes_left = length;
+
+    process_data->current_data_point = point->next;
+    if (process_data->current_data_point == NULL)
+    {
+        process_data->current_data_stream = stream->next;
+        process_data->current_field = (process_data->current_data_stream == NULL) ? columnar_finished : columnar_stream;
+        process_data->stream_state = columnar_state_stream_id_length;
+    }
+}
+
+STATIC connector_bool_t columnar_next_item(columnar_process_data_t * const process_data)
+{
+    connector_bool_t have_item = connector_true;
+
+    switch (process_data->current_field)
+    {
+        case columnar_header:
+        {
+            uint8_t * const bytes = process_data->item.bytes;
+
+            bytes[0] = 'D';
+            bytes[1] = 'P';
+            bytes[2] = 'C';
+            bytes[3] = DPC_VERSION;
+            process_data->item.next_byte = bytes;
+            process_data->item.bytes_left = 4;
+            process_data->current_field = columnar_stream;
+            process_data->stream_state = columnar_state_stream_id_length;
+            break;
+        }
+
+        case columnar_stream:
+            columnar_next_stream_item(process_data);
+            break;
+
+        case columnar_time:
+            columnar_next_time_item(process_data);
+            break;
+
+        case columnar_value:
+            columnar_next_value_item(process_data);
+            break;
+
+        case columnar_finished:
+            have_item = connector_false;
+            break;
+    }
+
+    return have_item;
+}
+
+STATIC void dp_init_columnar(columnar_process_data_t * const process_data, connector_data_stream_t const * const stream)
+{
+    process_data->current_data_stream = stream;
+    process_data->current_data_point = stream->point;
+    process_data->current_field = columnar_header;
+    process_data->stream_state = columnar_state_stream_id_length;
+    process_data->item.bytes_left = 0;
+}
+
+STATIC connector_bool_t dp_columnar_more_data(columnar_process_data_t const * const process_data)
+{
+    return connector_bool((process_data->current_field != columnar_finished) || (process_data->item.bytes_left > 0));
+}
+
+size_t dp_generate_columnar(columnar_process_data_t * const process_data, buffer_info_t * const buffer_info)
+{
+    while (buffer_info->bytes_available > 0)
+    {
+        if (process_data->item.bytes_left == 0)
+        {
+            if (!columnar_next_item(process_data))
+                break;
+        }
+        else
+        {
+            size_t const bytes = (process_data->item.bytes_left < buffer_info->bytes_available) ? process_data->item.bytes_left : buffer_info->bytes_available;
+
+            if (buffer_info->buffer != NULL)
+                memcpy(&buffer_info->buffer[buffer_info->bytes_written], process_data->item.next_byte, bytes);
+
+            process_data->item.next_byte += bytes;
+            process_data->item.bytes_left -= bytes;
+            buffer_info->bytes_written += bytes;
+            buffer_info->bytes_available -= bytes;
+        }
+    }
+
+    return buffer_info->bytes_written;
+}
+
+STATIC connector_bool_t dp_columnar_supported(connector_data_stream_t const * const stream)
+{
+    connector_bool_t supported = connector_false;
+    connector_data_point_t const * point;
+
+    if (stream->point == NULL)
+    {
+        connector_debug_line("dp_columnar_supported: NULL data point");
+        goto done;
+    }
+
+    switch (stream->type)
+    {
+        case connector_data_point_type_integer:
+#if (defined CONNECTOR_SUPPORTS_64_BIT_INTEGERS)
+        case connector_data_point_type_long:
+#endif
+#if (defined CONNECTOR_SUPPORTS_FLOATING_POINT)
+        case connector_data_point_type_float:
+        case connector_data_point_type_double:
+#endif
+            break;
+
+        default:
+            connector_debug_line("dp_columnar_supported: stream type %d is not numeric", stream->type);
+            goto done;
+    }
+
+    for (point = stream->point; point != NULL; point = point->next)
+    {
+        connector_bool_t const has_time = connector_bool(point->time.source != connector_time_cloud);
+
+        if ((point->data.type != connector_data_type_native) ||
+            (point->time.source == connector_time_local_iso8601) ||
+            (has_time != connector_bool(stream->point->time.source != connector_time_cloud)) ||
+            (point->location.type != connector_location_type_ignore) ||
+            (point->quality.type != connector_quality_type_ignore) ||
+            (point->description != NULL))
+        {
+            connector_debug_line("dp_columnar_supported: stream %s has a point which needs CSV", stream->stream_id);
+            goto done;
+        }
+    }
+
+    supported = connector_true;
+
+done:
+    return supported;
+}
+
+#endif
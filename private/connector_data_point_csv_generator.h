@@ -132,7 +132,7 @@ STATIC connector_bool_t process_csv_data(csv_process_data_t * const csv_process_
                     case connector_data_point_type_float:
                     {
 #if (defined CONNECTOR_SUPPORTS_FLOATING_POINT)
-                        init_double_info(&csv_process_data->data.info.dbl, current_data_point->data.element.native.float_value);
+                        init_float_info(&csv_process_data->data.info.dbl, current_data_point->data.element.native.float_value);
 #else
                         connector_debug_line("CONNECTOR_SUPPORTS_FLOATING_POINT not defined");
                         ASSERT(current_data_stream->type != connector_data_point_type_float);
@@ -239,7 +239,7 @@ STATIC connector_bool_t process_csv_location(csv_process_data_t * const csv_proc
 #if (defined CONNECTOR_SUPPORTS_FLOATING_POINT)
                     if (current_data_point->location.type == connector_location_type_native)
                     {
-                        init_double_info(&csv_process_data->data.info.dbl, current_data_point->location.value.native.latitude);
+                        init_float_info(&csv_process_data->data.info.dbl, current_data_point->location.value.native.latitude);
                     }
                     else
                     {
@@ -258,7 +258,7 @@ STATIC connector_bool_t process_csv_location(csv_process_data_t * const csv_proc
 #if (defined CONNECTOR_SUPPORTS_FLOATING_POINT)
                     if (current_data_point->location.type == connector_location_type_native)
                     {
-                        init_double_info(&csv_process_data->data.info.dbl, current_data_point->location.value.native.longitude);
+                        init_float_info(&csv_process_data->data.info.dbl, current_data_point->location.value.native.longitude);
                     }
                     else
                     {
@@ -277,7 +277,7 @@ STATIC connector_bool_t process_csv_location(csv_process_data_t * const csv_proc
 #if (defined CONNECTOR_SUPPORTS_FLOATING_POINT)
                     if (current_data_point->location.type == connector_location_type_native)
                     {
-                        init_double_info(&csv_process_data->data.info.dbl, current_data_point->location.value.native.elevation);
+                        init_float_info(&csv_process_data->data.info.dbl, current_data_point->location.value.native.elevation);
                     }
                     else
                     {
@@ -25,13 +25,6 @@ typedef enum
     data_service_opcode_device_response
 } data_service_opcode_t;
 
-typedef struct
-{
-    void * callback_context;
-    connector_request_data_service_send_t const * header;
-    connector_request_id_data_service_t request_type;
-} data_service_context_t;
-
 STATIC void set_data_service_error(msg_service_request_t * const service_request, connector_session_error_t const error_code)
 {
     service_request->error_value = error_code;
@@ -58,7 +51,15 @@ STATIC connector_status_t call_ds_receive_callback(connector_data_t * const conn
         case connector_request_id_data_service_receive_status:
         case connector_request_id_data_service_receive_reply_data:
         {
-            connector_callback_status_t const status = connector_callback(connector_ptr->callback, connector_class_id_data_service, request_id, data, connector_ptr->context);
+            connector_callback_status_t status;
+
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+            if (data_service->target_handler.function != NULL)
+                status = ds_target_callback(&data_service->target_handler, request_id.data_service_request, data);
+            else
+#endif
+            status = connector_callback(connector_ptr->callback, connector_class_id_data_service, request_id, data, connector_ptr->context);
+
             switch (status)
             {
                 case connector_callback_continue:
@@ -85,6 +86,100 @@ STATIC connector_status_t call_ds_receive_callback(connector_data_t * const conn
     return result;
 }
 
+STATIC connector_status_t alloc_device_request_context(connector_data_t * const connector_ptr,
+                                                       uint8_t const * const data,
+                                                       size_t const data_length,
+                                                       data_service_context_t ** const context)
+{
+    connector_status_t result = connector_working;
+
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+    /* look the target up before the request is parsed so a registered one can use a preallocated context */
+    enum {
+        field_define(ds_device_request, opcode, uint8_t),
+        field_define(ds_device_request, target_length, uint8_t),
+        record_end(ds_device_request_header)
+    };
+
+    uint8_t const * const ds_device_request = data;
+    connector_ds_targets_t * const table = &connector_ptr->ds_targets;
+    connector_ds_target_t const * target = NULL;
+
+    if (data_length >= record_bytes(ds_device_request_header))
+    {
+        size_t const target_length = message_load_u8(ds_device_request, target_length);
+
+        if (data_length >= record_bytes(ds_device_request_header) + target_length)
+            target = ds_find_target(table, (char const *)(ds_device_request + record_bytes(ds_device_request_header)), target_length);
+    }
+
+    if (target != NULL)
+    {
+        unsigned int i;
+
+        for (i = 0; i < CONNECTOR_DEVICE_REQUEST_TARGET_CONTEXTS; i++)
+        {
+            unsigned int const mask = 1u << i;
+
+            if ((table->contexts_in_use & mask) == 0)
+            {
+                table->contexts_in_use |= mask;
+                *context = &table->context[i];
+                goto done;
+            }
+        }
+    }
+#else
+    UNUSED_PARAMETER(data);
+    UNUSED_PARAMETER(data_length);
+#endif
+
+    {
+        void * ptr;
+
+        result = malloc_data_buffer(connector_ptr, sizeof **context, named_buffer_id(msg_service), &ptr);
+        if (result != connector_working)
+            goto done;
+
+        *context = ptr;
+    }
+
+done:
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+    if (result == connector_working)
+    {
+        if (target != NULL)
+            (*context)->target_handler = target->handler;
+        else
+            (*context)->target_handler.function = NULL;
+    }
+#endif
+    return result;
+}
+
+STATIC connector_status_t free_device_request_context(connector_data_t * const connector_ptr, data_service_context_t * const context)
+{
+    connector_status_t result = connector_working;
+
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+    connector_ds_targets_t * const table = &connector_ptr->ds_targets;
+    unsigned int i;
+
+    for (i = 0; i < CONNECTOR_DEVICE_REQUEST_TARGET_CONTEXTS; i++)
+    {
+        if (context == &table->context[i])
+            break;
+    }
+
+    if (i < CONNECTOR_DEVICE_REQUEST_TARGET_CONTEXTS)
+        table->contexts_in_use &= ~(1u << i);
+    else
+#endif
+    result = free_data_buffer(connector_ptr, named_buffer_id(msg_service), context);
+
+    return result;
+}
+
 STATIC connector_status_t process_ds_receive_target(connector_data_t * const connector_ptr,
                                                     data_service_context_t * const data_service,
                                                     uint8_t const * const data,
@@ -228,15 +323,12 @@ STATIC connector_status_t process_data_service_device_request(connector_data_t *
         if (data_service == NULL)
         {
             /* 1st time here so let's allocate service context memory for device request service */
-            void * ptr;
-
-            result = malloc_data_buffer(connector_ptr, sizeof *data_service, named_buffer_id(msg_service), &ptr);
+            result = alloc_device_request_context(connector_ptr, ds_device_request, ds_device_request_length, &data_service);
             if (result != connector_working)
             {
                 goto done;
             }
 
-            data_service = ptr;
             session->service_context = data_service;
             data_service->callback_context = NULL;
             data_service->request_type = connector_request_id_data_service_receive_target;
@@ -473,7 +565,7 @@ STATIC connector_status_t data_service_device_request_callback(connector_data_t
     case msg_service_type_free:
         {
             msg_session_t const * const session = service_request->session;
-            data_service_context_t const * const data_service = session->service_context;
+            data_service_context_t * const data_service = session->service_context;
             connector_request_id_data_service_t const previous_request = data_service->request_type;
 
             if (previous_request != connector_request_id_data_service_receive_status)
@@ -483,7 +575,7 @@ STATIC connector_status_t data_service_device_request_callback(connector_data_t
                 if (status != connector_working)
                     break;
             }
-            status = free_data_buffer(connector_ptr, named_buffer_id(msg_service), session->service_context);
+            status = free_device_request_context(connector_ptr, data_service);
             break;
         }
 
@@ -626,6 +718,7 @@ STATIC connector_status_t process_send_request(connector_data_t * const connecto
     user_data.user_context = ds_ptr->callback_context;
     user_data.bytes_used = 0;
     user_data.more_data = connector_false;
+    user_data.external_buffer = NULL;
 
     if (MsgIsStart(service_data->flags))
     {
@@ -653,8 +746,16 @@ STATIC connector_status_t process_send_request(connector_data_t * const connecto
 
     if (status == connector_working)
     {
+        ASSERT(user_data.bytes_used <= user_data.bytes_available);
         service_data->flags = 0;
-        service_data->length_in_bytes += user_data.bytes_used;
+        if (user_data.external_buffer != NULL)
+        {
+            service_data->external_ptr = user_data.external_buffer;
+            service_data->external_bytes = user_data.bytes_used;
+        }
+        else
+            service_data->length_in_bytes += user_data.bytes_used;
+
         if (user_data.more_data == connector_false)
             MsgSetLastData(service_data->flags);
     }
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Registered device request targets.
+ *
+ * Targets are kept in an open-addressing table keyed by the FNV-1a hash of the
+ * target name. The target of an incoming device request is looked up in place,
+ * with its length from the request, and the handler found is kept with the request
+ * so the rest of its callbacks skip both the lookup and the application callback.
+ */
+
+#define DS_TARGET_TABLE_MASK        (CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE - 1)
+/* keep a quarter of the slots free so probe sequences stay short */
+#define DS_TARGET_TABLE_MAX_LOAD    (CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE - (CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE / 4))
+/* the target length is a single byte in the device request */
+#define DS_TARGET_MAX_LENGTH        255
+
+STATIC uint32_t ds_target_hash(char const * const target, size_t const length)
+{
+    uint32_t hash = UINT32_C(2166136261);
+    size_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (uint8_t)target[i];
+        hash *= UINT32_C(16777619);
+    }
+
+    return hash;
+}
+
+STATIC unsigned int ds_find_target_slot(connector_ds_targets_t const * const table, char const * const target, size_t const length, uint32_t const hash)
+{
+    unsigned int index = hash & DS_TARGET_TABLE_MASK;
+
+    while (table->slot[index].target != NULL)
+    {
+        connector_ds_target_t const * const entry = &table->slot[index];
+
+        if ((entry->hash == hash) && (entry->length == length) && (memcmp(entry->target, target, length) == 0))
+            break;
+
+        index = (index + 1) & DS_TARGET_TABLE_MASK;
+    }
+
+    return index;
+}
+
+STATIC connector_ds_target_t const * ds_find_target(connector_ds_targets_t const * const table, char const * const target, size_t const length)
+{
+    connector_ds_target_t const * entry = NULL;
+
+    if (table->count > 0)
+    {
+        unsigned int const index = ds_find_target_slot(table, target, length, ds_target_hash(target, length));
+
+        if (table->slot[index].target != NULL)
+            entry = &table->slot[index];
+    }
+
+    return entry;
+}
+
+STATIC void ds_remove_target(connector_ds_targets_t * const table, unsigned int const index)
+{
+    /* backward shift deletion: move later entries of the probe sequence into the hole */
+    unsigned int hole = index;
+    unsigned int next = (index + 1) & DS_TARGET_TABLE_MASK;
+
+    while (table->slot[next].target != NULL)
+    {
+        unsigned int const home = table->slot[next].hash & DS_TARGET_TABLE_MASK;
+
+        if (((next - home) & DS_TARGET_TABLE_MASK) >= ((next - hole) & DS_TARGET_TABLE_MASK))
+        {
+            table->slot[hole] = table->slot[next];
+            hole = next;
+        }
+        next = (next + 1) & DS_TARGET_TABLE_MASK;
+    }
+    table->slot[hole].target = NULL;
+    table->count--;
+}
+
+STATIC connector_status_t ds_register_target(connector_ds_targets_t * const table, char const * const target,
+                                             connector_device_request_handler_t const handler, void * const context)
+{
+    connector_status_t result = connector_success;
+    size_t const length = strlen(target);
+    uint32_t hash;
+    unsigned int index;
+    connector_ds_target_t * entry;
+
+    if (length == 0 || length > DS_TARGET_MAX_LENGTH)
+    {
+        result = connector_invalid_data;
+        goto done;
+    }
+
+    hash = ds_target_hash(target, length);
+    index = ds_find_target_slot(table, target, length, hash);
+    entry = &table->slot[index];
+
+    if (entry->target == NULL)
+    {
+        if (handler == NULL)
+        {
+            result = connector_invalid_data;
+            goto done;
+        }
+
+        if (table->count >= DS_TARGET_TABLE_MAX_LOAD)
+        {
+            result = connector_no_resource;
+            goto done;
+        }
+
+        entry->length = length;
+        entry->hash = hash;
+        table->count++;
+    }
+    else if (handler == NULL)
+    {
+        ds_remove_target(table, index);
+        goto done;
+    }
+
+    entry->target = target;
+    entry->handler.function = handler;
+    entry->handler.context = context;
+
+done:
+    return result;
+}
+
+STATIC connector_callback_status_t ds_target_callback(connector_ds_target_handler_t const * const handler, connector_request_id_data_service_t const request_id, void * const data)
+{
+    connector_callback_status_t status = handler->function(request_id, data, handler->context);
+
+    switch (status)
+    {
+        case connector_callback_continue:
+        case connector_callback_busy:
+        case connector_callback_error:
+        case connector_callback_unrecognized:
+            break;
+
+        case connector_callback_abort:
+            connector_debug_line("ds_target_callback: handler for request id = %d returned abort", request_id);
+            break;
+
+        default:
+            connector_debug_line("ds_target_callback: handler for request id = %d returned invalid return code %d", request_id, status);
+            status = connector_callback_abort;
+            break;
+    }
+
+    return status;
+}
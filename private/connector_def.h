@@ -55,6 +55,22 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #define MAX_RECEIVE_TIMEOUT_IN_SECONDS  1
 #define MIN_RECEIVE_TIMEOUT_IN_SECONDS  0
 
+/* Orders the stores of a report the application posts from its own thread before the store that
+ * posts it, and the loads on the connector thread the other way round. GCC and compatible compilers
+ * get a full barrier, other compilers may define it in connector_config.h.
+ */
+#if !(defined CONNECTOR_MEMORY_BARRIER)
+#if (defined __GNUC__)
+#define CONNECTOR_MEMORY_BARRIER()  __sync_synchronize()
+#else
+#define CONNECTOR_MEMORY_BARRIER()
+#endif
+#endif
+
+#if !(defined CONNECTOR_COMPARE_AND_SWAP) && (defined __GNUC__)
+#define CONNECTOR_COMPARE_AND_SWAP(ptr, old_value, new_value)  __sync_bool_compare_and_swap((ptr), (old_value), (new_value))
+#endif
+
 #define FW_VERSION_NUMBER(version)  (MAKE32_4(version.major, version.minor, version.revision, version.build))
 
 #if !(defined CONNECTOR_TRANSPORT_RECONNECT_AFTER)
@@ -192,6 +208,21 @@ typedef enum {
 
 struct connector_data;
 
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+#if !(defined CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE)
+#define CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE  256
+#endif
+
+#if !(defined CONNECTOR_DEVICE_REQUEST_TARGET_CONTEXTS)
+#define CONNECTOR_DEVICE_REQUEST_TARGET_CONTEXTS    4
+#endif
+
+typedef struct {
+    connector_device_request_handler_t function;
+    void * context;
+} connector_ds_target_handler_t;
+#endif
+
 #if (defined CONNECTOR_TRANSPORT_TCP)
 #include "connector_edp_def.h"
 #endif
@@ -200,6 +231,69 @@ struct connector_data;
 #include "connector_sm_def.h"
 #endif
 
+#if (defined CONNECTOR_RCI_CACHE)
+#if !(defined CONNECTOR_RCI_CACHE_ENTRIES)
+#define CONNECTOR_RCI_CACHE_ENTRIES     8
+#endif
+
+#if !(defined CONNECTOR_RCI_CACHE_ENTRY_SIZE)
+#define CONNECTOR_RCI_CACHE_ENTRY_SIZE  512
+#endif
+
+#if !(defined CONNECTOR_RCI_CACHE_DEFAULT_TTL)
+#define CONNECTOR_RCI_CACHE_DEFAULT_TTL 0
+#endif
+
+typedef struct {
+    connector_remote_group_type_t group_type;
+    unsigned int group_id;
+    unsigned int instance;
+    rci_query_setting_attribute_source_t source;
+    rci_query_setting_attribute_compare_to_t compare_to;
+} connector_rci_cache_key_t;
+
+typedef struct {
+    connector_rci_cache_key_t key;
+    connector_bool_t valid;
+    unsigned long expires;
+    size_t length;
+    uint8_t data[CONNECTOR_RCI_CACHE_ENTRY_SIZE];
+} connector_rci_cache_entry_t;
+
+typedef struct {
+    connector_rci_cache_entry_t entry[CONNECTOR_RCI_CACHE_ENTRIES];
+    unsigned long hits;
+    unsigned long misses;
+    /* invalidation requests from the application, applied on the connector thread */
+    struct {
+        connector_rci_cache_invalidate_t group;     /* group of the last group request */
+        unsigned int volatile group_requests;       /* odd while group is written */
+        unsigned int volatile all_requests;         /* both bumped with CONNECTOR_COMPARE_AND_SWAP */
+        unsigned int group_applied;
+        unsigned int all_applied;
+    } invalidate;
+} connector_rci_cache_t;
+#endif
+
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+typedef struct {
+    char const * target;    /* application string, NULL for an empty slot */
+    size_t length;
+    uint32_t hash;
+    connector_ds_target_handler_t handler;
+} connector_ds_target_t;
+
+typedef struct {
+    connector_ds_target_t slot[CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE];
+    size_t count;
+#if (defined CONNECTOR_TRANSPORT_TCP)
+    /* device request state for registered targets, so their requests do not allocate */
+    data_service_context_t context[CONNECTOR_DEVICE_REQUEST_TARGET_CONTEXTS];
+    unsigned int contexts_in_use;
+#endif
+} connector_ds_targets_t;
+#endif
+
 typedef struct connector_data {
 
     uint8_t device_id[DEVICE_ID_LENGTH];
@@ -234,6 +328,8 @@ typedef struct connector_data {
 
     connector_callback_t callback;
     connector_status_t error_code;
+    connector_bool_t volatile wakeup_unsupported; /* written by whichever thread first asks for a wakeup */
+    connector_bool_t up_time_in_ms_unsupported;
 
 #if (defined CONNECTOR_TRANSPORT_UDP || defined CONNECTOR_TRANSPORT_SMS)
     uint32_t last_request_id;
@@ -258,10 +354,13 @@ typedef struct connector_data {
 #if (defined CONNECTOR_RCI_SERVICE)
     connector_remote_config_data_t const * rci_data;
     struct rci * rci_internal_data;
+#if (defined CONNECTOR_RCI_CACHE)
+    connector_rci_cache_t rci_cache;
+#endif
 #endif
 
-#if (defined CONNECTOR_DATA_POINTS)
-    connector_bool_t process_csv;
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+    connector_ds_targets_t ds_targets;
 #endif
 
     struct {
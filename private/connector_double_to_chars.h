@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+#ifndef _CONNECTOR_DOUBLE_TO_CHARS_H_
+#define _CONNECTOR_DOUBLE_TO_CHARS_H_
+
+/************************************************************************
+** Shortest round trip formatting of IEEE754 floats and doubles using  **
+** Grisu2 (F. Loitsch, "Printing Floating-Point Numbers Quickly and    **
+** Accurately with Integers", PLDI 2010). The digits produced always   **
+** read back to the same value and are the shortest such digits for   **
+** all but a tiny fraction of inputs.                                  **
+************************************************************************/
+
+#define DOUBLE_TO_CHARS_MAX_LENGTH  32  /* "-" + 17 digits + "e+308" + "0." and padding, rounded up */
+
+#define DTC_ALPHA                   (-60)
+#define DTC_GAMMA                   (-32)
+#define DTC_CACHED_POWERS_MIN_EXP   (-300)
+#define DTC_CACHED_POWERS_STEP      8
+
+#define DTC_MIN_DECIMAL_EXPONENT    (-4)   /* below 1e-4 switch to exponent notation */
+#define DTC_MAX_DECIMAL_EXPONENT    15     /* from 1e15 on switch to exponent notation */
+
+typedef struct {
+    uint64_t f;
+    int e;
+} dtc_diyfp_t;
+
+typedef struct {
+    uint64_t f;
+    int e;
+    int k;
+} dtc_cached_power_t;
+
+/* 10^k for k = -300, -292, ... 324 normalized to 64 bits */
+static dtc_cached_power_t const dtc_cached_powers[] = {
+    { UINT64_C(0xAB70FE17C79AC6CA), -1060, -300 },
+    { UINT64_C(0xFF77B1FCBEBCDC4F), -1034, -292 },
+    { UINT64_C(0xBE5691EF416BD60C), -1007, -284 },
+    { UINT64_C(0x8DD01FAD907FFC3C),  -980, -276 },
+    { UINT64_C(0xD3515C2831559A83),  -954, -268 },
+    { UINT64_C(0x9D71AC8FADA6C9B5),  -927, -260 },
+    { UINT64_C(0xEA9C227723EE8BCB),  -901, -252 },
+    { UINT64_C(0xAECC49914078536D),  -874, -244 },
+    { UINT64_C(0x823C12795DB6CE57),  -847, -236 },
+    { UINT64_C(0xC21094364DFB5637),  -821, -228 },
+    { UINT64_C(0x9096EA6F3848984F),  -794, -220 },
+    { UINT64_C(0xD77485CB25823AC7),  -768, -212 },
+    { UINT64_C(0xA086CFCD97BF97F4),  -741, -204 },
+    { UINT64_C(0xEF340A98172AACE5),  -715, -196 },
+    { UINT64_C(0xB23867FB2A35B28E),  -688, -188 },
+    { UINT64_C(0x84C8D4DFD2C63F3B),  -661, -180 },
+    { UINT64_C(0xC5DD44271AD3CDBA),  -635, -172 },
+    { UINT64_C(0x936B9FCEBB25C996),  -608, -164 },
+    { UINT64_C(0xDBAC6C247D62A584),  -582, -156 },
+    { UINT64_C(0xA3AB66580D5FDAF6),  -555, -148 },
+    { UINT64_C(0xF3E2F893DEC3F126),  -529, -140 },
+    { UINT64_C(0xB5B5ADA8AAFF80B8),  -502, -132 },
+    { UINT64_C(0x87625F056C7C4A8B),  -475, -124 },
+    { UINT64_C(0xC9BCFF6034C13053),  -449, -116 },
+    { UINT64_C(0x964E858C91BA2655),  -422, -108 },
+    { UINT64_C(0xDFF9772470297EBD),  -396, -100 },
+    { UINT64_C(0xA6DFBD9FB8E5B88F),  -369,  -92 },
+    { UINT64_C(0xF8A95FCF88747D94),  -343,  -84 },
+    { UINT64_C(0xB94470938FA89BCF),  -316,  -76 },
+    { UINT64_C(0x8A08F0F8BF0F156B),  -289,  -68 },
+    { UINT64_C(0xCDB02555653131B6),  -263,  -60 },
+    { UINT64_C(0x993FE2C6D07B7FAC),  -236,  -52 },
+    { UINT64_C(0xE45C10C42A2B3B06),  -210,  -44 },
+    { UINT64_C(0xAA242499697392D3),  -183,  -36 },
+    { UINT64_C(0xFD87B5F28300CA0E),  -157,  -28 },
+    { UINT64_C(0xBCE5086492111AEB),  -130,  -20 },
+    { UINT64_C(0x8CBCCC096F5088CC),  -103,  -12 },
+    { UINT64_C(0xD1B71758E219652C),   -77,   -4 },
+    { UINT64_C(0x9C40000000000000),   -50,    4 },
+    { UINT64_C(0xE8D4A51000000000),   -24,   12 },
+    { UINT64_C(0xAD78EBC5AC620000),     3,   20 },
+    { UINT64_C(0x813F3978F8940984),    30,   28 },
+    { UINT64_C(0xC097CE7BC90715B3),    56,   36 },
+    { UINT64_C(0x8F7E32CE7BEA5C70),    83,   44 },
+    { UINT64_C(0xD5D238A4ABE98068),   109,   52 },
+    { UINT64_C(0x9F4F2726179A2245),   136,   60 },
+    { UINT64_C(0xED63A231D4C4FB27),   162,   68 },
+    { UINT64_C(0xB0DE65388CC8ADA8),   189,   76 },
+    { UINT64_C(0x83C7088E1AAB65DB),   216,   84 },
+    { UINT64_C(0xC45D1DF942711D9A),   242,   92 },
+    { UINT64_C(0x924D692CA61BE758),   269,  100 },
+    { UINT64_C(0xDA01EE641A708DEA),   295,  108 },
+    { UINT64_C(0xA26DA3999AEF774A),   322,  116 },
+    { UINT64_C(0xF209787BB47D6B85),   348,  124 },
+    { UINT64_C(0xB454E4A179DD1877),   375,  132 },
+    { UINT64_C(0x865B86925B9BC5C2),   402,  140 },
+    { UINT64_C(0xC83553C5C8965D3D),   428,  148 },
+    { UINT64_C(0x952AB45CFA97A0B3),   455,  156 },
+    { UINT64_C(0xDE469FBD99A05FE3),   481,  164 },
+    { UINT64_C(0xA59BC234DB398C25),   508,  172 },
+    { UINT64_C(0xF6C69A72A3989F5C),   534,  180 },
+    { UINT64_C(0xB7DCBF5354E9BECE),   561,  188 },
+    { UINT64_C(0x88FCF317F22241E2),   588,  196 },
+    { UINT64_C(0xCC20CE9BD35C78A5),   614,  204 },
+    { UINT64_C(0x98165AF37B2153DF),   641,  212 },
+    { UINT64_C(0xE2A0B5DC971F303A),   667,  220 },
+    { UINT64_C(0xA8D9D1535CE3B396),   694,  228 },
+    { UINT64_C(0xFB9B7CD9A4A7443C),   720,  236 },
+    { UINT64_C(0xBB764C4CA7A44410),   747,  244 },
+    { UINT64_C(0x8BAB8EEFB6409C1A),   774,  252 },
+    { UINT64_C(0xD01FEF10A657842C),   800,  260 },
+    { UINT64_C(0x9B10A4E5E9913129),   827,  268 },
+    { UINT64_C(0xE7109BFBA19C0C9D),   853,  276 },
+    { UINT64_C(0xAC2820D9623BF429),   880,  284 },
+    { UINT64_C(0x80444B5E7AA7CF85),   907,  292 },
+    { UINT64_C(0xBF21E44003ACDD2D),   933,  300 },
+    { UINT64_C(0x8E679C2F5E44FF8F),   960,  308 },
+    { UINT64_C(0xD433179D9C8CB841),   986,  316 },
+    { UINT64_C(0x9E19DB92B4E31BA9),  1013,  324 }};
+
+STATIC dtc_diyfp_t dtc_diyfp(uint64_t const f, int const e)
+{
+    dtc_diyfp_t x;
+
+    x.f = f;
+    x.e = e;
+
+    return x;
+}
+
+STATIC dtc_diyfp_t dtc_normalize(dtc_diyfp_t x)
+{
+    ASSERT(x.f != 0);
+
+    while ((x.f >> 63) == 0)
+    {
+        x.f <<= 1;
+        x.e--;
+    }
+
+    return x;
+}
+
+/* the 64 most significant bits of the 128 bit product, rounded */
+STATIC dtc_diyfp_t dtc_multiply(dtc_diyfp_t const x, dtc_diyfp_t const y)
+{
+    uint64_t const x_lo = x.f & UINT64_C(0xFFFFFFFF);
+    uint64_t const x_hi = x.f >> 32;
+    uint64_t const y_lo = y.f & UINT64_C(0xFFFFFFFF);
+    uint64_t const y_hi = y.f >> 32;
+    uint64_t const p0 = x_lo * y_lo;
+    uint64_t const p1 = x_lo * y_hi;
+    uint64_t const p2 = x_hi * y_lo;
+    uint64_t const p3 = x_hi * y_hi;
+    uint64_t middle = (p0 >> 32) + (p1 & UINT64_C(0xFFFFFFFF)) + (p2 & UINT64_C(0xFFFFFFFF));
+
+    middle += UINT64_C(1) << 31;
+
+    return dtc_diyfp(p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32), x.e + y.e + 64);
+}
+
+/*
+ * Splits a positive finite value with the given number of significand bits (hidden bit
+ * included) and exponent bias into v and the normalized boundaries m- and m+ half way
+ * to its neighbours.
+ */
+STATIC dtc_diyfp_t dtc_compute_boundaries(uint64_t const bits, int const precision, int const bias, dtc_diyfp_t * const m_minus, dtc_diyfp_t * const m_plus)
+{
+    uint64_t const hidden_bit = UINT64_C(1) << (precision - 1);
+    uint64_t const biased_exponent = bits >> (precision - 1);
+    uint64_t const fraction = bits & (hidden_bit - 1);
+    dtc_diyfp_t const v = (biased_exponent == 0) ? dtc_diyfp(fraction, 1 - bias) : dtc_diyfp(fraction + hidden_bit, (int)biased_exponent - bias);
+    connector_bool_t const lower_boundary_is_closer = connector_bool(fraction == 0 && biased_exponent > 1);
+
+    *m_plus = dtc_normalize(dtc_diyfp(2 * v.f + 1, v.e - 1));
+    *m_minus = lower_boundary_is_closer ? dtc_diyfp(4 * v.f - 1, v.e - 2) : dtc_diyfp(2 * v.f - 1, v.e - 1);
+    m_minus->f <<= m_minus->e - m_plus->e;
+    m_minus->e = m_plus->e;
+
+    return dtc_normalize(v);
+}
+
+STATIC dtc_cached_power_t const * dtc_get_cached_power(int const e)
+{
+    /* k = ceil((alpha - e - 1) * log10(2)), 78913 / 2^18 being log10(2) */
+    int const f = DTC_ALPHA - e - 1;
+    int const k = (f * 78913) / (1 << 18) + (f > 0);
+    int const index = (-DTC_CACHED_POWERS_MIN_EXP + k + (DTC_CACHED_POWERS_STEP - 1)) / DTC_CACHED_POWERS_STEP;
+
+    ASSERT(index >= 0 && (size_t)index < ARRAY_SIZE(dtc_cached_powers));
+
+    return &dtc_cached_powers[index];
+}
+
+STATIC void dtc_round(char * const buffer, int const length, uint64_t const distance, uint64_t const delta, uint64_t rest, uint64_t const ten_k)
+{
+    /* move the last digit towards w while it stays inside the safe interval */
+    while (rest < distance && delta - rest >= ten_k &&
+           (rest + ten_k < distance || distance - rest > rest + ten_k - distance))
+    {
+        buffer[length - 1]--;
+        rest += ten_k;
+    }
+}
+
+STATIC int dtc_generate_digits(char * const buffer, int * const decimal_exponent, dtc_diyfp_t const m_minus, dtc_diyfp_t const w, dtc_diyfp_t const m_plus)
+{
+    static uint32_t const powers_of_ten[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+    int const shift = -m_plus.e;
+    uint64_t const one = UINT64_C(1) << shift;
+    uint64_t delta = m_plus.f - m_minus.f;
+    uint64_t distance = m_plus.f - w.f;
+    uint32_t integral = (uint32_t)(m_plus.f >> shift);
+    uint64_t fractional = m_plus.f & (one - 1);
+    int length = 0;
+    int n = 10;
+
+    while (n > 1 && integral < powers_of_ten[n - 1])
+        n--;
+
+    while (n > 0)
+    {
+        uint32_t const pow10 = powers_of_ten[--n];
+        uint64_t rest;
+
+        buffer[length++] = (char)('0' + integral / pow10);
+        integral %= pow10;
+
+        rest = ((uint64_t)integral << shift) + fractional;
+        if (rest <= delta)
+        {
+            *decimal_exponent += n;
+            dtc_round(buffer, length, distance, delta, rest, (uint64_t)pow10 << shift);
+            goto done;
+        }
+    }
+
+    for (;;)
+    {
+        fractional *= 10;
+        buffer[length++] = (char)('0' + (fractional >> shift));
+        fractional &= one - 1;
+        delta *= 10;
+        distance *= 10;
+        (*decimal_exponent)--;
+        if (fractional <= delta)
+            break;
+    }
+    dtc_round(buffer, length, distance, delta, fractional, one);
+
+done:
+    return length;
+}
+
+STATIC int dtc_append_exponent(char * const buffer, int exponent)
+{
+    int length = 0;
+
+    buffer[length++] = 'e';
+    if (exponent < 0)
+    {
+        buffer[length++] = '-';
+        exponent = -exponent;
+    }
+    else
+    {
+        buffer[length++] = '+';
+    }
+
+    if (exponent >= 100)
+    {
+        buffer[length++] = (char)('0' + exponent / 100);
+        exponent %= 100;
+    }
+    buffer[length++] = (char)('0' + exponent / 10);
+    buffer[length++] = (char)('0' + exponent % 10);
+
+    return length;
+}
+
+/* lays out the digits d1..dk * 10^decimal_exponent as a plain or an exponent number */
+STATIC int dtc_format(char * const buffer, int const k, int const decimal_exponent)
+{
+    int const n = k + decimal_exponent;
+    int length;
+
+    if (k <= n && n <= DTC_MAX_DECIMAL_EXPONENT)
+    {
+        /* digits[000].0 */
+        memset(&buffer[k], '0', n - k);
+        buffer[n] = '.';
+        buffer[n + 1] = '0';
+        length = n + 2;
+    }
+    else if (0 < n && n <= DTC_MAX_DECIMAL_EXPONENT)
+    {
+        /* dig.its */
+        memmove(&buffer[n + 1], &buffer[n], k - n);
+        buffer[n] = '.';
+        length = k + 1;
+    }
+    else if (DTC_MIN_DECIMAL_EXPONENT < n && n <= 0)
+    {
+        /* 0.[000]digits */
+        memmove(&buffer[2 - n], buffer, k);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        memset(&buffer[2], '0', -n);
+        length = 2 - n + k;
+    }
+    else
+    {
+        /* d.igitse+123 */
+        length = 1;
+        if (k > 1)
+        {
+            memmove(&buffer[2], &buffer[1], k - 1);
+            buffer[1] = '.';
+            length = k + 1;
+        }
+        length += dtc_append_exponent(&buffer[length], n - 1);
+    }
+
+    return length;
+}
+
+/*
+ * Writes the shortest text that reads back as the IEEE754 value held in bits, which has
+ * precision significand bits (hidden bit included) and the given exponent bias, and
+ * returns its length. buffer must hold DOUBLE_TO_CHARS_MAX_LENGTH characters.
+ */
+STATIC size_t dtc_ieee754_to_chars(char * const buffer, uint64_t const bits, int const precision, int const bias, int const exponent_bits)
+{
+    uint64_t const sign_bit = UINT64_C(1) << (precision - 1 + exponent_bits);
+    uint64_t const magnitude = bits & (sign_bit - 1);
+    uint64_t const infinity = ((UINT64_C(1) << exponent_bits) - 1) << (precision - 1);
+    char * digits = buffer;
+    int length;
+
+    if ((bits & sign_bit) != 0 && magnitude <= infinity)
+        *digits++ = '-';
+
+    if (magnitude == 0)
+    {
+        memcpy(digits, "0.0", 3);
+        length = 3;
+    }
+    else if (magnitude == infinity)
+    {
+        memcpy(digits, "Infinity", 8);
+        length = 8;
+    }
+    else if (magnitude > infinity)
+    {
+        memcpy(digits, "NaN", 3);
+        length = 3;
+    }
+    else
+    {
+        dtc_diyfp_t m_minus;
+        dtc_diyfp_t m_plus;
+        dtc_diyfp_t const v = dtc_compute_boundaries(magnitude, precision, bias, &m_minus, &m_plus);
+        dtc_cached_power_t const * const cached = dtc_get_cached_power(m_plus.e);
+        dtc_diyfp_t const c_minus_k = dtc_diyfp(cached->f, cached->e);
+        dtc_diyfp_t const w = dtc_multiply(v, c_minus_k);
+        dtc_diyfp_t w_minus = dtc_multiply(m_minus, c_minus_k);
+        dtc_diyfp_t w_plus = dtc_multiply(m_plus, c_minus_k);
+        int decimal_exponent = -cached->k;
+
+        /* shrink the interval by one ulp on both ends to cover the multiplication error */
+        w_minus.f++;
+        w_plus.f--;
+
+        length = dtc_generate_digits(digits, &decimal_exponent, w_minus, w, w_plus);
+        length = dtc_format(digits, length, decimal_exponent);
+    }
+
+    return (size_t)(digits - buffer) + length;
+}
+
+STATIC size_t double_to_chars(char * const buffer, double const value)
+{
+    uint64_t bits;
+
+    ASSERT(sizeof value == sizeof bits);
+    memcpy(&bits, &value, sizeof bits);
+
+    return dtc_ieee754_to_chars(buffer, bits, 53, 1075, 11);
+}
+
+STATIC size_t float_to_chars(char * const buffer, float const value)
+{
+    uint32_t bits;
+
+    ASSERT(sizeof value == sizeof bits);
+    memcpy(&bits, &value, sizeof bits);
+
+    return dtc_ieee754_to_chars(buffer, bits, 24, 150, 8);
+}
+
+#endif
@@ -51,6 +51,97 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 #include "layer.h"
 
+#if (defined CONNECTOR_DATA_SERVICE) || (defined CONNECTOR_FILE_SYSTEM) || (defined CONNECTOR_RCI_SERVICE) || (defined CONNECTOR_STREAMING_CLI_SERVICE) || (defined SM_CONFIGURATION)
+#define edp_msg_is_active(connector_ptr)    msg_is_active(connector_ptr)
+#else
+#define edp_msg_is_active(connector_ptr)    connector_false
+#endif
+
+STATIC void edp_get_wait_set(connector_data_t * const connector_ptr, connector_wait_network_t * const network,
+                             connector_wait_set_t * const wait_set, unsigned long const now)
+{
+    network->handle = connector_ptr->edp_data.network_handle;
+    network->send = tcp_is_send_active(connector_ptr);
+
+    if (edp_get_initiate_state(connector_ptr) != connector_transport_idle)
+    {
+        /* start or stop requested, a stop may wait for sessions to complete */
+        wait_set_timeout(wait_set, WAIT_SET_ACTIVE_TIMEOUT_IN_MS);
+    }
+
+    switch (edp_get_active_state(connector_ptr))
+    {
+    case connector_transport_idle:
+        if (connector_ptr->edp_data.stop.auto_connect)
+        {
+            wait_set_timeout(wait_set, 0);
+        }
+        break;
+
+    case connector_transport_wait_for_reconnect:
+        if (connector_ptr->edp_data.connect_at == 0)
+        {
+            wait_set_timeout(wait_set, 0);
+        }
+        else
+        {
+            wait_set_deadline(wait_set, now, connector_ptr->edp_data.connect_at);
+        }
+        break;
+
+    case connector_transport_open:
+        /* a non-blocking connect completes when the handle becomes writable, a TLS handshake may wait for either direction */
+        if (edp_get_edp_state(connector_ptr) == edp_communication_connect_to_cloud)
+        {
+            network->send = connector_bool(!connector_ptr->edp_data.open_wait_for_receive);
+        }
+        wait_set_timeout(wait_set, WAIT_SET_ACTIVE_TIMEOUT_IN_MS);
+        break;
+
+    case connector_transport_send:
+    case connector_transport_receive:
+        if (edp_get_edp_state(connector_ptr) != edp_facility_process)
+        {
+            wait_set_timeout(wait_set, WAIT_SET_ACTIVE_TIMEOUT_IN_MS);
+            break;
+        }
+
+#if (defined CONNECTOR_TCP_RECEIVE_BUFFER_SIZE)
+        /* packets read ahead do not show up on the network handle */
+        if (connector_ptr->edp_data.receive_packet.read_ahead.count > 0)
+        {
+            wait_set_timeout(wait_set, 0);
+        }
+#endif
+
+        if (!tcp_is_send_active(connector_ptr))
+        {
+            wait_set_deadline(wait_set, now, connector_ptr->edp_data.keepalive.last_rx_sent_time + GET_RX_KEEPALIVE_INTERVAL(connector_ptr));
+        }
+
+        if (GET_TX_KEEPALIVE_INTERVAL(connector_ptr) > 0)
+        {
+            unsigned long const tx_keepalive_interval = GET_TX_KEEPALIVE_INTERVAL(connector_ptr);
+#ifdef CONNECTOR_AGGRESSIVE_KEEPALIVES
+            unsigned long const max_timeout = (tx_keepalive_interval + (tx_keepalive_interval / 2));
+#else
+            unsigned long const max_timeout = tx_keepalive_interval * (connector_ptr->edp_data.keepalive.miss_tx_count + UINT32_C(1));
+#endif
+            wait_set_deadline(wait_set, now, connector_ptr->edp_data.keepalive.last_tx_received_time + max_timeout);
+        }
+
+        if (edp_msg_is_active(connector_ptr))
+        {
+            wait_set_timeout(wait_set, WAIT_SET_ACTIVE_TIMEOUT_IN_MS);
+        }
+        break;
+
+    default:
+        wait_set_timeout(wait_set, 0);
+        break;
+    }
+}
+
 
 STATIC connector_status_t edp_config_init(connector_data_t * const connector_ptr)
 {
@@ -209,6 +300,8 @@ connector_status_t connector_edp_step(connector_data_t * const connector_ptr)
                 if (uptime >= connector_ptr->edp_data.connect_at)
                     edp_set_active_state(connector_ptr, connector_transport_open);
             }
+            /* nothing to do until connect_at, same as the SM transports */
+            result = connector_idle;
             break;
         }
         }
@@ -279,7 +372,12 @@ check_state:
                 case connector_transport_close:
                 case connector_transport_idle:
                     if (result != connector_open_error)
+                    {
                         edp_set_active_state(connector_ptr, connector_transport_open);
+                        /* step again so the open callback is not held back by the wait set */
+                        if (result == connector_idle)
+                            result = connector_working;
+                    }
                     else
                         edp_set_initiate_state(connector_ptr, connector_transport_idle);
                     break;
@@ -415,6 +513,15 @@ connector_status_t edp_initiate_action(connector_data_t * const connector_ptr, c
             case connector_initiate_ping_request:
             case connector_initiate_session_cancel:
             case connector_initiate_session_cancel_all:
+#endif
+#if (defined CONNECTOR_RCI_CACHE)
+            case connector_initiate_rci_cache_invalidate:
+#endif
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+            case connector_initiate_firmware_write_complete:
+#endif
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+            case connector_initiate_streaming_cli_ready:
 #endif
             case connector_initiate_terminate:
                 break;
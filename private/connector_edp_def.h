@@ -41,6 +41,33 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #error "MSG_RECV_WINDOW_SIZE must be bigger than MSG_MAX_SEND_PACKET_SIZE"
 #endif
 
+/* Number of EDP packets which may be waiting to be sent at the same time
+ * (including the one being sent). 1 gives the single packet send path.
+ */
+#if !(defined CONNECTOR_TCP_SEND_QUEUE_SIZE)
+#define CONNECTOR_TCP_SEND_QUEUE_SIZE   4
+#endif
+
+#if (CONNECTOR_TCP_SEND_QUEUE_SIZE < 1) || (CONNECTOR_TCP_SEND_QUEUE_SIZE > 255)
+#error "CONNECTOR_TCP_SEND_QUEUE_SIZE must be between 1 and 255"
+#endif
+
+/* Bytes read from the network at once when defined. The EDP packets in them are taken from
+ * this buffer, so several small packets cost one receive callback instead of two each.
+ */
+#if (defined CONNECTOR_TCP_RECEIVE_BUFFER_SIZE)
+#if (CONNECTOR_TCP_RECEIVE_BUFFER_SIZE < 4)
+#error "CONNECTOR_TCP_RECEIVE_BUFFER_SIZE must be at least the EDP header size (4)"
+#endif
+#endif
+
+/* When defined, the messages of the handshake which follow the MT version exchange are
+ * built one after the other in the send packet buffer and sent together.
+ */
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+#define TCP_FLIGHT_MESSAGES     16
+#endif
+
 #define EDP_MT_VERSION      2
 
 #define DEVICE_TYPE_LENGTH  255
@@ -132,6 +159,15 @@ typedef enum {
     edp_state_send_in_progress
 } connector_edp_state_t;
 
+typedef enum {
+    edp_handshake_connect,
+    edp_handshake_version,
+    edp_handshake_protocol,
+    edp_handshake_security,
+    edp_handshake_discovery,
+    edp_handshake_phase_count
+} edp_handshake_phase_t;
+
 typedef enum {
     facility_callback_delete,
     facility_callback_cleanup
@@ -141,6 +177,15 @@ struct connector_data;
 
 typedef connector_status_t (* send_complete_cb_t)(struct connector_data * const connector_ptr, uint8_t const * const packet, connector_status_t const status, void * const user_data);
 
+typedef struct {
+    uint8_t const * ptr;
+    size_t bytes_sent;
+    size_t total_length;
+    send_complete_cb_t complete_cb;
+    void * user_data;
+    connector_bool_t continued;     /* the data continues the packet queued before it */
+} edp_send_entry_t;
+
 typedef struct connector_buffer {
     /* this buffer must be FIRST field in the structure
      * since this is used between network interface
@@ -162,6 +207,18 @@ typedef struct connector_facility {
     uint16_t facility_num;
 } connector_facility_t;
 
+#if (defined CONNECTOR_DATA_SERVICE)
+typedef struct
+{
+    void * callback_context;
+    connector_request_data_service_send_t const * header;
+    connector_request_id_data_service_t request_type;
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+    connector_ds_target_handler_t target_handler;
+#endif
+} data_service_context_t;
+#endif
+
 typedef struct connector_edp_data {
     unsigned long last_activity;
 
@@ -208,18 +265,48 @@ typedef struct connector_edp_data {
             connector_edp_state_t current;
             connector_edp_state_t next;
         }edp;
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+        connector_bool_t protocol_version_deferred;
+#endif
     } state;
 
+#if (defined CONNECTOR_DEBUG)
+    struct {
+        connector_bool_t started;
+        edp_handshake_phase_t phase;
+        unsigned long time;
+        unsigned long sends;
+        unsigned long reads;
+        struct {
+            unsigned long milliseconds;
+            unsigned long sends;
+            unsigned long reads;
+            unsigned int steps;
+        } phases[edp_handshake_phase_count];
+    } handshake;
+#endif
+
     struct {
         struct {
             uint8_t buffer[MSG_MAX_SEND_PACKET_SIZE];
             connector_bool_t in_use;
         } packet_buffer;
-        uint8_t * ptr;
-        size_t bytes_sent;
-        size_t total_length;
-        send_complete_cb_t complete_cb;
-        void * user_data;
+        edp_send_entry_t entry[CONNECTOR_TCP_SEND_QUEUE_SIZE];
+        unsigned int head;
+        unsigned int count;
+        connector_bool_t vectored;
+        unsigned long sends;
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+        struct {
+            connector_bool_t open;
+            size_t length;
+            unsigned int count;
+            struct {
+                send_complete_cb_t complete_cb;
+                void * user_data;
+            } message[TCP_FLIGHT_MESSAGES];
+        } flight;
+#endif
     } send_packet;
 
     struct {
@@ -233,6 +320,15 @@ typedef struct connector_edp_data {
         uint16_t  packet_length;
         size_t bytes_received;
         size_t total_length;
+#if (defined CONNECTOR_TCP_RECEIVE_BUFFER_SIZE)
+        struct {
+            uint8_t data[CONNECTOR_TCP_RECEIVE_BUFFER_SIZE];
+            size_t head;
+            size_t count;
+        } read_ahead;
+#endif
+        unsigned long reads;
+        unsigned long packets;
     } receive_packet;
 
     struct {
@@ -254,6 +350,7 @@ typedef struct connector_edp_data {
 
     connector_close_status_t  close_status;
     connector_network_handle_t * network_handle;
+    connector_bool_t open_wait_for_receive;
 
     struct {
         connector_bool_t is_set;
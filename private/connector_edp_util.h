@@ -49,10 +49,18 @@ STATIC void edp_reset_initial_data(connector_data_t * const connector_ptr)
     connector_ptr->edp_data.keepalive.miss_tx_count = 0;
 #endif
 
-    connector_ptr->edp_data.send_packet.total_length = 0;
-    connector_ptr->edp_data.send_packet.bytes_sent = 0;
-    connector_ptr->edp_data.send_packet.ptr = NULL;
-    connector_ptr->edp_data.send_packet.complete_cb = NULL;
+    connector_ptr->edp_data.send_packet.head = 0;
+    connector_ptr->edp_data.send_packet.count = 0;
+    connector_ptr->edp_data.send_packet.vectored = connector_true;
+    connector_ptr->edp_data.send_packet.sends = 0;
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+    connector_ptr->edp_data.send_packet.flight.open = connector_false;
+    connector_ptr->edp_data.send_packet.flight.count = 0;
+    connector_ptr->edp_data.state.protocol_version_deferred = connector_false;
+#endif
+#if (defined CONNECTOR_DEBUG)
+    memset(&connector_ptr->edp_data.handshake, 0, sizeof connector_ptr->edp_data.handshake);
+#endif
 
     connector_ptr->edp_data.receive_packet.total_length = 0;
     connector_ptr->edp_data.receive_packet.bytes_received = 0;
@@ -60,6 +68,12 @@ STATIC void edp_reset_initial_data(connector_data_t * const connector_ptr)
     connector_ptr->edp_data.receive_packet.ptr = NULL;
     connector_ptr->edp_data.receive_packet.data_packet = NULL;
     connector_ptr->edp_data.receive_packet.timeout = MAX_RECEIVE_TIMEOUT_IN_SECONDS;
+#if (defined CONNECTOR_TCP_RECEIVE_BUFFER_SIZE)
+    /* bytes read ahead belong to the previous connection */
+    connector_ptr->edp_data.receive_packet.read_ahead.count = 0;
+#endif
+    connector_ptr->edp_data.receive_packet.reads = 0;
+    connector_ptr->edp_data.receive_packet.packets = 0;
     connector_ptr->edp_data.close_status = (connector_close_status_t)0;
 
     edp_set_stop_condition(connector_ptr, connector_stop_immediately);
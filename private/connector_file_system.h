@@ -794,7 +794,8 @@ STATIC connector_status_t call_file_read_user(connector_data_t * const connector
                                               msg_service_request_t * const service_request,
                                               fs_context_t * const context,
                                               void   * const buffer,
-                                              size_t * const buffer_size)
+                                              size_t * const buffer_size,
+                                              void const * * const external)
 {
     connector_status_t status;
     connector_file_system_read_t data;
@@ -803,6 +804,8 @@ STATIC connector_status_t call_file_read_user(connector_data_t * const connector
     data.buffer = buffer;
     data.bytes_available = *buffer_size;
     data.bytes_used = 0;
+    data.external_buffer = NULL;
+    *external = NULL;
 
     status = fs_call_user(connector_ptr,
                           service_request,
@@ -823,6 +826,8 @@ STATIC connector_status_t call_file_read_user(connector_data_t * const connector
     }
 
     *buffer_size = data.bytes_used;
+    if (data.bytes_used > 0)
+        *external = data.external_buffer;
 
 done:
     return status;
@@ -1094,7 +1099,9 @@ STATIC connector_status_t process_file_get_response(connector_data_t * const con
         while (bytes_to_read > 0)
         {
             size_t cnt = bytes_to_read;
-            status = call_file_read_user(connector_ptr, service_request, context, data_ptr, &cnt);
+            void const * external;
+
+            status = call_file_read_user(connector_ptr, service_request, context, data_ptr, &cnt, &external);
 
             if (status == connector_pending)
             {
@@ -1105,6 +1112,15 @@ STATIC connector_status_t process_file_get_response(connector_data_t * const con
             if (!FsOperationSuccess(status, context))
                 goto close_file;
 
+            if (external != NULL)
+            {
+                /* sent from the application's memory right after what was read so far */
+                service_data->external_ptr = external;
+                service_data->external_bytes = cnt;
+                context->data.f.bytes_done += cnt;
+                break;
+            }
+
             if (cnt > 0)
             {
                 data_ptr += cnt;
@@ -1126,7 +1142,8 @@ STATIC connector_status_t process_file_get_response(connector_data_t * const con
         if (context->data.f.data_length == context->data.f.bytes_done)
             last_msg = connector_true;
 
-        if (!last_msg)
+        /* the file is closed in the next callback, once the external data has been sent */
+        if (!last_msg || service_data->external_bytes > 0)
             goto done;
     }
 
@@ -1862,21 +1879,6 @@ done:
     return status;
 }
 
-STATIC connector_status_t file_system_free_callback(connector_data_t * const connector_ptr,
-                                                    msg_service_request_t * const service_request)
-{
-    msg_session_t * const session = service_request->session;
-    fs_context_t * const context = session->service_context;
-    connector_status_t status = connector_working;
-
-    if (context != NULL)
-    {
-        status = free_data_buffer(connector_ptr, named_buffer_id(msg_service), context);
-    }
-
-    return status;
-}
-
 STATIC connector_status_t call_session_error_user(connector_data_t * const connector_ptr,
                                                   msg_service_request_t * const service_request,
                                                   fs_context_t * const context)
@@ -1957,6 +1959,31 @@ done:
     return status;
 }
 
+STATIC connector_status_t file_system_free_callback(connector_data_t * const connector_ptr,
+                                                    msg_service_request_t * const service_request)
+{
+    msg_session_t * const session = service_request->session;
+    fs_context_t * const context = session->service_context;
+    connector_status_t status = connector_working;
+
+    if (context != NULL)
+    {
+        /* A session that fails while its data is going out is deleted once the send completes,
+         * without the error callback: the file is closed here, after the data has been sent. */
+        if (FsIsOpen(context))
+            status = file_system_session_error_callback(connector_ptr, service_request);
+
+        {
+            connector_status_t const free_status = free_data_buffer(connector_ptr, named_buffer_id(msg_service), context);
+
+            if (status != connector_abort)
+                status = free_status;
+        }
+    }
+
+    return status;
+}
+
 
 STATIC connector_status_t file_system_callback(connector_data_t * const connector_ptr,
                                                msg_service_request_t * const service_request)
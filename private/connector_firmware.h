@@ -107,6 +107,30 @@ enum fw_target_list{
 static size_t const target_list_header_size = field_named_data(fw_target_list, opcode, size);
 static size_t const target_list_size = record_bytes(fw_target_list);
 
+/* largest image data in a binary block, also advertised in the download response */
+#define FW_BINARY_BLOCK_MAX_SIZE    (MSG_MAX_RECV_PACKET_SIZE - PACKET_EDP_FACILITY_SIZE - record_end(fw_binary_block))
+
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+/*
+ * Pipelined download: every binary block is copied into a ring of CONNECTOR_FIRMWARE_PIPELINE_BLOCKS
+ * buffers and handed to the application, which writes it in the background and reports the
+ * write with connector_initiate_firmware_write_complete. Blocks are committed in offset order
+ * and a block is only acknowledged to Device Cloud once it and all blocks before it are written.
+ *
+ * The write may be reported from any thread, so the report only goes into the completed ring,
+ * which the application side fills and fw_pipeline_process() empties on the connector thread.
+ * Nothing else of the pipeline is touched outside the connector thread.
+ */
+typedef struct {
+    uint32_t offset;
+    size_t length;
+    connector_bool_t ack_required;
+    connector_firmware_status_t status;
+    connector_bool_t written;
+    uint8_t data[FW_BINARY_BLOCK_MAX_SIZE];
+} fw_pipeline_block_t;
+#endif
+
 typedef struct {
     connector_data_t * connector_ptr;
     unsigned long last_fw_keepalive_sent_time;
@@ -116,14 +140,37 @@ typedef struct {
     size_t  response_size;
     connector_firmware_status_t abort_reason;
     connector_bool_t send_busy;
+    connector_bool_t response_queued;
     connector_bool_t update_started;
     connector_bool_t fw_keepalive_start;
     connector_firmware_info_t target_info;
 
     uint8_t response_buffer[FW_MESSAGE_RESPONSE_MAX_SIZE + PACKET_EDP_FACILITY_SIZE];
     uint8_t target_count;
+
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+    struct {
+        fw_pipeline_block_t block[CONNECTOR_FIRMWARE_PIPELINE_BLOCKS];
+        unsigned int head;
+        unsigned int count;
+        struct {
+            connector_firmware_write_complete_t entry[CONNECTOR_FIRMWARE_PIPELINE_BLOCKS];
+            unsigned int volatile posted;
+            unsigned int volatile applied;
+        } completed;
+    } pipeline;
+#endif
 } connector_firmware_data_t;
 
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+/* drops the pipeline and the write reports not applied yet, on the connector thread */
+#define fw_pipeline_discard(fw_ptr) \
+    do { \
+        (fw_ptr)->pipeline.count = 0; \
+        (fw_ptr)->pipeline.completed.applied = (fw_ptr)->pipeline.completed.posted; \
+    } while (0)
+#endif
+
 STATIC connector_status_t get_fw_config(connector_firmware_data_t * const fw_ptr,
                                         connector_request_id_firmware_t const fw_request_id,
                                         void * const data)
@@ -236,13 +283,27 @@ enum fw_abort {
 
 #define FW_ABORT_HEADER_SIZE    record_bytes(fw_abort)
 
+STATIC connector_status_t fw_response_sent(connector_data_t * const connector_ptr, uint8_t const * const packet, connector_status_t const status, void * const user_data)
+{
+    connector_firmware_data_t * const fw_ptr = user_data;
+
+    UNUSED_PARAMETER(connector_ptr);
+    UNUSED_PARAMETER(packet);
+    UNUSED_PARAMETER(status);
+
+    fw_ptr->response_queued = connector_false;
+    return connector_working;
+}
+
 STATIC connector_status_t send_fw_message(connector_firmware_data_t * const fw_ptr)
 {
 
     connector_status_t result;
 
-    result = tcp_initiate_send_facility_packet(fw_ptr->connector_ptr, fw_ptr->response_buffer, fw_ptr->response_size, E_MSG_FAC_FW_NUM, NULL, NULL);
+    result = tcp_initiate_send_facility_packet(fw_ptr->connector_ptr, fw_ptr->response_buffer, fw_ptr->response_size, E_MSG_FAC_FW_NUM, fw_response_sent, fw_ptr);
     fw_ptr->send_busy = (result == connector_pending) ? connector_true : connector_false;
+    if (result == connector_working)
+        fw_ptr->response_queued = connector_true;
     return result;
 
 }
@@ -546,7 +607,7 @@ error:
         message_store_u8(fw_download_response, target, download_request.target_number);
         message_store_u8(fw_download_response, response_type, download_request.status);
         /* Max size = Max buffer size - EDP facility size header (header: 4 bytes + protocol: 4 bytes) - Firmware binary block message size (7 bytes) */
-        message_store_be16(fw_download_response, max_size, MSG_MAX_RECV_PACKET_SIZE - PACKET_EDP_FACILITY_SIZE - record_end(fw_binary_block));
+        message_store_be16(fw_download_response, max_size, FW_BINARY_BLOCK_MAX_SIZE);
 
         fw_ptr->response_size = record_bytes(fw_download_response);
 
@@ -555,6 +616,10 @@ error:
         {
             fw_ptr->update_started = connector_true;
             fw_ptr->target_info.target_number = download_request.target_number;
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+            fw_ptr->pipeline.head = 0;
+            fw_pipeline_discard(fw_ptr);
+#endif
         }
 
     }
@@ -563,7 +628,7 @@ done:
     return result;
 }
 
-STATIC connector_status_t process_fw_binary_block(connector_firmware_data_t * const fw_ptr, uint8_t * const fw_binary_block, uint16_t const length)
+STATIC connector_status_t send_fw_binary_ack(connector_firmware_data_t * const fw_ptr, unsigned int const target, uint32_t const offset)
 {
 /* Firmware binary block acknowledge message format:
  *  -----------------------------------
@@ -580,6 +645,149 @@ enum fw_binary_ack {
     field_define(fw_binary_ack, status, uint8_t),
     record_end(fw_binary_ack)
 };
+    uint8_t * fw_binary_ack = GET_PACKET_DATA_POINTER(fw_ptr->response_buffer, PACKET_EDP_FACILITY_SIZE);
+
+    ASSERT((sizeof fw_ptr->response_buffer - PACKET_EDP_FACILITY_SIZE) > record_bytes(fw_binary_ack));
+    /* send firmware binary block acknowledge */
+    message_store_u8(fw_binary_ack, opcode, fw_binary_block_ack_opcode);
+    message_store_u8(fw_binary_ack, target, target);
+    message_store_be32(fw_binary_ack, offset, offset);
+    message_store_u8(fw_binary_ack, status, connector_firmware_status_success);
+
+    fw_ptr->response_size = record_bytes(fw_binary_ack);
+    return send_fw_message(fw_ptr);
+}
+
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+#define fw_pipeline_block(fw_ptr, n)    (&(fw_ptr)->pipeline.block[((fw_ptr)->pipeline.head + (n)) % CONNECTOR_FIRMWARE_PIPELINE_BLOCKS])
+
+/* Marks the blocks reported by connector_initiate_firmware_write_complete as written */
+STATIC void fw_pipeline_apply_completions(connector_firmware_data_t * const fw_ptr)
+{
+    unsigned int const posted = fw_ptr->pipeline.completed.posted;
+    unsigned int applied = fw_ptr->pipeline.completed.applied;
+
+    if (applied != posted)
+    {
+        /* the entries are read after posted */
+        CONNECTOR_MEMORY_BARRIER();
+        while (applied != posted)
+        {
+            connector_firmware_write_complete_t const * const write_complete = &fw_ptr->pipeline.completed.entry[applied % CONNECTOR_FIRMWARE_PIPELINE_BLOCKS];
+            connector_bool_t found = connector_false;
+
+            if (fw_ptr->update_started && write_complete->target_number == fw_ptr->target_info.target_number)
+            {
+                unsigned int i;
+
+                for (i = 0; i < fw_ptr->pipeline.count; i++)
+                {
+                    fw_pipeline_block_t * const block = fw_pipeline_block(fw_ptr, i);
+
+                    if (block->offset == write_complete->offset && !block->written)
+                    {
+                        block->status = write_complete->status;
+                        block->written = connector_true;
+                        found = connector_true;
+                        break;
+                    }
+                }
+            }
+
+            if (!found)
+                connector_debug_line("fw_pipeline_apply_completions: no block waits for target %u offset %lu", write_complete->target_number, (unsigned long)write_complete->offset);
+
+            applied++;
+        }
+
+        /* and are done with before they are handed back */
+        CONNECTOR_MEMORY_BARRIER();
+        fw_ptr->pipeline.completed.applied = applied;
+    }
+}
+
+/* Retires the written blocks at the head of the ring and acknowledges them in offset order */
+STATIC connector_status_t fw_pipeline_process(connector_firmware_data_t * const fw_ptr)
+{
+    connector_status_t result = connector_working;
+
+    fw_pipeline_apply_completions(fw_ptr);
+
+    /* the response buffer is reused, so only one response may be queued at a time */
+    while (fw_ptr->pipeline.count > 0 && !fw_ptr->send_busy && !fw_ptr->response_queued)
+    {
+        fw_pipeline_block_t * const block = fw_pipeline_block(fw_ptr, 0);
+
+        if (!block->written)
+            break;
+
+        if (block->status != connector_firmware_status_success)
+        {
+            fw_abort_status_t fw_status;
+
+            fw_status.user_status = block->status;
+            send_fw_abort(fw_ptr, (uint8_t)fw_ptr->target_info.target_number, fw_download_abort_opcode, fw_status);
+            fw_ptr->abort_reason = block->status;
+            fw_pipeline_discard(fw_ptr);
+            result = connector_pending;
+            break;
+        }
+
+        if (block->ack_required)
+        {
+            result = send_fw_binary_ack(fw_ptr, fw_ptr->target_info.target_number, block->offset);
+            if (result == connector_pending)
+            {
+                /* the block stays at the head and is acknowledged on the next call */
+                fw_ptr->send_busy = connector_false;
+                result = connector_working;
+                break;
+            }
+        }
+
+        fw_ptr->pipeline.head = (fw_ptr->pipeline.head + 1) % CONNECTOR_FIRMWARE_PIPELINE_BLOCKS;
+        fw_ptr->pipeline.count--;
+    }
+
+    return result;
+}
+
+/*
+ * Called by connector_initiate_action() on the application's thread. It only posts the report,
+ * fw_pipeline_process() applies it. Reports must come from one thread at a time.
+ */
+STATIC connector_status_t fw_pipeline_write_complete(connector_data_t * const connector_ptr, connector_firmware_write_complete_t const * const write_complete)
+{
+    connector_status_t result = connector_success;
+    connector_firmware_data_t * const fw_ptr = get_facility_data(connector_ptr, E_MSG_FAC_FW_NUM);
+    unsigned int posted;
+
+    if (fw_ptr == NULL)
+    {
+        result = connector_init_error;
+        goto done;
+    }
+
+    posted = fw_ptr->pipeline.completed.posted;
+    if (posted - fw_ptr->pipeline.completed.applied >= CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+    {
+        /* no more blocks than that can be waiting for their write */
+        result = connector_service_busy;
+        goto done;
+    }
+
+    fw_ptr->pipeline.completed.entry[posted % CONNECTOR_FIRMWARE_PIPELINE_BLOCKS] = *write_complete;
+    /* the entry is written before it is posted */
+    CONNECTOR_MEMORY_BARRIER();
+    fw_ptr->pipeline.completed.posted = posted + 1;
+
+done:
+    return result;
+}
+#endif
+
+STATIC connector_status_t process_fw_binary_block(connector_firmware_data_t * const fw_ptr, uint8_t * const fw_binary_block, uint16_t const length)
+{
     connector_status_t result = connector_idle;
 
     uint8_t ack_required;
@@ -619,26 +827,51 @@ enum fw_binary_ack {
     download_data.image.data = (fw_binary_block + record_bytes(fw_binary_block));
     download_data.status = connector_firmware_status_success;
 
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+    {
+        fw_pipeline_block_t * block;
+
+        if (fw_ptr->pipeline.count == CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+        {
+            /* keep the packet until a write completes */
+            result = connector_pending;
+            goto done;
+        }
+
+        ASSERT(download_data.image.bytes_used <= sizeof block->data);
+
+        /* the block is in the ring while the callback runs so it can already report the write */
+        block = fw_pipeline_block(fw_ptr, fw_ptr->pipeline.count);
+        memcpy(block->data, download_data.image.data, download_data.image.bytes_used);
+        block->offset = download_data.image.offset;
+        block->length = download_data.image.bytes_used;
+        block->ack_required = connector_bool(ack_required);
+        block->status = connector_firmware_status_success;
+        block->written = connector_false;
+        fw_ptr->pipeline.count++;
+
+        download_data.image.data = block->data;
+        result = get_fw_config(fw_ptr, connector_request_id_firmware_download_data, &download_data);
+        if (result != connector_working || download_data.status != connector_firmware_status_success)
+            fw_ptr->pipeline.count--;
+    }
+#else
     result = get_fw_config(fw_ptr, connector_request_id_firmware_download_data, &download_data);
+#endif
 
     if (result == connector_working)
     {
         if (download_data.status == connector_firmware_status_success)
         {
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+            /* acknowledged once written, which the callback may already have reported */
+            result = fw_pipeline_process(fw_ptr);
+#else
             if(ack_required)
             {
-                uint8_t * fw_binary_ack = GET_PACKET_DATA_POINTER(fw_ptr->response_buffer, PACKET_EDP_FACILITY_SIZE);
-
-                ASSERT((sizeof fw_ptr->response_buffer - PACKET_EDP_FACILITY_SIZE) > record_bytes(fw_binary_ack));
-                /* send firmware binary block acknowledge */
-                message_store_u8(fw_binary_ack, opcode, fw_binary_block_ack_opcode);
-                message_store_u8(fw_binary_ack, target, download_data.target_number);
-                message_store_be32(fw_binary_ack, offset, download_data.image.offset);
-                message_store_u8(fw_binary_ack, status, connector_firmware_status_success);
-
-                fw_ptr->response_size = record_bytes(fw_binary_ack);
-                result = send_fw_message(fw_ptr);
+                result = send_fw_binary_ack(fw_ptr, download_data.target_number, download_data.image.offset);
             }
+#endif
         }
         else
         {
@@ -756,6 +989,14 @@ enum fw_complete_response {
         goto done;
     }
 
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+    if (fw_ptr->pipeline.count > 0)
+    {
+        /* wait until every block is written before completing */
+        result = connector_pending;
+        goto done;
+    }
+#endif
 
     /* call callback */
     result = get_fw_config(fw_ptr, connector_request_id_firmware_download_complete, &download_complete);
@@ -914,7 +1155,29 @@ STATIC connector_status_t fw_process(connector_data_t * const connector_ptr, voi
     uint8_t * fw_message;
     uint16_t length;
 
-    if (edp_header == NULL)
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+    if (fw_ptr->pipeline.count > 0)
+    {
+        result = fw_pipeline_process(fw_ptr);
+        if (fw_ptr->pipeline.count > 0)
+        {
+            /* poll for write completions */
+            *receive_timeout = MIN_RECEIVE_TIMEOUT_IN_SECONDS;
+        }
+        if (result != connector_working)
+            goto done;
+    }
+#endif
+
+    if (fw_ptr->response_queued && edp_header != NULL)
+    {
+        /* keep the packet until the previous response in the response buffer is sent */
+        result = connector_pending;
+        goto done;
+    }
+
+    /* an aborted download still needs its abort callback when no packet is pending */
+    if (edp_header == NULL && fw_ptr->abort_reason == connector_firmware_status_success)
     {
         if (fw_ptr->update_started)
         {
@@ -923,7 +1186,7 @@ STATIC connector_status_t fw_process(connector_data_t * const connector_ptr, voi
         goto done;
     }
 
-    if (fw_ptr->fw_keepalive_start)
+    if (fw_ptr->fw_keepalive_start && edp_header != NULL)
     {
         result = fw_discovery(connector_ptr, facility_data, edp_header, receive_timeout);
         if (result == connector_working)
@@ -961,6 +1224,9 @@ STATIC connector_status_t fw_process(connector_data_t * const connector_ptr, voi
         {
             fw_ptr->abort_reason = connector_firmware_status_success;
             fw_ptr->update_started = connector_false;
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+            fw_pipeline_discard(fw_ptr);
+#endif
         }
         fw_ptr->last_fw_keepalive_sent_time = 0;
         goto done;
@@ -1045,6 +1311,9 @@ STATIC connector_status_t connector_facility_firmware_cleanup(connector_data_t *
         connector_firmware_download_abort_t request_data;
         request_data.target_number = fw_ptr->target_info.target_number;
         request_data.status = connector_firmware_status_device_error;
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+        fw_pipeline_discard(fw_ptr);
+#endif
         return get_fw_config(fw_ptr, connector_request_id_firmware_download_abort, &request_data);
     }
     else
@@ -1081,6 +1350,10 @@ STATIC connector_status_t connector_facility_firmware_init(connector_data_t * co
             goto done;
         }
         fw_ptr = ptr;
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+        fw_ptr->pipeline.completed.posted = 0;
+        fw_ptr->pipeline.completed.applied = 0;
+#endif
    }
     fw_ptr->target_count = 0;
     fw_ptr->target_info.target_number = 0;
@@ -1090,8 +1363,13 @@ STATIC connector_status_t connector_facility_firmware_init(connector_data_t * co
     fw_ptr->abort_reason = connector_firmware_status_success;
     fw_ptr->fw_keepalive_start = connector_false;
     fw_ptr->send_busy = connector_false;
+    fw_ptr->response_queued = connector_false;
     fw_ptr->update_started = connector_false;
     fw_ptr->connector_ptr = connector_ptr;
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+    fw_ptr->pipeline.head = 0;
+    fw_pipeline_discard(fw_ptr);
+#endif
 
     {
         connector_firmware_count_t firmware_data;
@@ -34,6 +34,50 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 #define MSG_INVALID_CLIENT_SESSION  0xFFFF
 
+/* Sessions are indexed by (session id, client owned) in an open-addressing table
+ * sized to a power of two. Sessions that do not fit are still found through the
+ * session list, so the table size only bounds the fast path.
+ */
+#if !(defined CONNECTOR_MSG_SESSION_TABLE_SIZE)
+#if (defined CONNECTOR_MSG_MAX_TRANSACTION) && (CONNECTOR_MSG_MAX_TRANSACTION > 0) && (CONNECTOR_MSG_MAX_TRANSACTION <= 4)
+#define CONNECTOR_MSG_SESSION_TABLE_SIZE    16
+#else
+#define CONNECTOR_MSG_SESSION_TABLE_SIZE    64
+#endif
+#endif
+
+#if (CONNECTOR_MSG_SESSION_TABLE_SIZE < 4) || ((CONNECTOR_MSG_SESSION_TABLE_SIZE & (CONNECTOR_MSG_SESSION_TABLE_SIZE - 1)) != 0)
+#error "CONNECTOR_MSG_SESSION_TABLE_SIZE must be a power of 2 and at least 4"
+#endif
+
+#define MSG_SESSION_TABLE_MASK      (CONNECTOR_MSG_SESSION_TABLE_SIZE - 1)
+/* keep a quarter of the slots free so probe sequences stay short */
+#define MSG_SESSION_TABLE_MAX_LOAD  (CONNECTOR_MSG_SESSION_TABLE_SIZE - (CONNECTOR_MSG_SESSION_TABLE_SIZE / 4))
+
+/* The receive window of each session starts at the window advertised in the capabilities
+ * and adapts between that and the maximum as the session's data is consumed.
+ */
+#if (defined CONNECTOR_MSG_RECV_WINDOW_MAX)
+#if (CONNECTOR_MSG_RECV_WINDOW_MAX < MSG_RECV_WINDOW_SIZE)
+#error "CONNECTOR_MSG_RECV_WINDOW_MAX must not be smaller than MSG_RECV_WINDOW_SIZE"
+#endif
+#define MSG_RECV_WINDOW_MAX         CONNECTOR_MSG_RECV_WINDOW_MAX
+#else
+#define MSG_RECV_WINDOW_MAX         (32 * DEFAULT_BUFFER_SIZE)
+#endif
+
+/* longest round trip, in seconds of the session's consumption rate, the window is sized for */
+#define MSG_RECV_WINDOW_SECONDS     2
+
+/* Acks of different sessions are collected and sent as one queued packet */
+#if !(defined CONNECTOR_MSG_ACK_BATCH_SIZE)
+#define CONNECTOR_MSG_ACK_BATCH_SIZE    4
+#endif
+
+#if (CONNECTOR_MSG_ACK_BATCH_SIZE < 1) || (CONNECTOR_MSG_ACK_BATCH_SIZE > 255)
+#error "CONNECTOR_MSG_ACK_BATCH_SIZE must be between 1 and 255"
+#endif
+
 #define MSG_FLAG_REQUEST      UINT32_C(0x01)
 #define MSG_FLAG_LAST_DATA    UINT32_C(0x02)
 #define MSG_FLAG_SENDER       UINT32_C(0x04)
@@ -48,6 +92,8 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #define MSG_FLAG_DEFLATED     UINT32_C(0x800)
 #define MSG_FLAG_SEND_NOW     UINT32_C(0x1000)
 #define MSG_FLAG_DOUBLE_BUF   UINT32_C(0x2000)
+#define MSG_FLAG_CONSUMER_BUSY UINT32_C(0x4000)
+#define MSG_FLAG_RATE_SAMPLED UINT32_C(0x8000)
 
 #define MsgIsBitSet(flag, bit)      (connector_bool(((flag) & (bit)) == (bit)))
 #define MsgIsBitClear(flag, bit)    (connector_bool(((flag) & (bit)) == 0))
@@ -66,6 +112,8 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #define MsgIsDeflated(flag)         MsgIsBitSet((flag), MSG_FLAG_DEFLATED)
 #define MsgIsSendNow(flag)          MsgIsBitSet((flag), MSG_FLAG_SEND_NOW)
 #define MsgIsDoubleBuf(flag)        MsgIsBitSet((flag), MSG_FLAG_DOUBLE_BUF)
+#define MsgIsConsumerBusy(flag)     MsgIsBitSet((flag), MSG_FLAG_CONSUMER_BUSY)
+#define MsgIsRateSampled(flag)      MsgIsBitSet((flag), MSG_FLAG_RATE_SAMPLED)
 #define MsgReplyExpected(flag)      MsgIsBitClear((flag), MSG_FLAG_NO_REPLY)
 
 #define MsgIsNotRequest(flag)       MsgIsBitClear((flag), MSG_FLAG_REQUEST)
@@ -90,6 +138,8 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #define MsgSetSendNow(flag)     MsgBitSet((flag), MSG_FLAG_SEND_NOW)
 #define MsgSetDoubleBuf(flag)   MsgBitSet((flag), MSG_FLAG_DOUBLE_BUF)
 #define MsgSetNoReply(flag)     MsgBitSet((flag), MSG_FLAG_NO_REPLY)
+#define MsgSetConsumerBusy(flag) MsgBitSet((flag), MSG_FLAG_CONSUMER_BUSY)
+#define MsgSetRateSampled(flag) MsgBitSet((flag), MSG_FLAG_RATE_SAMPLED)
 
 #define MsgClearRequest(flag)     MsgBitClear((flag), MSG_FLAG_REQUEST)
 #define MsgClearLastData(flag)    MsgBitClear((flag), MSG_FLAG_LAST_DATA)
@@ -101,6 +151,8 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #define MsgClearDeflated(flag)    MsgBitClear((flag), MSG_FLAG_DEFLATED)
 #define MsgClearSendNow(flag)     MsgBitClear((flag), MSG_FLAG_SEND_NOW)
 #define MsgClearNoReply(flag)     MsgBitClear((flag), MSG_FLAG_NO_REPLY)
+#define MsgClearConsumerBusy(flag) MsgBitClear((flag), MSG_FLAG_CONSUMER_BUSY)
+#define MsgClearRateSampled(flag) MsgBitClear((flag), MSG_FLAG_RATE_SAMPLED)
 
 typedef enum
 {
@@ -205,6 +257,8 @@ enum msg_ack_packet_t
     record_end(ack_packet)
 };
 
+#define MSG_ACK_PACKET_SIZE     (PACKET_EDP_FACILITY_SIZE + record_end(ack_packet))
+
 enum msg_error_packet_t
 {
     field_define(error_packet, opcode, uint8_t),
@@ -220,12 +274,16 @@ typedef struct msg_data_block_t
     size_t available_window;
     size_t ack_count;
     unsigned int status_flag;
+    size_t rate_bytes;          /* total_bytes when the consumption rate was last sampled */
+    unsigned long rate_time;
+    size_t consumption_rate;    /* bytes per second, 0 until sampled */
 #if (defined CONNECTOR_COMPRESSION)
     uint8_t  buffer_in[MSG_MAX_SEND_PACKET_SIZE];
     uint8_t  buffer_out[MSG_MAX_SEND_PACKET_SIZE];
     size_t   bytes_out;
     int      z_flag;
-    z_stream zlib;
+    z_streamp zlib;         /* own_zlib, or a stream borrowed from the pool */
+    z_stream own_zlib;
 #endif
 } msg_data_block_t;
 
@@ -234,6 +292,8 @@ typedef struct
     void * data_ptr;
     size_t length_in_bytes;
     unsigned int flags;
+    void const * external_ptr;      /* send data which follows data_ptr but was not copied there */
+    size_t external_bytes;
 } msg_service_data_t;
 
 #if (defined CONNECTOR_DATA_SERVICE)
@@ -257,15 +317,25 @@ typedef struct
 #endif
 } msg_service_request_t;
 
+typedef enum
+{
+    msg_session_not_indexed,
+    msg_session_indexed,
+    msg_session_unindexed
+} msg_session_index_t;
+
 typedef struct msg_session_t
 {
     unsigned int session_id;
+    msg_session_index_t index_state;
     unsigned int service_id;
     void * service_context;
     msg_state_t current_state;
     msg_state_t saved_state;
     uint8_t * send_data_ptr;
     size_t send_data_bytes;
+    uint8_t const * send_external_ptr;
+    size_t send_external_bytes;
     msg_data_block_t * in_dblock;
     msg_data_block_t * out_dblock;
     connector_session_error_t error;
@@ -285,6 +355,15 @@ typedef struct
     uint8_t max_transactions;
 } msg_capabilities_t;
 
+#if (defined CONNECTOR_COMPRESSION) && (CONNECTOR_COMPRESSION_STREAM_POOL_SIZE > 0)
+typedef struct
+{
+    z_stream stream;
+    connector_bool_t initialized;
+    connector_bool_t in_use;
+} msg_zlib_pool_entry_t;
+#endif
+
 typedef struct
 {
     msg_capabilities_t capabilities[msg_capability_count];
@@ -295,35 +374,328 @@ typedef struct
         msg_session_t * tail;
         msg_session_t * current;
     } session;
+    struct
+    {
+        msg_session_t * slot[CONNECTOR_MSG_SESSION_TABLE_SIZE];
+        unsigned int count;
+        unsigned int unindexed;
+    } session_table;
     unsigned int last_assigned_id;
     struct {
         void const * user;
         void const * internal;
     } pending_service_request;
     msg_service_id_t discovery_state;
+    uint32_t receive_window_max;
+    struct
+    {
+        uint8_t buffer[CONNECTOR_MSG_ACK_BATCH_SIZE * MSG_ACK_PACKET_SIZE];
+        unsigned int count;
+        connector_bool_t coalesced;
+        connector_bool_t sending;
+    } ack;
+#if (defined CONNECTOR_COMPRESSION) && (CONNECTOR_COMPRESSION_STREAM_POOL_SIZE > 0)
+    struct
+    {
+        msg_zlib_pool_entry_t deflate[CONNECTOR_COMPRESSION_STREAM_POOL_SIZE];
+        msg_zlib_pool_entry_t inflate[CONNECTOR_COMPRESSION_STREAM_POOL_SIZE];
+    } zlib_pool;
+#endif
 } connector_msg_data_t;
 
 #if (defined CONNECTOR_STREAMING_CLI_SERVICE)
 STATIC connector_status_t streaming_cli_service_poll_sessions(connector_data_t * const data_ptr, connector_msg_data_t * const msg_ptr);
 #endif
 
-STATIC msg_session_t * msg_find_session(connector_msg_data_t const * const msg_ptr, unsigned int const id, connector_bool_t const client_owned)
+#if (defined CONNECTOR_COMPRESSION)
+#if (defined CONNECTOR_COMPRESSION_DICTIONARY)
+/* Preset dictionary shared with Device Cloud. zlib matches the end of the dictionary
+ * with the shortest distances, so the most frequent strings go last. Any change to
+ * this text changes its Adler-32 id and must be made on Device Cloud as well.
+ */
+static uint8_t const msg_zlib_dictionary[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+    "<device_request target_name=\"</device_request><device_response target_name=\"</device_response>"
+    "<rci_request version=\"1.1\"></rci_request><rci_reply version=\"1.1\"></rci_reply>"
+    "<query_descriptor></query_descriptor><do_command target=\"</do_command><reboot/>"
+    "<set_state></set_state><query_state></query_state><set_setting></set_setting><query_setting></query_setting>"
+    "<error id=\"\"><desc></desc><hint></hint></error><state><value></value><index=\""
+    "{\"type\":\"\",\"value\":\"\",\"timestamp\":\"\",\"id\":\""
+    ",\"stream_id\":\",INTEGER,,LONG,,FLOAT,,DOUBLE,,STRING,,BINARY,,JSON,,GEOJSON,"
+    ",,,,INTEGER,,,,,,,DOUBLE,,,,,,,FLOAT,,,,,0.000000,,,,\n";
+#endif
+
+STATIC int msg_zlib_start(z_streamp const zlib_ptr, connector_bool_t const deflating, connector_bool_t const reset)
 {
-    msg_session_t * session = msg_ptr->session.head;
+    int zret;
 
-    while (session != NULL)
+    if (deflating)
     {
-        if (session->session_id == id)
+        if (reset)
+        {
+            zret = deflateReset(zlib_ptr);
+        }
+        else
         {
-            unsigned int const status = (session->in_dblock != NULL) ? session->in_dblock->status_flag : session->out_dblock->status_flag;
+            memset(zlib_ptr, 0, sizeof *zlib_ptr);
+            zret = deflateInit2(zlib_ptr, CONNECTOR_COMPRESSION_LEVEL, Z_DEFLATED, CONNECTOR_COMPRESSION_WINDOW_BITS,
+                                CONNECTOR_COMPRESSION_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+        }
+
+        #if (defined CONNECTOR_COMPRESSION_DICTIONARY)
+        if (zret == Z_OK)
+            zret = deflateSetDictionary(zlib_ptr, msg_zlib_dictionary, sizeof msg_zlib_dictionary - 1);
+        #endif
+    }
+    else
+    {
+        if (reset)
+        {
+            zret = inflateReset(zlib_ptr);
+        }
+        else
+        {
+            memset(zlib_ptr, 0, sizeof *zlib_ptr);
+            zret = inflateInit(zlib_ptr);
+        }
+    }
+
+    return zret;
+}
+
+STATIC void msg_zlib_end(z_streamp const zlib_ptr, connector_bool_t const deflating)
+{
+    if (deflating)
+        deflateEnd(zlib_ptr);
+    else
+        inflateEnd(zlib_ptr);
+}
+
+/* Points dblock->zlib to a ready stream: a free pooled one if there is one, otherwise its own. */
+STATIC connector_bool_t msg_open_zlib(connector_msg_data_t * const msg_ptr, msg_data_block_t * const dblock, connector_bool_t const deflating)
+{
+    connector_bool_t opened = connector_false;
+
+    #if (CONNECTOR_COMPRESSION_STREAM_POOL_SIZE > 0)
+    {
+        msg_zlib_pool_entry_t * const pool = deflating ? msg_ptr->zlib_pool.deflate : msg_ptr->zlib_pool.inflate;
+        size_t i;
+
+        for (i = 0; i < CONNECTOR_COMPRESSION_STREAM_POOL_SIZE; i++)
+        {
+            msg_zlib_pool_entry_t * const entry = &pool[i];
+
+            if (entry->in_use) continue;
+
+            if (entry->initialized && msg_zlib_start(&entry->stream, deflating, connector_true) != Z_OK)
+            {
+                msg_zlib_end(&entry->stream, deflating);
+                entry->initialized = connector_false;
+            }
+
+            if (!entry->initialized)
+                entry->initialized = connector_bool(msg_zlib_start(&entry->stream, deflating, connector_false) == Z_OK);
+
+            if (entry->initialized)
+            {
+                entry->in_use = connector_true;
+                dblock->zlib = &entry->stream;
+                opened = connector_true;
+                goto done;
+            }
+            break;
+        }
+    }
+    #else
+    UNUSED_PARAMETER(msg_ptr);
+    #endif
+
+    if (msg_zlib_start(&dblock->own_zlib, deflating, connector_false) == Z_OK)
+    {
+        dblock->zlib = &dblock->own_zlib;
+        opened = connector_true;
+    }
+
+#if (CONNECTOR_COMPRESSION_STREAM_POOL_SIZE > 0)
+done:
+#endif
+    return opened;
+}
+
+STATIC void msg_close_zlib(connector_msg_data_t * const msg_ptr, msg_data_block_t * const dblock, connector_bool_t const deflating)
+{
+    #if (CONNECTOR_COMPRESSION_STREAM_POOL_SIZE > 0)
+    if (dblock->zlib != &dblock->own_zlib)
+    {
+        msg_zlib_pool_entry_t * const pool = deflating ? msg_ptr->zlib_pool.deflate : msg_ptr->zlib_pool.inflate;
+        size_t i;
 
-            if (MsgIsClientOwned(status) == client_owned)
+        for (i = 0; i < CONNECTOR_COMPRESSION_STREAM_POOL_SIZE; i++)
+        {
+            if (dblock->zlib == &pool[i].stream)
+            {
+                pool[i].in_use = connector_false;
                 break;
+            }
         }
+        ASSERT(i < CONNECTOR_COMPRESSION_STREAM_POOL_SIZE);
+    }
+    else
+    #else
+    UNUSED_PARAMETER(msg_ptr);
+    #endif
+    {
+        msg_zlib_end(dblock->zlib, deflating);
+    }
 
-        session = session->next;
+    dblock->zlib = NULL;
+}
+
+#if (CONNECTOR_COMPRESSION_STREAM_POOL_SIZE > 0)
+STATIC void msg_free_zlib_pool(connector_msg_data_t * const msg_ptr)
+{
+    size_t i;
+
+    for (i = 0; i < CONNECTOR_COMPRESSION_STREAM_POOL_SIZE; i++)
+    {
+        if (msg_ptr->zlib_pool.deflate[i].initialized)
+            msg_zlib_end(&msg_ptr->zlib_pool.deflate[i].stream, connector_true);
+
+        if (msg_ptr->zlib_pool.inflate[i].initialized)
+            msg_zlib_end(&msg_ptr->zlib_pool.inflate[i].stream, connector_false);
     }
+    memset(&msg_ptr->zlib_pool, 0, sizeof msg_ptr->zlib_pool);
+}
+#endif
+#endif
 
+STATIC connector_bool_t msg_session_is_client_owned(msg_session_t const * const session)
+{
+    unsigned int const status = (session->in_dblock != NULL) ? session->in_dblock->status_flag : session->out_dblock->status_flag;
+
+    return MsgIsClientOwned(status);
+}
+
+STATIC unsigned int msg_session_table_hash(unsigned int const id, connector_bool_t const client_owned)
+{
+    /* ids are mostly sequential, so the id itself spreads well over the slots */
+    unsigned int const key = (id << 1) | (client_owned ? 1 : 0);
+
+    return key & MSG_SESSION_TABLE_MASK;
+}
+
+STATIC void msg_index_session(connector_msg_data_t * const msg_ptr, msg_session_t * const session)
+{
+    ASSERT(session->index_state == msg_session_not_indexed);
+
+    if (msg_ptr->session_table.count < MSG_SESSION_TABLE_MAX_LOAD)
+    {
+        unsigned int index = msg_session_table_hash(session->session_id, msg_session_is_client_owned(session));
+
+        while (msg_ptr->session_table.slot[index] != NULL)
+            index = (index + 1) & MSG_SESSION_TABLE_MASK;
+
+        msg_ptr->session_table.slot[index] = session;
+        msg_ptr->session_table.count++;
+        session->index_state = msg_session_indexed;
+    }
+    else
+    {
+        msg_ptr->session_table.unindexed++;
+        session->index_state = msg_session_unindexed;
+    }
+}
+
+STATIC void msg_unindex_session(connector_msg_data_t * const msg_ptr, msg_session_t * const session)
+{
+    switch (session->index_state)
+    {
+    case msg_session_indexed:
+    {
+        unsigned int index = msg_session_table_hash(session->session_id, msg_session_is_client_owned(session));
+
+        while (msg_ptr->session_table.slot[index] != session)
+        {
+            ASSERT(msg_ptr->session_table.slot[index] != NULL);
+            index = (index + 1) & MSG_SESSION_TABLE_MASK;
+        }
+
+        /* backward shift deletion: move later entries of the probe sequence into the hole */
+        {
+            unsigned int hole = index;
+            unsigned int next = (index + 1) & MSG_SESSION_TABLE_MASK;
+
+            while (msg_ptr->session_table.slot[next] != NULL)
+            {
+                msg_session_t * const entry = msg_ptr->session_table.slot[next];
+                unsigned int const home = msg_session_table_hash(entry->session_id, msg_session_is_client_owned(entry));
+
+                if (((next - home) & MSG_SESSION_TABLE_MASK) >= ((next - hole) & MSG_SESSION_TABLE_MASK))
+                {
+                    msg_ptr->session_table.slot[hole] = entry;
+                    hole = next;
+                }
+                next = (next + 1) & MSG_SESSION_TABLE_MASK;
+            }
+            msg_ptr->session_table.slot[hole] = NULL;
+        }
+
+        msg_ptr->session_table.count--;
+        break;
+    }
+
+    case msg_session_unindexed:
+        ASSERT(msg_ptr->session_table.unindexed > 0);
+        msg_ptr->session_table.unindexed--;
+        break;
+
+    case msg_session_not_indexed:
+        break;
+    }
+
+    session->index_state = msg_session_not_indexed;
+}
+
+STATIC void msg_set_session_id(connector_msg_data_t * const msg_ptr, msg_session_t * const session, unsigned int const id)
+{
+    session->session_id = id;
+    msg_index_session(msg_ptr, session);
+}
+
+STATIC msg_session_t * msg_find_session(connector_msg_data_t const * const msg_ptr, unsigned int const id, connector_bool_t const client_owned)
+{
+    msg_session_t * session = NULL;
+
+    {
+        unsigned int index = msg_session_table_hash(id, client_owned);
+
+        while (msg_ptr->session_table.slot[index] != NULL)
+        {
+            msg_session_t * const entry = msg_ptr->session_table.slot[index];
+
+            if ((entry->session_id == id) && (msg_session_is_client_owned(entry) == client_owned))
+            {
+                session = entry;
+                goto done;
+            }
+            index = (index + 1) & MSG_SESSION_TABLE_MASK;
+        }
+    }
+
+    if (msg_ptr->session_table.unindexed > 0)
+    {
+        session = msg_ptr->session.head;
+
+        while (session != NULL)
+        {
+            if ((session->session_id == id) && (msg_session_is_client_owned(session) == client_owned))
+                break;
+
+            session = session->next;
+        }
+    }
+
+done:
     return session;
 }
 
@@ -413,11 +785,42 @@ error:
     return status;
 }
 
+/* Takes the packets of the session off the send queue before the session or the data it
+ * sends from goes away. Returns connector_pending while one of them is going out, the session
+ * stays until msg_send_complete() is called for it.
+ */
+STATIC connector_status_t msg_cancel_session_sends(connector_data_t * const connector_ptr, msg_session_t * const session)
+{
+    unsigned int cancelled;
+    connector_status_t const status = tcp_cancel_send_entries(connector_ptr, session, &cancelled);
+
+    if ((cancelled > 0) && (session->out_dblock != NULL))
+    {
+        unsigned int const flag = session->out_dblock->status_flag;
+
+        /* msg_send_complete() would have released the packet buffer the data was built in */
+        if ((MsgIsDoubleBuf(flag) == connector_false) && (MsgIsCompressed(flag) == connector_false))
+            tcp_release_packet_buffer(connector_ptr, session->send_data_ptr, connector_abort, NULL);
+    }
+
+    return status;
+}
+
 STATIC connector_status_t msg_inform_error(connector_data_t * const connector_ptr, msg_session_t * const session, connector_session_error_t error_code)
 {
+    connector_status_t status = msg_cancel_session_sends(connector_ptr, session);
+
+    /* kept for the free callback in case the session is deleted before it can be told */
     session->service_layer_data.error_value = error_code;
 
-    return msg_call_service_layer(connector_ptr, session, msg_service_type_error);
+    /* the service layer releases the data being sent once it is told */
+    if (status != connector_working)
+        goto done;
+
+    status = msg_call_service_layer(connector_ptr, session, msg_service_type_error);
+
+done:
+    return status;
 }
 
 STATIC msg_session_t * msg_create_session(connector_data_t * const connector_ptr, connector_msg_data_t * const msg_ptr, unsigned int const service_id,
@@ -510,7 +913,8 @@ STATIC msg_session_t * msg_create_session(connector_data_t * const connector_ptr
         }
     }
 
-    session->session_id = session_id;
+    session->session_id = MSG_INVALID_CLIENT_SESSION;
+    session->index_state = msg_session_not_indexed;
     session->service_id = service_id;
     session->error = connector_session_error_none;
     session->service_layer_data.error_value = connector_session_error_none;
@@ -519,6 +923,7 @@ STATIC msg_session_t * msg_create_session(connector_data_t * const connector_ptr
 #endif
     session->error_flag = 0;
     session->send_data_bytes = 0;
+    session->send_external_bytes = 0;
     session->service_context = NULL;
     session->current_state = msg_state_init;
     session->saved_state = msg_state_init;
@@ -530,6 +935,8 @@ STATIC msg_session_t * msg_create_session(connector_data_t * const connector_ptr
         session->in_dblock->status_flag = flags;
 
     add_list_node(&msg_ptr->session.head, &msg_ptr->session.tail, session);
+    if (client_owned == connector_true)
+        msg_set_session_id(msg_ptr, session, session_id);
 
     msg_ptr->capabilities[capability_id].active_transactions++;
     *status = connector_working;
@@ -554,6 +961,14 @@ STATIC connector_status_t msg_delete_session(connector_data_t * const connector_
     ASSERT_GOTO(session != NULL, error);
     ASSERT_GOTO((session->in_dblock != NULL) || (session->out_dblock != NULL), error);
 
+    if (msg_cancel_session_sends(connector_ptr, session) == connector_pending)
+    {
+        /* msg_process_pending() deletes it once msg_send_complete() is called */
+        session->current_state = msg_state_delete;
+        goto error;
+    }
+
+    msg_unindex_session(msg_ptr, session);
     remove_list_node(&msg_ptr->session.head, &msg_ptr->session.tail, session);
     if (msg_ptr->session.current == session)
         msg_ptr->session.current = (session->prev != NULL) ? session->prev : msg_ptr->session.tail;
@@ -561,10 +976,10 @@ STATIC connector_status_t msg_delete_session(connector_data_t * const connector_
     #if (defined CONNECTOR_COMPRESSION)
     {
         if ((session->in_dblock != NULL) && MsgIsInflated(session->in_dblock->status_flag))
-            inflateEnd(&session->in_dblock->zlib);
+            msg_close_zlib(msg_ptr, session->in_dblock, connector_false);
 
         if ((session->out_dblock != NULL) && MsgIsDeflated(session->out_dblock->status_flag))
-            deflateEnd(&session->out_dblock->zlib);
+            msg_close_zlib(msg_ptr, session->out_dblock, connector_true);
     }
     #endif
 
@@ -605,15 +1020,21 @@ STATIC void msg_default_data_block(msg_data_block_t * dblock, uint32_t const win
     dblock->available_window = window_size;
     dblock->ack_count = 0;
     dblock->total_bytes = 0;
+    dblock->consumption_rate = 0;
     MsgSetStart(dblock->status_flag);
     MsgClearLastData(dblock->status_flag);
     MsgClearAckPending(dblock->status_flag);
+    MsgClearConsumerBusy(dblock->status_flag);
+    MsgClearRateSampled(dblock->status_flag);
 }
 
-STATIC connector_session_error_t msg_initialize_data_block(msg_session_t * const session, uint32_t const window_size, msg_block_state_t state)
+STATIC connector_session_error_t msg_initialize_data_block(connector_msg_data_t * const msg_ptr, msg_session_t * const session, uint32_t const window_size, msg_block_state_t state)
 {
     connector_session_error_t result = connector_session_error_none;
 
+    #if !(defined CONNECTOR_COMPRESSION)
+    UNUSED_PARAMETER(msg_ptr);
+    #endif
     ASSERT_GOTO(session != NULL, error);
 
     switch(state)
@@ -623,7 +1044,7 @@ STATIC connector_session_error_t msg_initialize_data_block(msg_session_t * const
         {
             #if (defined CONNECTOR_COMPRESSION)
             ASSERT_GOTO(session->in_dblock != NULL, compression_error);
-            inflateEnd(&session->in_dblock->zlib);
+            msg_close_zlib(msg_ptr, session->in_dblock, connector_false);
             MsgClearInflated(session->in_dblock->status_flag);
             #endif
             session->out_dblock = session->in_dblock;
@@ -643,18 +1064,7 @@ STATIC connector_session_error_t msg_initialize_data_block(msg_session_t * const
         #if (defined CONNECTOR_COMPRESSION)
         if (MsgIsNotDeflated(session->out_dblock->status_flag) == connector_true)
         {
-            int const zlevel = CONNECTOR_COMPRESSION_LEVEL;
-            int const zmethod = Z_DEFLATED;
-            int const zwindowBits = CONNECTOR_COMPRESSION_WINDOW_BITS;
-            int const zmemLevel = CONNECTOR_COMPRESSION_MEM_LEVEL;
-            int const zstrategy = Z_DEFAULT_STRATEGY;
-            z_streamp const zlib_ptr = &session->out_dblock->zlib;
-            int zret;
-
-            memset(zlib_ptr, 0, sizeof *zlib_ptr);
-            zret = deflateInit2(zlib_ptr, zlevel, zmethod, zwindowBits, zmemLevel, zstrategy);
-            ASSERT_GOTO(zret == Z_OK, compression_error);
-
+            ASSERT_GOTO(msg_open_zlib(msg_ptr, session->out_dblock, connector_true), compression_error);
             MsgSetDeflated(session->out_dblock->status_flag);
         }
         #endif
@@ -665,7 +1075,7 @@ STATIC connector_session_error_t msg_initialize_data_block(msg_session_t * const
         {
             #if (defined CONNECTOR_COMPRESSION)
             ASSERT_GOTO(session->out_dblock != NULL, compression_error);
-            deflateEnd(&session->out_dblock->zlib);
+            msg_close_zlib(msg_ptr, session->out_dblock, connector_true);
             MsgClearDeflated(session->out_dblock->status_flag);
             #endif
             session->in_dblock = session->out_dblock;
@@ -684,8 +1094,7 @@ STATIC connector_session_error_t msg_initialize_data_block(msg_session_t * const
         #if (defined CONNECTOR_COMPRESSION)
         if (MsgIsNotInflated(session->in_dblock->status_flag) == connector_true)
         {
-            memset(&session->in_dblock->zlib, 0, sizeof session->in_dblock->zlib);
-            ASSERT_GOTO(inflateInit(&session->in_dblock->zlib) == Z_OK, compression_error);
+            ASSERT_GOTO(msg_open_zlib(msg_ptr, session->in_dblock, connector_false), compression_error);
             MsgSetInflated(session->in_dblock->status_flag);
         }
         #endif
@@ -708,12 +1117,58 @@ done:
     return result;
 }
 
-STATIC connector_status_t msg_send_error(connector_data_t * const connector_ptr, connector_msg_data_t * const msg_ptr, msg_session_t * const session, uint16_t const session_id, connector_session_error_t const error_value, uint8_t const flag)
+#define msg_ack_batch_packet(msg_ptr, index)    (&(msg_ptr)->ack.buffer[(index) * MSG_ACK_PACKET_SIZE])
+
+STATIC connector_status_t msg_ack_sent(connector_data_t * const connector_ptr, uint8_t const * const packet, connector_status_t const status, void * const user_data)
+{
+    connector_msg_data_t * const msg_ptr = user_data;
+
+    UNUSED_PARAMETER(connector_ptr);
+    UNUSED_PARAMETER(packet);
+    UNUSED_PARAMETER(status);
+
+    msg_ptr->ack.count = 0;
+    msg_ptr->ack.coalesced = connector_false;
+    msg_ptr->ack.sending = connector_false;
+
+    return connector_working;
+}
+
+/* Queues all collected acks as one send, so they go out in a single network send */
+STATIC connector_status_t msg_flush_acks(connector_data_t * const connector_ptr, connector_msg_data_t * const msg_ptr)
 {
     connector_status_t status = connector_working;
+
+    if (msg_ptr->ack.sending)
+    {
+        status = connector_pending;
+        goto done;
+    }
+
+    if (msg_ptr->ack.count == 0)
+        goto done;
+
+    status = tcp_queue_send_entry(connector_ptr, msg_ptr->ack.buffer, msg_ptr->ack.count * MSG_ACK_PACKET_SIZE, msg_ack_sent, msg_ptr);
+    if (status != connector_working)
+        goto done;
+
+    msg_ptr->ack.sending = connector_true;
+    register_activity(connector_ptr, connector_network_tcp);
+
+done:
+    return status;
+}
+
+STATIC connector_status_t msg_send_error(connector_data_t * const connector_ptr, connector_msg_data_t * const msg_ptr, msg_session_t * const session, uint16_t const session_id, connector_session_error_t const error_value, uint8_t const flag)
+{
+    connector_status_t status = msg_flush_acks(connector_ptr, msg_ptr);
     uint8_t * error_packet;
-    uint8_t * const edp_header = tcp_get_packet_buffer(connector_ptr, E_MSG_FAC_MSG_NUM, &error_packet, NULL);
+    uint8_t * edp_header;
+
+    if (status != connector_working)
+        goto done;
 
+    edp_header = tcp_get_packet_buffer(connector_ptr, E_MSG_FAC_MSG_NUM, &error_packet, NULL);
     if (edp_header == NULL)
     {
         status = connector_pending;
@@ -785,11 +1240,16 @@ STATIC size_t msg_fill_service_capabilities_packet(connector_data_t * const conn
 
 STATIC connector_status_t msg_send_capabilities(connector_data_t * const connector_ptr, connector_msg_data_t * const msg_ptr, uint8_t const flag)
 {
-    connector_status_t status = connector_pending;
+    connector_status_t status = msg_flush_acks(connector_ptr, msg_ptr);
     uint8_t * msg_packet = NULL;
-    uint8_t * const edp_header = tcp_get_packet_buffer(connector_ptr, E_MSG_FAC_MSG_NUM, &msg_packet, NULL);
+    uint8_t * edp_header;
     size_t packet_len;
 
+    if (status != connector_working)
+        goto error;
+
+    status = connector_pending;
+    edp_header = tcp_get_packet_buffer(connector_ptr, E_MSG_FAC_MSG_NUM, &msg_packet, NULL);
     if ((edp_header == NULL) || (msg_packet == NULL))
         goto error;
 
@@ -937,12 +1397,20 @@ STATIC connector_status_t msg_send_complete(connector_data_t * const connector_p
     ASSERT_GOTO(session != NULL, error);
     ASSERT_GOTO(dblock != NULL, error);
 
+    UNUSED_PARAMETER(packet);
     if ((MsgIsDoubleBuf(dblock->status_flag) == connector_false) && (MsgIsCompressed(dblock->status_flag) == connector_false))
     {
-        return_status = tcp_release_packet_buffer(connector_ptr, packet, connector_success, NULL);
+        /* packet is the external data when it was sent after the packet buffer */
+        return_status = tcp_release_packet_buffer(connector_ptr, session->send_data_ptr, connector_success, NULL);
         if (return_status != connector_working) goto error;
     }
 
+    if ((session->current_state == msg_state_delete) || (session->current_state == msg_state_send_error))
+    {
+        /* the session was cancelled while the packet was going out */
+        goto done;
+    }
+
     switch (status)
     {
         case connector_service_busy:
@@ -969,16 +1437,17 @@ STATIC connector_status_t msg_send_complete(connector_data_t * const connector_p
 
             #if (defined CONNECTOR_COMPRESSION)
             dblock->bytes_out = 0;
-            if (dblock->zlib.avail_out == 0)
+            if (dblock->zlib->avail_out == 0)
             {
                 session->current_state = msg_state_compress;
                 goto done;
             }
 
             dblock->z_flag = Z_NO_FLUSH;
-            dblock->zlib.avail_out = 0;
+            dblock->zlib->avail_out = 0;
             #else
             session->send_data_bytes = 0;
+            session->send_external_bytes = 0;
             #endif
 
             session->service_layer_data.need_data->data_ptr = NULL;
@@ -1015,6 +1484,23 @@ STATIC connector_status_t msg_send_data(connector_data_t * const connector_ptr,
     #endif
 
     ASSERT_GOTO(bytes > 0, error);
+
+    /* acks queued earlier go out first */
+    {
+        connector_msg_data_t * const msg_ptr = get_facility_data(connector_ptr, E_MSG_FAC_MSG_NUM);
+
+        ASSERT_GOTO(msg_ptr != NULL, error);
+        status = msg_flush_acks(connector_ptr, msg_ptr);
+        if (status != connector_working)
+            goto error;
+    }
+
+    #if !(defined CONNECTOR_COMPRESSION) && (CONNECTOR_TCP_SEND_QUEUE_SIZE > 1)
+    if (session->send_external_bytes > 0)
+        status = tcp_initiate_send_facility_packet_external(connector_ptr, buffer, bytes, E_MSG_FAC_MSG_NUM,
+                                                            session->send_external_ptr, session->send_external_bytes, msg_send_complete, session);
+    else
+    #endif
     status = tcp_initiate_send_facility_packet(connector_ptr, buffer, bytes, E_MSG_FAC_MSG_NUM, msg_send_complete, session);
     if (status != connector_working)
     {
@@ -1038,7 +1524,7 @@ STATIC connector_status_t msg_compress_data(connector_data_t * const connector_p
     msg_data_block_t * const dblock = session->out_dblock;
     uint8_t * const msg_buffer = GET_PACKET_DATA_POINTER(dblock->buffer_out, PACKET_EDP_FACILITY_SIZE);
     size_t const frame_bytes = sizeof dblock->buffer_out - PACKET_EDP_FACILITY_SIZE;
-    z_streamp zlib_ptr = &dblock->zlib;
+    z_streamp zlib_ptr = dblock->zlib;
     int zret;
 
     if (zlib_ptr->avail_out == 0)
@@ -1081,7 +1567,7 @@ STATIC connector_status_t msg_prepare_send_data(connector_data_t * const connect
 
     UNUSED_PARAMETER(connector_ptr);
     ASSERT_GOTO(dblock != NULL, error);
-    ASSERT_GOTO(dblock->zlib.avail_in == 0, error);
+    ASSERT_GOTO(dblock->zlib->avail_in == 0, error);
 
     {
         unsigned int const flag = (dblock->total_bytes == 0) ? MSG_FLAG_START : 0;
@@ -1091,6 +1577,7 @@ STATIC connector_status_t msg_prepare_send_data(connector_data_t * const connect
         service_data->data_ptr = dblock->buffer_in;
         service_data->length_in_bytes = sizeof dblock->buffer_in;
         service_data->flags = flag;
+        service_data->external_bytes = 0;
         status = connector_working;
     }
 
@@ -1104,15 +1591,31 @@ STATIC connector_status_t msg_process_send_data(connector_data_t * const connect
     msg_data_block_t * const dblock = session->out_dblock;
 
     ASSERT_GOTO(dblock != NULL, error);
-    ASSERT_GOTO(dblock->zlib.avail_in == 0, error);
+    ASSERT_GOTO(dblock->zlib->avail_in == 0, error);
 
     {
-        z_streamp const zlib_ptr = &dblock->zlib;
+        z_streamp const zlib_ptr = dblock->zlib;
         msg_service_data_t * const service_data = session->service_layer_data.need_data;
+        size_t const bytes = service_data->length_in_bytes + service_data->external_bytes;
 
         zlib_ptr->next_in = dblock->buffer_in;
-        zlib_ptr->avail_in = service_data->length_in_bytes;
-        dblock->total_bytes += service_data->length_in_bytes;
+        if (service_data->external_bytes > 0)
+        {
+            if (service_data->length_in_bytes == 0)
+            {
+                /* deflate reads the external data in place; it stays valid until avail_in is 0 */
+                zlib_ptr->next_in = (Bytef *)service_data->external_ptr;
+            }
+            else
+            {
+                uint8_t * const buffer_in = dblock->buffer_in;
+
+                ASSERT_GOTO(bytes <= sizeof dblock->buffer_in, error);
+                memcpy(buffer_in + service_data->length_in_bytes, service_data->external_ptr, service_data->external_bytes);
+            }
+        }
+        zlib_ptr->avail_in = bytes;
+        dblock->total_bytes += bytes;
         if (MsgIsLastData(service_data->flags))
             dblock->z_flag = Z_FINISH;
     }
@@ -1171,6 +1674,7 @@ STATIC connector_status_t msg_prepare_send_data(connector_data_t * const connect
         service_data->data_ptr = msg_buffer + header_bytes;
         service_data->length_in_bytes = session->send_data_bytes - header_bytes;
         service_data->flags = flag;
+        service_data->external_bytes = 0;
         status = connector_working;
     }
 
@@ -1193,6 +1697,19 @@ STATIC connector_status_t msg_process_send_data(connector_data_t * const connect
         size_t const header_bytes = MsgIsStart(dblock->status_flag) == connector_true ? record_end(start_packet) : record_end(data_packet);
         uint8_t * const msg_buffer = GET_PACKET_DATA_POINTER(session->send_data_ptr, PACKET_EDP_FACILITY_SIZE);
 
+        #if (CONNECTOR_TCP_SEND_QUEUE_SIZE > 1)
+        /* the external data is queued right after the packet, see tcp_initiate_send_facility_packet_external() */
+        session->send_external_ptr = service_data->external_ptr;
+        session->send_external_bytes = service_data->external_bytes;
+        #else
+        if (service_data->external_bytes > 0)
+        {
+            memcpy(msg_buffer + header_bytes + service_data->length_in_bytes, service_data->external_ptr, service_data->external_bytes);
+            service_data->length_in_bytes += service_data->external_bytes;
+            service_data->external_bytes = 0;
+        }
+        #endif
+
         session->send_data_bytes = service_data->length_in_bytes + header_bytes;
         msg_fill_msg_header(session, msg_buffer);
         status = msg_send_data(connector_ptr, session);
@@ -1200,7 +1717,7 @@ STATIC connector_status_t msg_process_send_data(connector_data_t * const connect
             goto error;
     }
 
-    dblock->total_bytes += service_data->length_in_bytes;
+    dblock->total_bytes += service_data->length_in_bytes + service_data->external_bytes;
     if ((dblock->total_bytes - dblock->ack_count) > (dblock->available_window - MSG_MAX_SEND_PACKET_SIZE))
         MsgSetAckPending(dblock->status_flag);
 
@@ -1334,7 +1851,7 @@ STATIC connector_status_t msg_start_session(connector_data_t * const connector_p
     }
     else
     {
-        connector_session_error_t const result = msg_initialize_data_block(session, msg_ptr->capabilities[msg_capability_cloud].window_size, msg_block_state_send_request);
+        connector_session_error_t const result = msg_initialize_data_block(msg_ptr, session, msg_ptr->capabilities[msg_capability_cloud].window_size, msg_block_state_send_request);
 
         status = msg_handle_pending_requests(connector_ptr, msg_ptr, session, result);
     }
@@ -1343,28 +1860,114 @@ STATIC connector_status_t msg_start_session(connector_data_t * const connector_p
 }
 #endif
 
+/*
+ * The receive window follows the rate the service consumes the session's data. It
+ * doubles with every ack while the service keeps up, up to what the service consumes
+ * in MSG_RECV_WINDOW_SECONDS, and is halved when the service asked to be called back
+ * later. It never drops below the window advertised in the capabilities.
+ */
+STATIC uint32_t msg_adapt_receive_window(connector_data_t * const connector_ptr, connector_msg_data_t const * const msg_ptr, msg_data_block_t * const dblock)
+{
+    uint32_t const minimum = msg_ptr->capabilities[msg_capability_client].window_size;
+    uint32_t const maximum = msg_ptr->receive_window_max;
+    uint32_t window = (uint32_t)dblock->available_window;
+    unsigned long now;
+
+    if (get_system_time(connector_ptr, &now) == connector_working)
+    {
+        if (!MsgIsRateSampled(dblock->status_flag))
+        {
+            MsgSetRateSampled(dblock->status_flag);
+            dblock->rate_time = now;
+            dblock->rate_bytes = dblock->total_bytes;
+        }
+        else if (now > dblock->rate_time)
+        {
+            dblock->consumption_rate = (dblock->total_bytes - dblock->rate_bytes) / (now - dblock->rate_time);
+            dblock->rate_time = now;
+            dblock->rate_bytes = dblock->total_bytes;
+        }
+    }
+
+    if (MsgIsConsumerBusy(dblock->status_flag))
+    {
+        MsgClearConsumerBusy(dblock->status_flag);
+        window /= 2;
+    }
+    else if (window <= maximum / 2)
+    {
+        size_t const limit = dblock->consumption_rate * MSG_RECV_WINDOW_SECONDS;
+
+        if ((dblock->consumption_rate == 0) || (window * 2 <= limit))
+            window *= 2;
+        else if (window < limit)
+            window = (uint32_t)limit;
+    }
+    else
+        window = maximum;
+
+    if (window < minimum)
+        window = minimum;
+
+    dblock->available_window = window;
+
+    return window;
+}
+
+/*
+ * Acks are collected in msg_ptr->ack and sent together by msg_flush_acks(). A newer ack
+ * of a session replaces the one still waiting in the batch.
+ */
 STATIC connector_status_t msg_send_ack(connector_data_t * const connector_ptr, connector_msg_data_t * const msg_ptr, msg_session_t * const session)
 {
     connector_status_t status = connector_pending;
-    uint8_t * ack_packet;
-    uint8_t * const edp_packet = tcp_get_packet_buffer(connector_ptr, E_MSG_FAC_MSG_NUM, &ack_packet, NULL);
     msg_data_block_t * const dblock = session->in_dblock;
+    uint16_t const session_id = (uint16_t)session->session_id;
+    uint8_t * ack_packet;
+    uint8_t flag;
+    unsigned int i;
 
-    if (edp_packet == NULL)
+    if (msg_ptr->ack.sending)
         goto done;
 
     ASSERT_GOTO(dblock != NULL, error);
-    message_store_u8(ack_packet, opcode, msg_opcode_ack);
+    flag = MsgIsClientOwned(dblock->status_flag) ? 0 : MSG_FLAG_REQUEST;
+
+    for (i = 0; i < msg_ptr->ack.count; i++)
     {
-        uint8_t const flag = MsgIsClientOwned(dblock->status_flag) ? 0 : MSG_FLAG_REQUEST;
+        ack_packet = GET_PACKET_DATA_POINTER(msg_ack_batch_packet(msg_ptr, i), PACKET_EDP_FACILITY_SIZE);
+        if ((message_load_be16(ack_packet, transaction_id) == session_id) && (message_load_u8(ack_packet, flags) == flag))
+            break;
+    }
 
-        message_store_u8(ack_packet, flags, flag);
+    if (i < msg_ptr->ack.count)
+    {
+        msg_ptr->ack.coalesced = connector_true;
     }
+    else
     {
-        uint16_t const session_id = (uint16_t)session->session_id;
+        uint8_t * edp_header;
+
+        if (msg_ptr->ack.count == CONNECTOR_MSG_ACK_BATCH_SIZE)
+            goto done;
+
+        edp_header = msg_ack_batch_packet(msg_ptr, msg_ptr->ack.count);
+        msg_ptr->ack.count++;
 
+        tcp_fill_facility_header(edp_header, E_MSG_FAC_MSG_NUM);
+        message_store_be16(edp_header, type, E_MSG_MT2_TYPE_PAYLOAD);
+        {
+            uint16_t const length16 = (uint16_t)(PACKET_EDP_PROTOCOL_SIZE + record_end(ack_packet));
+
+            message_store_be16(edp_header, length, length16);
+        }
+
+        ack_packet = GET_PACKET_DATA_POINTER(edp_header, PACKET_EDP_FACILITY_SIZE);
+        message_store_u8(ack_packet, opcode, msg_opcode_ack);
+        message_store_u8(ack_packet, flags, flag);
         message_store_be16(ack_packet, transaction_id, session_id);
     }
+
     {
         uint32_t const val32 = (uint32_t) dblock->total_bytes;
 
@@ -1372,17 +1975,17 @@ STATIC connector_status_t msg_send_ack(connector_data_t * const connector_ptr, c
         message_store_be32(ack_packet, ack_count, val32);
     }
 
-    message_store_be32(ack_packet, window_size, msg_ptr->capabilities[msg_capability_client].window_size);
-
-    status = tcp_initiate_send_facility_packet(connector_ptr, edp_packet, record_end(ack_packet),
-                                           E_MSG_FAC_MSG_NUM, tcp_release_packet_buffer, NULL);
-    if (status != connector_pending)
     {
-        dblock->ack_count = dblock->total_bytes;
-        MsgClearAckPending(dblock->status_flag);
-        session->current_state = msg_state_receive;
+        uint32_t const window_size = msg_adapt_receive_window(connector_ptr, msg_ptr, dblock);
+
+        message_store_be32(ack_packet, window_size, window_size);
     }
 
+    dblock->ack_count = dblock->total_bytes;
+    MsgClearAckPending(dblock->status_flag);
+    session->current_state = msg_state_receive;
+    status = connector_working;
+
 error:
 done:
     return status;
@@ -1461,6 +2064,9 @@ STATIC connector_status_t msg_pass_service_data(connector_data_t * const connect
     if (status != connector_working && status != connector_idle && status != connector_pending && status != connector_active)
         goto error;
 
+    if (status == connector_pending || status == connector_active)
+        MsgSetConsumerBusy(dblock->status_flag);
+
     if (status == connector_working)
     {
         MsgClearStart(dblock->status_flag);
@@ -1475,7 +2081,7 @@ STATIC connector_status_t msg_pass_service_data(connector_data_t * const connect
                 ASSERT_GOTO(msg_ptr != NULL, error);
                 if (MsgIsDoubleBuf(dblock->status_flag) == connector_false)
                 {
-                    result = msg_initialize_data_block(session, msg_ptr->capabilities[msg_capability_cloud].window_size, msg_block_state_send_response);
+                    result = msg_initialize_data_block(msg_ptr, session, msg_ptr->capabilities[msg_capability_cloud].window_size, msg_block_state_send_response);
                     if (result != connector_session_error_none)
                         status = msg_inform_error(connector_ptr, session, result);
                 }
@@ -1535,7 +2141,7 @@ STATIC connector_status_t msg_process_decompressed_data(connector_data_t * const
         dblock->bytes_out = 0;
         if (session->current_state != msg_state_get_data)
         {
-            if (dblock->zlib.avail_out == 0)
+            if (dblock->zlib->avail_out == 0)
                 session->current_state = msg_state_decompress;
             else
             {
@@ -1561,7 +2167,7 @@ STATIC connector_status_t msg_decompress_data(connector_data_t * const connector
     z_streamp zlib_ptr;
 
     ASSERT_GOTO(dblock != NULL, error);
-    zlib_ptr = &dblock->zlib;
+    zlib_ptr = dblock->zlib;
 
     if (zlib_ptr->avail_out == 0)
     {
@@ -1570,7 +2176,12 @@ STATIC connector_status_t msg_decompress_data(connector_data_t * const connector
     }
 
     {
-        int const zret = inflate(zlib_ptr, Z_NO_FLUSH);
+        int zret = inflate(zlib_ptr, Z_NO_FLUSH);
+
+        #if (defined CONNECTOR_COMPRESSION_DICTIONARY)
+        if ((zret == Z_NEED_DICT) && (inflateSetDictionary(zlib_ptr, msg_zlib_dictionary, sizeof msg_zlib_dictionary - 1) == Z_OK))
+            zret = inflate(zlib_ptr, Z_NO_FLUSH);
+        #endif
 
         session->current_state = MsgIsAckPending(dblock->status_flag) ? msg_state_send_ack : msg_state_receive;
         switch(zret)
@@ -1613,7 +2224,7 @@ STATIC connector_status_t msg_process_compressed_data(connector_data_t * const c
     z_streamp zlib_ptr;
 
     ASSERT_GOTO(dblock != NULL, error);
-    zlib_ptr = &dblock->zlib;
+    zlib_ptr = dblock->zlib;
 
     if (zlib_ptr->avail_in > 0)
     {
@@ -1706,15 +2317,15 @@ STATIC connector_status_t msg_process_start(connector_data_t * const connector_p
             goto error;
         }
 
-        session->session_id = session_id;
+        msg_set_session_id(msg_ptr, session, session_id);
         if (session->out_dblock != NULL)
         {
-            result = msg_initialize_data_block(session, msg_ptr->capabilities[msg_capability_cloud].window_size, msg_block_state_send_response);
+            result = msg_initialize_data_block(msg_ptr, session, msg_ptr->capabilities[msg_capability_cloud].window_size, msg_block_state_send_response);
             if (result != connector_session_error_none)
                 goto error;
         }
 
-        result = msg_initialize_data_block(session, msg_ptr->capabilities[msg_capability_client].window_size, msg_block_state_recv_request);
+        result = msg_initialize_data_block(msg_ptr, session, msg_ptr->capabilities[msg_capability_client].window_size, msg_block_state_recv_request);
         if (result != connector_session_error_none)
             goto error;
     }
@@ -1725,7 +2336,7 @@ STATIC connector_status_t msg_process_start(connector_data_t * const connector_p
 
         if (client_owned)
         {
-            result = msg_initialize_data_block(session, msg_ptr->capabilities[msg_capability_client].window_size, msg_block_state_recv_response);
+            result = msg_initialize_data_block(msg_ptr, session, msg_ptr->capabilities[msg_capability_client].window_size, msg_block_state_recv_response);
             if (result != connector_session_error_none)
                 goto error;
         }
@@ -1872,6 +2483,21 @@ STATIC void msg_switch_session(connector_msg_data_t * const msg_ptr, msg_session
     msg_ptr->session.current = (session->prev != NULL) ? session->prev : msg_ptr->session.tail;
 }
 
+STATIC connector_bool_t msg_is_active(connector_data_t * const connector_ptr)
+{
+    connector_msg_data_t const * const msg_ptr = get_facility_data(connector_ptr, E_MSG_FAC_MSG_NUM);
+    connector_bool_t active = connector_false;
+
+    if (msg_ptr != NULL)
+    {
+        active = connector_bool((msg_ptr->session.head != NULL) ||
+                                (msg_ptr->pending_service_request.user != NULL) ||
+                                (msg_ptr->pending_service_request.internal != NULL));
+    }
+
+    return active;
+}
+
 STATIC connector_status_t msg_process_pending(connector_data_t * const connector_ptr, connector_msg_data_t * const msg_ptr, unsigned int * const receive_timeout)
 {
     connector_status_t status = connector_idle;
@@ -2042,6 +2668,19 @@ STATIC connector_status_t msg_process(connector_data_t * const connector_ptr, vo
         }
     }
 
+    /* Acks are held back while packets keep arriving so acks of several sessions go out together */
+    if (msg_ptr->ack.count > 0)
+    {
+        if ((edp_header == NULL) || msg_ptr->ack.coalesced || (msg_ptr->ack.count == CONNECTOR_MSG_ACK_BATCH_SIZE))
+        {
+            connector_status_t const flush_status = msg_flush_acks(connector_ptr, msg_ptr);
+
+            if ((flush_status == connector_working) && (status == connector_idle))
+                status = connector_working;
+        }
+        *receive_timeout = MIN_RECEIVE_TIMEOUT_IN_SECONDS;
+    }
+
     if (status == connector_unavailable) status = connector_working;
 
 error:
@@ -2113,7 +2752,15 @@ STATIC connector_status_t msg_delete_facility(connector_data_t * const connector
             }
         }
 
-        status = is_empty == connector_true ? del_facility_data(connector_ptr, E_MSG_FAC_MSG_NUM) : connector_working;
+        if (is_empty)
+        {
+            #if (defined CONNECTOR_COMPRESSION) && (CONNECTOR_COMPRESSION_STREAM_POOL_SIZE > 0)
+            msg_free_zlib_pool(msg_ptr);
+            #endif
+            status = del_facility_data(connector_ptr, E_MSG_FAC_MSG_NUM);
+        }
+        else
+            status = connector_working;
     }
 
 error:
@@ -2130,6 +2777,7 @@ STATIC connector_status_t msg_init_facility(connector_data_t * const connector_p
     {
         void * fac_ptr = NULL;
         connector_config_max_transaction_t config_max_transaction;
+        connector_config_msg_receive_window_t config_receive_window;
 
         status = add_facility_data(connector_ptr, facility_index, E_MSG_FAC_MSG_NUM, &fac_ptr, sizeof *msg_ptr);
         ASSERT_GOTO(status == connector_working, done);
@@ -2159,11 +2807,46 @@ STATIC connector_status_t msg_init_facility(connector_data_t * const connector_p
         }
         #endif
 
+        #if (defined CONNECTOR_MSG_RECV_WINDOW_MAX)
+        config_receive_window.initial = MSG_RECV_WINDOW_SIZE;
+        config_receive_window.maximum = CONNECTOR_MSG_RECV_WINDOW_MAX;
+        #else
+        {
+            connector_request_id_t request_id;
+            connector_callback_status_t callback_status;
+
+            config_receive_window.initial = MSG_RECV_WINDOW_SIZE;
+            config_receive_window.maximum = MSG_RECV_WINDOW_MAX;
+
+            request_id.config_request = connector_request_id_config_msg_receive_window;
+            callback_status = connector_callback(connector_ptr->callback, connector_class_id_config, request_id, &config_receive_window, connector_ptr->context);
+            if (callback_status != connector_callback_continue && callback_status != connector_callback_unrecognized)
+            {
+                status = connector_abort;
+                goto done;
+            }
+
+            if ((config_receive_window.initial <= MSG_MAX_SEND_PACKET_SIZE) || (config_receive_window.maximum < config_receive_window.initial))
+            {
+                connector_debug_line("msg_init_facility: invalid receive window %u..%u", (unsigned)config_receive_window.initial, (unsigned)config_receive_window.maximum);
+                status = connector_abort;
+                goto done;
+            }
+        }
+        #endif
+
         msg_ptr->capabilities[msg_capability_client].max_transactions = config_max_transaction.count;
-        msg_ptr->capabilities[msg_capability_client].window_size = MSG_RECV_WINDOW_SIZE;
+        msg_ptr->capabilities[msg_capability_client].window_size = config_receive_window.initial;
+        msg_ptr->receive_window_max = config_receive_window.maximum;
     }
 
 	msg_ptr->discovery_state = msg_service_id_none;
+    if (!msg_ptr->ack.sending)
+    {
+        /* acks held back on the previous connection belong to sessions that are gone */
+        msg_ptr->ack.count = 0;
+        msg_ptr->ack.coalesced = connector_false;
+    }
     msg_ptr->service_cb[service_id] = callback;
     status = connector_working;
 
@@ -438,6 +438,29 @@ STATIC uint32_t * get_request_id_ptr(connector_initiate_request_t const request,
     return request_id;
 }
 
+/*
+ * Whether request is the send data request dp_send_message() makes for a queued data point.
+ * Those carry the internal data point path, the mark the data service layers already go by.
+ */
+STATIC connector_bool_t sm_is_data_point_send(connector_initiate_request_t const request, void const * const request_data)
+{
+    connector_bool_t is_data_point = connector_false;
+
+#if (defined CONNECTOR_DATA_POINTS)
+    if (request == connector_initiate_send_data)
+    {
+        connector_request_data_service_send_t const * const send_ptr = request_data;
+
+        is_data_point = connector_bool((send_ptr->path != NULL) && (strncmp(send_ptr->path, internal_dp4d_path, internal_dp4d_path_strlen) == 0));
+    }
+#else
+    UNUSED_PARAMETER(request);
+    UNUSED_PARAMETER(request_data);
+#endif
+
+    return is_data_point;
+}
+
 STATIC connector_status_t sm_initiate_action(connector_handle_t const handle, connector_initiate_request_t const request, void const * const request_data)
 {
     connector_status_t result = connector_service_busy;
@@ -590,7 +613,6 @@ STATIC connector_status_t sm_initiate_action(connector_handle_t const handle, co
 
             sm_ptr->pending.data = request_data;
             sm_ptr->pending.request = request;
-            sm_ptr->pending.pending_internal = connector_false;
             break;
         }
 
@@ -633,14 +655,28 @@ STATIC connector_status_t sm_initiate_action(connector_handle_t const handle, co
                         goto error;
                     }
                     request_id = get_request_id_ptr(request, request_data);
+
+                    /* Data points are queued by dp_initiate_data_point(), everything else needs the pending slot.
+                     * Check it first so a busy retry of the hidden send data request keeps its request id.
+                     */
+#if (defined CONNECTOR_DATA_POINTS)
+                    if ((request != connector_initiate_data_point) && (request != connector_initiate_data_point_binary))
+#endif
+                    {
+                        if (sm_ptr->pending.data != NULL)
+                        {
+                            result = connector_service_busy;
+                            goto error;
+                        }
+                    }
+
                     /* dp_initiate_data_point() and dp_initiate_data_point_binary() convert a connector_initiate_data_point or
                      * connector_initiate_data_point_binary to a connector_initiate_send_data,
                      * but we want that that "hidden" connector_initiate_send_data
                      * use the same request_id, which has been already set by dp_send_message().
                      * */
-                    if (sm_ptr->pending.pending_internal)
+                    if (sm_is_data_point_send(request, request_data))
                     {
-                        sm_ptr->pending.pending_internal = connector_false;
                         if (request_id != NULL)
                         {
                             /* Use the same request_id */
@@ -675,13 +711,11 @@ STATIC connector_status_t sm_initiate_action(connector_handle_t const handle, co
                     {
                         case connector_initiate_data_point:
                         {
-                            sm_ptr->pending.pending_internal = connector_true;
                             result = dp_initiate_data_point(request_data);
                             goto done_datapoints;
                         }
                         case connector_initiate_data_point_binary:
                         {
-                            sm_ptr->pending.pending_internal = connector_true;
                             result = dp_initiate_data_point_binary(request_data);
                             goto done_datapoints;
                         }
@@ -690,11 +724,6 @@ STATIC connector_status_t sm_initiate_action(connector_handle_t const handle, co
                             break;
                     }
 #endif
-                    if (sm_ptr->pending.data != NULL)
-                    {
-                        result = connector_service_busy;
-                        goto error;
-                    }
                     sm_ptr->pending.data = request_data;
                     sm_ptr->pending.request = request;
                     break;
@@ -799,7 +828,13 @@ error:
 
 STATIC connector_status_t sm_close_transport(connector_data_t * const connector_ptr, connector_sm_data_t * const sm_ptr)
 {
-    connector_status_t result = sm_cancel_session(connector_ptr, sm_ptr, NULL);
+    connector_status_t result;
+
+#if (defined SM_TRACKING_WRITE_BACK)
+    sm_flush_tracking_data(connector_ptr, sm_ptr->network.transport);
+#endif
+
+    result = sm_cancel_session(connector_ptr, sm_ptr, NULL);
 
     if (result == connector_abort)
         sm_ptr->close.status = connector_close_status_abort;
@@ -883,6 +918,46 @@ done:
     return result;
 }
 
+STATIC void sm_get_wait_set(connector_data_t * const connector_ptr, connector_sm_data_t const * const sm_ptr, connector_wait_network_t * const network,
+                            connector_wait_set_t * const wait_set, unsigned long const now)
+{
+    UNUSED_PARAMETER(connector_ptr);
+
+    network->handle = sm_ptr->network.handle;
+    network->send = connector_bool(sm_ptr->network.send_packet.total_bytes > sm_ptr->network.send_packet.processed_bytes);
+
+    switch (sm_ptr->transport.state)
+    {
+        case connector_transport_idle:
+            if ((sm_ptr->transport.connect_type == connector_connect_auto) && (sm_ptr->close.status == connector_close_status_device_error))
+                wait_set_timeout(wait_set, 0);
+            break;
+
+        case connector_transport_wait_for_reconnect:
+            if (sm_ptr->transport.connect_at == 0)
+                wait_set_timeout(wait_set, 0);
+            else
+                wait_set_deadline(wait_set, now, sm_ptr->transport.connect_at);
+            break;
+
+        case connector_transport_receive:
+        case connector_transport_send:
+            /* sessions time out in seconds and requests may wait on busy callbacks */
+            if ((sm_ptr->session.head != NULL) || (sm_ptr->pending.data != NULL))
+                wait_set_timeout(wait_set, WAIT_SET_ACTIVE_TIMEOUT_IN_MS);
+            break;
+
+        default:
+            wait_set_timeout(wait_set, WAIT_SET_ACTIVE_TIMEOUT_IN_MS);
+            break;
+    }
+
+#if (defined SM_TRACKING_WRITE_BACK) && (CONNECTOR_SM_TRACKING_FLUSH_INTERVAL_IN_SECONDS > 0)
+    if (sm_ptr->request.journal.entry[0] > 0)
+        wait_set_deadline(wait_set, now, sm_ptr->request.journal.dirty_since + CONNECTOR_SM_TRACKING_FLUSH_INTERVAL_IN_SECONDS);
+#endif
+}
+
 STATIC connector_status_t sm_state_machine(connector_data_t * const connector_ptr, connector_sm_data_t * const sm_ptr)
 {
     connector_status_t result = connector_idle;
@@ -895,6 +970,11 @@ STATIC connector_status_t sm_state_machine(connector_data_t * const connector_pt
         result = connector_device_terminated;
         goto done;
     }
+
+#if (defined SM_TRACKING_WRITE_BACK) && (CONNECTOR_SM_TRACKING_FLUSH_INTERVAL_IN_SECONDS > 0)
+    sm_flush_tracking_data_if_due(connector_ptr, sm_ptr->network.transport);
+#endif
+
     result = sm_process_pending_data(connector_ptr, sm_ptr);
     if (result != connector_idle && result != connector_pending)
         goto done;
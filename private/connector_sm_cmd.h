@@ -147,7 +147,7 @@ done:
     return;
 }
 
-#if (defined CONNECTOR_COMPRESSION) || (defined CONNECTOR_SM_MULTIPART)
+#if (defined CONNECTOR_COMPRESSION) || (defined CONNECTOR_SM_MULTIPART) || (defined CONNECTOR_SM_ENCRYPTION)
 STATIC size_t sm_get_max_payload_bytes(connector_sm_data_t * const sm_ptr)
 {
     size_t const sm_header_size = 5;
@@ -240,6 +240,13 @@ STATIC connector_callback_status_t sm_inform_data_complete(connector_data_t * co
     }
     else
     #endif
+    #if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+    if (session->target_handler.function != NULL)
+    {
+        callback_status = ds_target_callback(&session->target_handler, connector_request_id_data_service_receive_status, &status_info);
+    }
+    else
+    #endif
     {
         request_id.data_service_request = (SmIsClientOwned(session->flags) == connector_true) ? connector_request_id_data_service_send_status : connector_request_id_data_service_receive_status;
         callback_status = connector_callback(connector_ptr->callback, connector_class_id_data_service, request_id, &status_info, connector_ptr->context);
@@ -799,8 +806,22 @@ STATIC connector_status_t sm_pass_target_info(connector_data_t * const connector
     cb_data.target = target_name;
     cb_data.response_required = SmIsResponseNeeded(session->flags);
 
-    request_id.data_service_request = connector_request_id_data_service_receive_target;
-    callback_status = connector_callback(connector_ptr->callback, connector_class_id_data_service, request_id, &cb_data, connector_ptr->context);
+    #if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+    {
+        connector_ds_target_t const * const target = ds_find_target(&connector_ptr->ds_targets, target_name, target_bytes);
+
+        if (target != NULL)
+            session->target_handler = target->handler;
+    }
+
+    if (session->target_handler.function != NULL)
+        callback_status = ds_target_callback(&session->target_handler, connector_request_id_data_service_receive_target, &cb_data);
+    else
+    #endif
+    {
+        request_id.data_service_request = connector_request_id_data_service_receive_target;
+        callback_status = connector_callback(connector_ptr->callback, connector_class_id_data_service, request_id, &cb_data, connector_ptr->context);
+    }
     if (callback_status == connector_callback_unrecognized)
         callback_status = connector_callback_error;
     result = sm_map_callback_status_to_connector_status(callback_status);
@@ -860,8 +881,15 @@ STATIC connector_status_t sm_process_data_request(connector_data_t * const conne
         cb_data.buffer = data_ptr;
         cb_data.bytes_used = bytes - bytes_pre_processed;
         cb_data.more_data = SmIsNotLastData(session->flags);
-        request_id.data_service_request = connector_request_id_data_service_receive_data;
-        callback_status = connector_callback(connector_ptr->callback, connector_class_id_data_service, request_id, &cb_data, connector_ptr->context);
+        #if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+        if (session->target_handler.function != NULL)
+            callback_status = ds_target_callback(&session->target_handler, connector_request_id_data_service_receive_data, &cb_data);
+        else
+        #endif
+        {
+            request_id.data_service_request = connector_request_id_data_service_receive_data;
+            callback_status = connector_callback(connector_ptr->callback, connector_class_id_data_service, request_id, &cb_data, connector_ptr->context);
+        }
         if (callback_status == connector_callback_unrecognized)
             callback_status = connector_callback_error;
         if (callback_status != connector_callback_busy)
@@ -134,6 +134,31 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #define SM_REQUEST_ID_COUNT (SM_REQUEST_ID_LAST - SM_REQUEST_ID_FIRST + 1)
 #define SM_TRACKING_BYTES   ((SM_REQUEST_ID_COUNT + CHAR_BIT - 1) / CHAR_BIT)
 
+#if !(defined CONNECTOR_SM_TRACKING_FLUSH_COUNT)
+#define CONNECTOR_SM_TRACKING_FLUSH_COUNT   1
+#endif
+
+#if (CONNECTOR_SM_TRACKING_FLUSH_COUNT < 1) || (CONNECTOR_SM_TRACKING_FLUSH_COUNT > 255)
+#error "CONNECTOR_SM_TRACKING_FLUSH_COUNT must be between 1 and 255"
+#endif
+
+#if !(defined CONNECTOR_SM_TRACKING_FLUSH_INTERVAL_IN_SECONDS)
+#define CONNECTOR_SM_TRACKING_FLUSH_INTERVAL_IN_SECONDS 0
+#endif
+
+#if (CONNECTOR_SM_TRACKING_FLUSH_COUNT > 1)
+#define SM_TRACKING_WRITE_BACK
+
+/* IDs seen since the tracking data was last stored. Only this journal is stored per request;
+ * the tracking data is stored when the journal is full, the flush interval expires or the transport closes.
+ */
+typedef struct
+{
+    uint16_t entry[CONNECTOR_SM_TRACKING_FLUSH_COUNT + 1];  /* entry[0] is the number of IDs which follow */
+    unsigned long dirty_since;
+} sm_tracking_journal_t;
+#endif
+
 #define SM_IV_TYPE_REQUEST      0x00
 #define SM_IV_TYPE_RESPONSE     0x80
 #define SM_IV_POOL_DEVICE       0x00
@@ -220,6 +245,9 @@ typedef struct connector_sm_session_t
         void * context;
         void const * header;
     } user;
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+    connector_ds_target_handler_t target_handler;
+#endif
 
     connector_transport_t transport;
     connector_sm_state_t sm_state;
@@ -303,7 +331,6 @@ typedef struct connector_sm_data_t
         void const * data;
         connector_initiate_request_t request;
         uint16_t request_id;
-        connector_bool_t pending_internal;
     } pending;
 
     struct
@@ -322,6 +349,9 @@ typedef struct connector_sm_data_t
         uint16_t id;
 #if (defined CONNECTOR_SM_ENCRYPTION)
          uint8_t tracking[SM_TRACKING_BYTES];
+#if (defined SM_TRACKING_WRITE_BACK)
+        sm_tracking_journal_t journal;
+#endif
 #endif
     } request;
 
@@ -108,6 +108,7 @@ STATIC connector_status_t sm_get_more_request_data(connector_data_t * const conn
     cb_data.bytes_available = session->in.bytes - session->bytes_processed;
     cb_data.bytes_used = 0;
     cb_data.more_data = connector_false;
+    cb_data.external_buffer = NULL;
 
     {
         connector_callback_status_t status;
@@ -132,6 +133,10 @@ STATIC connector_status_t sm_get_more_request_data(connector_data_t * const conn
     session->user.context = cb_data.user_context;
     if (result == connector_working)
     {
+        /* the whole message is needed for the CRC and multipart, so external data is copied */
+        if (cb_data.external_buffer != NULL)
+            memcpy(cb_data.buffer, cb_data.external_buffer, cb_data.bytes_used);
+
         session->bytes_processed += cb_data.bytes_used;
         ASSERT(session->bytes_processed <= session->in.bytes);
         if (!cb_data.more_data)
@@ -161,8 +166,15 @@ STATIC connector_status_t sm_get_more_response_data(connector_data_t * const con
         connector_callback_status_t status;
         connector_request_id_t request_id;
 
-        request_id.data_service_request = connector_request_id_data_service_receive_reply_data;
-        status = connector_callback(connector_ptr->callback, connector_class_id_data_service, request_id, &cb_data, connector_ptr->context);
+        #if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+        if (session->target_handler.function != NULL)
+            status = ds_target_callback(&session->target_handler, connector_request_id_data_service_receive_reply_data, &cb_data);
+        else
+        #endif
+        {
+            request_id.data_service_request = connector_request_id_data_service_receive_reply_data;
+            status = connector_callback(connector_ptr->callback, connector_class_id_data_service, request_id, &cb_data, connector_ptr->context);
+        }
         result = sm_map_callback_status_to_connector_status(status);
     }
 
@@ -66,6 +66,9 @@ STATIC connector_sm_session_t * sm_create_session(connector_data_t * const conne
     session->bytes_processed = 0;
     session->user.header = NULL;
     session->user.context = NULL;
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+    session->target_handler.function = NULL;
+#endif
     session->segments.processed = 0;
     session->segments.count = 0;
 
@@ -181,7 +184,7 @@ STATIC connector_status_t sm_cancel_session(connector_data_t * const connector_p
         session = next_session != NULL ? next_session : session->next;
     }
 #if (defined CONNECTOR_DATA_POINTS)
-    dp_cancel_session(connector_ptr, session, request_id);
+    dp_cancel_session(connector_ptr, sm_ptr->network.transport, session, request_id);
 #endif
     return result;
 }
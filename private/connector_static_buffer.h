@@ -17,7 +17,10 @@
  * =======================================================================
  */
 
-/* Example of adding a STATIC buffer (single structure) or static buffer array named my_data
+/* Per-type static buffers used for CONNECTOR_NO_MALLOC unless CONNECTOR_NO_MALLOC_POOL selects
+ * the size-class pool in connector_static_pool.h, which needs none of the steps below.
+ *
+ * Example of adding a STATIC buffer (single structure) or static buffer array named my_data
  *
  * In os_intf.h:
  * 1. Add to connector_static_buffer_id_t:
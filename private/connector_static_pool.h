@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2018 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Size-class pool used instead of the per-type static buffers when
+ * CONNECTOR_NO_MALLOC_POOL is defined.
+ *
+ * The application lists its size classes in ascending block size, for example:
+ *
+ *   #define CONNECTOR_NO_MALLOC_POOL_CLASSES(pool_class) \
+ *       pool_class(64, 16) \
+ *       pool_class(512, 8) \
+ *       pool_class(2048, 4)
+ *
+ * Every buffer except the connector_data_t itself is taken from the smallest class whose
+ * blocks are big enough, or from the next larger class when that one is exhausted. Free
+ * blocks of each class are kept on a singly linked list threaded through the blocks, so
+ * both operations take constant time regardless of the number of blocks.
+ */
+
+#if !(defined CONNECTOR_NO_MALLOC_POOL_CLASSES)
+#error "You have to define CONNECTOR_NO_MALLOC_POOL_CLASSES for CONNECTOR_NO_MALLOC_POOL configuration"
+#endif
+
+typedef union pool_unit
+{
+    union pool_unit * next;
+    unsigned long integer;
+    double floating;
+    void * pointer;
+} pool_unit_t;
+
+#define pool_block_units(size)          (((size) + sizeof(pool_unit_t) - 1) / sizeof(pool_unit_t))
+
+#define pool_class_config(size, count)  { pool_block_units(size) * sizeof(pool_unit_t), (count) },
+#define pool_class_units(size, count)   + pool_block_units(size) * (count)
+#define pool_class_blocks(size, count)  + (count)
+
+#define POOL_ARENA_UNITS    (0 CONNECTOR_NO_MALLOC_POOL_CLASSES(pool_class_units))
+#define POOL_BLOCK_COUNT    (0 CONNECTOR_NO_MALLOC_POOL_CLASSES(pool_class_blocks))
+
+typedef struct
+{
+    size_t block_size;
+    size_t block_count;
+} pool_class_config_t;
+
+static pool_class_config_t const pool_class_config[] =
+{
+    CONNECTOR_NO_MALLOC_POOL_CLASSES(pool_class_config)
+};
+
+#define POOL_CLASS_COUNT    (sizeof pool_class_config / sizeof pool_class_config[0])
+
+typedef struct
+{
+    pool_unit_t * base;
+    pool_unit_t * limit;
+    pool_unit_t * free_list;
+    size_t used;
+    size_t high_water;
+    unsigned long failures;
+    unsigned long spills;
+#if (defined CONNECTOR_DEBUG)
+    size_t first_block;
+#endif
+} pool_class_t;
+
+static struct
+{
+    connector_data_t connector_data;
+    connector_bool_t connector_data_used;
+    connector_bool_t initialized;
+
+    pool_class_t size_class[POOL_CLASS_COUNT];
+    pool_unit_t arena[POOL_ARENA_UNITS];
+#if (defined CONNECTOR_DEBUG)
+    size_t requested[POOL_BLOCK_COUNT];
+#endif
+} connector_static_pool;
+
+STATIC void pool_init(void)
+{
+    pool_unit_t * unit = connector_static_pool.arena;
+#if (defined CONNECTOR_DEBUG)
+    size_t first_block = 0;
+#endif
+    size_t i;
+
+    for (i = 0; i < POOL_CLASS_COUNT; i++)
+    {
+        pool_class_t * const size_class = &connector_static_pool.size_class[i];
+        size_t const units = pool_class_config[i].block_size / sizeof *unit;
+        size_t block;
+
+        ASSERT(i == 0 || pool_class_config[i].block_size > pool_class_config[i - 1].block_size);
+
+        size_class->base = unit;
+        size_class->free_list = NULL;
+        for (block = pool_class_config[i].block_count; block > 0; block--)
+        {
+            pool_unit_t * const free_block = unit + (block - 1) * units;
+
+            free_block->next = size_class->free_list;
+            size_class->free_list = free_block;
+        }
+        unit += pool_class_config[i].block_count * units;
+        size_class->limit = unit;
+        size_class->used = 0;
+        size_class->high_water = 0;
+        size_class->failures = 0;
+        size_class->spills = 0;
+#if (defined CONNECTOR_DEBUG)
+        size_class->first_block = first_block;
+        first_block += pool_class_config[i].block_count;
+#endif
+    }
+
+    connector_static_pool.initialized = connector_true;
+}
+
+#if (defined CONNECTOR_DEBUG)
+#define pool_block_index(size_class, index, block) \
+    ((size_class)->first_block + (size_t)((block) - (size_class)->base) / (pool_class_config[(index)].block_size / sizeof(pool_unit_t)))
+
+/* Internal fragmentation is the part of the blocks in use that the requests did not ask for */
+STATIC void pool_debug_report(void)
+{
+    size_t i;
+
+    for (i = 0; i < POOL_CLASS_COUNT; i++)
+    {
+        pool_class_t const * const size_class = &connector_static_pool.size_class[i];
+        size_t const block_size = pool_class_config[i].block_size;
+        size_t requested = 0;
+        size_t block;
+
+        for (block = 0; block < pool_class_config[i].block_count; block++)
+        {
+            requested += connector_static_pool.requested[size_class->first_block + block];
+        }
+
+        connector_debug_line("pool class %u (%u bytes): %u/%u in use, high water %u, %lu spilled from smaller classes, %lu failures, %u bytes unused in blocks in use",
+                             (unsigned)i, (unsigned)block_size, (unsigned)size_class->used, (unsigned)pool_class_config[i].block_count,
+                             (unsigned)size_class->high_water, size_class->spills, size_class->failures,
+                             (unsigned)(size_class->used * block_size - requested));
+    }
+}
+#endif
+
+/*
+ * A request is counted as a failure of the smallest class large enough for it, and only when
+ * neither that class nor a larger one had a free block. A larger class serving it counts a spill.
+ */
+STATIC void * pool_allocate(size_t const size)
+{
+    void * ptr = NULL;
+    size_t first_fit;
+    size_t i;
+
+    for (first_fit = 0; first_fit < POOL_CLASS_COUNT; first_fit++)
+    {
+        if (pool_class_config[first_fit].block_size >= size)
+            break;
+    }
+
+    for (i = first_fit; i < POOL_CLASS_COUNT; i++)
+    {
+        if (connector_static_pool.size_class[i].free_list != NULL)
+            break;
+    }
+
+    if (i < POOL_CLASS_COUNT)
+    {
+        pool_class_t * const size_class = &connector_static_pool.size_class[i];
+        pool_unit_t * const block = size_class->free_list;
+
+        size_class->free_list = block->next;
+        size_class->used++;
+        if (size_class->used > size_class->high_water)
+            size_class->high_water = size_class->used;
+        if (i != first_fit)
+            size_class->spills++;
+
+#if (defined CONNECTOR_DEBUG)
+        connector_static_pool.requested[pool_block_index(size_class, i, block)] = size;
+#endif
+        ptr = block;
+    }
+    else
+    {
+        if (first_fit < POOL_CLASS_COUNT)
+            connector_static_pool.size_class[first_fit].failures++;
+
+#if (defined CONNECTOR_DEBUG)
+        connector_debug_line("pool_allocate: no free block for %u bytes", (unsigned)size);
+        pool_debug_report();
+#endif
+    }
+
+    return ptr;
+}
+
+STATIC void pool_free(void * const ptr)
+{
+    pool_unit_t * const block = ptr;
+    size_t i;
+
+    for (i = 0; i < POOL_CLASS_COUNT; i++)
+    {
+        pool_class_t * const size_class = &connector_static_pool.size_class[i];
+
+        if (block >= size_class->base && block < size_class->limit)
+        {
+            ASSERT((size_t)((char *)block - (char *)size_class->base) % pool_class_config[i].block_size == 0);
+            ASSERT(size_class->used > 0);
+
+#if (defined CONNECTOR_DEBUG)
+            connector_static_pool.requested[pool_block_index(size_class, i, block)] = 0;
+#endif
+            block->next = size_class->free_list;
+            size_class->free_list = block;
+            size_class->used--;
+            goto done;
+        }
+    }
+
+    ASSERT(connector_false);
+
+done:
+    return;
+}
+
+STATIC connector_status_t malloc_static_data(connector_data_t * const connector_ptr, size_t const size, connector_static_buffer_id_t const buffer_id, void ** const ptr)
+{
+    connector_status_t status = connector_working;
+
+    UNUSED_PARAMETER(connector_ptr);
+
+    if (buffer_id == named_buffer_id(connector_data))
+    {
+        ASSERT(size == sizeof connector_static_pool.connector_data);
+        if (connector_static_pool.connector_data_used)
+        {
+            *ptr = NULL;
+            status = connector_pending;
+            goto done;
+        }
+
+        if (!connector_static_pool.initialized)
+            pool_init();
+
+        connector_static_pool.connector_data_used = connector_true;
+        *ptr = &connector_static_pool.connector_data;
+        goto done;
+    }
+
+    ASSERT(connector_ptr == &connector_static_pool.connector_data);
+
+    *ptr = pool_allocate(size);
+    if (*ptr == NULL)
+        status = connector_pending;
+
+done:
+    return status;
+}
+
+STATIC void free_static_data(connector_data_t * const connector_ptr, connector_static_buffer_id_t const buffer_id, void * const ptr)
+{
+    UNUSED_PARAMETER(connector_ptr);
+    ASSERT(connector_ptr == &connector_static_pool.connector_data);
+
+    if (buffer_id == named_buffer_id(connector_data))
+    {
+        connector_static_pool.connector_data_used = connector_false;
+    }
+    else
+    {
+        pool_free(ptr);
+    }
+}
@@ -28,6 +28,20 @@ Digi International Inc., 9350 Excelsior Blvd., Suite 700, Hopkins, MN 55343
 #endif
 #endif
 
+#if (defined CONNECTOR_STREAMING_CLI_POLL_BUDGET)
+#if (CONNECTOR_STREAMING_CLI_POLL_BUDGET < 1)
+#error "CONNECTOR_STREAMING_CLI_POLL_BUDGET must be greater than 0"
+#endif
+#endif
+
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+#if (CONNECTOR_STREAMING_CLI_MAX_SESSIONS > 0)
+#define STREAMING_CLI_READY_SLOTS   CONNECTOR_STREAMING_CLI_MAX_SESSIONS
+#else
+#define STREAMING_CLI_READY_SLOTS   16
+#endif
+#endif
+
 /* Opcodes */
 #define STREAMING_CLI_OPCODE_CAPABILITIES       0x00
 #define STREAMING_CLI_OPCODE_START_REQ          0x01
@@ -135,6 +149,9 @@ typedef struct streaming_cli_session
         } execute;
     } info;
     connector_bool_t read_only;
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+    connector_bool_t ready;
+#endif
     uint8_t last_opcode;
     char close_reason[CONNECTOR_STREAMING_CLI_MAX_CLOSE_REASON_LENGTH];
 } streaming_cli_session_t;
@@ -149,6 +166,26 @@ static struct
 static unsigned int streaming_cli_num_sessions;
 static streaming_cli_session_t * streaming_cli_sessions;
 
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+/*
+ * Sessions the application reported as having output. connector_initiate_action() fills a
+ * slot and the next step moves it to the session, so the application may report from
+ * another thread than the one calling connector_run()/connector_step().
+ */
+typedef enum
+{
+    streaming_cli_ready_slot_free,
+    streaming_cli_ready_slot_claimed,
+    streaming_cli_ready_slot_full
+} streaming_cli_ready_slot_state_t;
+
+static struct
+{
+    void * volatile handle;
+    unsigned int volatile state;
+} streaming_cli_ready_slot[STREAMING_CLI_READY_SLOTS];
+#endif
+
 STATIC streaming_cli_session_t * streaming_cli_service_find_session(uint16_t const id)
 {
     streaming_cli_session_t * first_session = streaming_cli_sessions;
@@ -503,7 +540,7 @@ STATIC connector_status_t streaming_cli_service_set_unknown_session_error(connec
         msg_session_t * response_session = msg_create_session(connector_ptr, msg_ptr, msg_service_id_cli_extended, connector_true, &status);
         if (status == connector_working)
         {
-            if (msg_initialize_data_block(response_session, msg_ptr->capabilities[msg_capability_cloud].window_size,
+            if (msg_initialize_data_block(msg_ptr, response_session, msg_ptr->capabilities[msg_capability_cloud].window_size,
                                           msg_block_state_send_request) == connector_session_error_none)
             {
                 uint8_t * streaming_cli_service_session_close;
@@ -659,6 +696,9 @@ STATIC streaming_cli_session_t * streaming_cli_service_create_new_session(connec
     session->bytes_consumed = 0;
     session->last_opcode = opcode;
     session->close_reason[0] = '\0';
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+    session->ready = connector_true;
+#endif
     streaming_cli_session_t ** const head_ptr = &streaming_cli_sessions;
     switch (opcode)
     {
@@ -940,6 +980,10 @@ STATIC connector_status_t streaming_cli_service_response_callback(connector_data
         {
             msg_session->service_context = NULL;
             session->info.streaming.active_send_transaction = NULL;
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+            /* the application may have written more since the poll */
+            session->ready = connector_true;
+#endif
         }
     }
     else if (session->session_state == streaming_cli_session_state_execute_command)
@@ -1065,6 +1109,14 @@ STATIC connector_status_t connector_facility_streaming_cli_service_init(connecto
     streaming_cli_error_buffer.transaction = NULL;
     streaming_cli_num_sessions = 0;
     streaming_cli_sessions = NULL;
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+    {
+        unsigned int i;
+
+        for (i = 0; i < STREAMING_CLI_READY_SLOTS; i++)
+            streaming_cli_ready_slot[i].state = streaming_cli_ready_slot_free;
+    }
+#endif
     return msg_init_facility(data_ptr, facility_index, msg_service_id_cli_extended, streaming_cli_service_callback);
 }
 
@@ -1073,7 +1125,7 @@ STATIC connector_bool_t streaming_cli_service_create_transaction(connector_data_
     msg_session_t * const msg_session = msg_create_session(data_ptr, msg_ptr, msg_service_id_cli_extended, connector_true, status);
     if (*status == connector_working)
     {
-        if (msg_initialize_data_block(msg_session, msg_ptr->capabilities[msg_capability_cloud].window_size, msg_block_state_send_request) == connector_session_error_none)
+        if (msg_initialize_data_block(msg_ptr, msg_session, msg_ptr->capabilities[msg_capability_cloud].window_size, msg_block_state_send_request) == connector_session_error_none)
         {
             msg_session->service_context = session;
             session->info.streaming.active_send_transaction = msg_session;
@@ -1115,39 +1167,184 @@ STATIC connector_status_t streaming_cli_service_run_poll_callback(connector_data
     return status;
 }
 
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+STATIC connector_status_t streaming_cli_service_notify_ready(connector_streaming_cli_ready_t const * const request)
+{
+    connector_status_t status = connector_service_busy;
+    unsigned int i;
+
+    for (i = 0; i < STREAMING_CLI_READY_SLOTS; i++)
+    {
+        if (streaming_cli_ready_slot[i].state == streaming_cli_ready_slot_full)
+        {
+            CONNECTOR_MEMORY_BARRIER();
+            if (streaming_cli_ready_slot[i].handle == request->handle)
+            {
+                /* not collected yet, the session will be polled anyway */
+                status = connector_success;
+                goto done;
+            }
+        }
+    }
+
+    /* several threads may report at once, each claims a free slot of its own */
+    for (i = 0; i < STREAMING_CLI_READY_SLOTS; i++)
+    {
+        if (CONNECTOR_COMPARE_AND_SWAP(&streaming_cli_ready_slot[i].state, streaming_cli_ready_slot_free, streaming_cli_ready_slot_claimed))
+        {
+            streaming_cli_ready_slot[i].handle = request->handle;
+            /* the handle is visible before the slot is seen full */
+            CONNECTOR_MEMORY_BARRIER();
+            streaming_cli_ready_slot[i].state = streaming_cli_ready_slot_full;
+            status = connector_success;
+            break;
+        }
+    }
+
+done:
+    return status;
+}
+
+STATIC void streaming_cli_service_collect_ready(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < STREAMING_CLI_READY_SLOTS; i++)
+    {
+        if (streaming_cli_ready_slot[i].state == streaming_cli_ready_slot_full)
+        {
+            streaming_cli_session_t * const first_session = streaming_cli_sessions;
+            connector_bool_t keep_report = connector_false;
+            void * handle;
+
+            CONNECTOR_MEMORY_BARRIER();
+            handle = streaming_cli_ready_slot[i].handle;
+
+            if (first_session != NULL)
+            {
+                streaming_cli_session_t * current_session = first_session;
+
+                do
+                {
+                    if (current_session->handle == handle)
+                    {
+                        if (current_session->session_state != streaming_cli_session_state_execute_command)
+                        {
+                            current_session->ready = connector_true;
+                            keep_report = connector_false;
+                            break;
+                        }
+                        /* not polled while it runs a command, the report waits for its state to change */
+                        keep_report = connector_true;
+                    }
+                    current_session = current_session->next;
+                } while (current_session != first_session);
+            }
+
+            if (!keep_report)
+            {
+                /* the session is marked before the slot is released */
+                CONNECTOR_MEMORY_BARRIER();
+                streaming_cli_ready_slot[i].state = streaming_cli_ready_slot_free;
+            }
+        }
+    }
+}
+
+#define streaming_cli_session_is_ready(session)     ((session)->ready)
+#else
+#define streaming_cli_session_is_ready(session)     connector_true
+#endif
+
+#if (defined CONNECTOR_STREAMING_CLI_POLL_BUDGET)
+#define streaming_cli_transaction_bytes(msg_ptr)    ((size_t)(msg_ptr)->capabilities[msg_capability_cloud].window_size)
+#endif
+
+/*
+ * Polls every started session that is not sending already, beginning one session further
+ * along the list each step. With CONNECTOR_STREAMING_CLI_POLL_BUDGET, each send transaction
+ * started takes as many bytes from the budget as it may carry. Once the budget is used up,
+ * the remaining sessions wait for the next step, and the first of them is polled first then.
+ */
 STATIC connector_status_t streaming_cli_service_poll_sessions(connector_data_t * const data_ptr, connector_msg_data_t * const msg_ptr)
 {
     connector_status_t status = connector_idle;
+    streaming_cli_session_t * const first_session = streaming_cli_sessions;
+    streaming_cli_session_t * next_first_session;
+#if (defined CONNECTOR_STREAMING_CLI_POLL_BUDGET)
+    size_t budget = CONNECTOR_STREAMING_CLI_POLL_BUDGET;
+#endif
+
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+    streaming_cli_service_collect_ready();
+#endif
+
+    if (first_session == NULL)
+        goto done;
+
+    next_first_session = first_session->next;
 
-    if (streaming_cli_sessions != NULL)
     {
-        streaming_cli_session_t * first_session = streaming_cli_sessions;
         streaming_cli_session_t * current_session = first_session;
 
         do
         {
-            if (current_session->session_state == streaming_cli_session_state_started && current_session->info.streaming.active_send_transaction == NULL)
+            connector_status_t session_status = connector_idle;
+
+            if (current_session->session_state == streaming_cli_session_state_started && current_session->info.streaming.active_send_transaction == NULL &&
+                streaming_cli_session_is_ready(current_session))
             {
-                status = streaming_cli_service_run_poll_callback(data_ptr, msg_ptr, current_session);
-                break;
+#if (defined CONNECTOR_STREAMING_CLI_POLL_BUDGET)
+                if (budget == 0)
+                {
+                    next_first_session = current_session;
+                    break;
+                }
+#endif
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+                current_session->ready = connector_false;
+#endif
+                session_status = streaming_cli_service_run_poll_callback(data_ptr, msg_ptr, current_session);
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+                if (session_status == connector_pending)
+                    current_session->ready = connector_true;
+#endif
+#if (defined CONNECTOR_STREAMING_CLI_POLL_BUDGET)
+                if (current_session->info.streaming.active_send_transaction != NULL)
+                    budget -= MIN_VALUE(budget, streaming_cli_transaction_bytes(msg_ptr));
+#endif
             }
             else if (current_session->session_state == streaming_cli_session_state_pending_error)
             {
-                streaming_cli_service_create_transaction(data_ptr, msg_ptr, current_session, &status);
-                if (status == connector_working)
+                streaming_cli_service_create_transaction(data_ptr, msg_ptr, current_session, &session_status);
+                if (session_status == connector_working)
                 {
                     current_session->session_state = streaming_cli_session_state_send_close;
                 }
-                break;
             }
+
+            switch (session_status)
+            {
+                case connector_idle:
+                case connector_pending:
+                    /* nothing to send, or the application or messaging layer is busy; try again next step */
+                    break;
+
+                case connector_working:
+                    status = connector_working;
+                    break;
+
+                default:
+                    status = session_status;
+                    goto done;
+            }
+
             current_session = current_session->next;
         } while (current_session != first_session);
-
-        if (status == connector_idle || status == connector_working)
-        {
-            streaming_cli_sessions = first_session->next;
-        }
     }
 
+    streaming_cli_sessions = next_first_session;
+
+done:
     return status;
 }
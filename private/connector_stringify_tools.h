@@ -28,6 +28,10 @@
 #define largest_int_t int32_t
 #endif
 
+#if (defined CONNECTOR_DATA_POINTS) && (defined CONNECTOR_SUPPORTS_FLOATING_POINT) && (defined CONNECTOR_SHORTEST_DOUBLE_FORMAT)
+#include "connector_double_to_chars.h"
+#endif
+
 #define QUOTES_NEEDED_FLAG          UINT32_C(0x01)
 #define LEADING_QUOTES_PUT_FLAG     UINT32_C(0x02)
 #define TRAILING_QUOTES_PUT_FLAG    UINT32_C(0x04)
@@ -69,11 +73,19 @@ typedef struct {
     unsigned int base;
 } int_info_t;
 
+#if (defined CONNECTOR_DATA_POINTS) && (defined CONNECTOR_SUPPORTS_FLOATING_POINT) && (defined CONNECTOR_SHORTEST_DOUBLE_FORMAT)
+typedef struct {
+    char chars[DOUBLE_TO_CHARS_MAX_LENGTH];
+    size_t length;
+    size_t next;
+} double_info_t;
+#else
 typedef struct {
     int_info_t integer;
     int_info_t fractional;
     connector_bool_t point_set;
 } double_info_t;
+#endif
 
 typedef struct {
     char const * next_char;
@@ -256,6 +268,23 @@ done:
 }
 
 #if (defined CONNECTOR_SUPPORTS_FLOATING_POINT)
+#if (defined CONNECTOR_SHORTEST_DOUBLE_FORMAT)
+STATIC connector_bool_t process_double(double_info_t * const double_info, buffer_info_t * const buffer_info)
+{
+    size_t const pending = double_info->length - double_info->next;
+    size_t const bytes = (pending < buffer_info->bytes_available) ? pending : buffer_info->bytes_available;
+
+    if (buffer_info->buffer != NULL)
+    {
+        memcpy(&buffer_info->buffer[buffer_info->bytes_written], &double_info->chars[double_info->next], bytes);
+    }
+    buffer_info->bytes_written += bytes;
+    buffer_info->bytes_available -= bytes;
+    double_info->next += bytes;
+
+    return connector_bool(double_info->next == double_info->length);
+}
+#else
 STATIC connector_bool_t process_double(double_info_t * const double_info, buffer_info_t * const buffer_info)
 {
     connector_bool_t done_processing = connector_false;
@@ -295,6 +324,7 @@ done:
 }
 #endif
 #endif
+#endif
 
 STATIC void init_int_info(int_info_t * const int_info, largest_int_t const value, unsigned int const base)
 {
@@ -308,6 +338,19 @@ STATIC void init_int_info(int_info_t * const int_info, largest_int_t const value
 
 #if (defined CONNECTOR_DATA_POINTS)
 #if (defined CONNECTOR_SUPPORTS_FLOATING_POINT)
+#if (defined CONNECTOR_SHORTEST_DOUBLE_FORMAT)
+STATIC void init_double_info(double_info_t * const double_info, double const value)
+{
+    double_info->length = double_to_chars(double_info->chars, value);
+    double_info->next = 0;
+}
+
+STATIC void init_float_info(double_info_t * const double_info, float const value)
+{
+    double_info->length = float_to_chars(double_info->chars, value);
+    double_info->next = 0;
+}
+#else
 STATIC long double_to_long_rounded(double const double_val)
 {
     long long_value;
@@ -341,6 +384,12 @@ STATIC void init_double_info(double_info_t * const double_info, double const val
     }
     double_info->point_set = connector_false;
 }
+
+STATIC void init_float_info(double_info_t * const double_info, float const value)
+{
+    init_double_info(double_info, value);
+}
+#endif
 #endif
 
 STATIC void init_string_info(string_info_t * const string_info, char const * const string)
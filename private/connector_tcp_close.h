@@ -62,6 +62,8 @@ STATIC connector_status_t tcp_close_cloud(connector_data_t * const connector_ptr
         close_data.reconnect = connector_true;
 
         connector_debug_line("tcp_close_cloud: status = %s", close_status_to_string(close_data.status));
+        connector_debug_line("tcp_close_cloud: received %lu packets in %lu network reads",
+                             connector_ptr->edp_data.receive_packet.packets, connector_ptr->edp_data.receive_packet.reads);
         request_id.network_request = connector_request_id_network_close;
 
         status = connector_callback(connector_ptr->callback, connector_class_id_network_tcp, request_id, &close_data, connector_ptr->context);
@@ -88,7 +90,7 @@ STATIC connector_status_t tcp_close_cloud(connector_data_t * const connector_ptr
                 connector_ptr->edp_data.stop.auto_connect = close_data.reconnect;
                 edp_set_active_state(connector_ptr, connector_transport_idle);
 
-                tcp_send_complete_callback(connector_ptr, connector_abort);
+                tcp_abort_send_queue(connector_ptr);
 
         }
         layer_remove_facilities(connector_ptr, facility_callback_cleanup);
@@ -28,10 +28,12 @@ STATIC connector_status_t connect_to_cloud(connector_data_t * const connector_pt
 
     open_data.device_cloud.url = cloud_url;
     open_data.handle = connector_ptr->edp_data.network_handle;
+    open_data.wait_for_receive = connector_false;
 
     request_id.network_request = connector_request_id_network_open;
     status = connector_callback(connector_ptr->callback, connector_class_id_network_tcp, request_id, &open_data, connector_ptr->context);
     ASSERT(status != connector_callback_unrecognized);
+    connector_ptr->edp_data.open_wait_for_receive = open_data.wait_for_receive;
     switch (status)
     {
     case connector_callback_continue:
@@ -271,16 +273,14 @@ STATIC connector_status_t send_keepalive(connector_data_t * const connector_ptr)
         ptr += PACKET_EDP_HEADER_SIZE;
     }
 #endif
-    /* Setting the total_length will enable tcp_send_packet_process.
-     * Clear length to 0 for actual length that has been sent.
+    /* Queueing the packet will enable edp_tcp_send_process.
+     * tcp_get_packet_buffer() made sure there is room in the send queue.
      */
     {
         size_t const total_packet_length = (size_t)(ptr - start_ptr);
         ASSERT(ptr > start_ptr);
-        connector_ptr->edp_data.send_packet.total_length = total_packet_length;
-        connector_ptr->edp_data.send_packet.bytes_sent = 0;
-        connector_ptr->edp_data.send_packet.ptr = packet;
-        connector_ptr->edp_data.send_packet.complete_cb = tcp_release_packet_buffer;
+        result = tcp_queue_send_entry(connector_ptr, packet, total_packet_length, tcp_release_packet_buffer, NULL);
+        ASSERT(result == connector_working);
     }
 
 done:
@@ -667,14 +667,27 @@ STATIC connector_status_t send_password(connector_data_t * const connector_ptr)
 
     uint8_t * edp_password;
     uint8_t * start_ptr;
+    size_t avail_length;
 
-    edp_header = tcp_get_packet_buffer(connector_ptr, E_MSG_MT2_MSG_NUM, &start_ptr, NULL);
+    edp_header = tcp_get_packet_buffer(connector_ptr, E_MSG_MT2_MSG_NUM, &start_ptr, &avail_length);
     if (edp_header == NULL)
     {
         result = connector_pending;
         goto done;
     }
 
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+    if ((record_bytes(edp_password) + connector_ptr->edp_data.config.password_length > avail_length) && (tcp_flight_length(connector_ptr) > 0))
+    {
+        /* the password does not fit after the packets already in the flight */
+        tcp_release_packet_buffer(connector_ptr, edp_header, connector_working, NULL);
+        result = connector_pending;
+        goto done;
+    }
+#else
+    UNUSED_VARIABLE(avail_length);
+#endif
+
     edp_password = start_ptr;
 
     message_store_u8(edp_password, opcode, SECURITY_OPER_PASSWORD);
@@ -859,10 +872,304 @@ done:
 STATIC connector_status_t layer_discovery_facility(connector_data_t * const connector_ptr);
 STATIC connector_status_t connector_edp_init(connector_data_t * const connector_ptr);
 
+STATIC connector_status_t edp_send_handshake_message(connector_data_t * const connector_ptr)
+{
+    connector_status_t result = connector_idle;
+
+    switch (edp_get_edp_state(connector_ptr))
+    {
+    case edp_communication_send_version:
+        connector_debug_line("Send MT Version");
+        result = send_version(connector_ptr, E_MSG_MT2_TYPE_VERSION, EDP_MT_VERSION);
+        if (result == connector_working)
+        {
+            edp_set_next_edp_state(connector_ptr, edp_communication_receive_version_response);
+        }
+        break;
+
+    case edp_communication_send_keepalive:
+        result = send_keepalive(connector_ptr);
+        if (result == connector_working)
+        {
+            edp_set_next_edp_state(connector_ptr, edp_initialization_send_protocol_version);
+        }
+        break;
+
+    case edp_initialization_send_protocol_version:
+    {
+        #define EDP_PROTOCOL_VERSION    0x120
+
+        connector_debug_line("Send protocol version");
+        result = send_version(connector_ptr, E_MSG_MT2_TYPE_PAYLOAD, EDP_PROTOCOL_VERSION);
+        if (result == connector_working)
+        {
+            edp_set_next_edp_state(connector_ptr, edp_initialization_receive_protocol_version);
+        }
+        break;
+    }
+    case edp_security_send_identity_verification:
+        result = send_identity_verification(connector_ptr);
+        if (result == connector_working)
+        {
+            edp_set_next_edp_state(connector_ptr, edp_security_send_device_id);
+        }
+        break;
+    case edp_security_send_device_id:
+        if (connector_ptr->connector_got_device_id)
+        {
+            result = send_device_id(connector_ptr);
+            if (result == connector_working)
+            {
+                edp_set_next_edp_state(connector_ptr, edp_security_send_device_cloud_url);
+            }
+        }
+        else
+        {
+            result = send_provisioning(connector_ptr);
+            if (result == connector_working)
+            {
+                edp_set_next_edp_state(connector_ptr, edp_security_receive_device_id);
+            }
+        }
+        break;
+    case edp_security_send_device_cloud_url:
+        result = send_cloud_url(connector_ptr);
+        if (result == connector_working)
+        {
+#if (defined CONNECTOR_IDENTITY_VERIFICATION)
+            edp_set_next_edp_state(connector_ptr, (CONNECTOR_IDENTITY_VERIFICATION == connector_identity_verification_password) ? edp_security_send_password : edp_discovery_send_vendor_id);
+#else
+            edp_set_next_edp_state(connector_ptr, (connector_ptr->edp_data.config.identity_verification == connector_identity_verification_password) ? edp_security_send_password : edp_discovery_send_vendor_id);
+#endif
+        }
+        break;
+
+    case edp_security_send_password:
+        result = send_password(connector_ptr);
+        if (result == connector_working)
+        {
+            edp_set_next_edp_state(connector_ptr, edp_discovery_send_vendor_id);
+        }
+        break;
+
+    case edp_discovery_send_vendor_id:
+        result = send_vendor_id(connector_ptr);
+        if (result == connector_working)
+        {
+            edp_set_next_edp_state(connector_ptr, edp_discovery_send_device_type);
+        }
+        break;
+
+    case edp_discovery_send_device_type:
+        result = send_device_type(connector_ptr);
+        if (result == connector_working)
+        {
+            edp_set_next_edp_state(connector_ptr, edp_discovery_facility);
+        }
+        break;
+    case edp_discovery_facility:
+        result = layer_discovery_facility(connector_ptr);
+
+        if (result == connector_working)
+        {
+            edp_set_next_edp_state(connector_ptr, edp_discovery_send_complete);
+        }
+        break;
+
+    case edp_discovery_send_complete:
+        result = send_complete(connector_ptr);
+        if (result == connector_working)
+        {
+            edp_set_next_edp_state(connector_ptr, edp_connected);
+        }
+        break;
+    case edp_state_send_in_progress:
+        break;
+    default:
+        break;
+    }
+
+    return result;
+}
+
+#if (defined CONNECTOR_DEBUG)
+STATIC edp_handshake_phase_t edp_handshake_phase(connector_edp_state_t const state)
+{
+    edp_handshake_phase_t phase;
+
+    switch (state)
+    {
+    case edp_communication_connect_to_cloud:
+    case edp_configuration_init:
+        phase = edp_handshake_connect;
+        break;
+    case edp_communication_send_version:
+    case edp_communication_receive_version_response:
+        phase = edp_handshake_version;
+        break;
+    case edp_communication_send_keepalive:
+    case edp_initialization_send_protocol_version:
+    case edp_initialization_receive_protocol_version:
+        phase = edp_handshake_protocol;
+        break;
+    case edp_security_send_identity_verification:
+    case edp_security_send_device_id:
+    case edp_security_receive_device_id:
+    case edp_security_send_device_cloud_url:
+    case edp_security_send_password:
+        phase = edp_handshake_security;
+        break;
+    default:
+        phase = edp_handshake_discovery;
+        break;
+    }
+
+    return phase;
+}
+
+/* The time, sends and receives between two calls of edp_tcp_open_process() go to the phase
+ * of the state the first call was in.
+ */
+STATIC void edp_handshake_step(connector_data_t * const connector_ptr)
+{
+    connector_edp_state_t state = edp_get_edp_state(connector_ptr);
+    unsigned long now;
+
+    if (state == edp_state_send_in_progress)
+    {
+        state = edp_get_next_edp_state(connector_ptr);
+    }
+
+    if (get_system_time_in_ms(connector_ptr, &now) != connector_working)
+    {
+        now = connector_ptr->edp_data.handshake.time;
+    }
+
+    if (connector_ptr->edp_data.handshake.started)
+    {
+        edp_handshake_phase_t const phase = connector_ptr->edp_data.handshake.phase;
+
+        connector_ptr->edp_data.handshake.phases[phase].milliseconds += now - connector_ptr->edp_data.handshake.time;
+        connector_ptr->edp_data.handshake.phases[phase].sends += connector_ptr->edp_data.send_packet.sends - connector_ptr->edp_data.handshake.sends;
+        connector_ptr->edp_data.handshake.phases[phase].reads += connector_ptr->edp_data.receive_packet.reads - connector_ptr->edp_data.handshake.reads;
+    }
+
+    connector_ptr->edp_data.handshake.started = connector_true;
+    connector_ptr->edp_data.handshake.phase = edp_handshake_phase(state);
+    connector_ptr->edp_data.handshake.phases[connector_ptr->edp_data.handshake.phase].steps++;
+    connector_ptr->edp_data.handshake.time = now;
+    connector_ptr->edp_data.handshake.sends = connector_ptr->edp_data.send_packet.sends;
+    connector_ptr->edp_data.handshake.reads = connector_ptr->edp_data.receive_packet.reads;
+}
+
+STATIC void edp_handshake_report(connector_data_t * const connector_ptr)
+{
+    static char const * const phase_name[edp_handshake_phase_count] = { "connect", "MT version", "protocol version", "security", "discovery" };
+    unsigned int i;
+
+    for (i = 0; i < edp_handshake_phase_count; i++)
+    {
+        connector_debug_line("EDP handshake %s: %lu ms, %u steps, %lu sends, %lu receives", phase_name[i],
+                             connector_ptr->edp_data.handshake.phases[i].milliseconds, connector_ptr->edp_data.handshake.phases[i].steps,
+                             connector_ptr->edp_data.handshake.phases[i].sends, connector_ptr->edp_data.handshake.phases[i].reads);
+    }
+}
+#else
+#define edp_handshake_step(connector_ptr)
+#define edp_handshake_report(connector_ptr)
+#endif
+
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+/* States whose message can follow the previous one without waiting for Device Cloud */
+STATIC connector_bool_t edp_joins_flight(connector_data_t * const connector_ptr, connector_edp_state_t const state)
+{
+    connector_bool_t joins = connector_false;
+
+    switch (state)
+    {
+    case edp_communication_send_keepalive:
+    case edp_initialization_send_protocol_version:
+    case edp_security_send_identity_verification:
+    case edp_security_send_device_cloud_url:
+    case edp_security_send_password:
+    case edp_discovery_send_vendor_id:
+    case edp_discovery_send_device_type:
+    case edp_discovery_send_complete:
+        joins = connector_true;
+        break;
+    case edp_security_send_device_id:
+        /* provisioning has to wait for the device ID in the response */
+        joins = connector_ptr->connector_got_device_id;
+        break;
+    case edp_discovery_facility:
+        /* facilities build their discovery packets assuming the whole send packet buffer */
+    default:
+        break;
+    }
+
+    return joins;
+}
+
+STATIC void edp_next_flight_state(connector_data_t * const connector_ptr)
+{
+    connector_edp_state_t next_state = edp_get_next_edp_state(connector_ptr);
+
+    if (next_state == edp_initialization_receive_protocol_version && connector_ptr->connector_got_device_id)
+    {
+        /* nothing else is answered until the device ID is known, so the protocol version
+         * response is received once the whole handshake is sent.
+         */
+        connector_ptr->edp_data.state.protocol_version_deferred = connector_true;
+        next_state = edp_security_send_identity_verification;
+    }
+    else if (next_state == edp_connected && connector_ptr->edp_data.state.protocol_version_deferred)
+    {
+        next_state = edp_initialization_receive_protocol_version;
+    }
+
+    edp_set_next_edp_state(connector_ptr, next_state);
+    edp_set_edp_state(connector_ptr, next_state);
+}
+
+/* Builds the messages of consecutive states in the send packet buffer until a state has to
+ * wait for Device Cloud or the buffer is full, and queues them to be sent at once.
+ */
+STATIC connector_status_t edp_send_handshake_flight(connector_data_t * const connector_ptr)
+{
+    connector_status_t result;
+    size_t flight_length;
+
+    tcp_open_flight(connector_ptr);
+
+    for (;;)
+    {
+        flight_length = tcp_flight_length(connector_ptr);
+        result = edp_send_handshake_message(connector_ptr);
+
+        if (result != connector_working && result != connector_idle && result != connector_pending) break;
+        if (tcp_flight_length(connector_ptr) == flight_length) break;
+
+        /* idle or pending means the state has more to send */
+        if (result == connector_working)
+        {
+            edp_next_flight_state(connector_ptr);
+        }
+
+        if (!edp_joins_flight(connector_ptr, edp_get_edp_state(connector_ptr))) break;
+    }
+
+    tcp_close_flight(connector_ptr);
+
+    return result;
+}
+#endif
+
 STATIC connector_status_t edp_tcp_open_process(connector_data_t * const connector_ptr)
 {
     connector_status_t result = connector_idle;
 
+    edp_handshake_step(connector_ptr);
+
     switch (edp_get_edp_state(connector_ptr))
     {
     case edp_communication_connect_to_cloud:
@@ -940,132 +1247,13 @@ STATIC connector_status_t edp_tcp_open_process(connector_data_t * const connecto
     case edp_discovery_facility:
     case edp_discovery_send_complete:
     case edp_state_send_in_progress:
-    case edp_connected:
     {
-        switch (edp_get_edp_state(connector_ptr))
-        {
-        case edp_communication_send_version:
-            connector_debug_line("Send MT Version");
-            result = send_version(connector_ptr, E_MSG_MT2_TYPE_VERSION, EDP_MT_VERSION);
-            if (result == connector_working)
-            {
-                edp_set_next_edp_state(connector_ptr, edp_communication_receive_version_response);
-            }
-            break;
-
-        case edp_communication_send_keepalive:
-            result = send_keepalive(connector_ptr);
-            if (result == connector_working)
-            {
-                edp_set_next_edp_state(connector_ptr, edp_initialization_send_protocol_version);
-            }
-            break;
-
-        case edp_initialization_send_protocol_version:
-        {
-            #define EDP_PROTOCOL_VERSION    0x120
-
-            connector_debug_line("Send protocol version");
-            result = send_version(connector_ptr, E_MSG_MT2_TYPE_PAYLOAD, EDP_PROTOCOL_VERSION);
-            if (result == connector_working)
-            {
-                edp_set_next_edp_state(connector_ptr, edp_initialization_receive_protocol_version);
-            }
-            break;
-        }
-        case edp_security_send_identity_verification:
-            result = send_identity_verification(connector_ptr);
-            if (result == connector_working)
-            {
-                edp_set_next_edp_state(connector_ptr, edp_security_send_device_id);
-            }
-            break;
-        case edp_security_send_device_id:
-            if (connector_ptr->connector_got_device_id)
-            {
-                result = send_device_id(connector_ptr);
-                if (result == connector_working)
-                {
-                    edp_set_next_edp_state(connector_ptr, edp_security_send_device_cloud_url);
-                }
-            }
-            else
-            {
-                result = send_provisioning(connector_ptr);
-                if (result == connector_working)
-                {
-                    edp_set_next_edp_state(connector_ptr, edp_security_receive_device_id);
-                }
-            }
-            break;
-        case edp_security_send_device_cloud_url:
-            result = send_cloud_url(connector_ptr);
-            if (result == connector_working)
-            {
-#if (defined CONNECTOR_IDENTITY_VERIFICATION)
-                edp_set_next_edp_state(connector_ptr, (CONNECTOR_IDENTITY_VERIFICATION == connector_identity_verification_password) ? edp_security_send_password : edp_discovery_send_vendor_id);
-#else
-                edp_set_next_edp_state(connector_ptr, (connector_ptr->edp_data.config.identity_verification == connector_identity_verification_password) ? edp_security_send_password : edp_discovery_send_vendor_id);
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+        if (edp_joins_flight(connector_ptr, edp_get_edp_state(connector_ptr)))
+            result = edp_send_handshake_flight(connector_ptr);
+        else
 #endif
-            }
-            break;
-
-        case edp_security_send_password:
-            result = send_password(connector_ptr);
-            if (result == connector_working)
-            {
-                edp_set_next_edp_state(connector_ptr, edp_discovery_send_vendor_id);
-            }
-            break;
-
-        case edp_discovery_send_vendor_id:
-            result = send_vendor_id(connector_ptr);
-            if (result == connector_working)
-            {
-                edp_set_next_edp_state(connector_ptr, edp_discovery_send_device_type);
-            }
-            break;
-
-        case edp_discovery_send_device_type:
-            result = send_device_type(connector_ptr);
-            if (result == connector_working)
-            {
-                edp_set_next_edp_state(connector_ptr, edp_discovery_facility);
-            }
-            break;
-        case edp_discovery_facility:
-            result = layer_discovery_facility(connector_ptr);
-
-            if (result == connector_working)
-            {
-                edp_set_next_edp_state(connector_ptr, edp_discovery_send_complete);
-            }
-            break;
-
-        case edp_discovery_send_complete:
-            result = send_complete(connector_ptr);
-            if (result == connector_working)
-            {
-                edp_set_next_edp_state(connector_ptr, edp_connected);
-            }
-            break;
-        case edp_connected:
-        {
-            edp_set_edp_state(connector_ptr, edp_facility_process);
-            edp_set_active_state(connector_ptr, connector_transport_receive);
-
-            result = notify_status(connector_ptr->callback, connector_tcp_communication_started, connector_ptr->context);
-            if (result != connector_working)
-            {
-                result = connector_abort;
-            }
-            goto done;
-        }
-        case edp_state_send_in_progress:
-            break;
-        default:
-            break;
-        }
+        result = edp_send_handshake_message(connector_ptr);
 
         if (result == connector_working || result == connector_idle || result == connector_pending)
         {
@@ -1096,6 +1284,18 @@ STATIC connector_status_t edp_tcp_open_process(connector_data_t * const connecto
 
         goto done;
     }
+    case edp_connected:
+        edp_handshake_report(connector_ptr);
+        edp_set_edp_state(connector_ptr, edp_facility_process);
+        edp_set_active_state(connector_ptr, connector_transport_receive);
+
+        result = notify_status(connector_ptr->callback, connector_tcp_communication_started, connector_ptr->context);
+        if (result != connector_working)
+        {
+            result = connector_abort;
+        }
+        goto done;
+
     case edp_communication_receive_version_response:
         result = receive_edp_version(connector_ptr);
         if (result == connector_working)
@@ -1109,6 +1309,14 @@ STATIC connector_status_t edp_tcp_open_process(connector_data_t * const connecto
         result = receive_protocol_version(connector_ptr);
         if (result == connector_working)
         {
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+            if (connector_ptr->edp_data.state.protocol_version_deferred)
+            {
+                connector_ptr->edp_data.state.protocol_version_deferred = connector_false;
+                edp_set_edp_state(connector_ptr, edp_connected);
+                break;
+            }
+#endif
             edp_set_edp_state(connector_ptr, edp_security_send_identity_verification);
         }
         break;
@@ -158,6 +158,50 @@ done:
 }
 
 
+#if (defined CONNECTOR_TCP_RECEIVE_BUFFER_SIZE)
+/*
+ * Hands out the bytes read ahead and only calls the receive callback once they are all used,
+ * asking for as many bytes as fit in the buffer.
+ */
+STATIC connector_callback_status_t tcp_receive_read_ahead(connector_data_t * const connector_ptr, uint8_t * const buffer, size_t * const length)
+{
+    connector_callback_status_t status = connector_callback_continue;
+    connector_bool_t const empty = connector_bool(connector_ptr->edp_data.receive_packet.read_ahead.count == 0);
+
+    if (empty)
+    {
+        size_t bytes = sizeof connector_ptr->edp_data.receive_packet.read_ahead.data;
+
+        status = tcp_receive_buffer(connector_ptr, connector_ptr->edp_data.receive_packet.read_ahead.data, &bytes);
+        if (status != connector_callback_continue)
+        {
+            *length = 0;
+            goto done;
+        }
+
+        connector_ptr->edp_data.receive_packet.read_ahead.head = 0;
+        connector_ptr->edp_data.receive_packet.read_ahead.count = bytes;
+    }
+
+    {
+        size_t const bytes = MIN_VALUE(*length, connector_ptr->edp_data.receive_packet.read_ahead.count);
+
+        memcpy(buffer, connector_ptr->edp_data.receive_packet.read_ahead.data + connector_ptr->edp_data.receive_packet.read_ahead.head, bytes);
+        connector_ptr->edp_data.receive_packet.read_ahead.head += bytes;
+        connector_ptr->edp_data.receive_packet.read_ahead.count -= bytes;
+        *length = bytes;
+    }
+
+done:
+    return status;
+}
+
+#define tcp_receive_has_read_ahead(connector_ptr)   connector_bool((connector_ptr)->edp_data.receive_packet.read_ahead.count > 0)
+#else
+#define tcp_receive_read_ahead                      tcp_receive_buffer
+#define tcp_receive_has_read_ahead(connector_ptr)   connector_false
+#endif
+
 STATIC connector_callback_status_t tcp_receive_data_status(connector_data_t * const connector_ptr)
 {
     connector_callback_status_t status = connector_callback_continue;
@@ -167,11 +211,15 @@ STATIC connector_callback_status_t tcp_receive_data_status(connector_data_t * co
     {
         uint8_t * const buf = connector_ptr->edp_data.receive_packet.ptr + connector_ptr->edp_data.receive_packet.bytes_received;
         size_t length = connector_ptr->edp_data.receive_packet.total_length - connector_ptr->edp_data.receive_packet.bytes_received;
-        status = tcp_receive_buffer(connector_ptr, buf, &length);
+        connector_bool_t const network_read = connector_bool(!tcp_receive_has_read_ahead(connector_ptr));
+
+        status = tcp_receive_read_ahead(connector_ptr, buf, &length);
 
         if (status == connector_callback_continue)
         {
             connector_ptr->edp_data.receive_packet.bytes_received += length;
+            if (network_read && length > 0)
+                connector_ptr->edp_data.receive_packet.reads++;
         }
         else if (status != connector_callback_busy)
         {
@@ -415,6 +463,7 @@ STATIC connector_status_t tcp_receive_packet(connector_data_t * const connector_
             break;
         }
         case receive_packet_complete:
+            connector_ptr->edp_data.receive_packet.packets++;
 
             if (connector_ptr->edp_data.receive_packet.data_packet != NULL)
             {
@@ -449,7 +498,25 @@ done:
 
 STATIC connector_status_t layer_facility_process(connector_data_t * const connector_ptr);
 
-STATIC connector_status_t edp_tcp_receive_process(connector_data_t * connector_ptr)
+/*
+ * Packets already read ahead are passed to the facilities in the same step as long as the
+ * receive packet is free again, before the network is read again.
+ */
+STATIC connector_bool_t tcp_receive_next_packet(connector_data_t * const connector_ptr, connector_status_t const result)
+{
+    connector_bool_t next = connector_false;
+
+    if (!tcp_receive_has_read_ahead(connector_ptr)) goto done;
+    if (connector_ptr->edp_data.receive_packet.free_packet_buffer == NULL) goto done;
+    if (edp_get_active_state(connector_ptr) != connector_transport_receive) goto done;
+
+    next = connector_bool(result == connector_idle || result == connector_working);
+
+done:
+    return next;
+}
+
+STATIC connector_status_t edp_tcp_receive_one_packet(connector_data_t * connector_ptr)
 {
 enum {
     facility_receive_message,
@@ -577,3 +644,14 @@ done:
     return result;
 }
 
+STATIC connector_status_t edp_tcp_receive_process(connector_data_t * connector_ptr)
+{
+    connector_status_t result;
+
+    do
+    {
+        result = edp_tcp_receive_one_packet(connector_ptr);
+    } while (tcp_receive_next_packet(connector_ptr, result));
+
+    return result;
+}
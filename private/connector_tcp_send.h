@@ -27,7 +27,57 @@
 #define DISC_OP_INITCOMPLETE  5
 #define DISC_OP_VENDOR_ID     6
 
-#define tcp_is_send_active(connector_ptr)   connector_bool(connector_ptr->edp_data.send_packet.total_length > 0)
+#define tcp_is_send_active(connector_ptr)   connector_bool((connector_ptr)->edp_data.send_packet.count > 0)
+
+/* n-th packet in the send queue, 0 is the one being sent */
+#define tcp_send_entry(connector_ptr, n)    (&(connector_ptr)->edp_data.send_packet.entry[((connector_ptr)->edp_data.send_packet.head + (n)) % CONNECTOR_TCP_SEND_QUEUE_SIZE])
+
+STATIC connector_status_t tcp_queue_send_entry(connector_data_t * const connector_ptr, uint8_t const * const packet, size_t const length,
+                                                send_complete_cb_t send_complete_cb, void * const user_data)
+{
+    connector_status_t status = connector_working;
+
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+    if (connector_ptr->edp_data.send_packet.flight.open)
+    {
+        /* the packet was built right after the previous ones of the flight, see tcp_get_packet_buffer() */
+        unsigned int const index = connector_ptr->edp_data.send_packet.flight.count;
+
+        ASSERT(packet == connector_ptr->edp_data.send_packet.packet_buffer.buffer + connector_ptr->edp_data.send_packet.flight.length);
+        ASSERT(index < TCP_FLIGHT_MESSAGES);
+
+        connector_ptr->edp_data.send_packet.flight.message[index].complete_cb = send_complete_cb;
+        connector_ptr->edp_data.send_packet.flight.message[index].user_data = user_data;
+        connector_ptr->edp_data.send_packet.flight.count++;
+        connector_ptr->edp_data.send_packet.flight.length += length;
+        goto done;
+    }
+#endif
+
+    if (connector_ptr->edp_data.send_packet.count >= CONNECTOR_TCP_SEND_QUEUE_SIZE)
+    {
+        /* connector_debug_line("tcp_queue_send_entry: unable to queue another send since the send queue is full"); */
+        status = connector_pending;
+        goto done;
+    }
+
+    {
+        edp_send_entry_t * const entry = tcp_send_entry(connector_ptr, connector_ptr->edp_data.send_packet.count);
+
+        entry->ptr = packet;
+        entry->total_length = length;
+        /* clear the actual number of bytes to be sent */
+        entry->bytes_sent = 0;
+        entry->complete_cb = send_complete_cb;
+        entry->user_data = user_data;
+        entry->continued = connector_false;
+
+        connector_ptr->edp_data.send_packet.count++;
+    }
+
+done:
+    return status;
+}
 
 STATIC connector_status_t tcp_initiate_send_packet(connector_data_t * const connector_ptr, uint8_t * const edp_header,
                                                     size_t const length, uint16_t const type,
@@ -35,14 +85,14 @@ STATIC connector_status_t tcp_initiate_send_packet(connector_data_t * const conn
 {
     connector_status_t status = connector_working;
 
-    /* Setup data to be sent. tcp_send_packet_process() will actually
+    /* Setup data to be sent. edp_tcp_send_process() will actually
      * send out the data.
      */
 
     ASSERT_GOTO(edp_header != NULL, done);
     ASSERT_GOTO(length <= UINT16_MAX, done);
 
-    if (connector_ptr->edp_data.send_packet.total_length > 0)
+    if (connector_ptr->edp_data.send_packet.count >= CONNECTOR_TCP_SEND_QUEUE_SIZE)
     {
         /* connector_debug_line("tcp_initiate_send_packet: unable to trigger another send since previous data is still pending"); */
         status = connector_pending;
@@ -63,10 +113,6 @@ STATIC connector_status_t tcp_initiate_send_packet(connector_data_t * const conn
      *
     */
 
-    /* total bytes to be sent to Device Cloud (packet data length + the edp header length) */
-    connector_ptr->edp_data.send_packet.total_length = length + PACKET_EDP_HEADER_SIZE;
-    connector_ptr->edp_data.send_packet.ptr = edp_header;
-
     message_store_be16(edp_header, type, type);
 
     {
@@ -76,10 +122,9 @@ STATIC connector_status_t tcp_initiate_send_packet(connector_data_t * const conn
         message_store_be16(edp_header, length, length16);
     }
 
-    /* clear the actual number of bytes to be sent */
-    connector_ptr->edp_data.send_packet.bytes_sent = 0;
-    connector_ptr->edp_data.send_packet.complete_cb = send_complete_cb;
-    connector_ptr->edp_data.send_packet.user_data = user_data;
+    /* total bytes to be sent to Device Cloud (packet data length + the edp header length) */
+    status = tcp_queue_send_entry(connector_ptr, edp_header, length + PACKET_EDP_HEADER_SIZE, send_complete_cb, user_data);
+    ASSERT_GOTO(status == connector_working, done);
 
     if (type != E_MSG_MT2_TYPE_KA_KEEPALIVE && type != E_MSG_MT2_TYPE_VERSION)
     {
@@ -90,9 +135,7 @@ done:
     return status;
 }
 
-STATIC connector_status_t tcp_initiate_send_facility_packet(connector_data_t * const connector_ptr, uint8_t * const edp_header,
-                                                             size_t const length, uint16_t const facility,
-                                                             send_complete_cb_t send_complete_cb, void * const user_data)
+STATIC void tcp_fill_facility_header(uint8_t * const edp_header, uint16_t const facility)
 {
     uint8_t * const edp_protocol = edp_header + PACKET_EDP_HEADER_SIZE;
 
@@ -112,7 +155,13 @@ STATIC connector_status_t tcp_initiate_send_facility_packet(connector_data_t * c
     message_store_u8(edp_protocol, sec_coding, SECURITY_PROTO_NONE);
     message_store_u8(edp_protocol, payload, DISC_OP_PAYLOAD);
     message_store_be16(edp_protocol, facility, facility);
+}
 
+STATIC connector_status_t tcp_initiate_send_facility_packet(connector_data_t * const connector_ptr, uint8_t * const edp_header,
+                                                             size_t const length, uint16_t const facility,
+                                                             send_complete_cb_t send_complete_cb, void * const user_data)
+{
+    tcp_fill_facility_header(edp_header, facility);
 
     return tcp_initiate_send_packet(connector_ptr, edp_header,
                                 (length + PACKET_EDP_PROTOCOL_SIZE),
@@ -121,24 +170,62 @@ STATIC connector_status_t tcp_initiate_send_facility_packet(connector_data_t * c
                                 user_data);
 }
 
-STATIC connector_callback_status_t tcp_send_buffer(connector_data_t * const connector_ptr, uint8_t * const buffer, size_t * const length)
+#if !(defined CONNECTOR_COMPRESSION) && (CONNECTOR_TCP_SEND_QUEUE_SIZE > 1)
+STATIC connector_status_t tcp_initiate_send_facility_packet_external(connector_data_t * const connector_ptr, uint8_t * const edp_header,
+                                                                      size_t const length, uint16_t const facility,
+                                                                      uint8_t const * const external, size_t const external_length,
+                                                                      send_complete_cb_t send_complete_cb, void * const user_data)
 {
-    connector_callback_status_t status;
-    connector_network_send_t send_data;
-    connector_request_id_t request_id;
+    /* Same as tcp_initiate_send_facility_packet() but the facility data continues in
+     * external, which is queued as its own send entry so it is never copied. Both entries
+     * are queued together so nothing can be sent in between them, and both carry user_data
+     * so tcp_cancel_send_entries() takes them off together. The complete callback is called
+     * once the external data has been sent.
+     */
+    connector_status_t status = connector_working;
+    size_t const packet_length = length + PACKET_EDP_PROTOCOL_SIZE;
 
-    send_data.buffer = buffer;
-    send_data.bytes_available = *length;
-    send_data.bytes_used = 0;
-    send_data.handle = connector_ptr->edp_data.network_handle;
+    ASSERT_GOTO(packet_length + external_length <= UINT16_MAX, done);
+
+    if (connector_ptr->edp_data.send_packet.count > (CONNECTOR_TCP_SEND_QUEUE_SIZE - 2))
+    {
+        status = connector_pending;
+        goto done;
+    }
+
+    tcp_fill_facility_header(edp_header, facility);
+    message_store_be16(edp_header, type, E_MSG_MT2_TYPE_PAYLOAD);
+    {
+        uint16_t const length16 = (uint16_t)(packet_length + external_length);
+
+        message_store_be16(edp_header, length, length16);
+    }
+
+    status = tcp_queue_send_entry(connector_ptr, edp_header, packet_length + PACKET_EDP_HEADER_SIZE, NULL, user_data);
+    ASSERT_GOTO(status == connector_working, done);
+    status = tcp_queue_send_entry(connector_ptr, external, external_length, send_complete_cb, user_data);
+    ASSERT_GOTO(status == connector_working, done);
+    tcp_send_entry(connector_ptr, connector_ptr->edp_data.send_packet.count - 1)->continued = connector_true;
+
+    register_activity(connector_ptr, connector_network_tcp);
+
+done:
+    return status;
+}
+#endif
+
+STATIC connector_callback_status_t tcp_send_status(connector_data_t * const connector_ptr, connector_callback_status_t status,
+                                                   size_t const bytes_used, size_t * const length)
+{
+    if (status != connector_callback_unrecognized)
+    {
+        connector_ptr->edp_data.send_packet.sends++;
+    }
 
-    request_id.network_request = connector_request_id_network_send;
-    status = connector_callback(connector_ptr->callback, connector_class_id_network_tcp, request_id, &send_data, connector_ptr->context);
-    ASSERT(status != connector_callback_unrecognized);
     switch (status)
     {
     case connector_callback_continue:
-        *length = send_data.bytes_used;
+        *length = bytes_used;
         if (*length > 0)
         {
             /* Retain the "last (RX) message send" time. */
@@ -149,11 +236,9 @@ STATIC connector_callback_status_t tcp_send_buffer(connector_data_t * const conn
         }
         break;
     case connector_callback_busy:
+    case connector_callback_unrecognized:
         *length = 0;
         break;
-    case connector_callback_unrecognized:
-        status = connector_callback_abort;
-        /* no break */
     case connector_callback_abort:
         break;
     case connector_callback_error:
@@ -164,6 +249,62 @@ STATIC connector_callback_status_t tcp_send_buffer(connector_data_t * const conn
     return status;
 }
 
+STATIC connector_callback_status_t tcp_send_buffer(connector_data_t * const connector_ptr, uint8_t const * const buffer, size_t * const length)
+{
+    connector_callback_status_t status;
+    connector_network_send_t send_data;
+    connector_request_id_t request_id;
+
+    send_data.buffer = buffer;
+    send_data.bytes_available = *length;
+    send_data.bytes_used = 0;
+    send_data.handle = connector_ptr->edp_data.network_handle;
+
+    request_id.network_request = connector_request_id_network_send;
+    status = connector_callback(connector_ptr->callback, connector_class_id_network_tcp, request_id, &send_data, connector_ptr->context);
+    ASSERT(status != connector_callback_unrecognized);
+    if (status == connector_callback_unrecognized)
+    {
+        status = connector_callback_abort;
+    }
+
+    return tcp_send_status(connector_ptr, status, send_data.bytes_used, length);
+}
+
+STATIC connector_callback_status_t tcp_send_vector(connector_data_t * const connector_ptr, size_t * const length)
+{
+    /* Gather all queued packets into one send. Returns connector_callback_unrecognized
+     * if the application does not support connector_request_id_network_send_iov.
+     */
+    connector_callback_status_t status;
+    connector_network_send_iov_t send_data;
+    connector_network_iovec_t iov[CONNECTOR_TCP_SEND_QUEUE_SIZE];
+    connector_request_id_t request_id;
+    size_t bytes_available = 0;
+    unsigned int i;
+
+    for (i = 0; i < connector_ptr->edp_data.send_packet.count; i++)
+    {
+        edp_send_entry_t const * const entry = tcp_send_entry(connector_ptr, i);
+
+        iov[i].buffer = entry->ptr + entry->bytes_sent;
+        iov[i].length = entry->total_length;
+        bytes_available += entry->total_length;
+    }
+
+    send_data.handle = connector_ptr->edp_data.network_handle;
+    send_data.iov = iov;
+    send_data.iov_count = connector_ptr->edp_data.send_packet.count;
+    send_data.bytes_available = bytes_available;
+    send_data.bytes_used = 0;
+
+    request_id.network_request = connector_request_id_network_send_iov;
+    status = connector_callback(connector_ptr->callback, connector_class_id_network_tcp, request_id, &send_data, connector_ptr->context);
+    ASSERT(send_data.bytes_used <= bytes_available);
+
+    return tcp_send_status(connector_ptr, status, send_data.bytes_used, length);
+}
+
 STATIC connector_status_t tcp_release_packet_buffer(connector_data_t * const connector_ptr, uint8_t const * const packet, connector_status_t const status, void * const user_data)
 {
     /* this is called when the Connector is done sending or after tcp_get_packet_buffer()
@@ -174,12 +315,92 @@ STATIC connector_status_t tcp_release_packet_buffer(connector_data_t * const con
     UNUSED_PARAMETER(packet);
     UNUSED_PARAMETER(user_data);
 
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+    if (connector_ptr->edp_data.send_packet.flight.open && connector_ptr->edp_data.send_packet.flight.count > 0)
+    {
+        /* drop the packet being built, the buffer still holds the ones of the flight */
+        ASSERT(packet == connector_ptr->edp_data.send_packet.packet_buffer.buffer + connector_ptr->edp_data.send_packet.flight.length);
+        goto done;
+    }
+#endif
+
     ASSERT(connector_ptr->edp_data.send_packet.packet_buffer.buffer == packet);
 
     connector_ptr->edp_data.send_packet.packet_buffer.in_use = connector_false;
 
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+done:
+#endif
     return connector_working;
 }
+
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+/* Room a packet of the flight may take, enough for the device type which is the largest
+ * handshake message with a bounded size.
+ */
+#define TCP_FLIGHT_PACKET_ROOM  (PACKET_EDP_HEADER_SIZE + PACKET_EDP_PROTOCOL_SIZE + 8 + DEVICE_TYPE_LENGTH)
+
+#define tcp_flight_length(connector_ptr)    ((connector_ptr)->edp_data.send_packet.flight.length)
+
+/* While a flight is open the packets are queued in the send packet buffer one after the
+ * other. tcp_close_flight() queues them as one packet which is sent with a single send.
+ */
+STATIC void tcp_open_flight(connector_data_t * const connector_ptr)
+{
+    ASSERT(!connector_ptr->edp_data.send_packet.flight.open);
+    ASSERT(connector_ptr->edp_data.send_packet.flight.count == 0);
+
+    connector_ptr->edp_data.send_packet.flight.open = connector_true;
+    connector_ptr->edp_data.send_packet.flight.length = 0;
+}
+
+STATIC connector_status_t tcp_flight_complete(connector_data_t * const connector_ptr, uint8_t const * const packet, connector_status_t const status, void * const user_data)
+{
+    connector_status_t result = connector_working;
+    unsigned int i;
+
+    UNUSED_PARAMETER(user_data);
+
+    /* every packet of the flight starts at the buffer as far as its complete callback is concerned */
+    for (i = 0; i < connector_ptr->edp_data.send_packet.flight.count; i++)
+    {
+        send_complete_cb_t const callback = connector_ptr->edp_data.send_packet.flight.message[i].complete_cb;
+
+        if (callback != NULL)
+        {
+            connector_status_t const message_result = callback(connector_ptr, packet, status, connector_ptr->edp_data.send_packet.flight.message[i].user_data);
+
+            if (result == connector_working)
+            {
+                result = message_result;
+            }
+        }
+    }
+
+    connector_ptr->edp_data.send_packet.flight.count = 0;
+    connector_ptr->edp_data.send_packet.flight.length = 0;
+
+    return result;
+}
+
+STATIC void tcp_close_flight(connector_data_t * const connector_ptr)
+{
+    connector_ptr->edp_data.send_packet.flight.open = connector_false;
+
+    if (connector_ptr->edp_data.send_packet.flight.count > 0)
+    {
+        /* tcp_get_packet_buffer() made sure there is room in the send queue for the first packet */
+        connector_status_t const status = tcp_queue_send_entry(connector_ptr, connector_ptr->edp_data.send_packet.packet_buffer.buffer,
+                                                               connector_ptr->edp_data.send_packet.flight.length, tcp_flight_complete, NULL);
+
+        UNUSED_VARIABLE(status);
+        ASSERT(status == connector_working);
+        connector_debug_line("tcp_close_flight: %u packets, %u bytes", connector_ptr->edp_data.send_packet.flight.count,
+                             (unsigned)connector_ptr->edp_data.send_packet.flight.length);
+    }
+}
+#endif
+
 #if (defined CONNECTOR_DEBUG)
 static unsigned int debug_count = 0;
 #endif
@@ -198,14 +419,31 @@ STATIC uint8_t * tcp_get_packet_buffer(connector_data_t * const connector_ptr, u
      */
 
 
-     /* make sure no send is pending */
-    if ((connector_ptr->edp_data.send_packet.total_length == 0) &&
+#if (defined CONNECTOR_TCP_HANDSHAKE_FLIGHT)
+    if (connector_ptr->edp_data.send_packet.flight.open && connector_ptr->edp_data.send_packet.flight.count > 0)
+    {
+        /* the packet follows the ones already in the flight if there is room for it */
+        size_t const flight_length = connector_ptr->edp_data.send_packet.flight.length;
+
+        if ((connector_ptr->edp_data.send_packet.flight.count < TCP_FLIGHT_MESSAGES) &&
+            (sizeof connector_ptr->edp_data.send_packet.packet_buffer.buffer - flight_length >= TCP_FLIGHT_PACKET_ROOM))
+        {
+            packet = connector_ptr->edp_data.send_packet.packet_buffer.buffer + flight_length;
+        }
+    }
+    else
+#endif
+     /* make sure the packet buffer is free and there is room to queue it */
+    if ((connector_ptr->edp_data.send_packet.count < CONNECTOR_TCP_SEND_QUEUE_SIZE) &&
         (!connector_ptr->edp_data.send_packet.packet_buffer.in_use))
     {
         connector_ptr->edp_data.send_packet.packet_buffer.in_use = connector_true;
 
         packet = connector_ptr->edp_data.send_packet.packet_buffer.buffer;
+    }
 
+    if (packet != NULL)
+    {
         /* set ptr to the data portion */
         ptr = GET_PACKET_DATA_POINTER(packet, PACKET_EDP_HEADER_SIZE);
 
@@ -217,11 +455,11 @@ STATIC uint8_t * tcp_get_packet_buffer(connector_data_t * const connector_ptr, u
 
         {
             size_t const max_packet_size = sizeof connector_ptr->edp_data.send_packet.packet_buffer.buffer;
-            size_t const header_size = (size_t)(ptr - packet);
+            size_t const data_offset = (size_t)(ptr - connector_ptr->edp_data.send_packet.packet_buffer.buffer);
 
             ASSERT(max_packet_size >= MIN_EDP_MESSAGE_SIZE);
             ASSERT(ptr > packet);
-            length = max_packet_size - header_size;
+            length = max_packet_size - data_offset;
         }
 #if (defined CONNECTOR_DEBUG)
         debug_count = 0;
@@ -282,15 +520,107 @@ done:
 STATIC connector_status_t tcp_send_complete_callback(connector_data_t * const connector_ptr, connector_status_t status)
 {
     connector_status_t result = connector_working;
-    send_complete_cb_t callback = connector_ptr->edp_data.send_packet.complete_cb;
 
-    if (callback != NULL)
+    if (connector_ptr->edp_data.send_packet.count > 0)
+    {
+        edp_send_entry_t * const entry = tcp_send_entry(connector_ptr, 0);
+        send_complete_cb_t const callback = entry->complete_cb;
+        uint8_t const * const packet = entry->ptr;
+        void * const user_data = entry->user_data;
+
+        /* dequeue before the callback since the callback may queue another packet */
+        entry->total_length = 0;
+        entry->complete_cb = NULL;
+        connector_ptr->edp_data.send_packet.head = (connector_ptr->edp_data.send_packet.head + 1) % CONNECTOR_TCP_SEND_QUEUE_SIZE;
+        connector_ptr->edp_data.send_packet.count--;
+
+        if (callback != NULL)
+        {
+            result = callback(connector_ptr, packet, status, user_data);
+            ASSERT(result != connector_pending);
+        }
+    }
+
+    return result;
+}
+
+STATIC void tcp_abort_send_queue(connector_data_t * const connector_ptr)
+{
+    unsigned int count = connector_ptr->edp_data.send_packet.count;
+
+    /* only abort the packets queued so far, not the ones queued by the callbacks */
+    while (count-- > 0)
+    {
+        tcp_send_complete_callback(connector_ptr, connector_abort);
+    }
+}
+
+/* Takes the packets queued with user_data off the send queue without calling their complete
+ * callbacks, so the owner of user_data can release it. A packet that has started to go out
+ * must be finished, together with the data that continues it. Returns connector_pending
+ * while such a packet is queued, its complete callback is called once it is sent.
+ * *cancelled is set to the number of entries taken off.
+ */
+STATIC connector_status_t tcp_cancel_send_entries(connector_data_t * const connector_ptr, void const * const user_data, unsigned int * const cancelled)
+{
+    connector_status_t status = connector_working;
+    unsigned int const count = connector_ptr->edp_data.send_packet.count;
+    unsigned int kept = 0;
+    connector_bool_t previous_started = connector_false;
+    unsigned int i;
+
+    ASSERT(user_data != NULL);
+    *cancelled = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        edp_send_entry_t const entry = *tcp_send_entry(connector_ptr, i);
+        connector_bool_t const started = connector_bool(((i == 0) && ((entry.bytes_sent > 0) || entry.continued)) ||
+                                                        (entry.continued && previous_started));
+
+        previous_started = started;
+        if (entry.user_data == user_data)
+        {
+            if (!started)
+            {
+                (*cancelled)++;
+                continue;
+            }
+            status = connector_pending;
+        }
+
+        if (kept != i)
+            *tcp_send_entry(connector_ptr, kept) = entry;
+        kept++;
+    }
+
+    connector_ptr->edp_data.send_packet.count = kept;
+
+    return status;
+}
+
+STATIC connector_status_t tcp_send_consume(connector_data_t * const connector_ptr, size_t length)
+{
+    connector_status_t result = connector_pending;
+
+    /* length may cover several queued packets when they were sent by one vectored send */
+    while ((length > 0) && tcp_is_send_active(connector_ptr))
     {
-        connector_ptr->edp_data.send_packet.complete_cb = NULL;
-        result = callback(connector_ptr, connector_ptr->edp_data.send_packet.ptr, status, connector_ptr->edp_data.send_packet.user_data);
-        ASSERT(result != connector_pending);
+        edp_send_entry_t * const entry = tcp_send_entry(connector_ptr, 0);
+        size_t const bytes = (length < entry->total_length) ? length : entry->total_length;
+
+        entry->total_length -= bytes;
+        entry->bytes_sent += bytes;
+        length -= bytes;
+
+        if (entry->total_length > 0) break;
+
+        /* sent completed so let's call the complete callback */
+        result = tcp_send_complete_callback(connector_ptr, connector_success);
+        if (result != connector_working) break;
     }
 
+    ASSERT(length == 0 || result != connector_working);
     return result;
 }
 
@@ -299,35 +629,40 @@ STATIC connector_status_t edp_tcp_send_process(connector_data_t * const connecto
     connector_status_t result = connector_idle;
 
     /* if nothing needs to be sent, check whether we need to send rx keepalive */
-    if (connector_ptr->edp_data.send_packet.total_length == 0)
+    if (!tcp_is_send_active(connector_ptr))
     {
 
         result = tcp_rx_keepalive_process(connector_ptr);
     }
 
-    if (connector_ptr->edp_data.send_packet.total_length > 0)
+    if (tcp_is_send_active(connector_ptr))
     {
         /* We have something to be sent */
+        connector_callback_status_t status = connector_callback_unrecognized;
+        size_t length = 0;
+
+        if ((connector_ptr->edp_data.send_packet.count > 1) && connector_ptr->edp_data.send_packet.vectored)
+        {
+            status = tcp_send_vector(connector_ptr, &length);
+            if (status == connector_callback_unrecognized)
+            {
+                connector_debug_line("edp_tcp_send_process: vectored send not supported, sending one packet at a time");
+                connector_ptr->edp_data.send_packet.vectored = connector_false;
+            }
+        }
 
-        uint8_t * const buf = connector_ptr->edp_data.send_packet.ptr + connector_ptr->edp_data.send_packet.bytes_sent;
-        size_t length = connector_ptr->edp_data.send_packet.total_length;
+        if (status == connector_callback_unrecognized)
+        {
+            edp_send_entry_t * const entry = tcp_send_entry(connector_ptr, 0);
 
-        connector_callback_status_t const status = tcp_send_buffer(connector_ptr, buf, &length);
+            length = entry->total_length;
+            status = tcp_send_buffer(connector_ptr, entry->ptr + entry->bytes_sent, &length);
+        }
 
         switch (status)
         {
             case connector_callback_continue:
-                connector_ptr->edp_data.send_packet.total_length -= length;
-                connector_ptr->edp_data.send_packet.bytes_sent += length;
-
-                if (connector_ptr->edp_data.send_packet.total_length == 0)
-                {   /* sent completed so let's call the complete callback */
-                    result = tcp_send_complete_callback(connector_ptr, connector_success);
-                }
-                else if (connector_ptr->edp_data.send_packet.total_length > 0)
-                {
-                    result = connector_pending;
-                }
+                result = tcp_send_consume(connector_ptr, length);
                 break;
 
             case connector_callback_busy:
@@ -352,5 +687,3 @@ done:
     return result;
 
 }
-
-
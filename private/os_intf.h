@@ -117,6 +117,43 @@ STATIC connector_status_t get_system_time(connector_data_t * const connector_ptr
     return result;
 }
 
+#if (defined CONNECTOR_DEBUG) && (defined CONNECTOR_TRANSPORT_TCP)
+/* Milliseconds from the optional up time callback, the seconds of get_system_time() without it */
+STATIC connector_status_t get_system_time_in_ms(connector_data_t * const connector_ptr, unsigned long * const uptime)
+{
+    connector_status_t result = connector_abort;
+
+    if (!connector_ptr->up_time_in_ms_unsupported)
+    {
+        connector_callback_status_t status;
+        connector_request_id_t request_id;
+        connector_os_system_up_time_t data;
+
+        request_id.os_request = connector_request_id_os_system_up_time_in_ms;
+        status = connector_callback(connector_ptr->callback, connector_class_id_operating_system, request_id, &data, connector_ptr->context);
+        switch (status)
+        {
+        case connector_callback_continue:
+            *uptime = data.sys_uptime;
+            result = connector_working;
+            goto done;
+        case connector_callback_unrecognized:
+            connector_ptr->up_time_in_ms_unsupported = connector_true;
+            break;
+        default:
+            *uptime = 0;
+            goto done;
+        }
+    }
+
+    result = get_system_time(connector_ptr, uptime);
+    *uptime *= 1000;
+
+done:
+    return result;
+}
+#endif
+
 #if !(defined CONNECTOR_NO_MALLOC)
 STATIC connector_status_t malloc_cb(connector_callback_t const callback, size_t const length, void ** ptr, void * const context)
 {
@@ -281,6 +318,28 @@ STATIC connector_status_t yield_process(connector_data_t * const connector_ptr,
     return result;
 }
 
+STATIC void wakeup_process(connector_data_t * const connector_ptr)
+{
+    /* Let a thread sleeping on the wait set know there is work to do.
+     * Not calling it again once the application says it's not supported.
+     * Any thread may get here through connector_initiate_action().
+     */
+    CONNECTOR_MEMORY_BARRIER();
+    if (!connector_ptr->wakeup_unsupported)
+    {
+        connector_request_id_t request_id;
+        connector_callback_status_t callback_status;
+
+        request_id.os_request = connector_request_id_os_wakeup;
+        callback_status = connector_callback(connector_ptr->callback, connector_class_id_operating_system, request_id, NULL, connector_ptr->context);
+        if (callback_status == connector_callback_unrecognized)
+        {
+            connector_ptr->wakeup_unsupported = connector_true;
+            CONNECTOR_MEMORY_BARRIER();
+        }
+    }
+}
+
 STATIC connector_status_t connector_reboot(connector_data_t * const connector_ptr)
 {
     connector_status_t result;
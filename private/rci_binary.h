@@ -25,6 +25,9 @@
 #include "rci_binary_group.h"
 #include "rci_binary_list.h"
 #include "rci_binary_element.h"
+#if (defined CONNECTOR_RCI_CACHE)
+#include "rci_binary_cache.h"
+#endif
 #include "rci_binary_callback.h"
 #include "rci_binary_output.h"
 #include "rci_binary_input.h"
@@ -87,6 +90,13 @@ STATIC connector_bool_t rci_action_session_start(rci_t * const rci, rci_service_
     invalidate_element_id(rci);
 
     rci->shared.callback_data.response.element_value = &rci->shared.value;
+#if (defined CONNECTOR_RCI_GROUP_PROCESS)
+    rci->shared.callback_data.response.element_values = NULL;
+#endif
+#if (defined CONNECTOR_RCI_CACHE)
+    rci->cache.entry = NULL;
+    rci->cache.enabled = connector_false;
+#endif
 
     rci->status = rci_status_busy;
     rci->error.command_error = connector_false;
@@ -160,6 +170,9 @@ STATIC connector_bool_t rci_action_session_active(rci_t * const rci)
             rci_set_buffer(&rci->buffer.output, &rci->service_data->output);
 #if defined RCI_DEBUG
             memset(rci->service_data->output.data, 0, rci->service_data->output.bytes);
+#endif
+#if (defined CONNECTOR_RCI_CACHE)
+            rci_cache_output_flushed(rci);
 #endif
             rci->status = rci_status_busy;
             break;
@@ -285,6 +298,9 @@ done:
 #endif
         break;
     case rci_status_flush_output:
+#if (defined CONNECTOR_RCI_CACHE)
+        rci_cache_capture(rci_internal_data);
+#endif
         rci_internal_data->service_data->output.bytes = rci_buffer_used(&rci_internal_data->buffer.output);
         break;
     case rci_status_complete:
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2018 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Query response cache.
+ *
+ * The serialized output of a whole group instance (group id, attributes, fields and
+ * field terminator) is copied into a cache entry while it is generated. A later query
+ * for the same group instance with the same attributes replays those bytes instead of
+ * calling the application. Entries expire after the TTL the group start callback
+ * returned and are dropped when the group is set or on connector_initiate_rci_cache_invalidate.
+ * The application only records invalidation requests, the cache itself is only touched by
+ * the connector thread.
+ */
+
+#define rci_cache_of(rci)   (&(rci)->service_data->connector_ptr->rci_cache)
+
+STATIC void rci_cache_invalidate(connector_rci_cache_t * const cache, connector_rci_cache_invalidate_t const * const request)
+{
+    unsigned int i;
+
+    for (i = 0; i < CONNECTOR_RCI_CACHE_ENTRIES; i++)
+    {
+        connector_rci_cache_entry_t * const entry = &cache->entry[i];
+
+        if (request == NULL || (entry->key.group_type == request->group_type && entry->key.group_id == request->group_id))
+        {
+            entry->valid = connector_false;
+        }
+    }
+}
+
+/*
+ * connector_initiate_rci_cache_invalidate runs on any of the application's threads, so it only
+ * records the request: the entries are dropped here, on the connector thread, before the next
+ * lookup. group_requests is odd while a group request writes group, a request finding it odd
+ * is recorded as a whole cache request instead. When more than one group request is pending,
+ * or one is being written while it is read, only the last group is known and every entry is dropped.
+ */
+STATIC void rci_cache_count_request(unsigned int volatile * const requests)
+{
+    unsigned int count;
+
+    do
+    {
+        count = *requests;
+    } while (!CONNECTOR_COMPARE_AND_SWAP(requests, count, count + 1));
+}
+
+STATIC void rci_cache_request_invalidate(connector_rci_cache_t * const cache, connector_rci_cache_invalidate_t const * const request)
+{
+    if (request != NULL)
+    {
+        unsigned int const group_requests = cache->invalidate.group_requests;
+
+        if ((group_requests & 1) == 0 && CONNECTOR_COMPARE_AND_SWAP(&cache->invalidate.group_requests, group_requests, group_requests + 1))
+        {
+            cache->invalidate.group = *request;
+            /* the group is visible before the request is seen complete */
+            CONNECTOR_MEMORY_BARRIER();
+            cache->invalidate.group_requests = group_requests + 2;
+            goto done;
+        }
+    }
+
+    rci_cache_count_request(&cache->invalidate.all_requests);
+
+done:
+    return;
+}
+
+#define rci_cache_invalidate_pending(cache) ((cache)->invalidate.all_requests != (cache)->invalidate.all_applied || \
+                                             (cache)->invalidate.group_requests != (cache)->invalidate.group_applied)
+
+STATIC void rci_cache_apply_invalidate(connector_rci_cache_t * const cache)
+{
+    unsigned int const all_requests = cache->invalidate.all_requests;
+    unsigned int const group_requests = cache->invalidate.group_requests;
+    connector_rci_cache_invalidate_t request;
+    connector_bool_t group_unchanged;
+
+    CONNECTOR_MEMORY_BARRIER();
+    request = cache->invalidate.group;
+    CONNECTOR_MEMORY_BARRIER();
+    group_unchanged = connector_bool(group_requests == cache->invalidate.group_requests);
+
+    if (all_requests != cache->invalidate.all_applied)
+    {
+        rci_cache_invalidate(cache, NULL);
+    }
+    else if (group_requests != cache->invalidate.group_applied)
+    {
+        /* one complete request since the last one applied, which may have been seen while written */
+        connector_bool_t const one_request = connector_bool((group_requests & 1) == 0 && (group_requests - cache->invalidate.group_applied) <= 2);
+
+        rci_cache_invalidate(cache, (one_request && group_unchanged) ? &request : NULL);
+    }
+
+    cache->invalidate.all_applied = all_requests;
+    cache->invalidate.group_applied = group_requests;
+}
+
+STATIC void rci_cache_invalidate_group(rci_t * const rci)
+{
+    connector_rci_cache_invalidate_t request;
+
+    request.group_type = rci->shared.callback_data.group.type;
+    request.group_id = get_group_id(rci);
+
+    rci_cache_invalidate(rci_cache_of(rci), &request);
+}
+
+STATIC void rci_cache_action_start(rci_t * const rci)
+{
+    rci->cache.entry = NULL;
+    rci->cache.enabled = connector_false;
+
+    if (rci->shared.callback_data.action == connector_remote_action_query)
+    {
+        connector_status_t const status = get_system_time(rci->service_data->connector_ptr, &rci->cache.now);
+
+        rci->cache.enabled = connector_bool(status == connector_working);
+    }
+}
+
+STATIC connector_bool_t rci_cache_group_is_cacheable(rci_t const * const rci)
+{
+    connector_bool_t cacheable = connector_false;
+
+    if (!rci->cache.enabled) goto done;
+#if (defined RCI_PARSER_USES_LIST)
+    if (get_list_depth(rci) != 0) goto done;
+#endif
+    if (!have_group_instance(rci) || get_group_instance(rci) == 0) goto done;
+#if (defined RCI_PARSER_USES_VARIABLE_GROUP)
+    /* instances of variable groups come and go under the application's lock */
+    if (group_is_dynamic(rci)) goto done;
+#endif
+
+    cacheable = connector_true;
+
+done:
+    return cacheable;
+}
+
+STATIC void rci_cache_make_key(rci_t const * const rci, connector_rci_cache_key_t * const key)
+{
+    connector_remote_config_t const * const remote_config = &rci->shared.callback_data;
+
+    key->group_type = remote_config->group.type;
+    key->group_id = get_group_id(rci);
+    key->instance = get_group_instance(rci);
+
+    if (remote_config->group.type == connector_remote_group_setting)
+    {
+        key->source = remote_config->attribute.source;
+        key->compare_to = remote_config->attribute.compare_to;
+    }
+    else
+    {
+        key->source = rci_query_setting_attribute_source_current;
+        key->compare_to = rci_query_setting_attribute_compare_to_none;
+    }
+}
+
+#define rci_cache_key_matches(a, b) ((a)->group_type == (b)->group_type && (a)->group_id == (b)->group_id && \
+                                     (a)->instance == (b)->instance && (a)->source == (b)->source && (a)->compare_to == (b)->compare_to)
+
+#define rci_cache_entry_is_live(entry, now)    ((entry)->valid && (now) < (entry)->expires)
+
+/*
+ * Called when a query reaches a new group instance. Returns connector_true and points
+ * the output at the cached bytes on a hit. On a miss an entry is picked to capture the
+ * output that is about to be generated.
+ */
+STATIC connector_bool_t rci_cache_group_start(rci_t * const rci)
+{
+    connector_rci_cache_t * const cache = rci_cache_of(rci);
+    connector_rci_cache_entry_t * victim = NULL;
+    connector_rci_cache_key_t key;
+    connector_bool_t hit = connector_false;
+    unsigned int i;
+
+    rci->cache.entry = NULL;
+    if (!rci_cache_group_is_cacheable(rci)) goto done;
+
+    rci_cache_apply_invalidate(cache);
+    rci_cache_make_key(rci, &key);
+
+    for (i = 0; i < CONNECTOR_RCI_CACHE_ENTRIES; i++)
+    {
+        connector_rci_cache_entry_t * const entry = &cache->entry[i];
+        connector_bool_t const live = rci_cache_entry_is_live(entry, rci->cache.now);
+
+        if (live && rci_cache_key_matches(&entry->key, &key))
+        {
+            cache->hits++;
+            rci->output.content.data = entry->data;
+            rci->output.content.length = entry->length;
+            hit = connector_true;
+            goto done;
+        }
+
+        if (victim == NULL || (!live && rci_cache_entry_is_live(victim, rci->cache.now)) ||
+            (live == rci_cache_entry_is_live(victim, rci->cache.now) && entry->expires < victim->expires))
+        {
+            victim = entry;
+        }
+    }
+
+    cache->misses++;
+    victim->valid = connector_false;
+    victim->key = key;
+    victim->length = 0;
+    rci->cache.entry = victim;
+    rci->cache.mark = rci_buffer_position(&rci->buffer.output);
+
+done:
+    return hit;
+}
+
+/* Copies the output generated since the last call into the entry being filled */
+STATIC void rci_cache_capture(rci_t * const rci)
+{
+    connector_rci_cache_entry_t * const entry = rci->cache.entry;
+
+    if (entry != NULL)
+    {
+        uint8_t const * const position = rci_buffer_position(&rci->buffer.output);
+        size_t const bytes = (size_t)(position - rci->cache.mark);
+
+        if (entry->length + bytes > sizeof entry->data)
+        {
+            rci->cache.entry = NULL;
+        }
+        else
+        {
+            memcpy(entry->data + entry->length, rci->cache.mark, bytes);
+            entry->length += bytes;
+            rci->cache.mark = position;
+        }
+    }
+}
+
+STATIC void rci_cache_output_flushed(rci_t * const rci)
+{
+    rci->cache.mark = rci_buffer_position(&rci->buffer.output);
+}
+
+STATIC void rci_cache_drop_capture(rci_t * const rci)
+{
+    rci->cache.entry = NULL;
+}
+
+/* Called once the group end callback of a query completed without error */
+STATIC void rci_cache_group_end(rci_t * const rci)
+{
+    rci_cache_capture(rci);
+
+    if (rci->cache.entry != NULL)
+    {
+        unsigned long const ttl = rci->shared.callback_data.response.cache_ttl;
+
+        /* the response may predate an invalidation requested while it was generated */
+        if (ttl > 0 && !rci_cache_invalidate_pending(rci_cache_of(rci)))
+        {
+            rci->cache.entry->expires = rci->cache.now + ttl;
+            rci->cache.entry->valid = connector_true;
+        }
+        rci->cache.entry = NULL;
+    }
+}
@@ -36,6 +36,9 @@ STATIC void rci_error(rci_t * const rci, unsigned int const id, char const * con
     rci->shared.callback_data.response.error_hint = hint;
 
     rci->error.description = description;
+#if (defined CONNECTOR_RCI_CACHE)
+    rci_cache_drop_capture(rci);
+#endif
 }
 
 #if defined RCI_PARSER_USES_ERROR_DESCRIPTIONS
@@ -196,6 +199,9 @@ STATIC void trigger_rci_callback(rci_t * const rci, connector_request_id_remote_
 #endif
                 break;
         }
+#if (defined CONNECTOR_RCI_CACHE)
+        rci_cache_action_start(rci);
+#endif
         break;
     case connector_request_id_remote_config_action_end:
         break;
@@ -239,6 +245,16 @@ STATIC void trigger_rci_callback(rci_t * const rci, connector_request_id_remote_
 #endif
         }
         prepare_group_info(rci, collection_type);
+#if (defined CONNECTOR_RCI_GROUP_PROCESS)
+        rci->shared.callback_data.response.element_values = NULL;
+#endif
+#if (defined CONNECTOR_RCI_CACHE)
+        rci->shared.callback_data.response.cache_ttl = CONNECTOR_RCI_CACHE_DEFAULT_TTL;
+        if (is_set_command(rci->shared.callback_data.action))
+        {
+            rci_cache_invalidate_group(rci);
+        }
+#endif
         break;
     }
 
@@ -824,6 +840,11 @@ STATIC connector_bool_t rci_callback(rci_t * const rci)
             reset_input_content(rci);
         }
 
+#if (defined CONNECTOR_RCI_CACHE)
+        if (remote_config->error_id != connector_success)
+            rci_cache_drop_capture(rci);
+#endif
+
         switch (remote_config_request)
         {
 #if (defined RCI_PARSER_USES_VARIABLE_GROUP)
@@ -878,6 +899,10 @@ STATIC connector_bool_t rci_callback(rci_t * const rci)
                 break;
 #endif
             case connector_request_id_remote_config_group_end:
+#if (defined CONNECTOR_RCI_CACHE)
+                if (remote_config->error_id == connector_success)
+                    rci_cache_group_end(rci);
+#endif
                 break;
             case connector_request_id_remote_config_element_process:
 #if (defined RCI_PARSER_USES_ELEMENT_NAMES)
@@ -92,6 +92,9 @@ static char const * rci_output_state_t_as_string(rci_output_state_t const value)
         enum_to_case(rci_output_state_group_terminator);
 #if (defined RCI_LEGACY_COMMANDS)
         enum_to_case(rci_output_state_do_command_payload);
+#endif
+#if (defined CONNECTOR_RCI_CACHE)
+        enum_to_case(rci_output_state_cached_group);
 #endif
         enum_to_case(rci_output_state_response_done);
         enum_to_case(rci_output_state_done);
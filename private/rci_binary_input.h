@@ -87,9 +87,51 @@ STATIC void reset_input_content(rci_t * const rci)
 #define BINARY_RCI_ONE_BYTE_LIMIT_MASK  UINT32_C(0x7F)
 #define BINARY_RCI_HI_BYTE_MASK         UINT32_C(0x1F)
 
+/* decodes a BER the fast path found whole in the input buffer; get_modifier_ber()
+ * keeps its own copy of this switch, calling out from it slowed down small fragments */
+STATIC uint32_t decode_modifier_ber(uint8_t const * const rci_ber, size_t const ber_bytes)
+{
+    uint8_t const modifier_ber = message_load_u8(rci_ber, value);
+    uint32_t value;
+
+    switch (ber_bytes)
+    {
+        case record_bytes(rci_ber):
+            value =  (modifier_ber & BINARY_RCI_SIZE_ALTERNATE_FLAG) ? modifier_ber : (modifier_ber & BINARY_RCI_ONE_BYTE_LIMIT_MASK);
+            break;
+        case record_bytes(rci_ber_u8):
+        {
+            uint8_t const * const rci_ber_u8 = rci_ber;
+            /* mask of the 1st byte for data value */
+            value = (modifier_ber & BINARY_RCI_HI_BYTE_MASK) << 8;
+            value |= message_load_u8(rci_ber_u8, value);
+            break;
+        }
+        case record_bytes(rci_ber_u16):
+        {
+            uint8_t const * const rci_ber_u16 = rci_ber;
+            value = message_load_be16(rci_ber_u16, value);
+            break;
+        }
+        case record_bytes(rci_ber_u32):
+        {
+            uint8_t const * const rci_ber_u32 = rci_ber;
+            value = message_load_be32(rci_ber_u32, value);
+            break;
+        }
+        default:
+            ASSERT(ber_bytes == 1);
+            /* NONUM or TRM value */
+            value = modifier_ber;
+            break;
+    }
+
+    return value;
+}
+
 STATIC size_t get_modifier_ber(rci_t * const rci, uint32_t * const value)
 {
-    uint8_t * const rci_ber = rci->shared.content.data;
+    uint8_t const * const rci_ber = rci->shared.content.data;
     uint8_t const modifier_ber = message_load_u8(rci_ber, value);
     size_t const bytes_to_follow = get_bytes_to_follow(modifier_ber) + 1;
     size_t bytes_read = 0;
@@ -107,7 +149,7 @@ STATIC size_t get_modifier_ber(rci_t * const rci, uint32_t * const value)
             break;
         case record_bytes(rci_ber_u8):
         {
-            uint8_t * const rci_ber_u8 = rci_ber;
+            uint8_t const * const rci_ber_u8 = rci_ber;
             /* mask of the 1st byte for data value */
             *value = (modifier_ber & BINARY_RCI_HI_BYTE_MASK) << 8;
             *value |= message_load_u8(rci_ber_u8, value);
@@ -115,13 +157,13 @@ STATIC size_t get_modifier_ber(rci_t * const rci, uint32_t * const value)
         }
         case record_bytes(rci_ber_u16):
         {
-            uint8_t * const rci_ber_u16 = rci_ber;
+            uint8_t const * const rci_ber_u16 = rci_ber;
             *value = message_load_be16(rci_ber_u16, value);
             break;
         }
         case record_bytes(rci_ber_u32):
         {
-            uint8_t * const rci_ber_u32 = rci_ber;
+            uint8_t const * const rci_ber_u32 = rci_ber;
             *value = message_load_be32(rci_ber_u32, value);
             break;
         }
@@ -1861,12 +1903,149 @@ done:
 }
 #endif
 
+STATIC size_t rci_input_item_bytes(rci_t const * const rci, uint8_t const * const data, size_t const bytes_available)
+{
+    size_t const ber_bytes = get_bytes_to_follow(data[0]) + 1;
+    size_t item_bytes = 0;
+
+    /* only the BER sizes get_modifier_ber() decodes as numbers take the fast path */
+    if ((ber_bytes > record_bytes(rci_ber_u32)) || (ber_bytes > bytes_available))
+    {
+        goto done;
+    }
+
+    switch (rci->input.state)
+    {
+        case rci_input_state_group_id:
+        case rci_input_state_field_id:
+        case rci_input_state_field_type:
+            item_bytes = ber_bytes;
+            break;
+
+        case rci_input_state_field_no_value:
+            if (has_rci_no_value(data[0]))
+            {
+                goto done;
+            }
+            /* fall through */
+        case rci_input_state_field_value:
+        {
+            connector_item_t const * const element = get_current_element(rci);
+
+            switch (element->type)
+            {
+#if defined RCI_PARSER_USES_STRINGS
+
+#if defined RCI_PARSER_USES_STRING
+            case connector_element_type_string:
+#endif
+
+#if defined RCI_PARSER_USES_MULTILINE_STRING
+            case connector_element_type_multiline_string:
+#endif
+
+#if defined RCI_PARSER_USES_PASSWORD
+            case connector_element_type_password:
+#endif
+
+#if defined RCI_PARSER_USES_FQDNV4
+            case connector_element_type_fqdnv4:
+#endif
+
+#if defined RCI_PARSER_USES_FQDNV6
+            case connector_element_type_fqdnv6:
+#endif
+
+#if defined RCI_PARSER_USES_DATETIME
+            case connector_element_type_datetime:
+#endif
+
+#if defined RCI_PARSER_USES_REF_ENUM
+            case connector_element_type_ref_enum:
+#endif
+#endif
+
+#if defined RCI_PARSER_USES_IPV4
+            case connector_element_type_ipv4:
+#endif
+
+#if defined RCI_PARSER_USES_MAC_ADDR
+            case connector_element_type_mac_addr:
+#endif
+            {
+                uint32_t const length = decode_modifier_ber(data, ber_bytes);
+
+                if (length <= bytes_available - ber_bytes)
+                {
+                    item_bytes = ber_bytes + length;
+                }
+                break;
+            }
+
+#if (defined RCI_PARSER_USES_LIST)
+            case connector_element_type_list:
+                break;
+#endif
+
+            default:
+                item_bytes = ber_bytes;
+                break;
+            }
+            break;
+        }
+
+        default:
+            /* commands and attributes stay on the byte at a time path */
+            break;
+    }
+
+done:
+    return item_bytes;
+}
+
+/* below this many bytes per fragment most items are split across fragments:
+ * those stay on the byte at a time path, copied into storage, since measuring
+ * them and moving back to the input buffer costs more than it saves */
+#define RCI_INPUT_WHOLE_ITEM_MIN_FRAGMENT   64
+
+STATIC void rci_input_whole_item(rci_t * const rci)
+{
+    rci_buffer_t * const input = &rci->buffer.input;
+    uint8_t * const position = rci_buffer_position(input);
+
+    if ((rci->input.destination != position) && destination_in_storage(rci))
+    {
+        /* the item split across the previous fragment is done, go back to parsing in place */
+        rci->input.destination = position;
+        reset_input_content(rci);
+    }
+
+    if ((rci->input.destination == position) && (rci_buffer_remaining(input) > 1))
+    {
+        size_t const item_bytes = rci_input_item_bytes(rci, position, rci_buffer_remaining(input));
+
+        if (item_bytes > 1)
+        {
+            /* whole item is in the input buffer: skip to its last byte so
+             * the state handler decodes it in one call */
+            rci->shared.content.length = item_bytes - 1;
+            rci->input.destination += item_bytes - 1;
+            rci_buffer_advance(input, item_bytes - 1);
+        }
+    }
+}
+
 STATIC void rci_parse_input(rci_t * const rci)
 {
     rci_buffer_t * const input = &rci->buffer.input;
+    connector_bool_t const whole_items = connector_bool((rci_buffer_used(input) + rci_buffer_remaining(input)) >= RCI_INPUT_WHOLE_ITEM_MIN_FRAGMENT);
 
     while ((rci->parser.state == rci_parser_state_input) && (rci_buffer_remaining(input) != 0))
     {
+        if (whole_items && (rci->shared.content.length == 0))
+        {
+            rci_input_whole_item(rci);
+        }
 
         if (rci->input.destination != rci_buffer_position(&rci->buffer.input))
         {
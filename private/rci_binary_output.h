@@ -1319,6 +1319,31 @@ STATIC void rci_output_do_command_payload(rci_t * const rci)
 }
 #endif
 
+#if (defined CONNECTOR_RCI_CACHE)
+STATIC void rci_output_cached_group(rci_t * const rci)
+{
+    rci_buffer_t * const output = &rci->buffer.output;
+    size_t const bytes_available = rci_buffer_remaining(output);
+    size_t const write_bytes = (rci->output.content.length < bytes_available) ? rci->output.content.length : bytes_available;
+
+    memcpy(rci_buffer_position(output), rci->output.content.data, write_bytes);
+    rci_buffer_advance(output, write_bytes);
+    rci->output.content.data += write_bytes;
+    rci->output.content.length -= write_bytes;
+
+    if (rci->output.content.length > 0)
+    {
+        rci->status = rci_status_flush_output;
+    }
+    else
+    {
+        clear_rcistr(&rci->output.content);
+        set_rci_output_state(rci, rci_output_state_field_terminator);
+        state_call(rci, rci_parser_state_traverse);
+    }
+}
+#endif
+
 STATIC void rci_output_field_terminator(rci_t * const rci)
 {
     connector_bool_t overflow = connector_false;
@@ -1452,6 +1477,12 @@ STATIC void rci_generate_output(rci_t * const rci)
                 break;
 #endif
 
+#if (defined CONNECTOR_RCI_CACHE)
+            case rci_output_state_cached_group:
+                rci_output_cached_group(rci);
+                break;
+#endif
+
             case rci_output_state_field_terminator:
                 rci_output_field_terminator(rci);
                 break;
@@ -268,6 +268,9 @@ typedef enum
     rci_output_state_group_terminator,
 #if (defined RCI_LEGACY_COMMANDS)
     rci_output_state_do_command_payload,
+#endif
+#if (defined CONNECTOR_RCI_CACHE)
+    rci_output_state_cached_group,
 #endif
     rci_output_state_response_done,
     rci_output_state_done
@@ -427,6 +430,15 @@ typedef struct rci
         connector_bool_t element_skip;
     } output;
 
+#if (defined CONNECTOR_RCI_CACHE)
+    struct {
+        connector_rci_cache_entry_t * entry;    /* entry being filled with the output of the current group instance */
+        uint8_t const * mark;                   /* output not copied into the entry yet */
+        connector_bool_t enabled;
+        unsigned long now;
+    } cache;
+#endif
+
     struct {
         rci_error_state_t state;
         connector_bool_t command_error;
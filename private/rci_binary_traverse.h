@@ -308,6 +308,20 @@ done:
 }
 #endif
 
+#if (defined CONNECTOR_RCI_GROUP_PROCESS)
+STATIC connector_bool_t group_values_are_supplied(rci_t const * const rci)
+{
+    connector_remote_config_t const * const remote_config = &rci->shared.callback_data;
+
+    return connector_bool(remote_config->action == connector_remote_action_query &&
+                          remote_config->response.element_values != NULL
+#if (defined RCI_PARSER_USES_LIST)
+                          && get_list_depth(rci) == 0
+#endif
+                          );
+}
+#endif
+
 STATIC connector_bool_t traverse_element_id(rci_t * const rci)
 {
     connector_bool_t done = connector_false;
@@ -357,6 +371,17 @@ STATIC connector_bool_t traverse_element_id(rci_t * const rci)
         goto done;
     }
 
+#if (defined CONNECTOR_RCI_GROUP_PROCESS)
+    if (group_values_are_supplied(rci))
+    {
+        /* values were filled in by the group start callback, output them without an element callback */
+        rci->shared.value = rci->shared.callback_data.response.element_values[get_element_id(rci)];
+        set_rci_output_state(rci, rci_output_state_field_id);
+        state_call(rci, rci_parser_state_output);
+        goto done;
+    }
+#endif
+
     trigger_rci_callback(rci, connector_request_id_remote_config_element_process);
     set_rci_output_state(rci, rci_output_state_field_id);
     state_call(rci, rci_parser_state_output);
@@ -544,10 +569,42 @@ STATIC void traverse_element(rci_t * const rci)
     }
 }
 
+#if (defined CONNECTOR_RCI_CACHE)
+STATIC connector_bool_t traverse_cached_group(rci_t * const rci)
+{
+    connector_bool_t const hit = rci_cache_group_start(rci);
+
+    if (hit)
+    {
+        /* replay the group instance and carry on as finish_all_elements() would after group end */
+        SET_RCI_SHARED_FLAG(rci, RCI_SHARED_FLAG_ALL_ELEMENTS, connector_false);
+        invalidate_element_id(rci);
+
+        if (should_traverse_all_group_instances(rci))
+            set_rci_traverse_state(rci, rci_traverse_state_all_group_instances);
+        else
+            set_rci_traverse_state(rci, rci_traverse_state_none);
+
+        set_rci_output_state(rci, rci_output_state_cached_group);
+        state_call(rci, rci_parser_state_output);
+    }
+
+    return hit;
+}
+#endif
+
 STATIC void traverse_all_elements(rci_t * const rci)
 {
     if (!have_element_id(rci))
     {
+#if (defined CONNECTOR_RCI_CACHE)
+#if (defined RCI_PARSER_USES_LIST)
+        if (get_list_depth(rci) == 0)
+#endif
+        {
+            if (traverse_cached_group(rci)) goto done;
+        }
+#endif
         SET_RCI_SHARED_FLAG(rci, RCI_SHARED_FLAG_FIRST_ELEMENT, connector_true);
         set_element_id(rci, 0);
     }
@@ -78,6 +78,7 @@ enum fw_message {
 typedef struct {
     connector_data_t * connector_ptr;
     connector_bool_t send_busy;
+    connector_bool_t response_queued;
     size_t  response_size;
     uint8_t response_buffer[FW_MESSAGE_RESPONSE_MAX_SIZE + PACKET_EDP_FACILITY_SIZE];
 } connector_firmware_data_t;
@@ -105,13 +106,27 @@ STATIC uint32_t rci_get_firmware_target_zero_version(connector_data_t const * co
     return connector_ptr->rci_data->firmware_target_zero_version;
 }
 
+STATIC connector_status_t fw_response_sent(connector_data_t * const connector_ptr, uint8_t const * const packet, connector_status_t const status, void * const user_data)
+{
+    connector_firmware_data_t * const fw_ptr = user_data;
+
+    UNUSED_PARAMETER(connector_ptr);
+    UNUSED_PARAMETER(packet);
+    UNUSED_PARAMETER(status);
+
+    fw_ptr->response_queued = connector_false;
+    return connector_working;
+}
+
 STATIC connector_status_t send_fw_message(connector_firmware_data_t * const fw_ptr)
 {
 
     connector_status_t status;
 
-    status = tcp_initiate_send_facility_packet(fw_ptr->connector_ptr, fw_ptr->response_buffer, fw_ptr->response_size, E_MSG_FAC_FW_NUM, NULL, NULL);
+    status = tcp_initiate_send_facility_packet(fw_ptr->connector_ptr, fw_ptr->response_buffer, fw_ptr->response_size, E_MSG_FAC_FW_NUM, fw_response_sent, fw_ptr);
     fw_ptr->send_busy = (status == connector_pending) ? connector_true : connector_false;
+    if (status == connector_working)
+        fw_ptr->response_queued = connector_true;
     return status;
 
 }
@@ -385,6 +400,13 @@ STATIC connector_status_t fw_process(connector_data_t * const connector_ptr, voi
         goto done;
     }
 
+    if (fw_ptr->response_queued)
+    {
+        /* keep the packet until the previous response in the response buffer is sent */
+        status = connector_pending;
+        goto done;
+    }
+
     if (fw_ptr->send_busy == connector_true)
     {
         /* callback is already called for this message.
@@ -492,6 +514,7 @@ STATIC connector_status_t connector_facility_firmware_init(connector_data_t * co
     }
 
     fw_ptr->send_busy = connector_false;
+    fw_ptr->response_queued = connector_false;
     fw_ptr->connector_ptr = connector_ptr;
 
 done:
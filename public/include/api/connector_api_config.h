@@ -65,6 +65,7 @@ typedef enum {
     connector_request_id_config_sm_sms_rx_timeout,      /**< Requesting callback to obtain timeout in seconds for incoming SMS Short Messaging sessions. */
     connector_request_id_config_rci_descriptor_data,    /**< Requesting callback to obtain Remote Configuration Interface descriptor data see @ref rci_descriptor_data. */
     connector_request_id_config_streaming_cli,
+    connector_request_id_config_msg_receive_window,     /**< Requesting callback to obtain the initial and maximum messaging receive window. */
 #if (defined CONNECTOR_TRANSPORT_UDP) || (defined CONNECTOR_TRANSPORT_SMS)
     connector_request_id_config_sm_key_distribution
 #endif
@@ -390,6 +391,23 @@ typedef struct {
 * @}
 */
 
+/**
+* @defgroup connector_config_msg_receive_window_t Messaging Receive Window Configuration
+* @{
+*/
+/**
+* Messaging receive window configuration for @ref connector_request_id_config_msg_receive_window callback.
+*
+* @see @ref msg_receive_window
+**/
+typedef struct {
+    uint32_t initial;   /**< Window in bytes advertised to Device Cloud and used to start every session */
+    uint32_t maximum;   /**< Largest window in bytes a session may grow to */
+} connector_config_msg_receive_window_t;
+/**
+* @}
+*/
+
 /**
 * @defgroup connector_config_sm_max_sessions_t Short Messaging Maximum Sessions
 * @{
@@ -332,6 +332,27 @@ typedef struct
 * @}
 */
 
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+/**
+* @defgroup connector_data_point_format_t Encoding used to upload data points.
+* @{
+*/
+/**
+* Selects how the streams of a connector_request_data_point_t request are encoded on the wire.
+*
+* @see connector_request_data_point_t
+* @see @ref columnar_format
+*/
+typedef enum
+{
+    connector_data_point_format_csv,      /**< one CSV line per data point (default) */
+    connector_data_point_format_columnar  /**< compact binary encoding with delta coded time and value columns */
+} connector_data_point_format_t;
+/**
+* @}
+*/
+#endif
+
 /**
 * @defgroup connector_request_data_point_t  Data points of multiple streams.
 * @{
@@ -357,6 +378,9 @@ typedef struct
     connector_data_stream_t * stream;   /**< pointer to list of data streams */
     connector_bool_t response_required; /**< set to connector_true if response is needed */
     unsigned long timeout_in_seconds;   /**< outgoing sessions timeout in seconds. Only valid for SM. Use SM_WAIT_FOREVER to wait forever for the complete request/response */
+#if (defined CONNECTOR_DATA_POINTS_COLUMNAR)
+    connector_data_point_format_t format; /**< wire encoding of the streams, see @ref columnar_format */
+#endif
 } connector_request_data_point_t;
 /**
 * @}
@@ -117,6 +117,11 @@ typedef struct
 * The callback data with request ID connector_request_id_data_service_send_data will point to this structure.
 * The callback is called to get user data to send to Device Cloud. The callback will be called again if more_data
 * field is set to connector_true. The bytes_used cannot exceed the bytes_available.
+*
+* Instead of copying the data to buffer, the callback may point external_buffer to bytes_used bytes
+* of its own memory. That memory must stay valid and unchanged until the send completes. The next callback
+* for this request, data, response or status, is only made once it has been sent or taken off the send queue,
+* so the memory may be released from there.
 */
 typedef struct
 {
@@ -127,6 +132,7 @@ typedef struct
     size_t CONST bytes_available;           /**< available bytes in buffer */
     size_t bytes_used;                      /**< bytes filled */
     connector_bool_t more_data;             /**< set to connector_true if more data to send */
+    void const * external_buffer;           /**< NULL, or set to the bytes_used bytes to send when they are not copied to buffer */
 } connector_data_service_send_data_t;
 /**
 * @}
@@ -259,6 +265,23 @@ typedef struct
 * @}
 */
 
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+/**
+* @defgroup connector_device_request_handler_t  Device request target handler
+* @{
+*/
+/**
+* Handler registered for one target with connector_register_device_request_target(). It is called
+* instead of the application callback for the connector_request_id_data_service_receive_target,
+* receive_data, receive_reply_data and receive_status requests of that target. data points to the
+* same structures the application callback gets and context is the context given at registration.
+*/
+typedef connector_callback_status_t (* connector_device_request_handler_t)(connector_request_id_data_service_t const request_id, void * const data, void * const context);
+/**
+* @}
+*/
+#endif
+
 #endif
 
 #if !defined _CONNECTOR_API_H
@@ -262,6 +262,7 @@ typedef struct
     void * CONST buffer;                        /**< A pointer to memory, where callback writes data */
     size_t CONST bytes_available;               /**< Size of a memory buffer */
     size_t bytes_used;                          /**< Number of bytes read from a file and copied to memory buffer */
+    void const * external_buffer;               /**< NULL, or set to the bytes_used bytes read when they are not copied to buffer */
 
 } connector_file_system_read_t;
 /**
@@ -246,6 +246,31 @@ typedef struct {
 /**
 * @}
 */
+
+#if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+/**
+* @defgroup connector_firmware_write_complete_t Firmware Block Write Complete Structure
+* @{
+*/
+/**
+* Firmware block write complete structure used on @ref connector_initiate_firmware_write_complete in
+* @ref connector_initiate_action API to report that a block passed to the
+* connector_request_id_firmware_download_data callback has been written.
+*
+* The report may be made from any thread, but from one thread at a time. It is applied on Cloud
+* Connector's thread, where a report for a block that is not waiting for its write is ignored.
+* connector_initiate_action returns connector_service_busy while CONNECTOR_FIRMWARE_PIPELINE_BLOCKS
+* earlier reports have not been applied yet.
+*/
+typedef struct {
+    unsigned int target_number;         /**< Target number the block was downloaded for */
+    uint32_t offset;                    /**< Offset of the written block, as passed in the download data callback */
+    connector_firmware_status_t status; /**< connector_firmware_status_success or the error found writing the block */
+} connector_firmware_write_complete_t;
+/**
+* @}
+*/
+#endif
 #endif
 
 #if !defined _CONNECTOR_API_H
@@ -36,7 +36,8 @@ typedef enum {
     connector_request_id_network_open,     /**< Requesting callback to set up and make connection to Device Cloud */
     connector_request_id_network_send,     /**< Requesting callback to send data to Device Cloud */
     connector_request_id_network_receive,  /**< Requesting callback to receive data from Device Cloud */
-    connector_request_id_network_close     /**< Requesting callback to close Device Cloud connection */
+    connector_request_id_network_close,    /**< Requesting callback to close Device Cloud connection */
+    connector_request_id_network_send_iov  /**< Requesting callback to send several buffers to Device Cloud at once (TCP only, optional) */
 } connector_request_id_network_t;
 /**
 * @}
@@ -56,6 +57,7 @@ typedef struct  {
         char const * CONST phone;    /**< Pointer to Device Cloud Phone Number where to send SMSs. Used for SMS transport */
     } device_cloud;  /**< Device Cloud information */
     connector_network_handle_t handle;      /**< Application defined network handle associated with the connection */
+    connector_bool_t wait_for_receive;      /**< Set with connector_callback_busy when the connection waits for data from Device Cloud, such as during a TLS handshake, rather than for the connect to complete (TCP only) */
 } connector_network_open_t;
 /**
 * @}
@@ -78,6 +80,43 @@ typedef struct  {
 * @}
 */
 
+/**
+* @defgroup connector_network_iovec_t Network I/O Vector
+* @{
+*/
+/**
+* One buffer of a @ref connector_network_send_iov_t vectored send request.
+*/
+typedef struct  {
+    void const * buffer;                        /**< Pointer to data to be sent */
+    size_t length;                              /**< Number of bytes in the buffer */
+} connector_network_iovec_t;
+/**
+* @}
+*/
+
+/**
+* @defgroup connector_network_send_iov_t Network Vectored Send Data Structure
+* @{
+*/
+/**
+* Send data structure for @ref connector_request_id_network_send_iov callback which is called to send
+* several queued packets to Device Cloud in one call. The buffers must be sent in order, as one stream.
+*
+* This request is optional. When the callback returns @ref connector_callback_unrecognized, Cloud Connector
+* uses @ref connector_request_id_network_send for the rest of the connection.
+*/
+typedef struct  {
+    connector_network_handle_t CONST handle;    /**< Network handle associated with a connection through the connector_network_open callback */
+    connector_network_iovec_t const * CONST iov; /**< Array of buffers to be sent */
+    size_t CONST iov_count;                     /**< Number of buffers in the iov array */
+    size_t CONST bytes_available;               /**< Total number of bytes in all buffers */
+    size_t bytes_used;                          /**< Number of bytes sent */
+} connector_network_send_iov_t;
+/**
+* @}
+*/
+
 /**
 * @defgroup connector_network_receive_t Network Receive Request
 * @{
@@ -34,7 +34,9 @@ typedef enum {
     connector_request_id_os_realloc,           /**< Callback is called to reallocate data in a different size memory position. */
     connector_request_id_os_system_up_time,    /**< Callback is called to return system up time in seconds. It is the time that a device has been up and running. */
     connector_request_id_os_yield,             /**< Callback is called with @ref connector_status_t to relinquish for other task to run when @ref connector_run is used. */
-    connector_request_id_os_reboot            /**< Callback is called to reboot the system. */
+    connector_request_id_os_reboot,           /**< Callback is called to reboot the system. */
+    connector_request_id_os_wakeup,           /**< Callback is called from connector_initiate_action() to wake up a thread waiting on @ref connector_get_wait_set. */
+    connector_request_id_os_system_up_time_in_ms  /**< Optional callback called to return system up time in milliseconds, used to time the EDP handshake in debug builds. */
 } connector_request_id_os_t;
 /**
 * @}
@@ -92,10 +94,10 @@ typedef struct {
 */
 /**
 * Structure passed to connector_request_id_os_system_up_time 
-* callback. 
+* and connector_request_id_os_system_up_time_in_ms callbacks. 
 */
 typedef struct {
-    unsigned long sys_uptime;             /**< Returned system uptime */
+    unsigned long sys_uptime;             /**< Returned system uptime, in seconds or milliseconds */
 } connector_os_system_up_time_t;
 /**
 * @}
@@ -368,6 +368,7 @@ typedef enum
     connector_sm_encryption_data_type_previous_key,
     connector_sm_encryption_data_type_id,
     connector_sm_encryption_data_type_tracking,
+    connector_sm_encryption_data_type_tracking_journal  /**< IDs received since tracking was last stored, only used when CONNECTOR_SM_TRACKING_FLUSH_COUNT is greater than 1 */
 } connector_sm_encryption_data_type_t;
 
 /**
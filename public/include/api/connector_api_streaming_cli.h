@@ -108,6 +108,12 @@ typedef struct {
     connector_bool_t read_only;
 } connector_streaming_cli_session_sessionless_execute_run_request_t;
 
+#if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+typedef struct {
+    void * handle;
+} connector_streaming_cli_ready_t;
+#endif
+
 #endif
 
 #if !defined _CONNECTOR_API_H
@@ -322,6 +322,18 @@ typedef enum
     connector_initiate_data_point,         /**< Initiates the action to send data points to Device Cloud. */
     #endif
 
+    #if (defined CONNECTOR_RCI_CACHE)
+    connector_initiate_rci_cache_invalidate, /**< Drops cached remote configuration query responses. */
+    #endif
+
+    #if (defined CONNECTOR_FIRMWARE_PIPELINE_BLOCKS)
+    connector_initiate_firmware_write_complete, /**< Reports that a firmware image block has been written. */
+    #endif
+
+    #if (defined CONNECTOR_STREAMING_CLI_NOTIFY_READY)
+    connector_initiate_streaming_cli_ready, /**< Reports that a streaming CLI session has output to send. */
+    #endif
+
     connector_initiate_terminate        /**< Terminates and stops Cloud Connector from running. */
 } connector_initiate_request_t;
 /**
@@ -528,6 +540,63 @@ typedef struct
 * @}
 */
 
+#if (defined CONNECTOR_RCI_CACHE)
+/**
+* @defgroup connector_rci_cache_invalidate_t Data type used to invalidate cached remote configuration responses
+* @{
+*/
+/**
+* This data structure is used on @ref connector_initiate_rci_cache_invalidate in @ref connector_initiate_action API
+* to drop the cached responses of every instance of a configuration group.
+*/
+typedef struct
+{
+    connector_remote_group_type_t group_type;   /**< @ref connector_remote_group_setting or @ref connector_remote_group_state */
+    unsigned int group_id;                      /**< Group enumeration value generated by the RCI tool */
+} connector_rci_cache_invalidate_t;
+/**
+* @}
+*/
+
+/**
+* @defgroup connector_rci_cache_statistics_t Remote configuration cache statistics
+* @{
+*/
+/**
+* Counters reported by connector_get_rci_cache_statistics().
+*/
+typedef struct
+{
+    unsigned long hits;     /**< Group instances answered from the cache */
+    unsigned long misses;   /**< Cacheable group instances that had to be queried from the application */
+} connector_rci_cache_statistics_t;
+/**
+* @}
+*/
+#endif
+
+#if (defined CONNECTOR_NO_MALLOC_POOL)
+/**
+* @defgroup connector_pool_statistics_t Static memory pool statistics
+* @{
+*/
+/**
+* Usage of one size class of @ref CONNECTOR_NO_MALLOC_POOL_CLASSES, reported by connector_get_pool_statistics().
+*/
+typedef struct
+{
+    size_t block_size;          /**< Size of each block in bytes, rounded up for alignment */
+    size_t block_count;         /**< Number of blocks in the class */
+    size_t used;                /**< Blocks currently allocated */
+    size_t high_water;          /**< Largest number of blocks allocated at the same time */
+    unsigned long failures;     /**< Allocations this class was the first fit for that no class could serve */
+    unsigned long spills;       /**< Allocations this class served because the smaller classes were exhausted */
+} connector_pool_statistics_t;
+/**
+* @}
+*/
+#endif
+
 
  /**
  * @defgroup connector_callback_t Application-defined callback
@@ -739,6 +808,159 @@ connector_status_t connector_run(connector_handle_t const handle);
 * @}
 */
 
+/**
+* @defgroup connector_wait_set_t Wait Set
+* @{
+*/
+/**
+* Network handle of a transport reported by connector_get_wait_set().
+*/
+typedef struct
+{
+    connector_network_handle_t CONST handle;    /**< Network handle returned by the open callback, NULL if the transport is not open */
+    connector_bool_t CONST send;                /**< connector_true if Cloud Connector is waiting to send (or to complete a connect) on the handle */
+} connector_wait_network_t;
+
+/**
+* What Cloud Connector is waiting on between connector_step() calls.
+*/
+typedef struct
+{
+#if (defined CONNECTOR_TRANSPORT_TCP)
+    connector_wait_network_t tcp;               /**< TCP transport */
+#endif
+#if (defined CONNECTOR_TRANSPORT_UDP)
+    connector_wait_network_t udp;               /**< UDP transport */
+#endif
+#if (defined CONNECTOR_TRANSPORT_SMS)
+    connector_wait_network_t sms;               /**< SMS transport */
+#endif
+    unsigned long CONST timeout_in_milliseconds; /**< Time after which connector_step() must be called even if no handle is ready.
+                                                      0 means connector_step() should be called again right away. */
+} connector_wait_set_t;
+/**
+* @}
+*/
+
+/**
+ * @defgroup connector_get_wait_set Wait Set Routine
+ * @{
+ * @b Include: connector_api.h
+ */
+/**
+ * @brief   Reports what Cloud Connector is waiting on.
+ *
+ * This function lets an application which uses connector_step() sleep until there is something to do,
+ * instead of calling connector_step() in a polling loop. After connector_step() returns @ref connector_idle
+ * or @ref connector_pending, the application may wait until one of the reported network handles is readable
+ * (or writable if its send flag is set), until timeout_in_milliseconds expires, or until the
+ * @ref connector_request_id_os_wakeup callback is called, whichever comes first.
+ *
+ * @param [in] handle  Handle returned from the connector_init() call.
+ * @param [out] wait_set  Pointer to the @ref connector_wait_set_t to be filled in.
+ *
+ * @retval connector_success       The wait set was filled in.
+ * @retval connector_init_error    Cloud Connector was not properly initialized.
+ * @retval connector_invalid_data  wait_set is NULL.
+ * @retval connector_abort         The system up time callback failed.
+ *
+ * @see connector_step()
+ */
+connector_status_t connector_get_wait_set(connector_handle_t const handle, connector_wait_set_t * const wait_set);
+/**
+* @}
+*/
+
+#if (defined CONNECTOR_RCI_CACHE)
+/**
+ * @defgroup connector_get_rci_cache_statistics RCI Cache Statistics Routine
+ * @{
+ * @b Include: connector_api.h
+ */
+/**
+ * @brief   Reports how often remote configuration queries were answered from the cache.
+ *
+ * @param [in] handle  Handle returned from the connector_init() call.
+ * @param [out] statistics  Pointer to the @ref connector_rci_cache_statistics_t to be filled in.
+ *
+ * @retval connector_success       The statistics were filled in.
+ * @retval connector_init_error    Cloud Connector was not properly initialized.
+ * @retval connector_invalid_data  statistics is NULL.
+ *
+ * @see @ref CONNECTOR_RCI_CACHE
+ */
+connector_status_t connector_get_rci_cache_statistics(connector_handle_t const handle, connector_rci_cache_statistics_t * const statistics);
+/**
+* @}
+*/
+#endif
+
+#if (defined CONNECTOR_NO_MALLOC_POOL)
+/**
+ * @defgroup connector_get_pool_statistics Static Memory Pool Statistics Routine
+ * @{
+ * @b Include: connector_api.h
+ */
+/**
+ * @brief   Reports the usage of one size class of the static memory pool.
+ *
+ * Use the high water marks of a test run to size @ref CONNECTOR_NO_MALLOC_POOL_CLASSES.
+ *
+ * @param [in] handle  Handle returned from the connector_init() call.
+ * @param [in] size_class  Index of the size class, in the order listed in @ref CONNECTOR_NO_MALLOC_POOL_CLASSES.
+ * @param [out] statistics  Pointer to the @ref connector_pool_statistics_t to be filled in.
+ *
+ * @retval connector_success       The statistics were filled in.
+ * @retval connector_init_error    Cloud Connector was not properly initialized.
+ * @retval connector_invalid_data  size_class is out of range or statistics is NULL.
+ *
+ * @see @ref CONNECTOR_NO_MALLOC_POOL
+ */
+connector_status_t connector_get_pool_statistics(connector_handle_t const handle, unsigned int const size_class, connector_pool_statistics_t * const statistics);
+/**
+* @}
+*/
+#endif
+
+#if (defined CONNECTOR_DEVICE_REQUEST_TARGETS)
+/**
+ * @defgroup connector_register_device_request_target Device Request Target Registration Routine
+ * @{
+ * @b Include: connector_api.h
+ */
+/**
+ * @brief   Routes device requests for one target straight to a handler.
+ *
+ * Requests for a registered target are looked up in a hashed table and passed to handler
+ * instead of the application callback. Requests for other targets still go to the application
+ * callback. Registering a target again replaces its handler and a NULL handler removes it.
+ *
+ * The table is read by the thread running connector_run() or connector_step() without a lock.
+ * Call this routine before connector_run() is started, or from that thread, for instance from a
+ * callback. It must not be called from another thread while Cloud Connector runs.
+ *
+ * @param [in] handle  Handle returned from the connector_init() call.
+ * @param [in] target  NUL-terminated target name. The string is not copied and must stay valid
+ *                     while the target is registered.
+ * @param [in] handler  Handler for the requests of target, or NULL to remove the target.
+ * @param [in] context  Passed to handler on every call.
+ *
+ * @retval connector_success       The target was registered or removed.
+ * @retval connector_init_error    Cloud Connector was not properly initialized.
+ * @retval connector_invalid_data  target is NULL, empty or longer than 255 characters, or
+ *                                 handler is NULL for a target that is not registered.
+ * @retval connector_no_resource   @ref CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE is too small for another target.
+ *
+ * @see connector_device_request_handler_t
+ * @see @ref CONNECTOR_DEVICE_REQUEST_TARGETS
+ */
+connector_status_t connector_register_device_request_target(connector_handle_t const handle, char const * const target,
+                                                            connector_device_request_handler_t const handler, void * const context);
+/**
+* @}
+*/
+#endif
+
 
  /**
  * @defgroup connector_initiate_action Initiate Action
@@ -801,6 +1023,15 @@ connector_status_t connector_run(connector_handle_t const handle);
  *                      @li @b connector_initiate_session_cancel_all:
  *                          Initiates the action to cancel all sessions.
  *
+ *                      @li @b connector_initiate_rci_cache_invalidate:
+ *                          Drops the cached remote configuration responses of a group, see @ref CONNECTOR_RCI_CACHE.
+ *
+ *                      @li @b connector_initiate_firmware_write_complete:
+ *                          Reports that a firmware image block has been written, see @ref CONNECTOR_FIRMWARE_PIPELINE_BLOCKS.
+ *
+ *                      @li @b connector_initiate_streaming_cli_ready:
+ *                          Reports that a streaming CLI session has output to send, see @ref CONNECTOR_STREAMING_CLI_NOTIFY_READY.
+ *
  * @param [in] request_data  Pointer to Request data
  *                      @li @b connector_initiate_terminate:
  *                          Should be NULL.
@@ -818,6 +1049,13 @@ connector_status_t connector_run(connector_handle_t const handle);
  *                          Pointer to @ref connector_sm_send_ping_request_t "connector_sm_send_ping_request_t"
  *                      @li @b connector_initiate_session_cancel:
  *                          Pointer to @ref connector_sm_cancel_request_t "connector_sm_cancel_request_t"
+ *                      @li @b connector_initiate_rci_cache_invalidate:
+ *                          Pointer to @ref connector_rci_cache_invalidate_t "connector_rci_cache_invalidate_t",
+ *                          or NULL to drop every cached response.
+ *                      @li @b connector_initiate_firmware_write_complete:
+ *                          Pointer to @ref connector_firmware_write_complete_t "connector_firmware_write_complete_t"
+ *                      @li @b connector_initiate_streaming_cli_ready:
+ *                          Pointer to connector_streaming_cli_ready_t with the session handle.
  *
  * @retval connector_success              No error
  * @retval connector_init_error           Cloud Connector was not initialized or not connected to Device Cloud.
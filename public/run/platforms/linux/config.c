@@ -508,6 +508,16 @@ static connector_callback_status_t app_get_max_message_transactions(connector_co
 }
 #endif
 
+#if ((defined CONNECTOR_DATA_SERVICE) || (defined CONNECTOR_FILE_SYSTEM) || (defined CONNECTOR_RCI_SERVICE)) && !(defined CONNECTOR_MSG_RECV_WINDOW_MAX)
+static connector_callback_status_t app_get_msg_receive_window(connector_config_msg_receive_window_t * const config_receive_window)
+{
+    /* keep the initial and maximum windows Cloud Connector preset */
+    UNUSED_ARGUMENT(config_receive_window);
+
+    return connector_callback_continue;
+}
+#endif
+
 /* Converts the first digit char ('0' to '9') to a nibble starting at index and working backwards. */
 static unsigned int digit_to_nibble(char const * const string, int * const index)
 {
@@ -785,6 +795,7 @@ static char const * app_config_class_to_string(connector_request_id_config_t con
         enum_to_case(connector_request_id_config_sm_udp_rx_timeout);
         enum_to_case(connector_request_id_config_sm_sms_rx_timeout);
         enum_to_case(connector_request_id_config_rci_descriptor_data);
+        enum_to_case(connector_request_id_config_msg_receive_window);
     }
     return result;
 }
@@ -798,6 +809,7 @@ static char const * app_network_class_to_string(connector_request_id_network_t c
         enum_to_case(connector_request_id_network_send);
         enum_to_case(connector_request_id_network_receive);
         enum_to_case(connector_request_id_network_close);
+        enum_to_case(connector_request_id_network_send_iov);
     }
     return result;
 }
@@ -813,6 +825,8 @@ static char const * app_os_class_to_string(connector_request_id_os_t const value
         enum_to_case(connector_request_id_os_system_up_time);
         enum_to_case(connector_request_id_os_yield);
         enum_to_case(connector_request_id_os_reboot);
+        enum_to_case(connector_request_id_os_wakeup);
+        enum_to_case(connector_request_id_os_system_up_time_in_ms);
     }
     return result;
 }
@@ -1203,6 +1217,12 @@ connector_callback_status_t app_config_handler(connector_request_id_config_t con
         break;
 #endif
 
+#if ((defined CONNECTOR_DATA_SERVICE) || (defined CONNECTOR_FILE_SYSTEM) || (defined CONNECTOR_RCI_SERVICE)) && !(defined CONNECTOR_MSG_RECV_WINDOW_MAX)
+    case connector_request_id_config_msg_receive_window:
+        status = app_get_msg_receive_window(data);
+        break;
+#endif
+
 #if !(defined CONNECTOR_NETWORK_TCP_START)
      case connector_request_id_config_network_tcp:
          status = app_start_network_tcp(data);
@@ -23,10 +23,12 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
 #include <errno.h>
+#include <limits.h>
 #include "connector_api.h"
 #include "platform.h"
 #include "connector_config.h"
@@ -53,19 +55,100 @@
 #define PRIoffset  PRId32
 #endif
 
+/*
+ * CRC32 is always available for file listings. Define APP_ENABLE_MD5 to also
+ * support MD5 and SHA-512, which come from OpenSSL.
+ */
 #if defined APP_ENABLE_MD5
 #include <openssl/md5.h>
+#include <openssl/sha.h>
+#endif
+
+#define APP_HASH_BUFFER_SIZE 8192
+
+/*
+ * Define APP_FILE_SYSTEM_WORKER_THREADS to the number of threads that run the file system
+ * requests, so a slow disk does not stall connector_run(). See app_file_system_handler().
+ */
+#ifndef APP_FILE_SYSTEM_WORKER_THREADS
+#define APP_FILE_SYSTEM_WORKER_THREADS 0
+#endif
 
-#define APP_MD5_BUFFER_SIZE 1024
+#if (APP_FILE_SYSTEM_WORKER_THREADS > 0)
+#include <pthread.h>
+#endif
 
 typedef struct
 {
-    MD5_CTX md5;
-    char buf[APP_MD5_BUFFER_SIZE];
+    union
+    {
+        uint32_t crc32;
+#if defined APP_ENABLE_MD5
+        MD5_CTX md5;
+        SHA512_CTX sha512;
+#endif
+    } state;
+    struct stat statbuf;
+    char buf[APP_HASH_BUFFER_SIZE];
     unsigned int flags;
     int fd;
 
-} app_md5_ctx;
+} app_hash_ctx;
+
+/*
+ * Hashes are kept in a cache keyed by path, device, inode, size and modification
+ * time, so listing an unchanged file again does not read it. The cache is saved
+ * by appending to APP_FILE_HASH_CACHE_PATH and loaded on the first hash request.
+ * Define APP_FILE_HASH_CACHE_PATH as "" to keep it in memory only.
+ */
+#ifndef APP_FILE_HASH_CACHE_PATH
+#define APP_FILE_HASH_CACHE_PATH    ".connector_file_hash_cache"
+#endif
+
+#define APP_HASH_CACHE_BUCKETS      1024
+#define APP_HASH_CACHE_MAGIC        "CCFH1\n"
+#define APP_HASH_MAX_SIZE           64
+
+typedef struct
+{
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    int64_t mtime_sec;
+    uint32_t mtime_nsec;
+    uint8_t algorithm;
+    uint8_t hash_length;
+    uint16_t path_length;
+    uint8_t hash[APP_HASH_MAX_SIZE];
+
+} app_hash_cache_key_t;
+
+typedef struct app_hash_cache_entry
+{
+    struct app_hash_cache_entry * next;
+    app_hash_cache_key_t key;
+    char path[];
+
+} app_hash_cache_entry_t;
+
+static struct
+{
+    app_hash_cache_entry_t * bucket[APP_HASH_CACHE_BUCKETS];
+    FILE * file;
+    unsigned long entries;
+    unsigned long records;
+    int loaded;
+
+} app_hash_cache;
+
+#if (APP_FILE_SYSTEM_WORKER_THREADS > 0)
+static pthread_mutex_t app_hash_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define app_hash_cache_lock()       pthread_mutex_lock(&app_hash_cache_mutex)
+#define app_hash_cache_unlock()     pthread_mutex_unlock(&app_hash_cache_mutex)
+#else
+#define app_hash_cache_lock()
+#define app_hash_cache_unlock()
 #endif
 
 #ifndef APP_MIN_VALUE
@@ -79,6 +162,94 @@ typedef struct
 
 } app_dir_data_t;
 
+/*
+ * Define APP_FILE_SYSTEM_MMAP_FILES as the number of files to keep mapped to memory map regular
+ * files opened read-only, so app_process_file_read() can point Cloud Connector at the mapping
+ * instead of copying the file with read(). The mapping stays until the file is closed.
+ * Off by default: the mapping is shared, and a file truncated by another process while Cloud
+ * Connector reads the mapping raises SIGBUS. Only use it for files nothing else rewrites.
+ * The worker threads read ahead instead, since touching a mapping blocks connector_run().
+ */
+#ifndef APP_FILE_SYSTEM_MMAP_FILES
+#define APP_FILE_SYSTEM_MMAP_FILES 0
+#endif
+
+#if (APP_FILE_SYSTEM_WORKER_THREADS > 0) && (APP_FILE_SYSTEM_MMAP_FILES > 0)
+#error "APP_FILE_SYSTEM_MMAP_FILES must be 0 when APP_FILE_SYSTEM_WORKER_THREADS is defined"
+#endif
+
+#if (APP_FILE_SYSTEM_MMAP_FILES > 0)
+typedef struct
+{
+    long int fd;
+    uint8_t const * base;
+    size_t size;
+
+} app_file_map_t;
+
+static app_file_map_t app_file_map[APP_FILE_SYSTEM_MMAP_FILES];
+
+static app_file_map_t * app_file_map_find(long int const fd)
+{
+    app_file_map_t * map = NULL;
+    int i;
+
+    for (i = 0; i < APP_FILE_SYSTEM_MMAP_FILES; i++)
+    {
+        if (app_file_map[i].base != NULL && app_file_map[i].fd == fd)
+        {
+            map = &app_file_map[i];
+            break;
+        }
+    }
+
+    return map;
+}
+
+static void app_file_map_open(long int const fd)
+{
+    struct stat st;
+    int i;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || (uintmax_t)st.st_size > SIZE_MAX)
+        goto done;
+
+    for (i = 0; i < APP_FILE_SYSTEM_MMAP_FILES; i++)
+    {
+        if (app_file_map[i].base == NULL)
+        {
+            void * const base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+            if (base == MAP_FAILED)
+            {
+                APP_DEBUG("mmap fd %ld, errno %d, using read()\n", fd, errno);
+                goto done;
+            }
+            madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+            app_file_map[i].fd = fd;
+            app_file_map[i].base = base;
+            app_file_map[i].size = (size_t)st.st_size;
+            goto done;
+        }
+    }
+
+done:
+    return;
+}
+
+static void app_file_map_close(long int const fd)
+{
+    app_file_map_t * const map = app_file_map_find(fd);
+
+    if (map != NULL)
+    {
+        munmap((void *)map->base, map->size);
+        map->base = NULL;
+    }
+}
+#endif
+
 
 static connector_callback_status_t app_process_file_error(connector_filesystem_errnum_t * const error_token, long int const errnum)
 {
@@ -176,10 +347,273 @@ static connector_callback_status_t app_process_file_get_error(connector_file_sys
 }
 
 
-#if defined APP_ENABLE_MD5
-static app_md5_ctx * app_allocate_md5_ctx(unsigned int const flags)
+/* CRC-32 (IEEE 802.3) using four tables so four bytes are folded in per step */
+static uint32_t app_crc32_table[4][256];
+
+static void app_crc32_init_table(void)
+{
+    uint32_t n;
+
+    for (n = 0; n < 256; n++)
+    {
+        uint32_t value = n;
+        int k;
+
+        for (k = 0; k < 8; k++)
+            value = (value & 1) ? (value >> 1) ^ 0xEDB88320 : value >> 1;
+        app_crc32_table[0][n] = value;
+    }
+    for (n = 0; n < 256; n++)
+    {
+        app_crc32_table[1][n] = (app_crc32_table[0][n] >> 8) ^ app_crc32_table[0][app_crc32_table[0][n] & 0xFF];
+        app_crc32_table[2][n] = (app_crc32_table[1][n] >> 8) ^ app_crc32_table[0][app_crc32_table[1][n] & 0xFF];
+        app_crc32_table[3][n] = (app_crc32_table[2][n] >> 8) ^ app_crc32_table[0][app_crc32_table[2][n] & 0xFF];
+    }
+}
+
+/* the workers may hash files at the same time, so they build the tables only once */
+#if (APP_FILE_SYSTEM_WORKER_THREADS > 0)
+static pthread_once_t app_crc32_table_once = PTHREAD_ONCE_INIT;
+
+#define app_crc32_table_init()      pthread_once(&app_crc32_table_once, app_crc32_init_table)
+#else
+#define app_crc32_table_init()      do { if (app_crc32_table[0][1] == 0) app_crc32_init_table(); } while (0)
+#endif
+
+static uint32_t app_crc32_update(uint32_t const crc, void const * const data, size_t const length)
+{
+    uint8_t const * bytes = data;
+    size_t remaining = length;
+    uint32_t c = ~crc;
+
+    app_crc32_table_init();
+
+    while (remaining >= 4)
+    {
+        c ^= (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+        c = app_crc32_table[3][c & 0xFF] ^ app_crc32_table[2][(c >> 8) & 0xFF] ^ app_crc32_table[1][(c >> 16) & 0xFF] ^ app_crc32_table[0][c >> 24];
+        bytes += 4;
+        remaining -= 4;
+    }
+
+    while (remaining-- > 0)
+        c = app_crc32_table[0][(c ^ *bytes++) & 0xFF] ^ (c >> 8);
+
+    return ~c;
+}
+
+static unsigned int app_hash_cache_bucket(char const * const path)
+{
+    unsigned int hash = 5381;
+    char const * p;
+
+    for (p = path; *p != '\0'; p++)
+        hash = hash * 33 + (unsigned char)*p;
+
+    return hash % APP_HASH_CACHE_BUCKETS;
+}
+
+static void app_hash_cache_make_key(app_hash_cache_key_t * const key, struct stat const * const statbuf,
+                                    connector_file_system_hash_algorithm_t const algorithm)
+{
+    memset(key, 0, sizeof *key);
+    key->device = (uint64_t)statbuf->st_dev;
+    key->inode = (uint64_t)statbuf->st_ino;
+    key->size = (uint64_t)statbuf->st_size;
+    key->mtime_sec = (int64_t)statbuf->st_mtim.tv_sec;
+    key->mtime_nsec = (uint32_t)statbuf->st_mtim.tv_nsec;
+    key->algorithm = (uint8_t)algorithm;
+}
+
+#define app_hash_cache_key_matches(a, b)    ((a)->device == (b)->device && (a)->inode == (b)->inode && (a)->size == (b)->size && \
+                                             (a)->mtime_sec == (b)->mtime_sec && (a)->mtime_nsec == (b)->mtime_nsec)
+
+static app_hash_cache_entry_t ** app_hash_cache_find(char const * const path, uint8_t const algorithm)
+{
+    app_hash_cache_entry_t ** link = &app_hash_cache.bucket[app_hash_cache_bucket(path)];
+
+    while (*link != NULL && ((*link)->key.algorithm != algorithm || strcmp((*link)->path, path) != 0))
+        link = &(*link)->next;
+
+    return link;
+}
+
+/* Adds or replaces the entry of the path, returns the entry or NULL when out of memory */
+static app_hash_cache_entry_t * app_hash_cache_insert(char const * const path, app_hash_cache_key_t const * const key)
+{
+    app_hash_cache_entry_t ** const link = app_hash_cache_find(path, key->algorithm);
+    app_hash_cache_entry_t * entry = *link;
+
+    if (entry == NULL)
+    {
+        size_t const path_length = strlen(path);
+
+        entry = malloc(sizeof *entry + path_length + 1);
+        if (entry == NULL)
+            goto done;
+
+        memcpy(entry->path, path, path_length + 1);
+        entry->next = NULL;
+        *link = entry;
+        app_hash_cache.entries++;
+    }
+    entry->key = *key;
+    entry->key.path_length = (uint16_t)strlen(path);
+
+done:
+    return entry;
+}
+
+static int app_hash_cache_write(FILE * const file, app_hash_cache_entry_t const * const entry)
+{
+    int const ok = fwrite(&entry->key, sizeof entry->key, 1, file) == 1 &&
+                   fwrite(entry->path, entry->key.path_length, 1, file) == 1;
+
+    return ok;
+}
+
+/* Rewrites the cache file with only the current entries, once replaced ones dominate it */
+static void app_hash_cache_compact(void)
+{
+    static char const temp_path[] = APP_FILE_HASH_CACHE_PATH ".tmp";
+    FILE * const file = fopen(temp_path, "wb");
+    int ok = file != NULL && fputs(APP_HASH_CACHE_MAGIC, file) >= 0;
+    unsigned int i;
+
+    for (i = 0; ok && i < APP_HASH_CACHE_BUCKETS; i++)
+    {
+        app_hash_cache_entry_t const * entry;
+
+        for (entry = app_hash_cache.bucket[i]; ok && entry != NULL; entry = entry->next)
+            ok = app_hash_cache_write(file, entry);
+    }
+
+    if (file != NULL)
+        ok = (fclose(file) == 0) && ok;
+
+    if (ok && rename(temp_path, APP_FILE_HASH_CACHE_PATH) == 0)
+    {
+        fclose(app_hash_cache.file);
+        app_hash_cache.file = fopen(APP_FILE_HASH_CACHE_PATH, "ab");
+        app_hash_cache.records = app_hash_cache.entries;
+        APP_DEBUG("app_hash_cache_compact: %lu entries\n", app_hash_cache.entries);
+    }
+    else
+    {
+        remove(temp_path);
+    }
+}
+
+static void app_hash_cache_load(void)
+{
+    char const * const cache_path = APP_FILE_HASH_CACHE_PATH;
+    FILE * file;
+
+    app_hash_cache.loaded = 1;
+    if (*cache_path == '\0')
+        goto done;
+
+    file = fopen(cache_path, "rb");
+    if (file != NULL)
+    {
+        char magic[sizeof APP_HASH_CACHE_MAGIC - 1];
+        app_hash_cache_key_t key;
+        char path[PATH_MAX];
+
+        if (fread(magic, sizeof magic, 1, file) == 1 && memcmp(magic, APP_HASH_CACHE_MAGIC, sizeof magic) == 0)
+        {
+            /* later records replace earlier ones, a truncated last record is ignored */
+            while (fread(&key, sizeof key, 1, file) == 1 &&
+                   key.path_length < sizeof path && key.hash_length <= APP_HASH_MAX_SIZE &&
+                   fread(path, key.path_length, 1, file) == 1)
+            {
+                path[key.path_length] = '\0';
+                if (app_hash_cache_insert(path, &key) == NULL)
+                    break;
+                app_hash_cache.records++;
+            }
+        }
+        else
+        {
+            app_hash_cache.records = ~0UL;
+        }
+        fclose(file);
+    }
+
+    app_hash_cache.file = fopen(cache_path, "ab");
+    if (app_hash_cache.file == NULL)
+    {
+        APP_DEBUG("app_hash_cache_load: cannot open %s, errno %d\n", cache_path, errno);
+        goto done;
+    }
+
+    if (fseek(app_hash_cache.file, 0, SEEK_END) == 0 && ftell(app_hash_cache.file) == 0)
+        fputs(APP_HASH_CACHE_MAGIC, app_hash_cache.file);
+    else if (app_hash_cache.records > 2 * app_hash_cache.entries + 256)
+        app_hash_cache_compact();
+
+    APP_DEBUG("app_hash_cache_load: %lu entries from %s\n", app_hash_cache.entries, cache_path);
+
+done:
+    return;
+}
+
+static int app_hash_cache_lookup(char const * const path, struct stat const * const statbuf,
+                                 connector_file_system_hash_algorithm_t const algorithm, void * const hash_value)
+{
+    app_hash_cache_entry_t const * entry;
+    app_hash_cache_key_t key;
+    int found = 0;
+
+    app_hash_cache_lock();
+    if (!app_hash_cache.loaded)
+        app_hash_cache_load();
+
+    app_hash_cache_make_key(&key, statbuf, algorithm);
+    entry = *app_hash_cache_find(path, key.algorithm);
+    if (entry != NULL && app_hash_cache_key_matches(&entry->key, &key))
+    {
+        memcpy(hash_value, entry->key.hash, entry->key.hash_length);
+        found = 1;
+    }
+    app_hash_cache_unlock();
+
+    return found;
+}
+
+static void app_hash_cache_store(char const * const path, struct stat const * const statbuf,
+                                 connector_file_system_hash_algorithm_t const algorithm,
+                                 void const * const hash_value, size_t const hash_length)
+{
+    app_hash_cache_entry_t * entry;
+    app_hash_cache_key_t key;
+
+    if (strlen(path) > UINT16_MAX || hash_length > APP_HASH_MAX_SIZE)
+        goto done;
+
+    app_hash_cache_make_key(&key, statbuf, algorithm);
+    key.hash_length = (uint8_t)hash_length;
+    memcpy(key.hash, hash_value, hash_length);
+
+    app_hash_cache_lock();
+    entry = app_hash_cache_insert(path, &key);
+    if (entry != NULL && app_hash_cache.file != NULL)
+    {
+        if (app_hash_cache_write(app_hash_cache.file, entry) && fflush(app_hash_cache.file) == 0)
+            app_hash_cache.records++;
+
+        if (app_hash_cache.records > 2 * app_hash_cache.entries + 256)
+            app_hash_cache_compact();
+    }
+    app_hash_cache_unlock();
+
+done:
+    return;
+}
+
+static app_hash_ctx * app_allocate_hash_ctx(unsigned int const flags)
 {
-    app_md5_ctx * ctx = malloc(sizeof *ctx);
+    app_hash_ctx * ctx = malloc(sizeof *ctx);
 
     if (ctx != NULL)
     {
@@ -188,8 +622,9 @@ static app_md5_ctx * app_allocate_md5_ctx(unsigned int const flags)
     }
     else
     {
-        APP_DEBUG("app_allocate_md5_ctx: malloc fails\n");
+        APP_DEBUG("app_allocate_hash_ctx: malloc fails\n");
     }
+
     return ctx;
 }
 
@@ -200,7 +635,7 @@ static connector_callback_status_t app_process_file_session_error(connector_file
     /* All application resources, used in the session, must be released in this callback */
     if (data->user_context != NULL)
     {
-        app_md5_ctx * ctx = data->user_context;
+        app_hash_ctx * ctx = data->user_context;
 
         if (ctx->fd >= 0)
             close(ctx->fd);
@@ -211,10 +646,53 @@ static connector_callback_status_t app_process_file_session_error(connector_file
     return connector_callback_continue;
 }
 
+static void app_hash_update(app_hash_ctx * const ctx, connector_file_system_hash_algorithm_t const algorithm, size_t const length)
+{
+    switch (algorithm)
+    {
+#if defined APP_ENABLE_MD5
+        case connector_file_system_hash_md5:
+            MD5_Update(&ctx->state.md5, ctx->buf, length);
+            break;
+
+        case connector_file_system_hash_sha512:
+            SHA512_Update(&ctx->state.sha512, ctx->buf, length);
+            break;
+#endif
+
+        default:
+            ctx->state.crc32 = app_crc32_update(ctx->state.crc32, ctx->buf, length);
+            break;
+    }
+}
+
+static void app_hash_final(app_hash_ctx * const ctx, connector_file_system_hash_algorithm_t const algorithm, uint8_t * const hash_value)
+{
+    switch (algorithm)
+    {
+#if defined APP_ENABLE_MD5
+        case connector_file_system_hash_md5:
+            MD5_Final(hash_value, &ctx->state.md5);
+            break;
+
+        case connector_file_system_hash_sha512:
+            SHA512_Final(hash_value, &ctx->state.sha512);
+            break;
+#endif
+
+        default:
+            hash_value[0] = (uint8_t)(ctx->state.crc32 >> 24);
+            hash_value[1] = (uint8_t)(ctx->state.crc32 >> 16);
+            hash_value[2] = (uint8_t)(ctx->state.crc32 >> 8);
+            hash_value[3] = (uint8_t)ctx->state.crc32;
+            break;
+    }
+}
+
 static connector_callback_status_t app_process_file_hash(connector_file_system_hash_t * const data)
 {
     connector_callback_status_t status = connector_callback_continue;
-    app_md5_ctx * ctx = data->user_context;
+    app_hash_ctx * ctx = data->user_context;
     int ret;
 
     if (ctx == NULL)
@@ -225,6 +703,12 @@ static connector_callback_status_t app_process_file_hash(connector_file_system_h
 
     if (ctx->fd < 0)
     {
+        if (stat(data->path, &ctx->statbuf) == 0 && app_hash_cache_lookup(data->path, &ctx->statbuf, data->hash_algorithm, data->hash_value))
+        {
+            APP_DEBUG("Hash of %s from cache\n", data->path);
+            goto done;
+        }
+
         ctx->fd = open(data->path, O_RDONLY);
         APP_DEBUG("Open %s, returned %d\n", data->path, ctx->fd);
 
@@ -234,28 +718,55 @@ static connector_callback_status_t app_process_file_hash(connector_file_system_h
             goto error;
         }
 
-        MD5_Init(&ctx->md5);
+        switch (data->hash_algorithm)
+        {
+#if defined APP_ENABLE_MD5
+            case connector_file_system_hash_md5:
+                MD5_Init(&ctx->state.md5);
+                break;
+
+            case connector_file_system_hash_sha512:
+                SHA512_Init(&ctx->state.sha512);
+                break;
+#endif
+
+            default:
+                ctx->state.crc32 = 0;
+                break;
+        }
     }
 
     while ((ret = read (ctx->fd, ctx->buf, sizeof ctx->buf)) > 0)
     {
-        MD5_Update(&ctx->md5, ctx->buf, ret);
+        app_hash_update(ctx, data->hash_algorithm, (size_t)ret);
     }
+
     if (ret == -1 && errno == EAGAIN)
     {
         status = connector_callback_busy;
         goto done;
     }
 
+    if (ret == 0)
+    {
+        struct stat after;
+
+        app_hash_final(ctx, data->hash_algorithm, data->hash_value);
+
+        /* only cache the hash when the file did not change while it was read */
+        if (fstat(ctx->fd, &after) == 0 && after.st_size == ctx->statbuf.st_size &&
+            after.st_mtim.tv_sec == ctx->statbuf.st_mtim.tv_sec && after.st_mtim.tv_nsec == ctx->statbuf.st_mtim.tv_nsec)
+        {
+            app_hash_cache_store(data->path, &ctx->statbuf, data->hash_algorithm, data->hash_value, data->bytes_requested);
+        }
+    }
+
     APP_DEBUG("Close %d\n", ctx->fd);
     close (ctx->fd);
     ctx->fd = -1;
 
     if (ret == 0)
-    {
-        MD5_Final (data->hash_value, &ctx->md5);
         goto done;
-    }
 
 error:
     memset(data->hash_value, 0, data->bytes_requested);
@@ -263,7 +774,7 @@ error:
 done:
     if (ctx != NULL && status == connector_callback_continue)
     {
-        /* free md5 context here,  if ls was issued a single file */
+        /* free hash context here,  if ls was issued a single file */
         if ((ctx->flags == connector_file_system_file_type_is_dir) == 0)
         {
             free(data->user_context);
@@ -272,26 +783,6 @@ done:
     }
     return status;
 }
-#else
-
-static connector_callback_status_t app_process_file_session_error(connector_file_system_session_error_t * const data)
-{
-    UNUSED_ARGUMENT(data);
-    APP_DEBUG("Session Error %d\n", data->session_error);
-
-    /* All application resources, used in the session, must be released in this callback */
-    return connector_callback_continue;
-}
-
-static connector_callback_status_t app_process_file_hash(connector_file_system_hash_t * const data)
-{
-
-    /* app_process_file_hash() should not be called if APP_ENABLE_MD5 is not defined */
-    ASSERT(0);
-    UNUSED_ARGUMENT(data);
-    return connector_callback_continue;
-}
-#endif
 
 static int app_copy_statbuf(connector_file_system_statbuf_t * const pstat, struct stat const * const statbuf)
 {
@@ -363,29 +854,43 @@ static connector_callback_status_t app_process_file_stat(connector_file_system_s
 
     data->hash_algorithm.actual = connector_file_system_hash_none;
 
-#if defined APP_ENABLE_MD5
     switch (data->hash_algorithm.requested)
     {
         case connector_file_system_hash_best:
-        case connector_file_system_hash_md5:
-            if (pstat->flags != connector_file_system_file_type_none)
-            {
-                data->hash_algorithm.actual = connector_file_system_hash_md5;
-                if (data->user_context == NULL)
-                {
-                    data->user_context = app_allocate_md5_ctx(pstat->flags);
-                    if (data->user_context == NULL)
-                    {
-                        status = app_process_file_error(&data->errnum, ENOMEM);
-                    }
-                }
-            }
+#if defined APP_ENABLE_MD5
+            data->hash_algorithm.actual = connector_file_system_hash_md5;
+#else
+            data->hash_algorithm.actual = connector_file_system_hash_crc32;
+#endif
             break;
 
-        default:
-            break;
-    }
+#if defined APP_ENABLE_MD5
+        case connector_file_system_hash_md5:
+        case connector_file_system_hash_sha512:
 #endif
+        case connector_file_system_hash_crc32:
+            data->hash_algorithm.actual = data->hash_algorithm.requested;
+            break;
+
+        default:
+            break;
+    }
+
+    if (data->hash_algorithm.actual != connector_file_system_hash_none)
+    {
+        if (pstat->flags == connector_file_system_file_type_none)
+        {
+            data->hash_algorithm.actual = connector_file_system_hash_none;
+        }
+        else if (data->user_context == NULL)
+        {
+            data->user_context = app_allocate_hash_ctx(pstat->flags);
+            if (data->user_context == NULL)
+            {
+                status = app_process_file_error(&data->errnum, ENOMEM);
+            }
+        }
+    }
 
 done:
     return status;
@@ -468,14 +973,12 @@ static connector_callback_status_t app_process_file_closedir(connector_file_syst
 
     /* All application resources, used in the session, must be released in this callback */
 
-#if defined APP_ENABLE_MD5
     if (data->user_context != NULL)
     {
-        /* free md5 context here, if ls was issued a directory */
+        /* free hash context here, if ls was issued a directory */
         free(data->user_context);
         data->user_context = NULL;
     }
-#endif
     return connector_callback_continue;
 }
 
@@ -544,6 +1047,11 @@ static connector_callback_status_t app_process_file_open(connector_file_system_o
         APP_DEBUG(", errno %d", errno);
     APP_DEBUG("\n");
 
+#if (APP_FILE_SYSTEM_MMAP_FILES > 0)
+    if (fd >= 0 && (oflag & O_ACCMODE) == O_RDONLY)
+        app_file_map_open(fd);
+#endif
+
     data->handle = fd;
 
     return status;
@@ -630,8 +1138,32 @@ static connector_callback_status_t app_process_file_read(connector_file_system_r
 {
     connector_callback_status_t status = connector_callback_continue;
     long int const fd = data->handle;
+    int result;
+
+#if (APP_FILE_SYSTEM_MMAP_FILES > 0)
+    {
+        app_file_map_t const * const map = app_file_map_find(fd);
+        off_t const offset = (map != NULL) ? lseek(fd, 0, SEEK_CUR) : -1;
+        struct stat st;
+
+        /* the file may have grown since it was mapped, read() picks up the rest;
+         * a file that has shrunk is read with read() so the pages past its end are not touched */
+        if (offset >= 0 && (uintmax_t)offset < map->size && fstat(fd, &st) == 0 && (uintmax_t)st.st_size >= map->size)
+        {
+            size_t const bytes = APP_MIN_VALUE(map->size - (size_t)offset, data->bytes_available);
+
+            if (lseek(fd, (off_t)bytes, SEEK_CUR) >= 0)
+            {
+                APP_DEBUG("read fd %ld, %" PRIsize ", mapped %" PRIsize "\n", fd, data->bytes_available, bytes);
+                data->external_buffer = map->base + offset;
+                data->bytes_used = bytes;
+                goto done;
+            }
+        }
+    }
+#endif
 
-    int const result = read(fd, data->buffer, data->bytes_available);
+    result = read(fd, data->buffer, data->bytes_available);
 
     if (result < 0)
     {
@@ -672,7 +1204,14 @@ static connector_callback_status_t app_process_file_close(connector_file_system_
 {
     connector_callback_status_t status = connector_callback_continue;
     long int const fd = data->handle;
-    int const result = close(fd);
+    int result;
+
+#if (APP_FILE_SYSTEM_MMAP_FILES > 0)
+    /* Cloud Connector only closes the file once the mapped bytes returned by the last read
+     * have been sent or taken off the send queue, also when the session fails */
+    app_file_map_close(fd);
+#endif
+    result = close(fd);
 
     if (result < 0)
     {
@@ -688,8 +1227,8 @@ static connector_callback_status_t app_process_file_close(connector_file_system_
     return status;
 }
 
-connector_callback_status_t app_file_system_handler(connector_request_id_file_system_t const request,
-                                                    void * const data)
+static connector_callback_status_t app_file_system_process(connector_request_id_file_system_t const request,
+                                                           void * const data)
 {
     connector_callback_status_t status = connector_callback_continue;
 
@@ -763,3 +1302,787 @@ connector_callback_status_t app_file_system_handler(connector_request_id_file_sy
     return status;
 }
 
+
+#if (APP_FILE_SYSTEM_WORKER_THREADS > 0)
+/*
+ * Worker threads. A request that touches the disk is copied into the session and queued
+ * to the workers, and the callback returns connector_callback_busy. Cloud Connector calls
+ * again with the same request, which picks up the result once the worker is done, so a
+ * slow disk only holds up the session waiting for it. Every session runs one job at a
+ * time. Once a file is read, the next APP_FILE_SYSTEM_READ_AHEAD_SIZE bytes are read in
+ * the background while the ones already read are returned.
+ *
+ * Cloud Connector keeps the session in user_context, the request handlers above find
+ * their own user_context in the session.
+ */
+#ifndef APP_FILE_SYSTEM_READ_AHEAD_SIZE
+#define APP_FILE_SYSTEM_READ_AHEAD_SIZE 32768
+#endif
+
+typedef enum
+{
+    app_fs_job_idle,
+    app_fs_job_queued,
+    app_fs_job_done
+
+} app_fs_job_state_t;
+
+/* Fields every file system request starts with */
+typedef struct
+{
+    void * user_context;
+    connector_filesystem_errnum_t errnum;
+
+} app_fs_user_data_t;
+
+typedef union
+{
+    app_fs_user_data_t user;
+    connector_file_system_open_t open;
+    connector_file_system_write_t write;
+    connector_file_system_close_t close;
+    connector_file_system_truncate_t ftruncate;
+    connector_file_system_remove_t remove;
+    connector_file_system_stat_t stat;
+    connector_file_system_stat_dir_entry_t stat_dir_entry;
+    connector_file_system_opendir_t opendir;
+    connector_file_system_readdir_t readdir;
+    connector_file_system_hash_t hash;
+
+} app_fs_request_data_t;
+
+typedef struct app_fs_session
+{
+    struct app_fs_session * next;
+    void * user_context;
+
+    app_fs_job_state_t state;
+    connector_request_id_file_system_t request;
+    connector_callback_status_t status;
+    app_fs_request_data_t data;
+
+    struct
+    {
+        uint8_t * buffer[2];
+        unsigned int current;
+        size_t length;
+        size_t offset;
+        long int fd;
+        ssize_t result;
+        int error;
+        int end;
+
+    } read_ahead;
+
+    char path[PATH_MAX];
+    char output[PATH_MAX];
+
+} app_fs_session_t;
+
+static struct
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t queued;
+    app_fs_session_t * head;
+    app_fs_session_t * tail;
+    unsigned int threads;
+    int started;
+
+} app_fs_workers = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, 0, 0 };
+
+static int app_fs_is_worker_request(connector_request_id_file_system_t const request)
+{
+    int worker_request;
+
+    switch (request)
+    {
+        case connector_request_id_file_system_open:
+        case connector_request_id_file_system_write:
+        case connector_request_id_file_system_close:
+        case connector_request_id_file_system_ftruncate:
+        case connector_request_id_file_system_remove:
+        case connector_request_id_file_system_stat:
+        case connector_request_id_file_system_stat_dir_entry:
+        case connector_request_id_file_system_opendir:
+        case connector_request_id_file_system_readdir:
+        case connector_request_id_file_system_hash:
+            worker_request = 1;
+            break;
+
+        default:
+            worker_request = 0;
+            break;
+    }
+
+    return worker_request;
+}
+
+static char const * app_fs_copy_path(app_fs_session_t * const session, char const * const path)
+{
+    size_t const length = strlen(path);
+    char const * copy = NULL;
+
+    if (length < sizeof session->path)
+    {
+        memcpy(session->path, path, length + 1);
+        copy = session->path;
+    }
+
+    return copy;
+}
+
+/*
+ * Cloud Connector may change what the request points to before it calls again, so the
+ * worker gets a copy that points at the session's path and output buffers instead.
+ */
+static connector_callback_status_t app_fs_copy_request(app_fs_session_t * const session, connector_request_id_file_system_t const request, void * const data)
+{
+    connector_callback_status_t status = connector_callback_continue;
+    app_fs_user_data_t * const user_data = data;
+    char const * path;
+
+    switch (request)
+    {
+        case connector_request_id_file_system_open:
+        {
+            connector_file_system_open_t const * const request_data = data;
+
+            path = app_fs_copy_path(session, request_data->path);
+            if (path == NULL)
+                goto error;
+
+            {
+                connector_file_system_open_t const copy = { NULL, 0, path, request_data->oflag, request_data->handle };
+
+                memcpy(&session->data.open, &copy, sizeof copy);
+            }
+            break;
+        }
+
+        case connector_request_id_file_system_write:
+            memcpy(&session->data.write, data, sizeof session->data.write);
+            break;
+
+        case connector_request_id_file_system_close:
+            memcpy(&session->data.close, data, sizeof session->data.close);
+            break;
+
+        case connector_request_id_file_system_ftruncate:
+            memcpy(&session->data.ftruncate, data, sizeof session->data.ftruncate);
+            break;
+
+        case connector_request_id_file_system_remove:
+        {
+            connector_file_system_remove_t const * const request_data = data;
+
+            path = app_fs_copy_path(session, request_data->path);
+            if (path == NULL)
+                goto error;
+
+            {
+                connector_file_system_remove_t const copy = { NULL, 0, path };
+
+                memcpy(&session->data.remove, &copy, sizeof copy);
+            }
+            break;
+        }
+
+        case connector_request_id_file_system_stat:
+        {
+            connector_file_system_stat_t const * const request_data = data;
+
+            path = app_fs_copy_path(session, request_data->path);
+            if (path == NULL)
+                goto error;
+
+            {
+                connector_file_system_stat_t const copy = { NULL, 0, path, request_data->statbuf,
+                                                            { request_data->hash_algorithm.requested, request_data->hash_algorithm.actual } };
+
+                memcpy(&session->data.stat, &copy, sizeof copy);
+            }
+            break;
+        }
+
+        case connector_request_id_file_system_stat_dir_entry:
+        {
+            connector_file_system_stat_dir_entry_t const * const request_data = data;
+
+            path = app_fs_copy_path(session, request_data->path);
+            if (path == NULL)
+                goto error;
+
+            {
+                connector_file_system_stat_dir_entry_t const copy = { NULL, 0, path, request_data->statbuf };
+
+                memcpy(&session->data.stat_dir_entry, &copy, sizeof copy);
+            }
+            break;
+        }
+
+        case connector_request_id_file_system_opendir:
+        {
+            connector_file_system_opendir_t const * const request_data = data;
+
+            path = app_fs_copy_path(session, request_data->path);
+            if (path == NULL)
+                goto error;
+
+            {
+                connector_file_system_opendir_t const copy = { NULL, 0, path, request_data->handle };
+
+                memcpy(&session->data.opendir, &copy, sizeof copy);
+            }
+            break;
+        }
+
+        case connector_request_id_file_system_readdir:
+        {
+            connector_file_system_readdir_t const * const request_data = data;
+            connector_file_system_readdir_t const copy = { NULL, 0, request_data->handle, session->output,
+                                                           APP_MIN_VALUE(request_data->bytes_available, sizeof session->output) };
+
+            session->output[0] = '\0';
+            memcpy(&session->data.readdir, &copy, sizeof copy);
+            break;
+        }
+
+        case connector_request_id_file_system_hash:
+        {
+            connector_file_system_hash_t const * const request_data = data;
+
+            path = app_fs_copy_path(session, request_data->path);
+            if (path == NULL || request_data->bytes_requested > sizeof session->output)
+                goto error;
+
+            {
+                connector_file_system_hash_t const copy = { NULL, 0, path, request_data->hash_algorithm,
+                                                            session->output, request_data->bytes_requested };
+
+                memcpy(&session->data.hash, &copy, sizeof copy);
+            }
+            break;
+        }
+
+        default:
+            ASSERT(0);
+            break;
+    }
+
+    goto done;
+
+error:
+    APP_DEBUG("app_fs_copy_request: path too long\n");
+    status = app_process_file_error(&user_data->errnum, ENAMETOOLONG);
+
+done:
+    return status;
+}
+
+/* Hands what the worker returned to Cloud Connector */
+static void app_fs_copy_result(app_fs_session_t const * const session, connector_request_id_file_system_t const request, void * const data)
+{
+    app_fs_user_data_t * const user_data = data;
+
+    user_data->errnum = session->data.user.errnum;
+
+    switch (request)
+    {
+        case connector_request_id_file_system_open:
+        {
+            connector_file_system_open_t * const request_data = data;
+
+            request_data->handle = session->data.open.handle;
+            break;
+        }
+
+        case connector_request_id_file_system_write:
+        {
+            connector_file_system_write_t * const request_data = data;
+
+            request_data->bytes_used = session->data.write.bytes_used;
+            break;
+        }
+
+        case connector_request_id_file_system_stat:
+        {
+            connector_file_system_stat_t * const request_data = data;
+
+            request_data->statbuf = session->data.stat.statbuf;
+            request_data->hash_algorithm.actual = session->data.stat.hash_algorithm.actual;
+            break;
+        }
+
+        case connector_request_id_file_system_stat_dir_entry:
+        {
+            connector_file_system_stat_dir_entry_t * const request_data = data;
+
+            request_data->statbuf = session->data.stat_dir_entry.statbuf;
+            break;
+        }
+
+        case connector_request_id_file_system_opendir:
+        {
+            connector_file_system_opendir_t * const request_data = data;
+
+            request_data->handle = session->data.opendir.handle;
+            break;
+        }
+
+        case connector_request_id_file_system_readdir:
+        {
+            connector_file_system_readdir_t * const request_data = data;
+
+            memcpy(request_data->entry_name, session->output, strlen(session->output) + 1);
+            break;
+        }
+
+        case connector_request_id_file_system_hash:
+        {
+            connector_file_system_hash_t * const request_data = data;
+
+            memcpy(request_data->hash_value, session->output, request_data->bytes_requested);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static void app_fs_run_job(app_fs_session_t * const session)
+{
+    if (session->request == connector_request_id_file_system_read)
+    {
+        uint8_t * const buffer = session->read_ahead.buffer[session->read_ahead.current ^ 1];
+
+        session->read_ahead.result = read(session->read_ahead.fd, buffer, APP_FILE_SYSTEM_READ_AHEAD_SIZE);
+        session->read_ahead.error = (session->read_ahead.result < 0) ? errno : 0;
+    }
+    else
+    {
+        app_fs_user_data_t * const user_data = &session->data.user;
+
+        user_data->user_context = session->user_context;
+        session->status = app_file_system_process(session->request, &session->data);
+        session->user_context = user_data->user_context;
+    }
+}
+
+static void * app_fs_worker(void * const arg)
+{
+    UNUSED_ARGUMENT(arg);
+
+    pthread_mutex_lock(&app_fs_workers.mutex);
+    for (;;)
+    {
+        app_fs_session_t * const session = app_fs_workers.head;
+
+        if (session == NULL)
+        {
+            pthread_cond_wait(&app_fs_workers.queued, &app_fs_workers.mutex);
+            continue;
+        }
+
+        app_fs_workers.head = session->next;
+        if (app_fs_workers.head == NULL)
+            app_fs_workers.tail = NULL;
+        pthread_mutex_unlock(&app_fs_workers.mutex);
+
+        app_fs_run_job(session);
+
+        pthread_mutex_lock(&app_fs_workers.mutex);
+        session->state = app_fs_job_done;
+    }
+
+    return NULL;
+}
+
+static void app_fs_start_workers(void)
+{
+    unsigned int i;
+
+    app_fs_workers.started = 1;
+
+    for (i = 0; i < APP_FILE_SYSTEM_WORKER_THREADS; i++)
+    {
+        pthread_t thread;
+        int const ccode = pthread_create(&thread, NULL, app_fs_worker, NULL);
+
+        if (ccode != 0)
+        {
+            APP_DEBUG("app_start_workers: pthread_create() error %d\n", ccode);
+            break;
+        }
+
+        pthread_detach(thread);
+        app_fs_workers.threads++;
+    }
+}
+
+static void app_fs_queue_job(app_fs_session_t * const session, connector_request_id_file_system_t const request)
+{
+    if (!app_fs_workers.started)
+        app_fs_start_workers();
+
+    session->request = request;
+    session->next = NULL;
+
+    if (app_fs_workers.threads == 0)
+    {
+        /* no threads could be created, run the job here */
+        app_fs_run_job(session);
+        session->state = app_fs_job_done;
+        goto done;
+    }
+
+    pthread_mutex_lock(&app_fs_workers.mutex);
+    session->state = app_fs_job_queued;
+    if (app_fs_workers.tail != NULL)
+        app_fs_workers.tail->next = session;
+    else
+        app_fs_workers.head = session;
+    app_fs_workers.tail = session;
+    pthread_cond_signal(&app_fs_workers.queued);
+    pthread_mutex_unlock(&app_fs_workers.mutex);
+
+done:
+    return;
+}
+
+static app_fs_job_state_t app_fs_job_state(app_fs_session_t const * const session)
+{
+    app_fs_job_state_t state;
+
+    pthread_mutex_lock(&app_fs_workers.mutex);
+    state = session->state;
+    pthread_mutex_unlock(&app_fs_workers.mutex);
+
+    return state;
+}
+
+/*
+ * Drops a finished job Cloud Connector no longer asks for. An open or opendir that worked
+ * left a file or directory nobody else knows about, so it is closed here.
+ */
+static void app_fs_discard_result(app_fs_session_t * const session)
+{
+    ASSERT(session->state == app_fs_job_done);
+    session->state = app_fs_job_idle;
+
+    if (session->status != connector_callback_continue)
+        goto done;
+
+    switch (session->request)
+    {
+        case connector_request_id_file_system_open:
+        {
+            connector_file_system_close_t close_data = { NULL, 0, session->data.open.handle };
+
+            APP_DEBUG("app_fs_discard_result: closing fd %ld\n", session->data.open.handle);
+            app_process_file_close(&close_data);
+            break;
+        }
+
+        case connector_request_id_file_system_opendir:
+        {
+            app_dir_data_t * const dir_data = session->data.opendir.handle;
+
+            APP_DEBUG("app_fs_discard_result: closing dir %p\n", (void *) dir_data->dirp);
+            closedir(dir_data->dirp);
+            free(dir_data);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+done:
+    return;
+}
+
+/* The read ahead is dropped by anything but a read. The caller makes sure no job is queued */
+static void app_fs_end_read_ahead(app_fs_session_t * const session)
+{
+    if (session->request == connector_request_id_file_system_read)
+        session->state = app_fs_job_idle;
+
+    free(session->read_ahead.buffer[0]);
+    session->read_ahead.buffer[0] = NULL;
+    session->read_ahead.buffer[1] = NULL;
+}
+
+/* Bytes taken from the file by the read ahead but not returned to Cloud Connector */
+static size_t app_fs_read_ahead_unused(app_fs_session_t const * const session)
+{
+    size_t unused = session->read_ahead.length - session->read_ahead.offset;
+
+    if (session->state == app_fs_job_done && session->request == connector_request_id_file_system_read && session->read_ahead.result > 0)
+        unused += (size_t)session->read_ahead.result;
+
+    return unused;
+}
+
+static connector_callback_status_t app_fs_read(app_fs_session_t * const session, connector_file_system_read_t * const data)
+{
+    connector_callback_status_t status = connector_callback_continue;
+    app_fs_job_state_t state = app_fs_job_state(session);
+
+    if (state == app_fs_job_done && session->request != connector_request_id_file_system_read)
+    {
+        app_fs_discard_result(session);
+        state = app_fs_job_idle;
+    }
+
+    if (session->read_ahead.buffer[0] == NULL)
+    {
+        uint8_t * const buffer = malloc(2 * APP_FILE_SYSTEM_READ_AHEAD_SIZE);
+
+        if (buffer == NULL)
+        {
+            APP_DEBUG("app_fs_read: malloc fails\n");
+            status = app_process_file_error(&data->errnum, ENOMEM);
+            goto done;
+        }
+
+        session->read_ahead.buffer[0] = buffer;
+        session->read_ahead.buffer[1] = buffer + APP_FILE_SYSTEM_READ_AHEAD_SIZE;
+        session->read_ahead.current = 0;
+        session->read_ahead.length = 0;
+        session->read_ahead.offset = 0;
+        session->read_ahead.fd = data->handle;
+        session->read_ahead.end = 0;
+
+        app_fs_queue_job(session, connector_request_id_file_system_read);
+        status = connector_callback_busy;
+        goto done;
+    }
+
+    if (session->read_ahead.offset == session->read_ahead.length)
+    {
+        if (session->read_ahead.end)
+        {
+            data->bytes_used = 0;
+            goto done;
+        }
+
+        if (state == app_fs_job_queued)
+        {
+            status = connector_callback_busy;
+            goto done;
+        }
+
+        ASSERT(state == app_fs_job_done);
+        session->state = app_fs_job_idle;
+        state = app_fs_job_idle;
+        session->read_ahead.current ^= 1;
+        session->read_ahead.offset = 0;
+        session->read_ahead.length = 0;
+
+        if (session->read_ahead.result < 0)
+        {
+            APP_DEBUG("read fd %ld returned %zd, errno %d\n", session->read_ahead.fd, session->read_ahead.result, session->read_ahead.error);
+            status = app_process_file_error(&data->errnum, session->read_ahead.error);
+            goto done;
+        }
+
+        if (session->read_ahead.result == 0)
+        {
+            session->read_ahead.end = 1;
+            data->bytes_used = 0;
+            goto done;
+        }
+
+        session->read_ahead.length = (size_t)session->read_ahead.result;
+    }
+
+    {
+        size_t const bytes = APP_MIN_VALUE(session->read_ahead.length - session->read_ahead.offset, data->bytes_available);
+
+        data->external_buffer = session->read_ahead.buffer[session->read_ahead.current] + session->read_ahead.offset;
+        data->bytes_used = bytes;
+        session->read_ahead.offset += bytes;
+    }
+
+    /* the other buffer was returned before this callback, so it can be filled again */
+    if (state == app_fs_job_idle)
+        app_fs_queue_job(session, connector_request_id_file_system_read);
+
+done:
+    return status;
+}
+
+static connector_callback_status_t app_fs_lseek(app_fs_session_t * const session, connector_file_system_lseek_t * const data)
+{
+    connector_callback_status_t status = connector_callback_busy;
+
+    if (app_fs_job_state(session) == app_fs_job_queued)
+        goto done;
+
+    if (session->read_ahead.buffer[0] != NULL)
+    {
+        off_t const unused = (off_t)app_fs_read_ahead_unused(session);
+
+        /* put the file position back to where Cloud Connector thinks it is */
+        if (unused > 0 && lseek(session->read_ahead.fd, -unused, SEEK_CUR) < 0)
+        {
+            status = app_process_file_error(&data->errnum, errno);
+            goto done;
+        }
+        app_fs_end_read_ahead(session);
+    }
+
+    data->user_context = session->user_context;
+    status = app_process_file_lseek(data);
+    session->user_context = data->user_context;
+
+done:
+    return status;
+}
+
+static connector_callback_status_t app_fs_run(app_fs_session_t * const session, connector_request_id_file_system_t const request, void * const data)
+{
+    connector_callback_status_t status = connector_callback_busy;
+
+    switch (app_fs_job_state(session))
+    {
+        case app_fs_job_queued:
+            goto done;
+
+        case app_fs_job_done:
+            if (session->request == request)
+            {
+                app_fs_copy_result(session, request, data);
+                session->state = app_fs_job_idle;
+                status = session->status;
+                goto done;
+            }
+            /* a result nobody asks for any more */
+            app_fs_discard_result(session);
+            break;
+
+        case app_fs_job_idle:
+            break;
+    }
+
+    if (session->read_ahead.buffer[0] != NULL)
+        app_fs_end_read_ahead(session);
+
+    status = app_fs_copy_request(session, request, data);
+    if (status != connector_callback_continue)
+        goto done;
+
+    app_fs_queue_job(session, request);
+    status = connector_callback_busy;
+
+done:
+    return status;
+}
+
+static connector_callback_status_t app_fs_run_here(app_fs_session_t * const session, connector_request_id_file_system_t const request, void * const data)
+{
+    connector_callback_status_t status = connector_callback_busy;
+    app_fs_user_data_t * const user_data = data;
+
+    switch (app_fs_job_state(session))
+    {
+        case app_fs_job_queued:
+            goto done;
+
+        case app_fs_job_done:
+            if (session->request != connector_request_id_file_system_read)
+                app_fs_discard_result(session);
+            break;
+
+        case app_fs_job_idle:
+            break;
+    }
+
+    if (session->read_ahead.buffer[0] != NULL)
+        app_fs_end_read_ahead(session);
+
+    user_data->user_context = session->user_context;
+    status = app_file_system_process(request, data);
+    session->user_context = user_data->user_context;
+
+done:
+    return status;
+}
+
+connector_callback_status_t app_file_system_handler(connector_request_id_file_system_t const request,
+                                                    void * const data)
+{
+    connector_callback_status_t status;
+    app_fs_user_data_t * const user_data = data;
+    app_fs_session_t * session = user_data->user_context;
+
+    if (request == connector_request_id_file_system_get_error)
+    {
+        status = app_file_system_process(request, data);
+        goto done;
+    }
+
+    if (session == NULL)
+    {
+        if (request == connector_request_id_file_system_session_error)
+        {
+            status = connector_callback_continue;
+            goto done;
+        }
+
+        session = calloc(1, sizeof *session);
+        if (session == NULL)
+        {
+            APP_DEBUG("app_file_system_handler: malloc fails\n");
+            status = app_process_file_error(&user_data->errnum, ENOMEM);
+            goto done;
+        }
+        session->read_ahead.fd = -1;
+    }
+
+    switch (request)
+    {
+        case connector_request_id_file_system_read:
+            status = app_fs_read(session, data);
+            break;
+
+        case connector_request_id_file_system_lseek:
+            status = app_fs_lseek(session, data);
+            break;
+
+        case connector_request_id_file_system_closedir:
+        case connector_request_id_file_system_session_error:
+            status = app_fs_run_here(session, request, data);
+            break;
+
+        default:
+            if (app_fs_is_worker_request(request))
+                status = app_fs_run(session, request, data);
+            else
+                status = app_fs_run_here(session, request, data);
+            break;
+    }
+
+    /* the session is only kept while it has something to keep */
+    if (status != connector_callback_busy && session->state == app_fs_job_idle &&
+        session->read_ahead.buffer[0] == NULL && session->user_context == NULL)
+    {
+        free(session);
+        session = NULL;
+    }
+    user_data->user_context = session;
+
+done:
+    return status;
+}
+
+#else
+
+connector_callback_status_t app_file_system_handler(connector_request_id_file_system_t const request,
+                                                    void * const data)
+{
+    return app_file_system_process(request, data);
+}
+
+#endif
@@ -18,9 +18,43 @@
  */
 
 #include <pthread.h>
+#include <sched.h>
 #include "connector_api.h"
 #include "platform.h"
 
+/*
+ * Same as connector_run() but sleeps in app_os_wait() on the handles and timers
+ * reported by connector_get_wait_set() instead of polling with app_os_yield().
+ */
+static connector_status_t app_connector_run(connector_handle_t const handle)
+{
+    connector_status_t status;
+
+    do {
+        status = connector_step(handle);
+
+        switch (status)
+        {
+        case connector_idle:
+        case connector_pending:
+            app_os_wait(handle, status);
+            break;
+
+        case connector_working:
+        case connector_active:
+        case connector_success:
+            sched_yield();
+            break;
+
+        default:
+            break;
+        }
+
+    } while (status == connector_idle || status == connector_working || status == connector_pending || status == connector_active || status == connector_success);
+
+    return status;
+}
+
 static void * connector_run_thread(void * arg)
 {
 
@@ -28,9 +62,9 @@ static void * connector_run_thread(void * arg)
 
     for (;;)
     {
-        connector_status_t const status = connector_run(arg);
+        connector_status_t const status = app_connector_run(arg);
 
-        APP_DEBUG("connector_run returns %d\n", status);
+        APP_DEBUG("app_connector_run returns %d\n", status);
 
         if (status != connector_open_error) break;
     }
@@ -66,6 +100,7 @@ int main (void)
     connector_handle_t connector_handle;
 
     APP_DEBUG("Start Cloud Connector for Embedded\n");
+    app_os_wakeup_init();
     connector_handle = connector_init(app_connector_callback, NULL);
 
     if (connector_handle != NULL)
@@ -21,9 +21,12 @@
 #include <netinet/tcp.h>
 #include <netdb.h>
 #include <arpa/inet.h>
+#include <arpa/nameser.h>
+#include <resolv.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <errno.h>
+#include <strings.h>
 
 #include "connector_api.h"
 #include "platform.h"
@@ -31,36 +34,77 @@
 
 #if defined (CONNECTOR_TRANSPORT_TCP) || (defined CONNECTOR_TRANSPORT_UDP)
 
+/* Longest time an entry is used, and the time to live of names found in /etc/hosts */
 #define APP_DNS_CACHE_TIMEOUT   (24 * 3600)
+#define APP_DNS_CACHE_ENTRIES   4
+#define APP_DNS_ANSWER_SIZE     2048
 #define APP_MAX_HOST_NAME   64
 
 typedef struct
 {
     char name[APP_MAX_HOST_NAME];
-    in_addr_t ip_addr;
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count;
     unsigned long sys_time;
+    unsigned long expires;
+} app_dns_cache_entry_t;
+
+typedef struct
+{
+    app_dns_cache_entry_t entry[APP_DNS_CACHE_ENTRIES];
     int is_redirected;
+    app_dns_resolver_t resolver;
+    app_dns_getaddrinfo_t lookup;
+    app_dns_search_t search;
 } app_dns_cache_t;
 
-static app_dns_cache_t app_dns_cache = {"", INADDR_NONE, 0, 0};
+static app_dns_cache_t app_dns_cache;
 #define app_dns_is_redirected(class_id) ((class_id) == connector_class_id_network_udp ? 0 : app_dns_cache.is_redirected)
 
+static app_dns_cache_entry_t * app_dns_cache_find(char const * const device_cloud_url)
+{
+    app_dns_cache_entry_t * found = NULL;
+    size_t i;
+
+    for (i = 0; i < APP_DNS_CACHE_ENTRIES; i++)
+    {
+        app_dns_cache_entry_t * const entry = &app_dns_cache.entry[i];
+
+        if ((entry->count > 0) && (strncmp(entry->name, device_cloud_url, APP_MAX_HOST_NAME) == 0))
+        {
+            found = entry;
+            break;
+        }
+    }
+
+    return found;
+}
+
+/*
+ * Copies the cached addresses of device_cloud_url. Entries past their time to live
+ * are only used when use_stale is set, after a failed resolution.
+ */
 static int app_dns_cache_is_valid(connector_class_id_t const class_id,
                                    char const * const device_cloud_url,
-                                   in_addr_t * const ip_addr)
+                                   app_dns_address_t * const addresses,
+                                   size_t * const count,
+                                   int const use_stale)
 {
     int valid = 0;
 
     if (!app_dns_is_redirected(class_id))
     {
-        if ((app_dns_cache.ip_addr != INADDR_NONE) && (strncmp(app_dns_cache.name, device_cloud_url, APP_MAX_HOST_NAME) == 0))
+        app_dns_cache_entry_t const * const entry = app_dns_cache_find(device_cloud_url);
+
+        if (entry != NULL)
         {
             unsigned long elapsed_time;
 
             app_os_get_system_time(&elapsed_time);
-            if ((elapsed_time - app_dns_cache.sys_time) < APP_DNS_CACHE_TIMEOUT)
+            if (use_stale || (elapsed_time < entry->expires))
             {
-                *ip_addr = app_dns_cache.ip_addr;
+                memcpy(addresses, entry->addresses, entry->count * sizeof *addresses);
+                *count = entry->count;
                 valid = 1;
             }
         }
@@ -71,54 +115,238 @@ static int app_dns_cache_is_valid(connector_class_id_t const class_id,
 
 static void app_dns_cache_update(connector_class_id_t const class_id,
                                  char const * const device_cloud_url,
-                                 in_addr_t const ip_addr)
+                                 app_dns_address_t const * const addresses,
+                                 size_t const count,
+                                 unsigned long const ttl)
 {
     if (!app_dns_is_redirected(class_id))
     {
-        strncpy(app_dns_cache.name, device_cloud_url, APP_MAX_HOST_NAME - 1);
-        app_dns_cache.name[APP_MAX_HOST_NAME - 1] = '\0';
-        app_dns_cache.ip_addr = ip_addr;
-        app_os_get_system_time(&app_dns_cache.sys_time);
+        app_dns_cache_entry_t * entry = app_dns_cache_find(device_cloud_url);
+
+        if (entry == NULL)
+        {
+            size_t i;
+
+            /* take a free entry or the one updated longest ago */
+            entry = &app_dns_cache.entry[0];
+            for (i = 1; i < APP_DNS_CACHE_ENTRIES && entry->count > 0; i++)
+            {
+                if ((app_dns_cache.entry[i].count == 0) || (app_dns_cache.entry[i].sys_time < entry->sys_time))
+                    entry = &app_dns_cache.entry[i];
+            }
+        }
+
+        strncpy(entry->name, device_cloud_url, APP_MAX_HOST_NAME - 1);
+        entry->name[APP_MAX_HOST_NAME - 1] = '\0';
+        memcpy(entry->addresses, addresses, count * sizeof *addresses);
+        entry->count = count;
+        app_os_get_system_time(&entry->sys_time);
+        entry->expires = entry->sys_time + ((ttl < APP_DNS_CACHE_TIMEOUT) ? ttl : APP_DNS_CACHE_TIMEOUT);
+    }
+}
+
+/*
+ * Alternates the address families, starting with the family of the first
+ * address, so consecutive connect attempts do not all go to the same family.
+ */
+static void app_dns_order_addresses(app_dns_address_t * const addresses, size_t const count)
+{
+    app_dns_address_t ordered[APP_DNS_MAX_ADDRESSES];
+    int taken[APP_DNS_MAX_ADDRESSES] = {0};
+    sa_family_t family = addresses[0].addr.ss_family;
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        size_t next;
+
+        for (next = 0; next < count; next++)
+        {
+            if (!taken[next] && addresses[next].addr.ss_family == family)
+                break;
+        }
+
+        if (next == count)
+        {
+            /* only the other family is left */
+            for (next = 0; taken[next]; next++)
+                ;
+        }
+
+        ordered[i] = addresses[next];
+        taken[next] = 1;
+        family = (addresses[next].addr.ss_family == AF_INET6) ? AF_INET : AF_INET6;
     }
+
+    memcpy(addresses, ordered, count * sizeof *addresses);
 }
 
-static int app_dns_resolve_name(char const * const domain_name, in_addr_t * const ip_addr)
+static int app_dns_set_address(app_dns_address_t * const address, int const family, void const * const data)
+{
+    int ret = 0;
+
+    memset(address, 0, sizeof *address);
+
+    switch (family)
+    {
+    case AF_INET:
+    {
+        struct sockaddr_in * const sin = cast_for_alignment(struct sockaddr_in *, &address->addr);
+
+        sin->sin_family = AF_INET;
+        memcpy(&sin->sin_addr, data, sizeof sin->sin_addr);
+        address->length = sizeof *sin;
+        break;
+    }
+    case AF_INET6:
+    {
+        struct sockaddr_in6 * const sin6 = cast_for_alignment(struct sockaddr_in6 *, &address->addr);
+
+        sin6->sin6_family = AF_INET6;
+        memcpy(&sin6->sin6_addr, data, sizeof sin6->sin6_addr);
+        address->length = sizeof *sin6;
+        break;
+    }
+    default:
+        ret = -1;
+        break;
+    }
+
+    return ret;
+}
+
+/*
+ * Lowest time to live of the answer records of a DNS response, CNAME records
+ * included. Returns -1 when the response has no answer record.
+ */
+static int app_dns_answer_ttl(unsigned char const * const answer, int const length, unsigned long * const ttl)
 {
     int ret = -1;
+    ns_msg msg;
+    int i;
+
+    if (ns_initparse(answer, length, &msg) < 0)
+        goto done;
+
+    for (i = 0; i < ns_msg_count(msg, ns_s_an); i++)
+    {
+        ns_rr rr;
+
+        if (ns_parserr(&msg, ns_s_an, i, &rr) < 0)
+            break;
+
+        if (ret < 0 || ns_rr_ttl(rr) < *ttl)
+            *ttl = ns_rr_ttl(rr);
+        ret = 0;
+    }
+
+done:
+    return ret;
+}
+
+/* Whether domain_name is one of the names or aliases of the hosts database (/etc/hosts) */
+static int app_dns_is_host_file_name(char const * const domain_name)
+{
+    struct hostent const * host;
+    int found = 0;
+
+    sethostent(0);
+    while (!found && (host = gethostent()) != NULL)
+    {
+        char * const * alias;
+
+        found = (strcasecmp(host->h_name, domain_name) == 0);
+        for (alias = host->h_aliases; !found && *alias != NULL; alias++)
+            found = (strcasecmp(*alias, domain_name) == 0);
+    }
+    endhostent();
+
+    return found;
+}
+
+/*
+ * The default resolver. The addresses come from getaddrinfo(), which follows
+ * nsswitch.conf and /etc/hosts. getaddrinfo() does not report the time to live,
+ * so one more DNS query is made for it, of the A records if there is an IPv4
+ * address, of the AAAA records otherwise. Names of the hosts database and
+ * failed queries keep the entry for APP_DNS_CACHE_TIMEOUT.
+ */
+int app_dns_resolve_name(char const * const domain_name,
+                         app_dns_address_t * const addresses,
+                         size_t * const count,
+                         unsigned long * const ttl)
+{
+    app_dns_getaddrinfo_t const lookup = (app_dns_cache.lookup != NULL) ? app_dns_cache.lookup : getaddrinfo;
+    app_dns_search_t const search = (app_dns_cache.search != NULL) ? app_dns_cache.search : res_search;
     struct addrinfo *res_list;
     struct addrinfo *res;
+    struct addrinfo hint = {0};
+    int has_ipv4 = 0;
+    int ret = -1;
+    int error;
+    size_t i;
 
-   {
-        struct addrinfo hint = {0};
-        int error;
+    *count = 0;
+    *ttl = APP_DNS_CACHE_TIMEOUT;
 
-        hint.ai_socktype = SOCK_STREAM;
-        hint.ai_family   = AF_INET;
-        error = getaddrinfo(domain_name, NULL, &hint, &res_list);
-        if (error != 0)
-        {
-            APP_DEBUG("dns_resolve_name: DNS resolution failed for [%s]\n", domain_name);
-            goto done;
-        }
+    hint.ai_socktype = SOCK_STREAM;
+    hint.ai_family   = AF_UNSPEC;
+    error = lookup(domain_name, NULL, &hint, &res_list);
+    if (error != 0)
+    {
+        APP_DEBUG("dns_resolve_name: DNS resolution failed for [%s]\n", domain_name);
+        goto done;
     }
 
-    /* loop over all returned results and look for a IPv4 address */
-    for (res = res_list; res; res = res->ai_next)
+    for (res = res_list; res != NULL && *count < APP_DNS_MAX_ADDRESSES; res = res->ai_next)
     {
-        if (res->ai_family == PF_INET)
+        if (res->ai_family == AF_INET)
         {
-            struct sockaddr_in * const sa = cast_for_alignment(struct sockaddr_in *, res->ai_addr);
-            struct in_addr const ipv4_addr = sa->sin_addr;
+            struct sockaddr_in const * const sa = cast_for_alignment(struct sockaddr_in const *, res->ai_addr);
 
-            *ip_addr = ipv4_addr.s_addr;
-            APP_DEBUG("dns_resolve_name: ip address = [%s]\n", inet_ntoa(ipv4_addr));
-            ret = 0;
-            break;
+            app_dns_set_address(&addresses[*count], AF_INET, &sa->sin_addr);
+            (*count)++;
+            has_ipv4 = 1;
+        }
+        else if (res->ai_family == AF_INET6)
+        {
+            struct sockaddr_in6 const * const sa = cast_for_alignment(struct sockaddr_in6 const *, res->ai_addr);
+
+            app_dns_set_address(&addresses[*count], AF_INET6, &sa->sin6_addr);
+            (*count)++;
         }
     }
 
     freeaddrinfo(res_list);
 
+    if (*count == 0)
+        goto done;
+
+    if (!app_dns_is_host_file_name(domain_name))
+    {
+        unsigned char answer[APP_DNS_ANSWER_SIZE];
+        int const length = search(domain_name, ns_c_in, has_ipv4 ? ns_t_a : ns_t_aaaa, answer, sizeof answer);
+
+        if (length < 0 || app_dns_answer_ttl(answer, (length < (int)sizeof answer) ? length : (int)sizeof answer, ttl) < 0)
+        {
+            APP_DEBUG("dns_resolve_name: no time to live for [%s]\n", domain_name);
+            *ttl = APP_DNS_CACHE_TIMEOUT;
+        }
+    }
+
+    for (i = 0; i < *count; i++)
+    {
+        char name[INET6_ADDRSTRLEN];
+        struct sockaddr_in const * const sin = cast_for_alignment(struct sockaddr_in const *, &addresses[i].addr);
+        struct sockaddr_in6 const * const sin6 = cast_for_alignment(struct sockaddr_in6 const *, &addresses[i].addr);
+        void const * const addr = (addresses[i].addr.ss_family == AF_INET) ? (void const *)&sin->sin_addr : (void const *)&sin6->sin6_addr;
+
+        if (inet_ntop(addresses[i].addr.ss_family, addr, name, sizeof name) != NULL)
+            APP_DEBUG("dns_resolve_name: ip address = [%s], ttl %lu\n", name, *ttl);
+    }
+
+    ret = 0;
+
 done:
     return ret;
 }
@@ -130,46 +358,131 @@ void app_dns_set_redirected(connector_class_id_t const class_id, int const state
     app_dns_cache.is_redirected = state;
 }
 
+/*
+ * Makes the next resolution go to DNS again. The addresses are kept in case
+ * that resolution fails.
+ */
 void app_dns_cache_invalidate(connector_class_id_t const class_id)
 {
     if (!app_dns_is_redirected(class_id))
     {
-        app_dns_cache.ip_addr = INADDR_NONE;
+        size_t i;
+
+        for (i = 0; i < APP_DNS_CACHE_ENTRIES; i++)
+            app_dns_cache.entry[i].expires = 0;
     }
 }
 
+void app_dns_set_resolver(app_dns_resolver_t const resolver)
+{
+    app_dns_cache.resolver = resolver;
+}
+
+void app_dns_set_lookup(app_dns_getaddrinfo_t const lookup, app_dns_search_t const search)
+{
+    app_dns_cache.lookup = lookup;
+    app_dns_cache.search = search;
+}
+
+connector_callback_status_t app_dns_resolve_all(connector_class_id_t const class_id,
+                                                char const * const device_cloud_url,
+                                                app_dns_address_t * const addresses,
+                                                size_t * const count)
+{
+    connector_callback_status_t status = connector_callback_error;
+
+    if ((device_cloud_url == NULL) || (addresses == NULL) || (count == NULL))
+    {
+        status = connector_callback_abort;
+        goto done;
+    }
+
+    {
+        in_addr_t const ip_addr = inet_addr(device_cloud_url);
+        struct in6_addr ip6_addr;
+
+        if (ip_addr != INADDR_NONE)
+        {
+            app_dns_set_address(&addresses[0], AF_INET, &ip_addr);
+            *count = 1;
+            status = connector_callback_continue;
+            goto done;
+        }
+
+        if (inet_pton(AF_INET6, device_cloud_url, &ip6_addr) == 1)
+        {
+            app_dns_set_address(&addresses[0], AF_INET6, &ip6_addr);
+            *count = 1;
+            status = connector_callback_continue;
+            goto done;
+        }
+    }
+
+    if (!app_dns_cache_is_valid(class_id, device_cloud_url, addresses, count, 0))
+    {
+        app_dns_resolver_t const resolver = (app_dns_cache.resolver != NULL) ? app_dns_cache.resolver : app_dns_resolve_name;
+        unsigned long ttl;
+
+        if ((resolver(device_cloud_url, addresses, count, &ttl) == 0) && (*count > 0))
+        {
+            app_dns_order_addresses(addresses, *count);
+            app_dns_cache_update(class_id, device_cloud_url, addresses, *count, ttl);
+        }
+        else if (app_dns_cache_is_valid(class_id, device_cloud_url, addresses, count, 1))
+        {
+            APP_DEBUG("app_dns_resolve: Can't resolve DNS for %s, using the last known addresses\n", device_cloud_url);
+        }
+        else
+        {
+            APP_DEBUG("app_dns_resolve: Can't resolve DNS for %s\n", device_cloud_url);
+            goto done;
+        }
+    }
+    status = connector_callback_continue;
+
+done:
+    return status;
+}
+
+/*
+ * First IPv4 address of device_cloud_url.
+ */
 connector_callback_status_t app_dns_resolve(connector_class_id_t const class_id,
                                        char const * const device_cloud_url,
                                        in_addr_t * const ip_addr)
 {
-    connector_callback_status_t status = connector_callback_error;
+    connector_callback_status_t status;
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count;
+    size_t i;
 
-    if ((device_cloud_url == NULL) || (ip_addr == NULL))
+    if (ip_addr == NULL)
     {
         status = connector_callback_abort;
         goto done;
     }
-    *ip_addr = inet_addr(device_cloud_url);
 
-    if (*ip_addr == INADDR_NONE)
+    status = app_dns_resolve_all(class_id, device_cloud_url, addresses, &count);
+    if (status != connector_callback_continue)
+        goto done;
+
+    status = connector_callback_error;
+    for (i = 0; i < count; i++)
     {
-        if (!app_dns_cache_is_valid(class_id, device_cloud_url, ip_addr))
+        if (addresses[i].addr.ss_family == AF_INET)
         {
-            if (app_dns_resolve_name(device_cloud_url, ip_addr) == 0)
-            {
-                app_dns_cache_update(class_id, device_cloud_url, *ip_addr);
-            }
-            else
-            {
-                APP_DEBUG("app_dns_resolve: Can't resolve DNS for %s\n", device_cloud_url);
-                goto done;
-            }
+            struct sockaddr_in const * const sin = cast_for_alignment(struct sockaddr_in const *, &addresses[i].addr);
+
+            *ip_addr = sin->sin_addr.s_addr;
+            status = connector_callback_continue;
+            break;
         }
     }
-    status = connector_callback_continue;
+
+    if (status != connector_callback_continue)
+        APP_DEBUG("app_dns_resolve: no IPv4 address for %s\n", device_cloud_url);
 
 done:
     return status;
 }
 #endif
-
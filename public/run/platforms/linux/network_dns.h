@@ -20,10 +20,49 @@
 #ifndef _NETWORK_DNS_H
 #define _NETWORK_DNS_H
 
+/* Addresses kept for each host name, IPv6 and IPv4 together. */
+#define APP_DNS_MAX_ADDRESSES   8
+
+typedef struct
+{
+    struct sockaddr_storage addr;
+    socklen_t length;
+} app_dns_address_t;
+
+/*
+ * Looks up the addresses of domain_name, up to APP_DNS_MAX_ADDRESSES. Returns 0
+ * and sets count and ttl (in seconds) on success, -1 when the name could not be
+ * resolved. app_dns_set_resolver() replaces the default resolver, NULL restores it.
+ */
+typedef int (* app_dns_resolver_t)(char const * const domain_name,
+                                   app_dns_address_t * const addresses,
+                                   size_t * const count,
+                                   unsigned long * const ttl);
+
+/*
+ * The lookups of the default resolver, getaddrinfo() for the addresses and
+ * res_search() for their time to live. app_dns_set_lookup() replaces them,
+ * NULL restores the library function.
+ */
+typedef int (* app_dns_getaddrinfo_t)(char const * node, char const * service,
+                                      struct addrinfo const * hints, struct addrinfo ** res);
+typedef int (* app_dns_search_t)(char const * domain_name, int class_, int type,
+                                 unsigned char * answer, int length);
+
 extern connector_callback_status_t app_dns_resolve(connector_class_id_t const class_id,
                                                char const * const domain_name,
                                                in_addr_t * const ip_addr);
+extern connector_callback_status_t app_dns_resolve_all(connector_class_id_t const class_id,
+                                                   char const * const domain_name,
+                                                   app_dns_address_t * const addresses,
+                                                   size_t * const count);
 extern void app_dns_set_redirected(connector_class_id_t const class_id, int const state);
 extern void app_dns_cache_invalidate(connector_class_id_t const class_id);
+extern void app_dns_set_resolver(app_dns_resolver_t const resolver);
+extern void app_dns_set_lookup(app_dns_getaddrinfo_t const lookup, app_dns_search_t const search);
+extern int app_dns_resolve_name(char const * const domain_name,
+                                app_dns_address_t * const addresses,
+                                size_t * const count,
+                                unsigned long * const ttl);
 
 #endif
@@ -24,6 +24,9 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <time.h>
 #include <errno.h>
 
 #include "connector_api.h"
@@ -131,10 +134,54 @@ static connector_callback_status_t app_network_tcp_send(connector_network_send_t
     return status;
 }
 
+/*
+ * Send several queued packets with one writev() call. Buffers past
+ * APP_TCP_MAX_IOV are left for the next call.
+ */
+#define APP_TCP_MAX_IOV 16
 
-static int app_tcp_create_socket(void)
+static connector_callback_status_t app_network_tcp_send_iov(connector_network_send_iov_t * const data)
 {
-    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    connector_callback_status_t status = connector_callback_continue;
+    int * const fd = data->handle;
+    struct iovec iov[APP_TCP_MAX_IOV];
+    int const iov_count = (data->iov_count < APP_TCP_MAX_IOV) ? (int)data->iov_count : APP_TCP_MAX_IOV;
+    int i;
+    ssize_t ccode;
+
+    for (i = 0; i < iov_count; i++)
+    {
+        iov[i].iov_base = (void *)data->iov[i].buffer;
+        iov[i].iov_len = data->iov[i].length;
+    }
+
+    ccode = writev(*fd, iov, iov_count);
+    if (ccode >= 0)
+    {
+        data->bytes_used = (size_t)ccode;
+    }
+    else
+    {
+        int const err = errno;
+        if (err == EAGAIN)
+        {
+            status = connector_callback_busy;
+        }
+        else
+        {
+            status = connector_callback_error;
+            APP_DEBUG("app_network_tcp_send_iov: writev() failed, errno %d\n", err);
+            app_dns_cache_invalidate(connector_class_id_network_tcp);
+        }
+    }
+
+    return status;
+}
+
+
+static int app_tcp_create_socket(int const family)
+{
+    int fd = socket(family, SOCK_STREAM, 0);
 
     if (fd >= 0)
     {
@@ -165,20 +212,20 @@ static int app_tcp_create_socket(void)
     return fd;
 }
 
-static connector_callback_status_t app_tcp_connect(int const fd, in_addr_t const ip_addr)
+static connector_callback_status_t app_tcp_connect(int const fd, app_dns_address_t const * const address)
 {
-
-    struct sockaddr_in sin = {0};
+    app_dns_address_t sin = *address;
     connector_callback_status_t status = connector_callback_continue;
 
-    memcpy(&sin.sin_addr, &ip_addr, sizeof sin.sin_addr);
-    sin.sin_port   = htons(CONNECTOR_PORT);
-    sin.sin_family = AF_INET;
+    if (sin.addr.ss_family == AF_INET6)
+        cast_for_alignment(struct sockaddr_in6 *, &sin.addr)->sin6_port = htons(CONNECTOR_PORT);
+    else
+        cast_for_alignment(struct sockaddr_in *, &sin.addr)->sin_port = htons(CONNECTOR_PORT);
 
     APP_DEBUG("app_tcp_connect: fd %d\n", fd);
 
 
-    if (connect(fd, (struct sockaddr *)&sin, sizeof(sin)) < 0)
+    if (connect(fd, (struct sockaddr *)&sin.addr, sin.length) < 0)
     {
         int const err = errno;
         switch (err)
@@ -198,53 +245,170 @@ static connector_callback_status_t app_tcp_connect(int const fd, in_addr_t const
     return status;
 }
 
-static connector_callback_status_t app_is_tcp_connect_complete(int const fd)
+/*
+ * Connects to the addresses of Device Cloud the Happy Eyeballs way (RFC 8305):
+ * a new attempt starts every APP_CONNECT_ATTEMPT_DELAY_MS, or as soon as one
+ * fails, while the earlier ones keep going. The first to connect is used.
+ */
+#define APP_CONNECT_TIMEOUT             30
+#define APP_CONNECT_ATTEMPT_DELAY_MS    250
+#define APP_MAX_CONNECT_ATTEMPTS        4
+
+typedef struct
 {
-    connector_callback_status_t status = connector_callback_busy;
-    struct timeval timeout = {0};
-    fd_set read_set, write_set;
-    int rc;
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count;
+    size_t next;
+    int fd[APP_MAX_CONNECT_ATTEMPTS];
+    unsigned long connect_time;
+    unsigned long attempt_time_ms;
+} app_tcp_connect_t;
 
-    FD_ZERO(&read_set);
-    FD_SET(fd, &read_set);
-    write_set = read_set;
+static app_tcp_connect_t app_tcp_connect_state;
 
-    rc = select(fd+1, &read_set, &write_set, NULL, &timeout);
-    if (rc < 0)
+static unsigned long app_tcp_time_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)now.tv_sec * 1000 + (unsigned long)(now.tv_nsec / 1000000);
+}
+
+static void app_tcp_close_attempts(app_tcp_connect_t * const connect_ptr, int const keep_fd)
+{
+    int i;
+
+    for (i = 0; i < APP_MAX_CONNECT_ATTEMPTS; i++)
     {
-        if (errno != EINTR) {
-            APP_DEBUG("app_is_tcp_connect_complete: select on fd %d returned %d, errno %d\n", fd, rc, errno);
-            status = connector_callback_error;
+        if (connect_ptr->fd[i] >= 0 && connect_ptr->fd[i] != keep_fd)
+            close(connect_ptr->fd[i]);
+        connect_ptr->fd[i] = -1;
+    }
+}
+
+/* Starts a connect to the next address, returns the socket or -1 when no attempt is pending */
+static int app_tcp_start_attempt(app_tcp_connect_t * const connect_ptr, int const slot)
+{
+    int fd = -1;
+
+    while (fd < 0 && connect_ptr->next < connect_ptr->count)
+    {
+        app_dns_address_t const * const address = &connect_ptr->addresses[connect_ptr->next++];
+
+        fd = app_tcp_create_socket(address->addr.ss_family);
+        if (fd >= 0 && app_tcp_connect(fd, address) == connector_callback_error)
+        {
+            /* unreachable family or address, go on with the next one */
+            close(fd);
+            fd = -1;
         }
     }
-    else
-    /* Check whether the socket is now writable (connection succeeded). */
-    if (rc > 0 && FD_ISSET(fd, &write_set))
+
+    connect_ptr->fd[slot] = fd;
+    connect_ptr->attempt_time_ms = app_tcp_time_ms();
+
+    return fd;
+}
+
+/*
+ * Returns connector_callback_continue and the connected socket in connected_fd,
+ * connector_callback_busy while attempts are pending or connector_callback_error
+ * once every address failed.
+ */
+static connector_callback_status_t app_tcp_connect_attempts(app_tcp_connect_t * const connect_ptr, int * const connected_fd)
+{
+    connector_callback_status_t status = connector_callback_busy;
+    struct pollfd fds[APP_MAX_CONNECT_ATTEMPTS];
+    int slot[APP_MAX_CONNECT_ATTEMPTS];
+    nfds_t count = 0;
+    nfds_t pending;
+    int free_slot = -1;
+    int i;
+
+    for (i = 0; i < APP_MAX_CONNECT_ATTEMPTS; i++)
     {
-        /* We expect "socket writable" when the connection succeeds. */
-        /* If we also got a "socket readable" we have an error. */
-        if (FD_ISSET(fd, &read_set))
+        if (connect_ptr->fd[i] >= 0)
         {
-            APP_DEBUG("app_is_tcp_connect_complete: FD_ISSET for read, fd %d\n", fd);
-            status = connector_callback_error;
+            fds[count].fd = connect_ptr->fd[i];
+            fds[count].events = POLLOUT;
+            fds[count].revents = 0;
+            slot[count] = i;
+            count++;
+        }
+        else if (free_slot < 0)
+        {
+            free_slot = i;
+        }
+    }
+
+    pending = count;
+    if (count > 0 && poll(fds, count, 0) > 0)
+    {
+        nfds_t n;
+
+        for (n = 0; n < count; n++)
+        {
+            int error = 0;
+            socklen_t length = sizeof error;
+
+            if (fds[n].revents == 0)
+                continue;
 
+            if (getsockopt(fds[n].fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0)
+            {
+                *connected_fd = fds[n].fd;
+                app_tcp_close_attempts(connect_ptr, fds[n].fd);
+                status = connector_callback_continue;
+                goto done;
+            }
+
+            APP_DEBUG("app_tcp_connect_attempts: connect failed, fd %d, errno %d\n", fds[n].fd, error);
+            close(fds[n].fd);
+            connect_ptr->fd[slot[n]] = -1;
+            pending--;
+            if (free_slot < 0 || slot[n] < free_slot)
+                free_slot = slot[n];
+            /* a failure starts the next attempt right away */
+            connect_ptr->attempt_time_ms = 0;
         }
-        else
+    }
+
+    if (free_slot >= 0 && connect_ptr->next < connect_ptr->count)
+    {
+        if (pending == 0 || app_tcp_time_ms() - connect_ptr->attempt_time_ms >= APP_CONNECT_ATTEMPT_DELAY_MS)
         {
-            status = connector_callback_continue;
+            if (app_tcp_start_attempt(connect_ptr, free_slot) >= 0)
+                pending++;
         }
     }
+
+    if (pending == 0 && connect_ptr->next >= connect_ptr->count)
+        status = connector_callback_error;
+
+done:
     return status;
 }
 
-static connector_callback_status_t app_network_tcp_open(connector_network_open_t * const data)
+/* Socket of the latest attempt, the one connector_get_wait_set() reports while connecting */
+static int app_tcp_latest_attempt(app_tcp_connect_t const * const connect_ptr)
 {
-#define APP_CONNECT_TIMEOUT 30
+    int fd = -1;
+    int i;
+
+    for (i = 0; i < APP_MAX_CONNECT_ATTEMPTS; i++)
+    {
+        if (connect_ptr->fd[i] > fd)
+            fd = connect_ptr->fd[i];
+    }
 
-    static unsigned long connect_time;
+    return fd;
+}
+
+static connector_callback_status_t app_network_tcp_open(connector_network_open_t * const data)
+{
+    app_tcp_connect_t * const connect_ptr = &app_tcp_connect_state;
     int * pfd = NULL;
-    struct sockaddr_in interface_addr;
-    socklen_t interface_addr_len;
+    int connected_fd = -1;
 
     connector_callback_status_t status = connector_callback_error;
 
@@ -261,41 +425,27 @@ static connector_callback_status_t app_network_tcp_open(connector_network_open_t
 
     if (*pfd == -1)
     {
-        in_addr_t ip_addr;
+        int i;
 
-        status = app_dns_resolve(connector_class_id_network_tcp, data->device_cloud.url, &ip_addr);
+        status = app_dns_resolve_all(connector_class_id_network_tcp, data->device_cloud.url, connect_ptr->addresses, &connect_ptr->count);
         if (status != connector_callback_continue)
         {
             APP_DEBUG("app_network_tcp_open: Can't resolve DNS for %s\n", data->device_cloud.url);
             goto done;
         }
 
-        *pfd = app_tcp_create_socket();
-        if (*pfd == -1)
-        {
-            status = connector_callback_error;
-            free(pfd);
-            goto done;
-        }
-
-        app_os_get_system_time(&connect_time);
-        status = app_tcp_connect(*pfd, ip_addr);
-        if (status != connector_callback_continue)
-            goto error;
+        for (i = 0; i < APP_MAX_CONNECT_ATTEMPTS; i++)
+            connect_ptr->fd[i] = -1;
+        connect_ptr->next = 0;
+        connect_ptr->attempt_time_ms = 0;
+        app_os_get_system_time(&connect_ptr->connect_time);
     }
 
-    /* Get socket info of connected interface */
-    interface_addr_len = sizeof(interface_addr);
-    if (getsockname(*pfd, (struct sockaddr *)&interface_addr, &interface_addr_len))
-    {
-        APP_DEBUG("network_connect: getsockname error, errno %d\n", errno);
-        goto done;
-    }
-
-    status = app_is_tcp_connect_complete(*pfd);
+    status = app_tcp_connect_attempts(connect_ptr, &connected_fd);
     if (status == connector_callback_continue)
     {
-         APP_DEBUG("app_network_tcp_open: connected to %s\n", data->device_cloud.url);
+         *pfd = connected_fd;
+         APP_DEBUG("app_network_tcp_open: connected to %s, fd %d\n", data->device_cloud.url, connected_fd);
          goto done;
     }
 
@@ -304,30 +454,27 @@ static connector_callback_status_t app_network_tcp_open(connector_network_open_t
         unsigned long elapsed_time;
 
         app_os_get_system_time(&elapsed_time);
-        elapsed_time -= connect_time;
+        elapsed_time -= connect_ptr->connect_time;
 
         if (elapsed_time >= APP_CONNECT_TIMEOUT)
         {
-            APP_DEBUG("app_network_tcp_open: failed to connect within 30 seconds\n");
+            APP_DEBUG("app_network_tcp_open: failed to connect within %d seconds\n", APP_CONNECT_TIMEOUT);
             status = connector_callback_error;
         }
+        else
+        {
+            *pfd = app_tcp_latest_attempt(connect_ptr);
+        }
     }
 
-error:
     if (status == connector_callback_error)
     {
         APP_DEBUG("app_network_tcp_open: failed to connect to %s\n", data->device_cloud.url);
+        app_tcp_close_attempts(connect_ptr, -1);
+        app_dns_cache_invalidate(connector_class_id_network_tcp);
         app_dns_set_redirected(connector_class_id_network_tcp, 0);
 
-        if (pfd != NULL)
-        {
-            if (*pfd >= 0)
-            {
-                close(*pfd);
-                *pfd = -1;
-            }
-            free(pfd);
-        }
+        free(pfd);
     }
 
 done:
@@ -335,6 +482,17 @@ done:
 }
 
 
+/*
+ * Socket to wait on for the handle reported by connector_get_wait_set().
+ */
+int app_network_tcp_get_fd(connector_network_handle_t const handle, connector_bool_t * const data_pending)
+{
+    int const * const fd = handle;
+
+    *data_pending = connector_false;
+    return *fd;
+}
+
 /*
  *  Callback routine to handle all networking related calls.
  */
@@ -353,6 +511,10 @@ connector_callback_status_t app_network_tcp_handler(connector_request_id_network
         status = app_network_tcp_send(data);
         break;
 
+    case connector_request_id_network_send_iov:
+        status = app_network_tcp_send_iov(data);
+        break;
+
     case connector_request_id_network_receive:
         status = app_network_tcp_receive(data);
         break;
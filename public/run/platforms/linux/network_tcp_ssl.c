@@ -47,13 +47,40 @@ connector_callback_status_t app_get_interface_ip_address(uint8_t ** ip_address,
     return connector_callback_continue;
 }
 
+/*
+ * Define APP_SSL_SESSION_RESUMPTION to 0 to run a full handshake on every connect. Otherwise
+ * the session Device Cloud issued last, by session ID or ticket, is offered when connecting
+ * to the same URL again, which skips the certificate exchange and verification.
+ */
+#ifndef APP_SSL_SESSION_RESUMPTION
+#define APP_SSL_SESSION_RESUMPTION 1
+#endif
+
+#define APP_CONNECT_TIMEOUT 30
+
+typedef enum
+{
+    app_ssl_state_tcp_connect,
+    app_ssl_state_handshake,
+    app_ssl_state_connected
+} app_ssl_state_t;
+
 typedef struct
 {
     int sfd;
-    SSL_CTX * ctx;
     SSL * ssl;
+    app_ssl_state_t state;
+    unsigned long connect_time;
 } app_ssl_t;
 
+/* Kept across connections, so the CA certificate is only loaded once and sessions can be resumed */
+static SSL_CTX * app_ssl_ctx;
+
+#if (APP_SSL_SESSION_RESUMPTION)
+static SSL_SESSION * app_ssl_session;
+static char app_ssl_session_url[256];
+#endif
+
 static int app_setup_socket(void)
 {
     int const protocol = 0;
@@ -117,35 +144,37 @@ static int app_connect_to_device_cloud(int fd, in_addr_t const ip_addr)
     return ret;
 }
 
-static int app_is_connect_complete(int fd)
+static connector_callback_status_t app_is_connect_complete(int const fd)
 {
-    int ret = -1;
+    connector_callback_status_t status = connector_callback_busy;
     struct timeval timeout = {0};
     fd_set read_set;
     fd_set write_set;
+    int rc;
 
     FD_ZERO(&read_set);
     FD_SET(fd, &read_set);
     write_set = read_set;
 
-    timeout.tv_sec = 2;
-    /* wait for 2 seconds to connect */
-    if (select(fd+1, &read_set, &write_set, NULL, &timeout) <= 0)
-        goto error;
-
+    rc = select(fd+1, &read_set, &write_set, NULL, &timeout);
+    if (rc < 0)
+    {
+        if (errno != EINTR)
+        {
+            APP_DEBUG("app_is_connect_complete: select failed, errno %d\n", errno);
+            status = connector_callback_error;
+        }
+    }
+    else
     /* Check whether the socket is now writable (connection succeeded). */
-    if (FD_ISSET(fd, &write_set))
+    if (rc > 0 && FD_ISSET(fd, &write_set))
     {
         /* We expect "socket writable" when the connection succeeds. */
         /* If we also got a "socket readable" we have an error. */
-        if (FD_ISSET(fd, &read_set))
-            goto error;
-
-        ret = 0;
+        status = FD_ISSET(fd, &read_set) ? connector_callback_error : connector_callback_continue;
     }
 
-error:
-    return ret;
+    return status;
 }
 
 #if (defined APP_SSL_CLNT_CERT)
@@ -210,12 +239,6 @@ static void app_free_ssl_info(app_ssl_t * const ssl_ptr)
         ssl_ptr->ssl = NULL;
     }
 
-    if (ssl_ptr->ctx != NULL)
-    {
-        SSL_CTX_free(ssl_ptr->ctx);
-        ssl_ptr->ctx = NULL;
-    }
-
     if (ssl_ptr->sfd != -1)
     {
         close(ssl_ptr->sfd);
@@ -245,52 +268,159 @@ done:
     return ret;
 }
 
-static int app_ssl_connect(app_ssl_t * const ssl_ptr)
+#if (APP_SSL_SESSION_RESUMPTION)
+/* Called for every session Device Cloud issues, which with TLS 1.3 is after the handshake */
+static int app_ssl_new_session(SSL * const ssl, SSL_SESSION * const session)
 {
-    int ret = -1;
+    UNUSED_ARGUMENT(ssl);
+
+    if (app_ssl_session != NULL)
+        SSL_SESSION_free(app_ssl_session);
+    app_ssl_session = session;
 
-    SSL_library_init();
-    OpenSSL_add_all_algorithms();
-    SSL_load_error_strings();
-    ssl_ptr->ctx = SSL_CTX_new(TLSv1_client_method());
-    if (ssl_ptr->ctx == NULL)
+    return 1;
+}
+
+static void app_ssl_drop_session(void)
+{
+    if (app_ssl_session != NULL)
     {
-        ERR_print_errors_fp(stderr);
-        goto error;
+        SSL_SESSION_free(app_ssl_session);
+        app_ssl_session = NULL;
+    }
+}
+
+/* A session is only offered to the URL that issued it, a redirect starts over */
+static void app_ssl_offer_session(SSL * const ssl, char const * const url)
+{
+    if (strcmp(url, app_ssl_session_url) != 0)
+    {
+        app_ssl_drop_session();
+        app_ssl_session_url[0] = '\0';
+        if (strlen(url) < sizeof app_ssl_session_url)
+            strcpy(app_ssl_session_url, url);
+    }
+    else if (app_ssl_session != NULL)
+    {
+        SSL_set_session(ssl, app_ssl_session);
     }
+}
+#endif
 
-    ssl_ptr->ssl = SSL_new(ssl_ptr->ctx);
+static SSL_CTX * app_ssl_get_ctx(void)
+{
+    if (app_ssl_ctx == NULL)
+    {
+        SSL_CTX * ctx;
+
+        SSL_library_init();
+        OpenSSL_add_all_algorithms();
+        SSL_load_error_strings();
+#if (OPENSSL_VERSION_NUMBER >= 0x10100000L)
+        ctx = SSL_CTX_new(TLS_client_method());
+#else
+        ctx = SSL_CTX_new(SSLv23_client_method());
+#endif
+        if (ctx == NULL)
+        {
+            ERR_print_errors_fp(stderr);
+            goto done;
+        }
+        SSL_CTX_set_options(ctx, SSL_OP_ALL | SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
+
+        if (app_load_certificate_and_key(ctx) != 1)
+        {
+            SSL_CTX_free(ctx);
+            goto done;
+        }
+
+#if (APP_SSL_SESSION_RESUMPTION)
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(ctx, app_ssl_new_session);
+#else
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+        SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+#endif
+        app_ssl_ctx = ctx;
+    }
+
+done:
+    return app_ssl_ctx;
+}
+
+static connector_callback_status_t app_ssl_start(app_ssl_t * const ssl_ptr, char const * const url)
+{
+    connector_callback_status_t status = connector_callback_error;
+    SSL_CTX * const ctx = app_ssl_get_ctx();
+
+    if (ctx == NULL)
+        goto done;
+
+    ssl_ptr->ssl = SSL_new(ctx);
     if (ssl_ptr->ssl == NULL)
     {
         ERR_print_errors_fp(stderr);
-        goto error;
+        goto done;
     }
 
     SSL_set_fd(ssl_ptr->ssl, ssl_ptr->sfd);
-    if (app_load_certificate_and_key(ssl_ptr->ctx) != 1)
-        goto error;
+#if (APP_SSL_SESSION_RESUMPTION)
+    app_ssl_offer_session(ssl_ptr->ssl, url);
+#else
+    UNUSED_ARGUMENT(url);
+#endif
+    status = connector_callback_continue;
+
+done:
+    return status;
+}
 
-    SSL_set_options(ssl_ptr->ssl, SSL_OP_ALL);
-    if (SSL_connect(ssl_ptr->ssl) <= 0)
+/*
+ * Steps the handshake on the non-blocking socket, returns connector_callback_busy
+ * until Device Cloud answered. wait_for_receive tells connector_get_wait_set() which
+ * way the handshake is blocked.
+ */
+static connector_callback_status_t app_ssl_handshake(app_ssl_t * const ssl_ptr, connector_bool_t * const wait_for_receive)
+{
+    connector_callback_status_t status = connector_callback_error;
+    int const ret = SSL_connect(ssl_ptr->ssl);
+
+    if (ret <= 0)
     {
-        ERR_print_errors_fp(stderr);
-        goto error;
+        switch (SSL_get_error(ssl_ptr->ssl, ret))
+        {
+        case SSL_ERROR_WANT_READ:
+            *wait_for_receive = connector_true;
+            status = connector_callback_busy;
+            break;
+
+        case SSL_ERROR_WANT_WRITE:
+            status = connector_callback_busy;
+            break;
+
+        default:
+            ERR_print_errors_fp(stderr);
+            break;
+        }
+        goto done;
     }
 
+    /* a resumed session carries the peer certificate and verify result of the full handshake */
     if (app_verify_device_cloud_certificate(ssl_ptr->ssl) != X509_V_OK)
-        goto error;
+        goto done;
 
-    ret = 0;
+    APP_DEBUG("network_connect: TLS handshake done, session %s\n", SSL_session_reused(ssl_ptr->ssl) ? "resumed" : "new");
+    status = connector_callback_continue;
 
-error:
-    return ret;
+done:
+    return status;
 }
 
 static connector_callback_status_t app_tcp_connect(in_addr_t const ip_addr,
                                                    connector_network_open_t * const data)
 {
     connector_callback_status_t status = connector_callback_error;
-    static app_ssl_t ssl_info = {0};
+    static app_ssl_t ssl_info = {-1, NULL, app_ssl_state_tcp_connect, 0};
     socklen_t interface_addr_len;
 
     ssl_info.sfd = app_setup_socket();
@@ -300,16 +430,7 @@ static connector_callback_status_t app_tcp_connect(in_addr_t const ip_addr,
         goto done;
     }
 
-    if (app_connect_to_device_cloud(ssl_info.sfd, ip_addr) < 0)
-       goto error;
-
-    if (app_is_connect_complete(ssl_info.sfd) < 0)
-        goto error;
-
-    if (app_ssl_connect(&ssl_info) < 0)
-        goto error;
-
-    /* make it non-blocking now */
+    /* non-blocking from the start, the handshake is stepped by app_network_tcp_open() */
     {
         int enabled = 1;
 
@@ -320,17 +441,21 @@ static connector_callback_status_t app_tcp_connect(in_addr_t const ip_addr,
         }
     }
 
+    if (app_connect_to_device_cloud(ssl_info.sfd, ip_addr) < 0)
+       goto error;
+
     /* Get socket info of connected interface */
     interface_addr_len = sizeof(interface_addr);
     if (getsockname(ssl_info.sfd, (struct sockaddr *)&interface_addr, &interface_addr_len))
     {
         APP_DEBUG("network_connect: getsockname error, errno %d\n", errno);
-        goto done;
+        goto error;
     }
 
-    APP_DEBUG("network_connect: connected\n");
+    app_os_get_system_time(&ssl_info.connect_time);
+    ssl_info.state = app_ssl_state_tcp_connect;
     data->handle = &ssl_info;
-    status = connector_callback_continue;
+    status = connector_callback_busy;
     goto done;
 
 error:
@@ -441,17 +566,73 @@ static connector_callback_status_t app_network_tcp_close(connector_network_close
 static connector_callback_status_t app_network_tcp_open(connector_network_open_t * const data)
 {
     connector_callback_status_t status;
-    in_addr_t ip_addr;
+    app_ssl_t * ssl_ptr = data->handle;
 
-    status = app_dns_resolve(connector_class_id_network_tcp, data->device_cloud.url, &ip_addr);
-    if (status != connector_callback_continue)
+    if (ssl_ptr == NULL)
     {
-        APP_DEBUG("app_network_tcp_open: Can't resolve DNS for %s\n", data->device_cloud.url);
-        goto done;
+        in_addr_t ip_addr;
+
+        status = app_dns_resolve(connector_class_id_network_tcp, data->device_cloud.url, &ip_addr);
+        if (status != connector_callback_continue)
+        {
+            APP_DEBUG("app_network_tcp_open: Can't resolve DNS for %s\n", data->device_cloud.url);
+            goto done;
+        }
+
+        status = app_tcp_connect(ip_addr, data);
+        if (status != connector_callback_busy)
+            goto error;
+        ssl_ptr = data->handle;
+    }
+
+    switch (ssl_ptr->state)
+    {
+    case app_ssl_state_tcp_connect:
+        status = app_is_connect_complete(ssl_ptr->sfd);
+        if (status != connector_callback_continue)
+            break;
+
+        status = app_ssl_start(ssl_ptr, data->device_cloud.url);
+        if (status != connector_callback_continue)
+            break;
+        ssl_ptr->state = app_ssl_state_handshake;
+        /* fall through */
+
+    case app_ssl_state_handshake:
+        status = app_ssl_handshake(ssl_ptr, &data->wait_for_receive);
+        if (status == connector_callback_continue)
+            ssl_ptr->state = app_ssl_state_connected;
+        break;
+
+    case app_ssl_state_connected:
+        status = connector_callback_continue;
+        break;
     }
 
-    status = app_tcp_connect(ip_addr, data);
+    if (status == connector_callback_busy)
+    {
+        unsigned long elapsed_time;
+
+        app_os_get_system_time(&elapsed_time);
+        if (elapsed_time - ssl_ptr->connect_time >= APP_CONNECT_TIMEOUT)
+        {
+            APP_DEBUG("app_network_tcp_open: failed to connect within %d seconds\n", APP_CONNECT_TIMEOUT);
+            status = connector_callback_error;
+        }
+    }
+
+    if (status == connector_callback_error)
+    {
+#if (APP_SSL_SESSION_RESUMPTION)
+        /* do not offer a session Device Cloud may have refused */
+        if (ssl_ptr->state == app_ssl_state_handshake)
+            app_ssl_drop_session();
+#endif
+        app_free_ssl_info(ssl_ptr);
+        app_dns_set_redirected(connector_class_id_network_tcp, 0);
+    }
 
+error:
     if (status == connector_callback_continue)
         APP_DEBUG("network_tcp_open: connected to %s\n", data->device_cloud.url);
     else
@@ -463,6 +644,18 @@ done:
 
 }
 
+/*
+ * Socket to wait on for the handle reported by connector_get_wait_set().
+ * Data already decrypted by SSL does not show up on the socket.
+ */
+int app_network_tcp_get_fd(connector_network_handle_t const handle, connector_bool_t * const data_pending)
+{
+    app_ssl_t const * const ssl_ptr = handle;
+
+    *data_pending = (ssl_ptr->ssl != NULL && SSL_pending(ssl_ptr->ssl) > 0) ? connector_true : connector_false;
+    return ssl_ptr->sfd;
+}
+
 /*
  *  Callback routine to handle all networking related calls.
  */
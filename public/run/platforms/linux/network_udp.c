@@ -204,6 +204,16 @@ done:
 }
 
 
+/*
+ * Socket to wait on for the handle reported by connector_get_wait_set().
+ */
+int app_network_udp_get_fd(connector_network_handle_t const handle)
+{
+    int const * const fd = handle;
+
+    return *fd;
+}
+
 /*
  *  Callback routine to handle all networking related calls.
  */
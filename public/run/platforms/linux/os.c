@@ -27,6 +27,10 @@
 #include <sys/reboot.h>
 #endif
 #include <sched.h>
+#include <poll.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <errno.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -99,6 +103,16 @@ connector_callback_status_t app_os_get_system_time(unsigned long * const uptime)
     return connector_callback_continue;
 }
 
+static connector_callback_status_t app_os_get_system_time_in_ms(unsigned long * const uptime)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    *uptime = (unsigned long)now.tv_sec * 1000 + (unsigned long)(now.tv_nsec / 1000000);
+
+    return connector_callback_continue;
+}
+
 connector_callback_status_t app_os_yield(connector_status_t const * const status)
 {
     int error;
@@ -119,6 +133,139 @@ connector_callback_status_t app_os_yield(connector_status_t const * const status
     return connector_callback_continue;
 }
 
+/*
+ * Pipe used to wake up app_os_wait() when connector_initiate_action() is called
+ * from another thread.
+ */
+static int app_wakeup_pipe[2] = {-1, -1};
+
+int app_os_wakeup_init(void)
+{
+    int result = pipe(app_wakeup_pipe);
+
+    if (result == 0)
+    {
+        fcntl(app_wakeup_pipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(app_wakeup_pipe[1], F_SETFL, O_NONBLOCK);
+    }
+    else
+    {
+        APP_DEBUG("app_os_wakeup_init: pipe() failed, errno %d\n", errno);
+        app_wakeup_pipe[0] = app_wakeup_pipe[1] = -1;
+    }
+
+    return result;
+}
+
+static connector_callback_status_t app_os_wakeup(void)
+{
+    if (app_wakeup_pipe[1] >= 0)
+    {
+        char const wakeup = 0;
+
+        /* a full pipe already has a wakeup pending */
+        if (write(app_wakeup_pipe[1], &wakeup, sizeof wakeup) < 0 && errno != EAGAIN)
+        {
+            APP_DEBUG("app_os_wakeup: write() failed, errno %d\n", errno);
+        }
+    }
+
+    return connector_callback_continue;
+}
+
+static int app_os_add_poll_fd(struct pollfd * const fds, int const count, int const fd, connector_bool_t const send)
+{
+    int result = count;
+
+    if (fd >= 0)
+    {
+        fds[count].fd = fd;
+        fds[count].events = (send == connector_true) ? (POLLIN | POLLOUT) : POLLIN;
+        fds[count].revents = 0;
+        result++;
+    }
+
+    return result;
+}
+
+/*
+ * Sleep until one of the network handles reported by connector_get_wait_set()
+ * is ready, its timeout expires or app_os_wakeup() is called.
+ */
+void app_os_wait(connector_handle_t const handle, connector_status_t const status)
+{
+    /* connector_pending may be a busy callback which needs to be retried soon */
+    unsigned int const pending_timeout_in_milliseconds = 10;
+    /* SMS transport has no descriptor to wait on */
+    unsigned int const sms_timeout_in_milliseconds = 100;
+    connector_wait_set_t wait_set;
+    struct pollfd fds[4];
+    int count = 0;
+    int timeout;
+
+    if (connector_get_wait_set(handle, &wait_set) != connector_success)
+    {
+        APP_DEBUG("app_os_wait: connector_get_wait_set failed\n");
+        return;
+    }
+
+    timeout = (wait_set.timeout_in_milliseconds > INT_MAX) ? INT_MAX : (int)wait_set.timeout_in_milliseconds;
+    if (status == connector_pending && timeout > (int)pending_timeout_in_milliseconds)
+    {
+        timeout = pending_timeout_in_milliseconds;
+    }
+
+    count = app_os_add_poll_fd(fds, count, app_wakeup_pipe[0], connector_false);
+
+#if (defined CONNECTOR_TRANSPORT_TCP)
+    if (wait_set.tcp.handle != NULL)
+    {
+        connector_bool_t data_pending = connector_false;
+        int const fd = app_network_tcp_get_fd(wait_set.tcp.handle, &data_pending);
+
+        if (data_pending == connector_true || fd < 0)
+            timeout = 0;
+        else
+            count = app_os_add_poll_fd(fds, count, fd, wait_set.tcp.send);
+    }
+#endif
+#if (defined CONNECTOR_TRANSPORT_UDP)
+    if (wait_set.udp.handle != NULL)
+    {
+        int const fd = app_network_udp_get_fd(wait_set.udp.handle);
+
+        if (fd < 0)
+            timeout = 0;
+        else
+            count = app_os_add_poll_fd(fds, count, fd, wait_set.udp.send);
+    }
+#endif
+#if (defined CONNECTOR_TRANSPORT_SMS)
+    if (wait_set.sms.handle != NULL && timeout > (int)sms_timeout_in_milliseconds)
+    {
+        timeout = sms_timeout_in_milliseconds;
+    }
+#else
+    UNUSED_ARGUMENT(sms_timeout_in_milliseconds);
+#endif
+
+    if (timeout == 0)
+    {
+        sched_yield();
+    }
+    else if (poll(fds, (nfds_t)count, timeout) < 0 && errno != EINTR)
+    {
+        APP_DEBUG("app_os_wait: poll() failed, errno %d\n", errno);
+    }
+    else if (count > 0 && fds[0].fd == app_wakeup_pipe[0] && (fds[0].revents & POLLIN))
+    {
+        char buffer[16];
+
+        while (read(app_wakeup_pipe[0], buffer, sizeof buffer) > 0)
+            continue;
+    }
+}
+
 static connector_callback_status_t app_os_reboot(void)
 {
     APP_DEBUG("app_os_reboot!\n");
@@ -177,6 +324,17 @@ connector_callback_status_t app_os_handler(connector_request_id_os_t const reque
         status = app_os_reboot();
         break;
 
+    case connector_request_id_os_wakeup:
+        status = app_os_wakeup();
+        break;
+
+    case connector_request_id_os_system_up_time_in_ms:
+        {
+            connector_os_system_up_time_t * p = data;
+            status = app_os_get_system_time_in_ms(&p->sys_uptime);
+        }
+        break;
+
     default:
         APP_DEBUG("app_os_handler: unrecognized request [%d]\n", request);
         status = connector_callback_unrecognized;
@@ -65,6 +65,15 @@ extern connector_callback_status_t app_file_system_handler(connector_request_id_
 extern int application_run(connector_handle_t handle);
 
 extern connector_callback_status_t app_os_get_system_time(unsigned long * const uptime);
+extern int app_os_wakeup_init(void);
+extern void app_os_wait(connector_handle_t const handle, connector_status_t const status);
+
+#if (defined CONNECTOR_TRANSPORT_TCP)
+extern int app_network_tcp_get_fd(connector_network_handle_t const handle, connector_bool_t * const data_pending);
+#endif
+#if (defined CONNECTOR_TRANSPORT_UDP)
+extern int app_network_udp_get_fd(connector_network_handle_t const handle);
+#endif
 
 extern connector_bool_t app_connector_reconnect(connector_class_id_t const class_id, connector_close_status_t const status);
 extern connector_callback_status_t app_status_handler(connector_request_id_status_t const request,
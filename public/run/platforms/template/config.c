@@ -535,6 +535,29 @@ static connector_callback_status_t app_get_max_message_transactions(connector_co
     return connector_callback_continue;
 }
 
+/**
+ * @brief   Get the messaging receive window
+ *
+ * This routine tells Cloud Connector the initial and maximum receive window for data service, file system,
+ * and remote_config messages received from Device Cloud.
+ *
+ * @param [in,out] config_receive_window  Pointer to @ref connector_config_msg_receive_window_t, preset to the defaults,
+ *                           where callback writes the initial and maximum receive window in bytes.
+ *
+ * @retval connector_callback_continue  The receive window was successfully returned.
+ * @retval connector_callback_abort     Could not get the receive window and abort Cloud Connector.
+ *
+ * @see @ref msg_receive_window API Configuration Callback
+ *
+ * @note This routine is not needed if you define @b CONNECTOR_MSG_RECV_WINDOW_MAX configuration in @ref connector_config.h.
+ * See @ref connector_config_data_options
+ */
+static connector_callback_status_t app_get_msg_receive_window(connector_config_msg_receive_window_t * const config_receive_window)
+{
+    UNUSED_ARGUMENT(config_receive_window);
+    return connector_callback_continue;
+}
+
 /**
  * @brief  Start Network TCP
  *
@@ -841,6 +864,7 @@ static char const * app_config_class_to_string(connector_request_id_config_t con
         enum_to_case(connector_request_id_config_sm_udp_rx_timeout);
         enum_to_case(connector_request_id_config_sm_sms_rx_timeout);
         enum_to_case(connector_request_id_config_rci_descriptor_data);
+        enum_to_case(connector_request_id_config_msg_receive_window);
     }
     return result;
 }
@@ -861,6 +885,7 @@ static char const * app_network_class_to_string(connector_request_id_network_t c
         enum_to_case(connector_request_id_network_send);
         enum_to_case(connector_request_id_network_receive);
         enum_to_case(connector_request_id_network_close);
+        enum_to_case(connector_request_id_network_send_iov);
     }
     return result;
 }
@@ -883,6 +908,8 @@ static char const * app_os_class_to_string(connector_request_id_os_t const value
         enum_to_case(connector_request_id_os_system_up_time);
         enum_to_case(connector_request_id_os_yield);
         enum_to_case(connector_request_id_os_reboot);
+        enum_to_case(connector_request_id_os_wakeup);
+        enum_to_case(connector_request_id_os_system_up_time_in_ms);
     }
     return result;
 }
@@ -1322,6 +1349,10 @@ connector_callback_status_t app_config_handler(connector_request_id_config_t con
         status = app_get_max_message_transactions(data);
         break;
 
+    case connector_request_id_config_msg_receive_window:
+        status = app_get_msg_receive_window(data);
+        break;
+
      case connector_request_id_config_network_tcp:
          status = app_start_network_tcp(data);
          break;
@@ -10,7 +10,8 @@ connector_callback_status_t dev_health_handle_data_callback(connector_data_servi
 
     bytes_used = MIN_VALUE(data_ptr->bytes_available, dev_health_data_push->bytes_available);
 
-    memcpy(data_ptr->buffer, dev_health_data_push->p_csv, bytes_used);
+    /* Cloud Connector sends straight from p_csv, the CSV data is kept until the status callback */
+    data_ptr->external_buffer = dev_health_data_push->p_csv;
     data_ptr->bytes_used = bytes_used;
     data_ptr->more_data = connector_bool(dev_health_data_push->bytes_available);
 
@@ -38,6 +39,7 @@ connector_callback_status_t dev_health_handle_status_callback(connector_data_ser
     health_metrics_data_t * const health_metrics_data = dev_health_data_push->health_metrics_data;
 
     hm_print_line("dev_health_handle_status_callback, status %d", data_ptr->status);
+    /* none of p_csv is queued to be sent any more, so the CSV data may be reused once it's marked sent */
     hm_free_data(dev_health_data_push);
     health_metrics_data->info.csv.status = DEV_HEALTH_CSV_STATUS_SENT;
 
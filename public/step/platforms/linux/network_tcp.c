@@ -24,6 +24,7 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <errno.h>
 
 #include "connector_api.h"
@@ -143,6 +144,51 @@ static connector_callback_status_t app_network_tcp_send(connector_network_send_t
 }
 
 
+/*
+ * Send several queued packets with one writev() call. Buffers past
+ * APP_TCP_MAX_IOV are left for the next call.
+ */
+#define APP_TCP_MAX_IOV 16
+
+static connector_callback_status_t app_network_tcp_send_iov(connector_network_send_iov_t * const data)
+{
+    connector_callback_status_t status = connector_callback_continue;
+    int * const fd = data->handle;
+    struct iovec iov[APP_TCP_MAX_IOV];
+    int const iov_count = (data->iov_count < APP_TCP_MAX_IOV) ? (int)data->iov_count : APP_TCP_MAX_IOV;
+    int i;
+    ssize_t ccode;
+
+    for (i = 0; i < iov_count; i++)
+    {
+        iov[i].iov_base = (void *)data->iov[i].buffer;
+        iov[i].iov_len = data->iov[i].length;
+    }
+
+    ccode = writev(*fd, iov, iov_count);
+    if (ccode >= 0)
+    {
+        data->bytes_used = (size_t)ccode;
+    }
+    else
+    {
+        int const err = errno;
+        if (err == EAGAIN)
+        {
+            status = connector_callback_busy;
+        }
+        else
+        {
+            status = connector_callback_error;
+            APP_DEBUG("app_network_tcp_send_iov: writev() failed, errno %d\n", err);
+            app_dns_cache_invalidate(connector_class_id_network_tcp);
+        }
+    }
+
+    return status;
+}
+
+
 static int app_tcp_create_socket(void)
 {
     int fd = socket(AF_INET, SOCK_STREAM, 0);
@@ -348,6 +394,10 @@ connector_callback_status_t app_network_tcp_handler(connector_request_id_network
         status = app_network_tcp_send(data);
         break;
 
+    case connector_request_id_network_send_iov:
+        status = app_network_tcp_send_iov(data);
+        break;
+
     case connector_request_id_network_receive:
         status = app_network_tcp_receive(data);
         break;
@@ -97,7 +97,8 @@ sample_tests = {
     'firmware_download' : ('test_firmware.py',),
     'send_data'         : ('test_send_data.py',),
     'device_request'    : ('test_device_request.py',),
-    'file_system'       : ('test_file_system.py',),
+    'file_system'       : ('test_file_system.py',
+                           'test_file_system_stress.py',),
     'remote_config'     : ('test_binary_rci.py',),
     'data_point'        : ('test_data_point.py',),
 }
@@ -666,6 +666,12 @@ public class GenFsmHeaderFile extends GenHeaderFile {
             "        connector_bool_t compare_matches;\n" +
             "        char const * error_hint;\n" +
             "        connector_element_value_t * element_value;\n" +
+            "#if (defined CONNECTOR_RCI_GROUP_PROCESS)\n" +
+            "        connector_element_value_t const * element_values;\n" +
+            "#endif\n" +
+            "#if (defined CONNECTOR_RCI_CACHE)\n" +
+            "        unsigned long cache_ttl;\n" +
+            "#endif\n" +
             "        connector_response_item_t item;\n" +
             "    } response;\n" +
             "} connector_remote_config_t;\n"
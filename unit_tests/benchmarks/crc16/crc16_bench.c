@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Short message CRC16 benchmark.
+ *
+ * Times the three sm_calculate_crc16() implementations over the packet
+ * sizes the short messaging layer checks: an SMS packet, a UDP packet and a
+ * reassembled multipart message. The table driven one is the library's
+ * default, built by connector_api.c, the bitwise (CONNECTOR_SM_CRC16_BITWISE)
+ * and slice-by-8 (CONNECTOR_SM_CRC16_SLICE_BY_8) ones are built from
+ * connector_sm_crc16.h again under other names. Reported per size: time per
+ * call, throughput, and the CRC, which all three must agree on.
+ *
+ * The table sizes matter as much on small targets: bitwise has no table,
+ * table driven has 512 bytes and slice-by-8 has 4 KB.
+ */
+#include "connector_api.c"
+
+#define CONNECTOR_SM_CRC16_BITWISE
+#define sm_calculate_crc16 bench_crc16_bitwise
+#include "connector_sm_crc16.h"
+#undef CONNECTOR_SM_CRC16_BITWISE
+#undef sm_calculate_crc16
+
+#define CONNECTOR_SM_CRC16_SLICE_BY_8
+#define sm_calculate_crc16 bench_crc16_slice_by_8
+#define crc_table bench_crc_table
+#include "connector_sm_crc16.h"
+#undef sm_calculate_crc16
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_BYTES_PER_CASE    (64UL * 1024 * 1024)
+#define BENCH_MAX_BYTES         (64 * 1024)
+
+typedef uint16_t (* bench_crc16_t)(uint16_t crc, uint8_t const * const data, size_t const bytes);
+
+static struct
+{
+    char const * name;
+    bench_crc16_t crc16;
+} const bench_variants[] =
+{
+    {"bitwise", bench_crc16_bitwise},
+    {"table", sm_calculate_crc16},
+    {"slice-by-8", bench_crc16_slice_by_8}
+};
+
+static uint8_t bench_data[BENCH_MAX_BYTES];
+
+static double bench_time_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void run_case(char const * const label, size_t const bytes)
+{
+    unsigned long const calls = BENCH_BYTES_PER_CASE / bytes;
+    uint16_t expected = 0;
+    size_t i;
+
+    for (i = 0; i < ARRAY_SIZE(bench_variants); i++)
+    {
+        bench_crc16_t const crc16 = bench_variants[i].crc16;
+        uint16_t crc = 0;
+        unsigned long call;
+        double start;
+        double call_ns;
+
+        start = bench_time_ns();
+        for (call = 0; call < calls; call++)
+            crc = crc16(crc, bench_data, bytes);
+        call_ns = (bench_time_ns() - start) / calls;
+
+        if (i == 0)
+            expected = crc;
+        else if (crc != expected)
+        {
+            fprintf(stderr, "%s: %s CRC %04X, bitwise %04X\n", label, bench_variants[i].name, crc, expected);
+            exit(EXIT_FAILURE);
+        }
+
+        printf("%-18s %6zu B  %-10s  %10.1f ns  %8.1f MB/s  crc %04X\n",
+               label, bytes, bench_variants[i].name, call_ns, (bytes * 1e3) / call_ns, crc);
+    }
+}
+
+int main(void)
+{
+    size_t i;
+
+    srand(1);
+    for (i = 0; i < sizeof bench_data; i++)
+        bench_data[i] = (uint8_t)rand();
+
+    printf("%lu MB per case, each call continues the previous CRC\n", BENCH_BYTES_PER_CASE / (1024 * 1024));
+    run_case("SMS packet", SM_PACKET_SIZE_SMS);
+    run_case("UDP packet", SM_PACKET_SIZE_UDP);
+    run_case("multipart message", BENCH_MAX_BYTES);
+
+    return 0;
+}
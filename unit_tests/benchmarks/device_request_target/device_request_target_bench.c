@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Device request target benchmark.
+ *
+ * Complete device requests, from the first data block to the free of the
+ * session, are handed to data_service_device_request_callback() for targets
+ * picked round-robin out of BENCH_MAX_TARGETS names. Each case is run twice:
+ * once with the application callback finding the target in a chain of
+ * strcmp() calls, the way applications dispatch without registration, and
+ * once with every target registered by
+ * connector_register_device_request_target(). Reported per case: time per
+ * request, allocations per request, calls that reached the application
+ * callback, and the time of the target lookup alone.
+ *
+ * The table size is a build option, rebuild with
+ * "make CPPFLAGS=-DCONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE=64" to compare
+ * another size. Cases with more targets than the table takes are skipped.
+ */
+#include "connector_api.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_MAX_TARGETS       192
+#define BENCH_REQUESTS          200000UL
+#define BENCH_LOOKUPS           2000000UL
+#define BENCH_TARGET_STRIDE     37
+#define BENCH_PAYLOAD           "payload"
+#define BENCH_REPLY             "ok"
+
+static char target_names[BENCH_MAX_TARGETS][24];
+static unsigned long target_requests[BENCH_MAX_TARGETS];
+static unsigned int target_count;
+static unsigned long malloc_calls;
+static unsigned long application_calls;
+
+static void bench_reply(connector_data_service_receive_reply_data_t * const reply_data)
+{
+    memcpy(reply_data->buffer, BENCH_REPLY, sizeof BENCH_REPLY - 1);
+    reply_data->bytes_used = sizeof BENCH_REPLY - 1;
+    reply_data->more_data = connector_false;
+}
+
+static connector_callback_status_t target_handler(connector_request_id_data_service_t const request_id, void * const data, void * const context)
+{
+    unsigned long * const requests = context;
+
+    switch (request_id)
+    {
+        case connector_request_id_data_service_receive_target:
+            (*requests)++;
+            break;
+        case connector_request_id_data_service_receive_reply_data:
+            bench_reply(data);
+            break;
+        default:
+            break;
+    }
+
+    return connector_callback_continue;
+}
+
+static connector_callback_status_t app_data_service(connector_request_id_data_service_t const request_id, void * const data)
+{
+    connector_callback_status_t status = connector_callback_continue;
+
+    application_calls++;
+
+    switch (request_id)
+    {
+        case connector_request_id_data_service_receive_target:
+        {
+            connector_data_service_receive_target_t * const receive_target = data;
+            unsigned int i;
+
+            status = connector_callback_error;
+            for (i = 0; i < target_count; i++)
+            {
+                if (strcmp(receive_target->target, target_names[i]) == 0)
+                {
+                    target_requests[i]++;
+                    receive_target->user_context = &target_requests[i];
+                    status = connector_callback_continue;
+                    break;
+                }
+            }
+            break;
+        }
+        case connector_request_id_data_service_receive_reply_data:
+            bench_reply(data);
+            break;
+        default:
+            break;
+    }
+
+    return status;
+}
+
+static connector_callback_status_t app_callback(connector_class_id_t const class_id, connector_request_id_t const request_id, void * const data, void * const context)
+{
+    connector_callback_status_t status = connector_callback_unrecognized;
+
+    UNUSED_PARAMETER(context);
+
+    switch (class_id)
+    {
+        case connector_class_id_operating_system:
+            switch (request_id.os_request)
+            {
+                case connector_request_id_os_malloc:
+                {
+                    connector_os_malloc_t * const os_malloc = data;
+
+                    os_malloc->ptr = malloc(os_malloc->size);
+                    malloc_calls++;
+                    status = connector_callback_continue;
+                    break;
+                }
+                case connector_request_id_os_free:
+                {
+                    connector_os_free_t * const os_free = data;
+
+                    free(os_free->ptr);
+                    status = connector_callback_continue;
+                    break;
+                }
+                default:
+                    break;
+            }
+            break;
+
+        case connector_class_id_data_service:
+            status = app_data_service(request_id.data_service_request, data);
+            break;
+
+        default:
+            break;
+    }
+
+    return status;
+}
+
+static double bench_time_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static char const * bench_target(unsigned long const request)
+{
+    return target_names[(request * BENCH_TARGET_STRIDE) % target_count];
+}
+
+/* one device request through data_service_device_request_callback(), returns the step that failed or 0 */
+static int bench_request(connector_data_t * const connector_ptr, char const * const target)
+{
+    static uint8_t request[300];
+    static uint8_t response[64];
+    size_t const target_length = strlen(target);
+    size_t const length = 3 + target_length + sizeof BENCH_PAYLOAD - 1;
+    msg_session_t session;
+    msg_service_request_t service_request;
+    msg_service_data_t have_data;
+    msg_service_data_t need_data;
+    int step = 0;
+
+    request[0] = data_service_opcode_device_request;
+    request[1] = (uint8_t)target_length;
+    memcpy(&request[2], target, target_length);
+    request[2 + target_length] = 0;     /* no parameters */
+    memcpy(&request[3 + target_length], BENCH_PAYLOAD, sizeof BENCH_PAYLOAD - 1);
+
+    memset(&session, 0, sizeof session);
+    memset(&service_request, 0, sizeof service_request);
+    have_data.data_ptr = request;
+    have_data.length_in_bytes = length;
+    have_data.flags = MSG_FLAG_START | MSG_FLAG_LAST_DATA;
+    service_request.session = &session;
+    service_request.service_type = msg_service_type_have_data;
+    service_request.have_data = &have_data;
+
+    /* the first call only starts the request */
+    step++;
+    if (data_service_device_request_callback(connector_ptr, &service_request) != connector_pending)
+        goto done;
+    step++;
+    if (data_service_device_request_callback(connector_ptr, &service_request) != connector_working)
+        goto done;
+
+    need_data.data_ptr = response;
+    need_data.length_in_bytes = sizeof response;
+    need_data.flags = MSG_FLAG_START;
+    service_request.service_type = msg_service_type_need_data;
+    service_request.need_data = &need_data;
+    step++;
+    if (data_service_device_request_callback(connector_ptr, &service_request) != connector_working)
+        goto done;
+    step++;
+    if ((need_data.length_in_bytes != 2 + sizeof BENCH_REPLY - 1) || (response[1] != 0))
+        goto done;
+
+    service_request.service_type = msg_service_type_free;
+    step++;
+    if (data_service_device_request_callback(connector_ptr, &service_request) != connector_working)
+        goto done;
+
+    step = 0;
+
+done:
+    return step;
+}
+
+static void bench_run(connector_data_t * const connector_ptr, char const * const dispatch)
+{
+    unsigned long const first_malloc = malloc_calls;
+    unsigned long request;
+    double start;
+    double elapsed;
+
+    application_calls = 0;
+    memset(target_requests, 0, sizeof target_requests);
+
+    start = bench_time_ns();
+    for (request = 0; request < BENCH_REQUESTS; request++)
+    {
+        int const step = bench_request(connector_ptr, bench_target(request));
+
+        if (step != 0)
+        {
+            fprintf(stderr, "%u targets, %s: request %lu failed at step %d\n", target_count, dispatch, request, step);
+            exit(EXIT_FAILURE);
+        }
+    }
+    elapsed = bench_time_ns() - start;
+
+    for (request = 0; request < target_count; request++)
+    {
+        if (target_requests[request] == 0)
+        {
+            fprintf(stderr, "%u targets, %s: %s got no request\n", target_count, dispatch, target_names[request]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("%3u targets  %-8s %6.0f ns/request  %4.2f mallocs/request  %6.2f application calls/request\n", target_count, dispatch,
+           elapsed / BENCH_REQUESTS, (double)(malloc_calls - first_malloc) / BENCH_REQUESTS, (double)application_calls / BENCH_REQUESTS);
+}
+
+static void bench_lookup(connector_data_t const * const connector_ptr)
+{
+    volatile unsigned long sink = 0;
+    unsigned long lookup;
+    double start;
+    double table_ns;
+    double chain_ns;
+
+    start = bench_time_ns();
+    for (lookup = 0; lookup < BENCH_LOOKUPS; lookup++)
+    {
+        char const * const target = bench_target(lookup);
+
+        sink += (ds_find_target(&connector_ptr->ds_targets, target, strlen(target)) != NULL);
+    }
+    table_ns = (bench_time_ns() - start) / BENCH_LOOKUPS;
+
+    start = bench_time_ns();
+    for (lookup = 0; lookup < BENCH_LOOKUPS; lookup++)
+    {
+        char const * const target = bench_target(lookup);
+        unsigned int i;
+
+        for (i = 0; i < target_count; i++)
+        {
+            if (strcmp(target, target_names[i]) == 0)
+                break;
+        }
+        sink += i;
+    }
+    chain_ns = (bench_time_ns() - start) / BENCH_LOOKUPS;
+
+    printf("%3u targets  lookup   %6.1f ns table  %6.1f ns strcmp chain\n", target_count, table_ns, chain_ns);
+}
+
+static void bench_case(unsigned int const targets)
+{
+    connector_data_t * const connector_ptr = calloc(1, sizeof *connector_ptr);
+    unsigned int i;
+
+    if (connector_ptr == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    connector_ptr->callback = app_callback;
+    target_count = targets;
+
+    bench_run(connector_ptr, "strcmp");
+
+    for (i = 0; i < target_count; i++)
+    {
+        if (connector_register_device_request_target(connector_ptr, target_names[i], target_handler, &target_requests[i]) != connector_success)
+        {
+            fprintf(stderr, "%u targets: registering %s failed\n", target_count, target_names[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    bench_run(connector_ptr, "table");
+    if (application_calls != 0)
+    {
+        fprintf(stderr, "%u targets: %lu registered requests reached the application callback\n", target_count, application_calls);
+        exit(EXIT_FAILURE);
+    }
+
+    bench_lookup(connector_ptr);
+
+    free(connector_ptr);
+}
+
+int main(void)
+{
+    static unsigned int const cases[] = { 16, 128, BENCH_MAX_TARGETS };
+    size_t i;
+
+    for (i = 0; i < BENCH_MAX_TARGETS; i++)
+        snprintf(target_names[i], sizeof target_names[i], "device/target_%03u", (unsigned int)i);
+
+    printf("table size %d\n", CONNECTOR_DEVICE_REQUEST_TARGET_TABLE_SIZE);
+    for (i = 0; i < sizeof cases / sizeof cases[0]; i++)
+    {
+        if (cases[i] > DS_TARGET_TABLE_MAX_LOAD)
+        {
+            printf("%3u targets  skipped, more than the table takes\n", cases[i]);
+            continue;
+        }
+        bench_case(cases[i]);
+    }
+
+    return 0;
+}
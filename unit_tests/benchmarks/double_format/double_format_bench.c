@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Data point double formatting benchmark.
+ *
+ * Formats sets of sensor-like values the way the CSV generator does, with
+ * init_double_info() or init_float_info() and process_double() writing into
+ * send packet sized chunks. Reported per set: time per value, characters per
+ * value, and how many of the values read back unchanged with strtod() or
+ * strtof(). Built with CONNECTOR_SHORTEST_DOUBLE_FORMAT by default,
+ * "make CPPFLAGS=-DBENCH_FIXED_DOUBLE_FORMAT" builds the 6 fractional digit
+ * formatter instead.
+ */
+#include "connector_api.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_VALUES            4096
+#define BENCH_ROUNDS            256
+#define BENCH_CHUNK_BYTES       (MSG_MAX_SEND_PACKET_SIZE - PACKET_EDP_FACILITY_SIZE)
+
+typedef double (* bench_value_t)(void);
+
+static double bench_values[BENCH_VALUES];
+static char bench_chunk[BENCH_CHUNK_BYTES];
+
+static double bench_time_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/* a reading of low to high counts, counts / scale is the value the sensor reports */
+static double bench_reading(long const low, long const high, double const scale)
+{
+    return (low + rand() % (high - low + 1)) / scale;
+}
+
+static double bench_temperature(void)
+{
+    return bench_reading(-200, 500, 10);
+}
+
+static double bench_voltage(void)
+{
+    return bench_reading(3000, 3600, 1000);
+}
+
+static double bench_pressure(void)
+{
+    return bench_reading(950000, 1050000, 10);
+}
+
+static double bench_current(void)
+{
+    return bench_reading(10, 5000, 100000);
+}
+
+static double bench_humidity(void)
+{
+    /* a 12-bit ADC sample scaled to percent */
+    return (rand() % 4096) * 100.0 / 4095;
+}
+
+static double bench_counter(void)
+{
+    return (double)rand();
+}
+
+static double bench_latitude(void)
+{
+    return (float)bench_reading(-9000000, 9000000, 100000);
+}
+
+static void bench_init(double_info_t * const double_info, double const value, connector_bool_t const is_float)
+{
+    if (is_float)
+        init_float_info(double_info, (float)value);
+    else
+        init_double_info(double_info, value);
+}
+
+static size_t bench_format(char * const chars, size_t const size, double const value, connector_bool_t const is_float)
+{
+    double_info_t double_info;
+    buffer_info_t buffer_info;
+
+    buffer_info.buffer = chars;
+    buffer_info.bytes_available = size - 1;
+    buffer_info.bytes_written = 0;
+    bench_init(&double_info, value, is_float);
+    if (!process_double(&double_info, &buffer_info))
+    {
+        fprintf(stderr, "%g does not fit in %zu characters\n", value, size - 1);
+        exit(EXIT_FAILURE);
+    }
+    chars[buffer_info.bytes_written] = '\0';
+
+    return buffer_info.bytes_written;
+}
+
+static void run_case(char const * const label, bench_value_t const value, connector_bool_t const is_float)
+{
+    size_t chars = 0;
+    size_t round_trips = 0;
+    double start;
+    double value_ns;
+    char text[64];
+    size_t i;
+    int round;
+
+    srand(1);
+    for (i = 0; i < BENCH_VALUES; i++)
+    {
+        bench_values[i] = value();
+
+        chars += bench_format(text, sizeof text, bench_values[i], is_float);
+        if (is_float ? strtof(text, NULL) == (float)bench_values[i] : strtod(text, NULL) == bench_values[i])
+            round_trips++;
+    }
+
+    start = bench_time_ns();
+    for (round = 0; round < BENCH_ROUNDS; round++)
+    {
+        buffer_info_t buffer_info;
+
+        buffer_info.buffer = bench_chunk;
+        buffer_info.bytes_available = sizeof bench_chunk;
+        buffer_info.bytes_written = 0;
+
+        for (i = 0; i < BENCH_VALUES; i++)
+        {
+            double_info_t double_info;
+
+            bench_init(&double_info, bench_values[i], is_float);
+            while (!process_double(&double_info, &buffer_info))
+            {
+                buffer_info.bytes_available = sizeof bench_chunk;
+                buffer_info.bytes_written = 0;
+            }
+        }
+    }
+    value_ns = (bench_time_ns() - start) / ((double)BENCH_ROUNDS * BENCH_VALUES);
+
+    bench_format(text, sizeof text, bench_values[0], is_float);
+    printf("%-12s %-6s  %7.1f ns/value  %5.1f chars/value  %4zu/%d round trip  e.g. %s\n",
+           label, is_float ? "float" : "double", value_ns, (double)chars / BENCH_VALUES, round_trips, BENCH_VALUES, text);
+}
+
+int main(void)
+{
+#if (defined CONNECTOR_SHORTEST_DOUBLE_FORMAT)
+    printf("shortest round trip format, %d values per set\n", BENCH_VALUES);
+#else
+    printf("6 fractional digit format, %d values per set\n", BENCH_VALUES);
+#endif
+    run_case("temperature", bench_temperature, connector_false);
+    run_case("voltage", bench_voltage, connector_false);
+    run_case("pressure", bench_pressure, connector_false);
+    run_case("current", bench_current, connector_false);
+    run_case("humidity", bench_humidity, connector_false);
+    run_case("counter", bench_counter, connector_false);
+    run_case("latitude", bench_latitude, connector_true);
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Data point columnar encoding benchmark.
+ *
+ * Generates the same streams with dp_generate_csv() and dp_generate_columnar()
+ * in chunks of one send packet, as the data service callback does: a 32-bit
+ * counter stepping by a few counts and a double temperature with one decimal,
+ * both sampled once a second. Reported per stream and point count: the
+ * payload bytes, the bytes after deflate at the library's compression
+ * settings, the time to generate one request and the points generated per
+ * second. Deflate is not timed, both formats pay it the same way
+ * on a CONNECTOR_COMPRESSION build.
+ */
+#include "connector_api.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_POINTS_PER_CASE   1000000UL
+#define BENCH_MAX_POINTS        1000
+#define BENCH_CHUNK_BYTES       (MSG_MAX_SEND_PACKET_SIZE - PACKET_EDP_FACILITY_SIZE)
+#define BENCH_MAX_PAYLOAD       (64 * 1024)
+
+typedef size_t (* bench_generate_t)(connector_data_stream_t const * const stream, uint8_t * const payload);
+
+static connector_data_point_t bench_points[BENCH_MAX_POINTS];
+static connector_data_stream_t bench_stream;
+static uint8_t bench_payload[BENCH_MAX_PAYLOAD];
+static uint8_t bench_deflated[BENCH_MAX_PAYLOAD];
+
+static double bench_time_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static size_t bench_generate_csv(connector_data_stream_t const * const stream, uint8_t * const payload)
+{
+    csv_process_data_t process_data;
+    buffer_info_t buffer_info;
+    size_t bytes = 0;
+
+    process_data.current_csv_field = csv_data;
+    process_data.current_data_stream = stream;
+    process_data.current_data_point = stream->point;
+    process_data.data.init = connector_false;
+
+    do
+    {
+        buffer_info.buffer = (char *)&payload[bytes];
+        buffer_info.bytes_available = BENCH_CHUNK_BYTES;
+        buffer_info.bytes_written = 0;
+        bytes += dp_generate_csv(&process_data, &buffer_info);
+    } while (process_data.current_data_point != NULL);
+
+    return bytes;
+}
+
+static size_t bench_generate_columnar(connector_data_stream_t const * const stream, uint8_t * const payload)
+{
+    columnar_process_data_t process_data;
+    buffer_info_t buffer_info;
+    size_t bytes = 0;
+
+    dp_init_columnar(&process_data, stream);
+
+    do
+    {
+        buffer_info.buffer = (char *)&payload[bytes];
+        buffer_info.bytes_available = BENCH_CHUNK_BYTES;
+        buffer_info.bytes_written = 0;
+        bytes += dp_generate_columnar(&process_data, &buffer_info);
+    } while (dp_columnar_more_data(&process_data));
+
+    return bytes;
+}
+
+static size_t bench_deflate(uint8_t const * const payload, size_t const bytes)
+{
+    z_stream zlib;
+    size_t deflated;
+
+    memset(&zlib, 0, sizeof zlib);
+    if (deflateInit2(&zlib, CONNECTOR_COMPRESSION_LEVEL, Z_DEFLATED, CONNECTOR_COMPRESSION_WINDOW_BITS,
+                     CONNECTOR_COMPRESSION_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        fprintf(stderr, "deflateInit2 failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    zlib.next_in = (Bytef *)payload;
+    zlib.avail_in = bytes;
+    zlib.next_out = bench_deflated;
+    zlib.avail_out = sizeof bench_deflated;
+    if (deflate(&zlib, Z_FINISH) != Z_STREAM_END)
+    {
+        fprintf(stderr, "deflate of %zu bytes failed\n", bytes);
+        exit(EXIT_FAILURE);
+    }
+
+    deflated = zlib.total_out;
+    deflateEnd(&zlib);
+
+    return deflated;
+}
+
+static void bench_fill_stream(connector_data_point_type_t const type, size_t const count)
+{
+    int32_t counter = 1000;
+    double temperature = 21.5;
+    size_t i;
+
+    memset(bench_points, 0, sizeof bench_points);
+    srand(1);
+
+    for (i = 0; i < count; i++)
+    {
+        connector_data_point_t * const point = &bench_points[i];
+
+        point->data.type = connector_data_type_native;
+        if (type == connector_data_point_type_integer)
+        {
+            counter += rand() % 8;
+            point->data.element.native.int_value = counter;
+        }
+        else
+        {
+            temperature += ((rand() % 5) - 2) / 10.0;
+            point->data.element.native.double_value = (int)(temperature * 10) / 10.0;
+        }
+
+        point->time.source = connector_time_local_epoch_fractional;
+        point->time.value.since_epoch_fractional.seconds = 1700000000 + i;
+        point->time.value.since_epoch_fractional.milliseconds = 0;
+        point->location.type = connector_location_type_ignore;
+        point->quality.type = connector_quality_type_ignore;
+        point->description = NULL;
+        point->next = (i + 1 < count) ? &bench_points[i + 1] : NULL;
+    }
+
+    bench_stream.stream_id = (type == connector_data_point_type_integer) ? "sensors/counter" : "sensors/temperature";
+    bench_stream.unit = (type == connector_data_point_type_integer) ? "counts" : "C";
+    bench_stream.forward_to = NULL;
+    bench_stream.type = type;
+    bench_stream.point = bench_points;
+    bench_stream.next = NULL;
+}
+
+static void run_format(char const * const label, size_t const count, char const * const format, bench_generate_t const generate)
+{
+    unsigned long const requests = BENCH_POINTS_PER_CASE / count;
+    unsigned long request;
+    size_t bytes = 0;
+    size_t deflated;
+    double start;
+    double request_ns;
+
+    start = bench_time_ns();
+    for (request = 0; request < requests; request++)
+        bytes = generate(&bench_stream, bench_payload);
+    request_ns = (bench_time_ns() - start) / requests;
+
+    if (bytes == 0 || bytes > BENCH_MAX_PAYLOAD - BENCH_CHUNK_BYTES)
+    {
+        fprintf(stderr, "%s: %s generated %zu bytes\n", label, format, bytes);
+        exit(EXIT_FAILURE);
+    }
+    deflated = bench_deflate(bench_payload, bytes);
+
+    printf("%-12s %5zu points  %-8s  %6zu B  %5.1f B/point  deflated %6zu B  %9.2f us  %6.2f Mpoints/s\n",
+           label, count, format, bytes, (double)bytes / count, deflated, request_ns / 1e3, (count * 1e3) / request_ns);
+}
+
+static void run_case(char const * const label, connector_data_point_type_t const type, size_t const count)
+{
+    bench_fill_stream(type, count);
+    if (!dp_columnar_supported(&bench_stream))
+    {
+        fprintf(stderr, "%s: stream not supported by the columnar format\n", label);
+        exit(EXIT_FAILURE);
+    }
+
+    run_format(label, count, "csv", bench_generate_csv);
+    run_format(label, count, "columnar", bench_generate_columnar);
+}
+
+int main(void)
+{
+    static size_t const counts[] = {10, 100, BENCH_MAX_POINTS};
+    size_t i;
+
+    printf("%lu points per case, generated in %d byte chunks\n", BENCH_POINTS_PER_CASE, (int)BENCH_CHUNK_BYTES);
+    for (i = 0; i < ARRAY_SIZE(counts); i++)
+    {
+        run_case("counter", connector_data_point_type_integer, counts[i]);
+        run_case("temperature", connector_data_point_type_double, counts[i]);
+    }
+
+    return 0;
+}
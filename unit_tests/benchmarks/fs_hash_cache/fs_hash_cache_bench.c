@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * File system listing hash cache benchmark.
+ *
+ * Lists a directory of BENCH_FILES files of BENCH_FILE_BYTES with hashes
+ * through the Linux platform's file system callbacks, in the order
+ * process_file_ls_response() makes them: stat of the directory, opendir,
+ * then readdir, stat_dir_entry and hash for every entry, and closedir.
+ * Reported per algorithm, each listing timed on its own:
+ *
+ *   cold          a new process with no APP_FILE_HASH_CACHE_PATH file
+ *   warm memory   the same process listing again
+ *   warm disk     a new process loading the cache file
+ *   one touched   that process again after one file's mtime changed
+ *
+ * Every listing must return the hashes of the cold one. The files were just
+ * written, so the page cache is warm and the cold listing is the hashing
+ * cost alone; on flash it also pays for reading every file.
+ */
+#include "connector_api.c"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#define BENCH_FILES             100
+#define BENCH_FILE_BYTES        (1024 * 1024)
+#define BENCH_HASH_BYTES        64
+
+#define BENCH_CACHE_PATH        "/tmp/fs_hash_cache_bench.cache"
+
+static char bench_dir[] = "/tmp/fs_hash_cache_XXXXXX";
+
+#define APP_ENABLE_MD5
+#define APP_FILE_HASH_CACHE_PATH    BENCH_CACHE_PATH
+#include "platform.h"
+
+/* the sample logs every callback */
+static int bench_quiet(char const * const format, ...)
+{
+    UNUSED_ARGUMENT(format);
+    return 0;
+}
+
+#undef APP_DEBUG
+#define APP_DEBUG   bench_quiet
+
+#include "file_system.c"
+
+static uint8_t (* bench_expected)[BENCH_HASH_BYTES];
+static uint8_t bench_hashes[BENCH_FILES][BENCH_HASH_BYTES];
+
+static double bench_time_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void bench_call(connector_request_id_file_system_t const request, void * const data)
+{
+    if (app_file_system_handler(request, data) != connector_callback_continue)
+    {
+        fprintf(stderr, "file system request %d failed\n", request);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* returns the number of files hashed */
+static size_t bench_list(connector_file_system_hash_algorithm_t const algorithm)
+{
+    size_t const hash_bytes = file_hash_size(algorithm);
+    connector_file_system_stat_t stat_data;
+    connector_file_system_opendir_t opendir_data;
+    connector_file_system_closedir_t closedir_data;
+    char entry_name[NAME_MAX + 1];
+    size_t files = 0;
+
+    memset(&stat_data, 0, sizeof stat_data);
+    stat_data.path = bench_dir;
+    stat_data.hash_algorithm.requested = algorithm;
+    bench_call(connector_request_id_file_system_stat, &stat_data);
+
+    memset(&opendir_data, 0, sizeof opendir_data);
+    opendir_data.user_context = stat_data.user_context;
+    opendir_data.path = bench_dir;
+    bench_call(connector_request_id_file_system_opendir, &opendir_data);
+
+    for (;;)
+    {
+        connector_file_system_readdir_t readdir_data;
+        connector_file_system_stat_dir_entry_t entry_data;
+        connector_file_system_hash_t hash_data;
+        char path[CONNECTOR_FILE_SYSTEM_MAX_PATH_LENGTH];
+        unsigned int index;
+
+        memset(&readdir_data, 0, sizeof readdir_data);
+        readdir_data.user_context = opendir_data.user_context;
+        readdir_data.handle = opendir_data.handle;
+        readdir_data.entry_name = entry_name;
+        readdir_data.bytes_available = sizeof entry_name;
+        *entry_name = '\0';
+        bench_call(connector_request_id_file_system_readdir, &readdir_data);
+        opendir_data.user_context = readdir_data.user_context;
+        if (*entry_name == '\0')
+            break;
+
+        snprintf(path, sizeof path, "%s/%s", bench_dir, entry_name);
+        memset(&entry_data, 0, sizeof entry_data);
+        entry_data.user_context = opendir_data.user_context;
+        entry_data.path = path;
+        bench_call(connector_request_id_file_system_stat_dir_entry, &entry_data);
+        opendir_data.user_context = entry_data.user_context;
+
+        if (entry_data.statbuf.flags != connector_file_system_file_type_is_reg || sscanf(entry_name, "file%u", &index) != 1 || index >= BENCH_FILES)
+            continue;
+
+        memset(&hash_data, 0, sizeof hash_data);
+        hash_data.user_context = opendir_data.user_context;
+        hash_data.path = path;
+        hash_data.hash_algorithm = stat_data.hash_algorithm.actual;
+        hash_data.hash_value = bench_hashes[index];
+        hash_data.bytes_requested = hash_bytes;
+        bench_call(connector_request_id_file_system_hash, &hash_data);
+        opendir_data.user_context = hash_data.user_context;
+        files++;
+    }
+
+    memset(&closedir_data, 0, sizeof closedir_data);
+    closedir_data.user_context = opendir_data.user_context;
+    closedir_data.handle = opendir_data.handle;
+    bench_call(connector_request_id_file_system_closedir, &closedir_data);
+
+    return files;
+}
+
+static void run_listing(char const * const algorithm_name, char const * const label, connector_file_system_hash_algorithm_t const algorithm)
+{
+    double const start = bench_time_ns();
+    size_t const files = bench_list(algorithm);
+    double const listing_ns = bench_time_ns() - start;
+
+    if (files != BENCH_FILES || memcmp(bench_hashes, bench_expected, sizeof bench_hashes) != 0)
+    {
+        fprintf(stderr, "%s %s: %zu files, hashes differ from the cold listing\n", algorithm_name, label, files);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-7s %-12s %8.3f s  %9.1f us/file\n", algorithm_name, label, listing_ns / 1e9, listing_ns / 1e3 / files);
+    fflush(stdout);
+}
+
+static void bench_in_child(void (* const run)(char const *, connector_file_system_hash_algorithm_t), char const * const name,
+                           connector_file_system_hash_algorithm_t const algorithm)
+{
+    int child_status;
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+
+    if (pid == 0)
+    {
+        run(name, algorithm);
+        exit(EXIT_SUCCESS);
+    }
+
+    if (pid < 0 || waitpid(pid, &child_status, 0) != pid || !WIFEXITED(child_status) || WEXITSTATUS(child_status) != EXIT_SUCCESS)
+        exit(EXIT_FAILURE);
+}
+
+static void run_cold(char const * const name, connector_file_system_hash_algorithm_t const algorithm)
+{
+    double const start = bench_time_ns();
+    size_t const files = bench_list(algorithm);
+    double const listing_ns = bench_time_ns() - start;
+
+    if (files != BENCH_FILES)
+    {
+        fprintf(stderr, "%s cold: %zu files\n", name, files);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(bench_expected, bench_hashes, sizeof bench_hashes);
+    printf("%-7s %-12s %8.3f s  %9.1f us/file\n", name, "cold", listing_ns / 1e9, listing_ns / 1e3 / files);
+    fflush(stdout);
+
+    run_listing(name, "warm memory", algorithm);
+}
+
+static void run_warm(char const * const name, connector_file_system_hash_algorithm_t const algorithm)
+{
+    char path[sizeof bench_dir + 16];
+
+    run_listing(name, "warm disk", algorithm);
+
+    snprintf(path, sizeof path, "%s/file%u", bench_dir, 0);
+    if (utimes(path, NULL) != 0)
+    {
+        fprintf(stderr, "utimes %s failed\n", path);
+        exit(EXIT_FAILURE);
+    }
+    run_listing(name, "one touched", algorithm);
+}
+
+static void bench_make_files(void)
+{
+    static uint8_t data[BENCH_FILE_BYTES];
+    unsigned int i;
+    size_t j;
+
+    if (mkdtemp(bench_dir) == NULL)
+    {
+        fprintf(stderr, "mkdtemp failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    srand(1);
+    for (i = 0; i < BENCH_FILES; i++)
+    {
+        char path[sizeof bench_dir + 16];
+        FILE * file;
+
+        for (j = 0; j < sizeof data; j++)
+            data[j] = (uint8_t)rand();
+
+        snprintf(path, sizeof path, "%s/file%u", bench_dir, i);
+        file = fopen(path, "wb");
+        if (file == NULL || fwrite(data, 1, sizeof data, file) != sizeof data || fclose(file) != 0)
+        {
+            fprintf(stderr, "writing %s failed\n", path);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static void bench_remove_files(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < BENCH_FILES; i++)
+    {
+        char path[sizeof bench_dir + 16];
+
+        snprintf(path, sizeof path, "%s/file%u", bench_dir, i);
+        unlink(path);
+    }
+    unlink(BENCH_CACHE_PATH);
+    rmdir(bench_dir);
+}
+
+int main(void)
+{
+    static struct
+    {
+        char const * name;
+        connector_file_system_hash_algorithm_t algorithm;
+    } const algorithms[] =
+    {
+        {"crc32", connector_file_system_hash_crc32},
+        {"md5", connector_file_system_hash_md5},
+        {"sha512", connector_file_system_hash_sha512}
+    };
+    size_t i;
+
+    bench_expected = mmap(NULL, sizeof bench_hashes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (bench_expected == MAP_FAILED)
+    {
+        fprintf(stderr, "mmap failed\n");
+        return EXIT_FAILURE;
+    }
+
+    bench_make_files();
+    printf("%d files of %d KB\n", BENCH_FILES, BENCH_FILE_BYTES / 1024);
+
+    for (i = 0; i < ARRAY_SIZE(algorithms); i++)
+    {
+        unlink(BENCH_CACHE_PATH);
+        bench_in_child(run_cold, algorithms[i].name, algorithms[i].algorithm);
+        bench_in_child(run_warm, algorithms[i].name, algorithms[i].algorithm);
+    }
+
+    bench_remove_files();
+
+    return 0;
+}
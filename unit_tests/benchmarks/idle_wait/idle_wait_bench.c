@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Idle wait benchmark.
+ *
+ * Runs Cloud Connector on its own thread, first the way the samples did with
+ * connector_run() and app_os_yield(), which sleeps 100 ms whenever
+ * connector_step() is idle, then with connector_step() and app_os_wait(),
+ * which sleeps in poll() on the wait set reported by connector_get_wait_set()
+ * and is woken up by connector_initiate_action(). Both come from the Linux
+ * platform's os.c.
+ *
+ * The TCP transport is started manually and its open callback fails, so each
+ * connector_initiate_action() start request from the main thread ends in one
+ * call to the open callback. Reported per loop: the time from the request to
+ * the open callback, then for BENCH_IDLE_SECONDS without requests the CPU
+ * time of the connector thread and how often it went round its loop.
+ */
+#include "connector_api.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "platform.h"
+
+/* the platform code logs every unrecognized request */
+static int bench_quiet(char const * const format, ...)
+{
+    UNUSED_ARGUMENT(format);
+    return 0;
+}
+
+#undef APP_DEBUG
+#define APP_DEBUG   bench_quiet
+
+#include "os.c"
+
+#define BENCH_REQUESTS          40
+#define BENCH_REQUEST_GAP_US    37000
+#define BENCH_IDLE_SECONDS      3
+#define BENCH_TIME_LIMIT_NS     5e9
+
+typedef struct {
+    char const * name;
+    connector_bool_t wait_set;
+} bench_case_t;
+
+static uint8_t const bench_device_id[DEVICE_ID_LENGTH] = {0x00, 0x01};
+static connector_handle_t bench_handle;
+static bench_case_t const * bench;
+static unsigned long volatile bench_loops;
+static unsigned long volatile bench_opens;
+static double volatile bench_open_ns;
+static connector_status_t bench_exit_status;
+
+static double bench_time_ns(clockid_t const clock_id)
+{
+    struct timespec now;
+
+    clock_gettime(clock_id, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/* the platform's network callbacks are not built in, nothing is waited on */
+int app_network_tcp_get_fd(connector_network_handle_t const handle, connector_bool_t * const data_pending)
+{
+    UNUSED_ARGUMENT(handle);
+    *data_pending = connector_false;
+    return -1;
+}
+
+static connector_callback_status_t app_callback(connector_class_id_t const class_id, connector_request_id_t const request_id, void * const data, void * const context)
+{
+    connector_callback_status_t status = connector_callback_unrecognized;
+
+    UNUSED_PARAMETER(context);
+
+    switch (class_id)
+    {
+        case connector_class_id_operating_system:
+            if (request_id.os_request == connector_request_id_os_yield)
+                bench_loops++;
+            status = app_os_handler(request_id.os_request, data);
+            break;
+
+        case connector_class_id_config:
+            if (request_id.config_request == connector_request_id_config_device_id)
+            {
+                connector_config_pointer_data_t * const device_id = data;
+
+                device_id->data = bench_device_id;
+                status = connector_callback_continue;
+            }
+            break;
+
+        case connector_class_id_network_tcp:
+            if (request_id.network_request == connector_request_id_network_open)
+            {
+                bench_open_ns = bench_time_ns(CLOCK_MONOTONIC);
+                bench_opens++;
+            }
+            status = connector_callback_error;
+            break;
+
+        case connector_class_id_status:
+            status = connector_callback_continue;
+            break;
+
+        default:
+            break;
+    }
+
+    return status;
+}
+
+/* app_connector_run() of the Linux platform's main.c */
+static connector_status_t bench_step_and_wait(connector_handle_t const handle)
+{
+    connector_status_t status;
+
+    do {
+        status = connector_step(handle);
+
+        switch (status)
+        {
+        case connector_idle:
+        case connector_pending:
+            app_os_wait(handle, status);
+            bench_loops++;
+            break;
+
+        case connector_working:
+        case connector_active:
+        case connector_success:
+            sched_yield();
+            bench_loops++;
+            break;
+
+        default:
+            break;
+        }
+    } while (status == connector_idle || status == connector_working || status == connector_pending ||
+             status == connector_active || status == connector_success);
+
+    return status;
+}
+
+static void * bench_connector_thread(void * const arg)
+{
+    UNUSED_ARGUMENT(arg);
+
+    /* restarted after a failed open like connector_run_thread() of main.c */
+    do
+    {
+        bench_exit_status = bench->wait_set ? bench_step_and_wait(bench_handle) : connector_run(bench_handle);
+    } while (bench_exit_status == connector_open_error);
+
+    return NULL;
+}
+
+static void run_case(bench_case_t const * const bench_case)
+{
+    pthread_t thread;
+    clockid_t thread_clock;
+    connector_transport_t const transport = connector_transport_tcp;
+    double latency_sum = 0;
+    double latency_max = 0;
+    double idle_start;
+    double cpu_start;
+    double cpu_ns;
+    unsigned long loops;
+    unsigned int i;
+
+    bench = bench_case;
+    bench_opens = 0;
+
+    bench_handle = connector_init(app_callback, NULL);
+    if (bench_handle == NULL)
+    {
+        fprintf(stderr, "%s: connector_init failed\n", bench->name);
+        exit(EXIT_FAILURE);
+    }
+
+    if (pthread_create(&thread, NULL, bench_connector_thread, NULL) != 0 || pthread_getcpuclockid(thread, &thread_clock) != 0)
+    {
+        fprintf(stderr, "%s: unable to start the connector thread\n", bench->name);
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < BENCH_REQUESTS; i++)
+    {
+        unsigned long const opens = bench_opens;
+        double const start = bench_time_ns(CLOCK_MONOTONIC);
+        double latency;
+
+        usleep(BENCH_REQUEST_GAP_US);
+
+        while (connector_initiate_action(bench_handle, connector_initiate_transport_start, &transport) == connector_service_busy)
+            usleep(1000);
+
+        {
+            double const request_ns = bench_time_ns(CLOCK_MONOTONIC);
+
+            while (bench_opens == opens)
+            {
+                if (bench_time_ns(CLOCK_MONOTONIC) - start > BENCH_TIME_LIMIT_NS)
+                {
+                    fprintf(stderr, "%s: request %u was not handled\n", bench->name, i);
+                    exit(EXIT_FAILURE);
+                }
+                usleep(100);
+            }
+            latency = bench_open_ns - request_ns;
+        }
+
+        latency_sum += latency;
+        if (latency > latency_max)
+            latency_max = latency;
+    }
+
+    /* let the last request settle before the idle time is measured */
+    usleep(200000);
+
+    loops = bench_loops;
+    cpu_start = bench_time_ns(thread_clock);
+    idle_start = bench_time_ns(CLOCK_MONOTONIC);
+    sleep(BENCH_IDLE_SECONDS);
+    cpu_ns = bench_time_ns(thread_clock) - cpu_start;
+    loops = bench_loops - loops;
+
+    printf("%-28s latency %8.3f ms mean %8.3f ms max  idle %7.3f ms CPU/s %7.1f loops/s\n", bench->name,
+           latency_sum / BENCH_REQUESTS / 1e6, latency_max / 1e6,
+           cpu_ns / BENCH_IDLE_SECONDS / 1e6, loops / ((bench_time_ns(CLOCK_MONOTONIC) - idle_start) / 1e9));
+
+    while (connector_initiate_action(bench_handle, connector_initiate_terminate, NULL) == connector_service_busy)
+        usleep(1000);
+    pthread_join(thread, NULL);
+
+    if (bench_exit_status != connector_device_terminated)
+    {
+        fprintf(stderr, "%s: connector exited with %d\n", bench->name, bench_exit_status);
+        exit(EXIT_FAILURE);
+    }
+}
+
+int main(void)
+{
+    static bench_case_t const cases[] =
+    {
+        {"connector_run, app_os_yield", connector_false},
+        {"connector_step, app_os_wait", connector_true}
+    };
+    size_t i;
+
+    if (app_os_wakeup_init() != 0)
+    {
+        fprintf(stderr, "app_os_wakeup_init failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%d requests %d ms apart, then %d s idle\n", BENCH_REQUESTS, BENCH_REQUEST_GAP_US / 1000, BENCH_IDLE_SECONDS);
+    for (i = 0; i < ARRAY_SIZE(cases); i++)
+        run_case(&cases[i]);
+
+    return 0;
+}
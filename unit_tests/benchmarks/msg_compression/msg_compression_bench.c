@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Messaging compression benchmark.
+ *
+ * Compresses typical small messaging payloads, each in its own session, with
+ * the streams msg_open_zlib() hands out, and times the per-session setup:
+ * msg_open_zlib() and msg_close_zlib() for deflate and inflate, with a free
+ * pooled stream and with the pool taken, which is the same path a build
+ * without CONNECTOR_COMPRESSION_STREAM_POOL_SIZE takes. Every payload is
+ * inflated again to check it. Built with CONNECTOR_COMPRESSION_DICTIONARY
+ * by default, "make CPPFLAGS=-DBENCH_NO_DICTIONARY" builds without it.
+ */
+#include "connector_api.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_SESSIONS          100000UL
+
+static struct
+{
+    char const * name;
+    char const * payload;
+} const bench_payloads[] =
+{
+    {"data points",
+        "21.4,1700000000000,,,,DOUBLE,C,,sensors/temperature\n"
+        "21.5,1700000001000,,,,DOUBLE,C,,sensors/temperature\n"
+        "21.5,1700000002000,,,,DOUBLE,C,,sensors/temperature\n"},
+    {"rci reply",
+        "<rci_reply version=\"1.1\"><query_setting><system><contact>ops</contact>"
+        "<location>Minnetonka</location><description>gateway 3</description></system></query_setting></rci_reply>"},
+    {"rci error",
+        "<rci_reply version=\"1.1\"><set_setting><serial index=\"1\"><baud><error id=\"1\">"
+        "<desc>Invalid value</desc><hint>9600</hint></error></baud></serial></set_setting></rci_reply>"},
+    {"json",
+        "{\"type\":\"DOUBLE\",\"value\":\"3.304\",\"timestamp\":\"1700000000000\",\"id\":\"sensors/voltage\"}"}
+};
+
+static connector_msg_data_t bench_msg;
+static msg_data_block_t bench_dblock;
+static uint8_t bench_deflated[MSG_MAX_SEND_PACKET_SIZE];
+static uint8_t bench_inflated[MSG_MAX_SEND_PACKET_SIZE];
+
+static double bench_time_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void bench_open(connector_bool_t const deflating)
+{
+    if (!msg_open_zlib(&bench_msg, &bench_dblock, deflating))
+    {
+        fprintf(stderr, "msg_open_zlib failed\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static size_t bench_deflate(char const * const payload)
+{
+    size_t const bytes = strlen(payload);
+    z_streamp zlib;
+    size_t deflated;
+
+    bench_open(connector_true);
+    zlib = bench_dblock.zlib;
+    zlib->next_in = (Bytef *)payload;
+    zlib->avail_in = bytes;
+    zlib->next_out = bench_deflated;
+    zlib->avail_out = sizeof bench_deflated;
+    if (deflate(zlib, Z_FINISH) != Z_STREAM_END)
+    {
+        fprintf(stderr, "deflate of %zu bytes failed\n", bytes);
+        exit(EXIT_FAILURE);
+    }
+    deflated = sizeof bench_deflated - zlib->avail_out;
+    msg_close_zlib(&bench_msg, &bench_dblock, connector_true);
+
+    return deflated;
+}
+
+static void bench_check_inflate(char const * const payload, size_t const deflated)
+{
+    size_t const bytes = strlen(payload);
+    z_streamp zlib;
+    int zret;
+
+    bench_open(connector_false);
+    zlib = bench_dblock.zlib;
+    zlib->next_in = bench_deflated;
+    zlib->avail_in = deflated;
+    zlib->next_out = bench_inflated;
+    zlib->avail_out = sizeof bench_inflated;
+
+    /* as msg_decompress_data() does */
+    zret = inflate(zlib, Z_NO_FLUSH);
+    #if (defined CONNECTOR_COMPRESSION_DICTIONARY)
+    if ((zret == Z_NEED_DICT) && (inflateSetDictionary(zlib, msg_zlib_dictionary, sizeof msg_zlib_dictionary - 1) == Z_OK))
+        zret = inflate(zlib, Z_NO_FLUSH);
+    #endif
+
+    if (zret != Z_STREAM_END || sizeof bench_inflated - zlib->avail_out != bytes || memcmp(bench_inflated, payload, bytes) != 0)
+    {
+        fprintf(stderr, "inflate of %zu bytes failed (%d)\n", deflated, zret);
+        exit(EXIT_FAILURE);
+    }
+    msg_close_zlib(&bench_msg, &bench_dblock, connector_false);
+}
+
+static void run_ratio(void)
+{
+    size_t total_bytes = 0;
+    size_t total_deflated = 0;
+    size_t i;
+
+    for (i = 0; i < ARRAY_SIZE(bench_payloads); i++)
+    {
+        char const * const payload = bench_payloads[i].payload;
+        size_t const bytes = strlen(payload);
+        size_t const deflated = bench_deflate(payload);
+
+        bench_check_inflate(payload, deflated);
+        printf("%-12s %5zu B -> %5zu B  %5.1f%%\n", bench_payloads[i].name, bytes, deflated, (deflated * 100.0) / bytes);
+        total_bytes += bytes;
+        total_deflated += deflated;
+    }
+    printf("%-12s %5zu B -> %5zu B  %5.1f%%\n", "total", total_bytes, total_deflated, (total_deflated * 100.0) / total_bytes);
+}
+
+static void run_setup(char const * const label, connector_bool_t const deflating, connector_bool_t const pooled)
+{
+    msg_zlib_pool_entry_t * const pool = deflating ? bench_msg.zlib_pool.deflate : bench_msg.zlib_pool.inflate;
+    unsigned long session;
+    double start;
+    double session_ns;
+    size_t i;
+
+    /* a session holding each pooled stream sends the others to their own */
+    for (i = 0; i < CONNECTOR_COMPRESSION_STREAM_POOL_SIZE; i++)
+        pool[i].in_use = connector_bool(!pooled);
+
+    start = bench_time_ns();
+    for (session = 0; session < BENCH_SESSIONS; session++)
+    {
+        bench_open(deflating);
+        msg_close_zlib(&bench_msg, &bench_dblock, deflating);
+    }
+    session_ns = (bench_time_ns() - start) / BENCH_SESSIONS;
+
+    for (i = 0; i < CONNECTOR_COMPRESSION_STREAM_POOL_SIZE; i++)
+        pool[i].in_use = connector_false;
+
+    printf("%-8s %-9s %8.2f us per session\n", label, pooled ? "pooled" : "unpooled", session_ns / 1e3);
+}
+
+static void run_sessions(connector_bool_t const pooled)
+{
+    unsigned long const rounds = BENCH_SESSIONS / ARRAY_SIZE(bench_payloads);
+    unsigned long round;
+    double start;
+    double session_ns;
+    size_t i;
+
+    for (i = 0; i < CONNECTOR_COMPRESSION_STREAM_POOL_SIZE; i++)
+        bench_msg.zlib_pool.deflate[i].in_use = connector_bool(!pooled);
+
+    start = bench_time_ns();
+    for (round = 0; round < rounds; round++)
+    {
+        for (i = 0; i < ARRAY_SIZE(bench_payloads); i++)
+            bench_deflate(bench_payloads[i].payload);
+    }
+    session_ns = (bench_time_ns() - start) / (rounds * ARRAY_SIZE(bench_payloads));
+
+    for (i = 0; i < CONNECTOR_COMPRESSION_STREAM_POOL_SIZE; i++)
+        bench_msg.zlib_pool.deflate[i].in_use = connector_false;
+
+    printf("%-8s %-9s %8.2f us per session\n", "send", pooled ? "pooled" : "unpooled", session_ns / 1e3);
+}
+
+int main(void)
+{
+#if (defined CONNECTOR_COMPRESSION_DICTIONARY)
+    printf("preset dictionary (%zu bytes), level %d, window bits %d, memLevel %d\n",
+           sizeof msg_zlib_dictionary - 1, CONNECTOR_COMPRESSION_LEVEL, CONNECTOR_COMPRESSION_WINDOW_BITS, CONNECTOR_COMPRESSION_MEM_LEVEL);
+#else
+    printf("no dictionary, level %d, window bits %d, memLevel %d\n",
+           CONNECTOR_COMPRESSION_LEVEL, CONNECTOR_COMPRESSION_WINDOW_BITS, CONNECTOR_COMPRESSION_MEM_LEVEL);
+#endif
+    run_ratio();
+
+    printf("open and close, %lu sessions\n", BENCH_SESSIONS);
+    run_setup("deflate", connector_true, connector_false);
+    run_setup("deflate", connector_true, connector_true);
+    run_setup("inflate", connector_false, connector_false);
+    run_setup("inflate", connector_false, connector_true);
+
+    printf("open, compress one payload and close, %lu sessions\n", BENCH_SESSIONS);
+    run_sessions(connector_false);
+    run_sessions(connector_true);
+
+    msg_free_zlib_pool(&bench_msg);
+
+    return 0;
+}
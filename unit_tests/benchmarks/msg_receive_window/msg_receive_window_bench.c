@@ -0,0 +1,495 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Messaging receive window benchmark.
+ *
+ * Device requests are sent to msg_process() by a simulated Device Cloud over
+ * a simulated link: packets are serialized at the link rate and arrive half a
+ * round trip later, the acks msg_process() queues are taken off the send queue
+ * and reach the sender half a round trip after that. The sender keeps at most
+ * the window of the last ack in flight. The uptime callback returns the
+ * simulated clock, so the run is deterministic and takes no real time.
+ *
+ * Each case is run with the window fixed at the initial size, by returning
+ * the same initial and maximum window from the config callback, and with the
+ * default adaptive window. The ack batch size is a build option, rebuild with
+ * "make CPPFLAGS=-DCONNECTOR_MSG_ACK_BATCH_SIZE=1" to compare the number of
+ * sends without batching.
+ */
+#include "connector_api.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_SESSION_BYTES     (4UL * 1024 * 1024)
+#define BENCH_MAX_SESSIONS      4
+#define BENCH_TICK_US           1000UL
+#define BENCH_TRIES_PER_TICK    8
+#define BENCH_TIME_LIMIT_US     (1000UL * 1000 * 1000)
+#define BENCH_LINK_PACKETS      256
+#define BENCH_TARGET            "bench"
+
+typedef struct {
+    char const * name;
+    unsigned long link_bits_per_second;
+    unsigned long rtt_us;
+    unsigned int sessions;
+    unsigned long consumer_bytes_per_second;    /* 0 consumes everything at once */
+} bench_case_t;
+
+typedef struct {
+    uint16_t id;
+    size_t total;
+    size_t sent;
+    size_t acked;
+    uint32_t window;
+    size_t received;
+    unsigned long done_us;
+    unsigned long window_sum;
+    unsigned long window_samples;
+} bench_session_t;
+
+typedef struct {
+    unsigned long arrival_us;
+    bench_session_t * session;
+    size_t length;
+    uint8_t data[MSG_MAX_RECV_PACKET_SIZE];
+} bench_packet_t;
+
+typedef struct {
+    unsigned long arrival_us;
+    uint16_t id;
+    uint32_t ack_count;
+    uint32_t window;
+} bench_ack_t;
+
+static bench_case_t const * bench;
+static connector_bool_t bench_fixed_window;
+static unsigned long now_us;
+
+static bench_session_t sessions[BENCH_MAX_SESSIONS];
+static bench_session_t * delivering;
+static unsigned long consumed_bytes;
+
+static bench_packet_t link_packets[BENCH_LINK_PACKETS];
+static unsigned int link_head;
+static unsigned int link_count;
+static unsigned long link_free_us;
+
+static bench_ack_t acks[BENCH_LINK_PACKETS * BENCH_MAX_SESSIONS];
+static unsigned int ack_head;
+static unsigned int ack_count;
+static unsigned long ack_packets;
+static unsigned long ack_sends;
+
+static connector_callback_status_t app_data_service(connector_request_id_data_service_t const request_id, void * const data)
+{
+    connector_callback_status_t status = connector_callback_continue;
+
+    switch (request_id)
+    {
+        case connector_request_id_data_service_receive_target:
+        {
+            connector_data_service_receive_target_t * const receive_target = data;
+
+            receive_target->user_context = delivering;
+            break;
+        }
+        case connector_request_id_data_service_receive_data:
+        {
+            connector_data_service_receive_data_t * const receive_data = data;
+            bench_session_t * const session = receive_data->user_context;
+
+            if (bench->consumer_bytes_per_second > 0)
+            {
+                unsigned long long const allowed = ((unsigned long long)bench->consumer_bytes_per_second * now_us) / 1000000;
+
+                if (consumed_bytes + receive_data->bytes_used > allowed)
+                {
+                    status = connector_callback_busy;
+                    break;
+                }
+            }
+            consumed_bytes += receive_data->bytes_used;
+            session->received += receive_data->bytes_used;
+            break;
+        }
+        case connector_request_id_data_service_receive_reply_data:
+        {
+            connector_data_service_receive_reply_data_t * const reply_data = data;
+
+            reply_data->bytes_used = 0;
+            reply_data->more_data = connector_false;
+            break;
+        }
+        default:
+            break;
+    }
+
+    return status;
+}
+
+static connector_callback_status_t app_callback(connector_class_id_t const class_id, connector_request_id_t const request_id, void * const data, void * const context)
+{
+    connector_callback_status_t status = connector_callback_unrecognized;
+
+    UNUSED_PARAMETER(context);
+
+    switch (class_id)
+    {
+        case connector_class_id_operating_system:
+            switch (request_id.os_request)
+            {
+                case connector_request_id_os_malloc:
+                {
+                    connector_os_malloc_t * const os_malloc = data;
+
+                    os_malloc->ptr = malloc(os_malloc->size);
+                    status = connector_callback_continue;
+                    break;
+                }
+                case connector_request_id_os_free:
+                {
+                    connector_os_free_t * const os_free = data;
+
+                    free(os_free->ptr);
+                    status = connector_callback_continue;
+                    break;
+                }
+                case connector_request_id_os_system_up_time:
+                {
+                    connector_os_system_up_time_t * const up_time = data;
+
+                    up_time->sys_uptime = now_us / 1000000;
+                    status = connector_callback_continue;
+                    break;
+                }
+                default:
+                    break;
+            }
+            break;
+
+        case connector_class_id_config:
+            if (request_id.config_request == connector_request_id_config_msg_receive_window)
+            {
+                connector_config_msg_receive_window_t * const config_receive_window = data;
+
+                if (bench_fixed_window)
+                    config_receive_window->maximum = config_receive_window->initial;
+                status = connector_callback_continue;
+            }
+            break;
+
+        case connector_class_id_data_service:
+            status = app_data_service(request_id.data_service_request, data);
+            break;
+
+        default:
+            break;
+    }
+
+    return status;
+}
+
+/* queues the next packet of the session on the link, returns connector_false when the window is full */
+static connector_bool_t send_packet(bench_session_t * const session)
+{
+    connector_bool_t const start = connector_bool(session->sent == 0);
+    size_t const header_bytes = start ? record_end(start_packet) : record_end(data_packet);
+    size_t const room = MSG_MAX_RECV_PACKET_SIZE - PACKET_EDP_FACILITY_SIZE - header_bytes;
+    size_t const remaining = session->total - session->sent;
+    size_t const bytes = (remaining < room) ? remaining : room;
+    connector_bool_t const last = connector_bool(bytes == remaining);
+    bench_packet_t * packet;
+    uint8_t * edp_header;
+
+    if ((remaining == 0) || (link_count == BENCH_LINK_PACKETS) || (session->sent + bytes - session->acked > session->window))
+        return connector_false;
+
+    packet = &link_packets[(link_head + link_count) % BENCH_LINK_PACKETS];
+    link_count++;
+
+    packet->session = session;
+    packet->length = PACKET_EDP_FACILITY_SIZE + header_bytes + bytes;
+
+    /* as connector_tcp_recv.h leaves it: the length in the EDP header is the facility data only */
+    edp_header = packet->data;
+    message_store_be16(edp_header, type, E_MSG_MT2_TYPE_PAYLOAD);
+    message_store_be16(edp_header, length, (uint16_t)(header_bytes + bytes));
+    tcp_fill_facility_header(edp_header, E_MSG_FAC_MSG_NUM);
+
+    if (start)
+    {
+        uint8_t * const start_packet = GET_PACKET_DATA_POINTER(edp_header, PACKET_EDP_FACILITY_SIZE);
+        uint8_t * const ds_request = start_packet + header_bytes;
+
+        message_store_u8(start_packet, opcode, msg_opcode_start);
+        message_store_u8(start_packet, flags, MSG_FLAG_REQUEST | (last ? MSG_FLAG_LAST_DATA : 0));
+        message_store_be16(start_packet, transaction_id, session->id);
+        message_store_be16(start_packet, service_id, msg_service_id_data);
+        message_store_u8(start_packet, compression_id, MSG_COMPRESSION_NONE);
+
+        /* opcode, target length, target, parameter count, then the request data */
+        ds_request[0] = data_service_opcode_device_request;
+        ds_request[1] = sizeof BENCH_TARGET - 1;
+        memcpy(&ds_request[2], BENCH_TARGET, sizeof BENCH_TARGET - 1);
+        ds_request[2 + sizeof BENCH_TARGET - 1] = 0;
+    }
+    else
+    {
+        uint8_t * const data_packet = GET_PACKET_DATA_POINTER(edp_header, PACKET_EDP_FACILITY_SIZE);
+
+        message_store_u8(data_packet, opcode, msg_opcode_data);
+        message_store_u8(data_packet, flags, MSG_FLAG_REQUEST | (last ? MSG_FLAG_LAST_DATA : 0));
+        message_store_be16(data_packet, transaction_id, session->id);
+    }
+
+    {
+        unsigned long const wire_us = (unsigned long)(((unsigned long long)packet->length * 8 * 1000000) / bench->link_bits_per_second);
+
+        if (link_free_us < now_us)
+            link_free_us = now_us;
+        link_free_us += wire_us;
+        packet->arrival_us = link_free_us + bench->rtt_us / 2;
+    }
+
+    session->sent += bytes;
+
+    return connector_true;
+}
+
+/* takes what msg_process() queued off the send queue, as if the network callback sent it */
+static void drain_send_queue(connector_data_t * const connector_ptr)
+{
+    while (tcp_is_send_active(connector_ptr))
+    {
+        edp_send_entry_t const * const entry = tcp_send_entry(connector_ptr, 0);
+        uint8_t * edp_header = (uint8_t *)entry->ptr;
+        size_t const total_length = entry->total_length;
+        size_t offset = 0;
+        connector_bool_t has_ack = connector_false;
+
+        /* one send may hold a batch of acks */
+        while (offset < total_length)
+        {
+            uint8_t * const ack_packet = GET_PACKET_DATA_POINTER(edp_header, PACKET_EDP_FACILITY_SIZE);
+            size_t const packet_bytes = PACKET_EDP_HEADER_SIZE + message_load_be16(edp_header, length);
+
+            if (message_load_u8(ack_packet, opcode) == msg_opcode_ack)
+            {
+                bench_ack_t * const ack = &acks[(ack_head + ack_count) % ARRAY_SIZE(acks)];
+
+                ASSERT(ack_count < ARRAY_SIZE(acks));
+                ack_count++;
+                ack->arrival_us = now_us + bench->rtt_us / 2;
+                ack->id = message_load_be16(ack_packet, transaction_id);
+                ack->ack_count = message_load_be32(ack_packet, ack_count);
+                ack->window = message_load_be32(ack_packet, window_size);
+                ack_packets++;
+                has_ack = connector_true;
+            }
+
+            offset += packet_bytes;
+            edp_header += packet_bytes;
+        }
+
+        if (has_ack)
+            ack_sends++;
+
+        tcp_send_consume(connector_ptr, total_length);
+    }
+}
+
+static void receive_acks(void)
+{
+    while ((ack_count > 0) && (acks[ack_head].arrival_us <= now_us))
+    {
+        bench_ack_t const * const ack = &acks[ack_head];
+        unsigned int i;
+
+        for (i = 0; i < bench->sessions; i++)
+        {
+            bench_session_t * const session = &sessions[i];
+
+            if ((session->id == ack->id) && (ack->ack_count >= session->acked))
+            {
+                session->acked = ack->ack_count;
+                session->window = ack->window;
+                if (session->sent * 2 > session->total)
+                {
+                    session->window_sum += ack->window;
+                    session->window_samples++;
+                }
+            }
+        }
+
+        ack_head = (ack_head + 1) % ARRAY_SIZE(acks);
+        ack_count--;
+    }
+}
+
+static void run_case(bench_case_t const * const bench_case, connector_bool_t const fixed_window)
+{
+    connector_data_t connector;
+    connector_msg_data_t * msg_ptr;
+    unsigned int receive_timeout;
+    unsigned int i;
+    unsigned int finished = 0;
+    unsigned int next_session = 0;
+    unsigned long window_sum = 0;
+    unsigned long window_samples = 0;
+    unsigned long total_bytes = 0;
+    unsigned long done_us = 0;
+
+    bench = bench_case;
+    bench_fixed_window = fixed_window;
+    now_us = 0;
+    consumed_bytes = 0;
+    link_head = link_count = 0;
+    link_free_us = 0;
+    ack_head = ack_count = 0;
+    ack_packets = ack_sends = 0;
+
+    memset(&connector, 0, sizeof connector);
+    connector.callback = app_callback;
+
+    if (connector_facility_data_service_init(&connector, 0) != connector_working)
+    {
+        fprintf(stderr, "%s: connector_facility_data_service_init failed\n", bench->name);
+        exit(EXIT_FAILURE);
+    }
+    msg_ptr = get_facility_data(&connector, E_MSG_FAC_MSG_NUM);
+    msg_ptr->capabilities[msg_capability_cloud].window_size = MSG_RECV_WINDOW_SIZE;
+    msg_ptr->capabilities[msg_capability_cloud].max_transactions = CONNECTOR_MSG_MAX_TRANSACTION;
+
+    for (i = 0; i < bench->sessions; i++)
+    {
+        bench_session_t * const session = &sessions[i];
+
+        memset(session, 0, sizeof *session);
+        session->id = (uint16_t)(i + 1);
+        session->total = 3 + sizeof BENCH_TARGET - 1 + BENCH_SESSION_BYTES;
+        session->window = msg_ptr->capabilities[msg_capability_client].window_size;
+    }
+
+    while (finished < bench->sessions)
+    {
+        connector_bool_t held = connector_false;
+
+        if (now_us > BENCH_TIME_LIMIT_US)
+        {
+            fprintf(stderr, "%s: no progress\n", bench->name);
+            exit(EXIT_FAILURE);
+        }
+
+        receive_acks();
+
+        /* the sender goes round the sessions so they share the link */
+        for (i = 0; i < bench->sessions; i++)
+        {
+            unsigned int const index = (next_session + i) % bench->sessions;
+
+            while (send_packet(&sessions[index]))
+                ;
+        }
+        next_session = (next_session + 1) % bench->sessions;
+
+        while ((link_count > 0) && (link_packets[link_head].arrival_us <= now_us))
+        {
+            bench_packet_t * const packet = &link_packets[link_head];
+            unsigned int tries;
+
+            /* layer_facility_process() hands a packet in again until the facility is done with it,
+             * a busy consumer leaves it for the next tick */
+            delivering = packet->session;
+            for (tries = 0; tries < BENCH_TRIES_PER_TICK; tries++)
+            {
+                connector_status_t const status = msg_process(&connector, msg_ptr, packet->data, &receive_timeout);
+
+                drain_send_queue(&connector);
+                if ((status != connector_pending) && (status != connector_active))
+                    break;
+            }
+
+            if (tries == BENCH_TRIES_PER_TICK)
+            {
+                held = connector_true;
+                break;
+            }
+            link_head = (link_head + 1) % BENCH_LINK_PACKETS;
+            link_count--;
+        }
+
+        if (!held)
+        {
+            msg_process(&connector, msg_ptr, NULL, &receive_timeout);
+            drain_send_queue(&connector);
+        }
+
+        for (i = 0; i < bench->sessions; i++)
+        {
+            bench_session_t * const session = &sessions[i];
+
+            if ((session->done_us == 0) && (session->received == BENCH_SESSION_BYTES))
+            {
+                session->done_us = now_us;
+                finished++;
+            }
+        }
+
+        now_us += BENCH_TICK_US;
+    }
+
+    for (i = 0; i < bench->sessions; i++)
+    {
+        total_bytes += sessions[i].received;
+        window_sum += sessions[i].window_sum;
+        window_samples += sessions[i].window_samples;
+        if (sessions[i].done_us > done_us)
+            done_us = sessions[i].done_us;
+    }
+
+    printf("%-26s %-9s %9.1f KB/s  window %6lu  acks %5lu in %5lu sends\n", bench->name, fixed_window ? "fixed" : "adaptive",
+           (total_bytes / 1024.0) / (done_us / 1000000.0), (window_samples > 0) ? window_sum / window_samples : 0, ack_packets, ack_sends);
+
+    connector_facility_data_service_delete(&connector);
+}
+
+int main(void)
+{
+    static bench_case_t const cases[] =
+    {
+        { "RTT 20 ms",                 10000000, 20000, 1, 0 },
+        { "RTT 100 ms",                10000000, 100000, 1, 0 },
+        { "RTT 300 ms",                10000000, 300000, 1, 0 },
+        { "RTT 100 ms, 30 KB/s",       10000000, 100000, 1, 30 * 1024 },
+        { "RTT 20 ms, 4 sessions",    100000000, 20000, 4, 0 }
+    };
+    size_t i;
+
+    printf("%lu bytes per session, batches of %d acks\n", BENCH_SESSION_BYTES, CONNECTOR_MSG_ACK_BATCH_SIZE);
+    for (i = 0; i < ARRAY_SIZE(cases); i++)
+    {
+        run_case(&cases[i], connector_true);
+        run_case(&cases[i], connector_false);
+    }
+
+    return EXIT_SUCCESS;
+}
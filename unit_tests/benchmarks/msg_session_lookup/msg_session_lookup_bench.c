@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Messaging session lookup benchmark.
+ *
+ * Sessions are created with msg_create_session(), half of them device owned
+ * with ids from msg_find_next_available_id() and half of them cloud owned
+ * with the ids msg_process() would give them, the way a busy connection
+ * fills the session list. For each session count the benchmark reports the
+ * time of a msg_find_session() hit and miss, the same lookups done by
+ * walking the session list the way msg_find_session() did before the
+ * session table, the time to pick the next device session id, and the time
+ * to create and delete one session with all the others open.
+ *
+ * The table size is a build option, rebuild with
+ * "make CPPFLAGS=-DCONNECTOR_MSG_SESSION_TABLE_SIZE=256" to compare another
+ * size. Sessions past the table load are found by the list walk fallback.
+ */
+#include "connector_api.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_MAX_SESSIONS      512
+#define BENCH_LOOKUPS           2000000UL
+#define BENCH_CHURN             200000UL
+#define BENCH_CLOUD_ID_BASE     1000
+#define BENCH_SESSION_STRIDE    37
+
+static msg_session_t * bench_sessions[BENCH_MAX_SESSIONS];
+
+static connector_callback_status_t app_callback(connector_class_id_t const class_id, connector_request_id_t const request_id, void * const data, void * const context)
+{
+    connector_callback_status_t status = connector_callback_unrecognized;
+
+    UNUSED_PARAMETER(context);
+
+    switch (class_id)
+    {
+        case connector_class_id_operating_system:
+            switch (request_id.os_request)
+            {
+                case connector_request_id_os_malloc:
+                {
+                    connector_os_malloc_t * const os_malloc = data;
+
+                    os_malloc->ptr = malloc(os_malloc->size);
+                    status = connector_callback_continue;
+                    break;
+                }
+                case connector_request_id_os_free:
+                {
+                    connector_os_free_t * const os_free = data;
+
+                    free(os_free->ptr);
+                    status = connector_callback_continue;
+                    break;
+                }
+                default:
+                    break;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return status;
+}
+
+/* stands in for the data service, so deleting a session only frees it */
+static connector_status_t bench_service_callback(connector_data_t * const connector_ptr, msg_service_request_t * const service_request)
+{
+    UNUSED_PARAMETER(connector_ptr);
+    UNUSED_PARAMETER(service_request);
+
+    return connector_working;
+}
+
+static double bench_time_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/* the lookup msg_find_session() did before the session table */
+static msg_session_t * bench_list_find(connector_msg_data_t const * const msg_ptr, unsigned int const id, connector_bool_t const client_owned)
+{
+    msg_session_t * session = msg_ptr->session.head;
+
+    while (session != NULL)
+    {
+        if ((session->session_id == id) && (msg_session_is_client_owned(session) == client_owned))
+            break;
+
+        session = session->next;
+    }
+
+    return session;
+}
+
+static msg_session_t * bench_create(connector_data_t * const connector_ptr, connector_msg_data_t * const msg_ptr, unsigned int const index)
+{
+    connector_bool_t const client_owned = connector_bool((index % 2) == 0);
+    connector_status_t status;
+    msg_session_t * const session = msg_create_session(connector_ptr, msg_ptr, msg_service_id_data, client_owned, &status);
+
+    if (session == NULL)
+    {
+        fprintf(stderr, "session %u: msg_create_session failed\n", index);
+        exit(EXIT_FAILURE);
+    }
+
+    if (!client_owned)
+        msg_set_session_id(msg_ptr, session, BENCH_CLOUD_ID_BASE + index);
+
+    return session;
+}
+
+static void bench_check(msg_session_t const * const found, msg_session_t const * const expected, char const * const lookup)
+{
+    if (found != expected)
+    {
+        fprintf(stderr, "%s: wrong session\n", lookup);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void run_case(unsigned int const session_count)
+{
+    connector_data_t connector;
+    connector_msg_data_t * msg_ptr;
+    msg_session_t * volatile found = NULL;
+    unsigned long i;
+    double start;
+    double table_hit_ns;
+    double table_miss_ns;
+    double list_hit_ns;
+    double list_miss_ns;
+    double next_id_ns;
+    double churn_ns;
+
+    memset(&connector, 0, sizeof connector);
+    connector.callback = app_callback;
+
+    if (connector_facility_data_service_init(&connector, 0) != connector_working)
+    {
+        fprintf(stderr, "%u sessions: connector_facility_data_service_init failed\n", session_count);
+        exit(EXIT_FAILURE);
+    }
+    msg_ptr = get_facility_data(&connector, E_MSG_FAC_MSG_NUM);
+    msg_ptr->capabilities[msg_capability_cloud].max_transactions = 0;
+    msg_ptr->capabilities[msg_capability_client].max_transactions = 0;
+    msg_ptr->service_cb[msg_service_id_data] = bench_service_callback;
+
+    for (i = 0; i < session_count; i++)
+        bench_sessions[i] = bench_create(&connector, msg_ptr, i);
+
+    for (i = 0; i < session_count; i++)
+    {
+        msg_session_t * const session = bench_sessions[i];
+        connector_bool_t const client_owned = msg_session_is_client_owned(session);
+
+        bench_check(msg_find_session(msg_ptr, session->session_id, client_owned), session, "table");
+        bench_check(bench_list_find(msg_ptr, session->session_id, client_owned), session, "list");
+    }
+
+    start = bench_time_ns();
+    for (i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        msg_session_t const * const session = bench_sessions[(i * BENCH_SESSION_STRIDE) % session_count];
+
+        found = msg_find_session(msg_ptr, session->session_id, msg_session_is_client_owned(session));
+    }
+    table_hit_ns = (bench_time_ns() - start) / BENCH_LOOKUPS;
+
+    start = bench_time_ns();
+    for (i = 0; i < BENCH_LOOKUPS; i++)
+        found = msg_find_session(msg_ptr, MSG_INVALID_CLIENT_SESSION - 1 - (i % 256), connector_bool(i & 1));
+    table_miss_ns = (bench_time_ns() - start) / BENCH_LOOKUPS;
+
+    start = bench_time_ns();
+    for (i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        msg_session_t const * const session = bench_sessions[(i * BENCH_SESSION_STRIDE) % session_count];
+
+        found = bench_list_find(msg_ptr, session->session_id, msg_session_is_client_owned(session));
+    }
+    list_hit_ns = (bench_time_ns() - start) / BENCH_LOOKUPS;
+
+    start = bench_time_ns();
+    for (i = 0; i < BENCH_LOOKUPS; i++)
+        found = bench_list_find(msg_ptr, MSG_INVALID_CLIENT_SESSION - 1 - (i % 256), connector_bool(i & 1));
+    list_miss_ns = (bench_time_ns() - start) / BENCH_LOOKUPS;
+
+    start = bench_time_ns();
+    for (i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        if (msg_find_next_available_id(msg_ptr) == MSG_INVALID_CLIENT_SESSION)
+        {
+            fprintf(stderr, "%u sessions: no session id available\n", session_count);
+            exit(EXIT_FAILURE);
+        }
+    }
+    next_id_ns = (bench_time_ns() - start) / BENCH_LOOKUPS;
+
+    start = bench_time_ns();
+    for (i = 0; i < BENCH_CHURN; i++)
+    {
+        unsigned int const index = (i * BENCH_SESSION_STRIDE) % session_count;
+
+        if (msg_delete_session(&connector, msg_ptr, bench_sessions[index]) != connector_working)
+        {
+            fprintf(stderr, "%u sessions: msg_delete_session failed\n", session_count);
+            exit(EXIT_FAILURE);
+        }
+        bench_sessions[index] = bench_create(&connector, msg_ptr, index);
+    }
+    churn_ns = (bench_time_ns() - start) / BENCH_CHURN;
+
+    for (i = 0; i < session_count; i++)
+        msg_delete_session(&connector, msg_ptr, bench_sessions[i]);
+    connector_facility_data_service_delete(&connector);
+
+    (void)found;
+    printf("%4u sessions  hit %6.1f ns table %7.1f ns list  miss %6.1f ns table %7.1f ns list  next id %7.1f ns  create+delete %7.1f ns\n",
+           session_count, table_hit_ns, list_hit_ns, table_miss_ns, list_miss_ns, next_id_ns, churn_ns);
+}
+
+int main(void)
+{
+    static unsigned int const cases[] = {4, 16, 48, 128, 512};
+    size_t i;
+
+    printf("table size %d, %d indexed\n", CONNECTOR_MSG_SESSION_TABLE_SIZE, MSG_SESSION_TABLE_MAX_LOAD);
+    for (i = 0; i < ARRAY_SIZE(cases); i++)
+        run_case(cases[i]);
+
+    return 0;
+}
@@ -0,0 +1,446 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * Binary RCI input parser benchmark.
+ *
+ * Builds a set_setting request for the setting groups of
+ * public/run/samples/remote_config/config.rci, repeated BENCH_COPIES times,
+ * and times rci_binary() on it with the request delivered whole and in
+ * fragments of decreasing size. Every run must hand the same values to the
+ * callback, the checksum printed with each result shows that they do.
+ */
+#include "connector_api.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_COPIES        100
+#define BENCH_RUNS          400
+#define BENCH_OUTPUT_BYTES  1497
+
+static connector_element_t element_read_write = { NULL, connector_element_access_read_write };
+static connector_element_t element_read_only = { NULL, connector_element_access_read_only };
+static connector_element_t element_write_only = { NULL, connector_element_access_write_only };
+
+#define READ_WRITE(type)    { connector_element_type_##type, { &element_read_write } }
+#define READ_ONLY(type)     { connector_element_type_##type, { &element_read_only } }
+#define WRITE_ONLY(type)    { connector_element_type_##type, { &element_write_only } }
+
+static connector_item_t serial_items[] =
+{
+    READ_WRITE(enum), READ_WRITE(enum), READ_WRITE(uint32), READ_WRITE(on_off), READ_ONLY(uint32)
+};
+
+static connector_item_t ethernet_items[] =
+{
+    READ_WRITE(ipv4), READ_WRITE(ipv4), READ_WRITE(ipv4), READ_WRITE(boolean), READ_WRITE(fqdnv4), READ_WRITE(mac_addr), READ_WRITE(enum)
+};
+
+static connector_item_t device_time_items[] =
+{
+    READ_WRITE(datetime)
+};
+
+static connector_item_t device_info_items[] =
+{
+    READ_ONLY(0x_hex32), READ_WRITE(string), READ_WRITE(string), READ_WRITE(string), READ_WRITE(multiline_string)
+};
+
+static connector_item_t system_items[] =
+{
+    READ_WRITE(string), READ_WRITE(string), READ_WRITE(string)
+};
+
+static connector_item_t devicesecurity_items[] =
+{
+    READ_WRITE(enum), WRITE_ONLY(password)
+};
+
+static char * serial_errors[] =
+{
+    "Invalid baud rate ", "Invalid data bits", " Invalid parity", "Invalid xbreak setting", "Invalid combination of data bits and parity"
+};
+
+static char * ethernet_errors[] =
+{
+    "Invalid ethernet duplex setting", "Invalid IP address", "Invalid subnet mask", "Invalid gateway address", "Invalid DNS address"
+};
+
+static char * device_time_errors[] =
+{
+    "Invalid time"
+};
+
+#define GROUP(name, instances, errors, error_count) \
+    { { connector_collection_type_fixed_array, { instances }, { ARRAY_SIZE(name##_items), name##_items } }, { error_count, errors } }
+
+static connector_group_t setting_groups[] =
+{
+    GROUP(serial, 2, serial_errors, ARRAY_SIZE(serial_errors)),
+    GROUP(ethernet, 1, ethernet_errors, ARRAY_SIZE(ethernet_errors)),
+    GROUP(device_time, 1, device_time_errors, ARRAY_SIZE(device_time_errors)),
+    GROUP(device_info, 1, NULL, 0),
+    GROUP(system, 1, NULL, 0),
+    GROUP(devicesecurity, 1, NULL, 0)
+};
+
+static connector_remote_group_table_t const group_table[] =
+{
+    { setting_groups, ARRAY_SIZE(setting_groups) },
+    { NULL, 0 }
+};
+
+static char const * const error_table[] =
+{
+    "Bad command", "Bad configuration", "Bad value",
+    "Bad value", "Invalid index", "Invalid name", "Missing name",
+    "Load fail", "Save fail", "Insufficient memory"
+};
+
+static connector_remote_config_data_t const bench_rci_data =
+{
+    group_table, error_table, ARRAY_SIZE(error_table), 0, 0x00000001, "Linux Cloud Connector Sample"
+};
+
+connector_remote_config_data_t const * const rci_descriptor_data = &bench_rci_data;
+
+static uint8_t * request;
+static size_t request_bytes;
+static size_t request_values;
+
+static void put_u8(uint8_t const value)
+{
+    request[request_bytes++] = value;
+}
+
+/* same encoding as rci_output_uint32() */
+static void put_ber(uint32_t const value)
+{
+    if (value <= UINT32_C(0x7F))
+    {
+        put_u8((uint8_t)value);
+    }
+    else if (value <= UINT32_C(0x1FFF))
+    {
+        put_u8((uint8_t)(BINARY_RCI_SIZE_ALTERNATE_FLAG | (value >> 8)));
+        put_u8((uint8_t)value);
+    }
+    else if (value <= UINT32_C(0xFFFF))
+    {
+        put_u8(BINARY_RCI_SET_MULTI_FOLLOW_BYTES(binary_rci_two_follow_byte));
+        put_u8((uint8_t)(value >> 8));
+        put_u8((uint8_t)value);
+    }
+    else
+    {
+        put_u8(BINARY_RCI_SET_MULTI_FOLLOW_BYTES(binary_rci_four_follow_byte));
+        put_u8((uint8_t)(value >> 24));
+        put_u8((uint8_t)(value >> 16));
+        put_u8((uint8_t)(value >> 8));
+        put_u8((uint8_t)value);
+    }
+}
+
+static void put_bytes(void const * const data, size_t const length)
+{
+    put_ber((uint32_t)length);
+    memcpy(&request[request_bytes], data, length);
+    request_bytes += length;
+}
+
+static void put_string(char const * const string)
+{
+    put_bytes(string, strlen(string));
+}
+
+static void put_field(unsigned int const id)
+{
+    put_ber(encode_element_id(id));
+    request_values++;
+}
+
+static void build_request(void)
+{
+    static uint8_t const ip[] = { 192, 168, 1, 10 };
+    static uint8_t const subnet[] = { 255, 255, 255, 0 };
+    static uint8_t const gateway[] = { 192, 168, 1, 1 };
+    static uint8_t const mac[] = { 0x00, 0x40, 0x9D, 0x12, 0x34, 0x56 };
+    int copy;
+
+    request = malloc(BENCH_COPIES * 512);
+    request_bytes = 0;
+    request_values = 0;
+
+    put_ber(rci_command_set_setting);
+
+    for (copy = 0; copy < BENCH_COPIES; copy++)
+    {
+        put_ber(encode_group_id(0));
+        put_field(0); put_ber(6);
+        put_field(1); put_ber(copy % 3);
+        put_field(2); put_ber(8);
+        put_field(3); put_ber(copy & 1);
+        put_u8(BINARY_RCI_TERMINATOR);
+
+        put_ber(encode_group_id(1));
+        put_field(0); put_bytes(ip, sizeof ip);
+        put_field(1); put_bytes(subnet, sizeof subnet);
+        put_field(2); put_bytes(gateway, sizeof gateway);
+        put_field(3); put_ber(1);
+        put_field(4); put_string("devicecloud.digi.com");
+        put_field(5); put_bytes(mac, sizeof mac);
+        put_field(6); put_ber(2);
+        put_u8(BINARY_RCI_TERMINATOR);
+
+        put_ber(encode_group_id(2));
+        put_field(0); put_string("2022-03-14T15:09:26+0100");
+        put_u8(BINARY_RCI_TERMINATOR);
+
+        put_ber(encode_group_id(3));
+        put_field(1); put_string("Cloud Connector for Embedded Linux");
+        put_field(2); put_string("ConnectCore 6UL SBC Pro");
+        put_field(3); put_string("Digi International Inc.");
+        put_field(4); put_string("Remote configuration sample device\nSecond line of the description\nThird line");
+        put_u8(BINARY_RCI_TERMINATOR);
+
+        put_ber(encode_group_id(4));
+        put_field(0); put_string("Benchmark device");
+        put_field(1); put_string("support@example.com");
+        put_field(2); put_string("Minnetonka, MN 55343");
+        put_u8(BINARY_RCI_TERMINATOR);
+
+        put_ber(encode_group_id(5));
+        put_field(0); put_ber(1);
+        put_field(1); put_string("a password long enough to take more than one fragment of the small sizes");
+        put_u8(BINARY_RCI_TERMINATOR);
+    }
+
+    put_u8(BINARY_RCI_TERMINATOR);
+}
+
+static size_t values_seen;
+static uint32_t checksum;
+
+static void checksum_add(uint32_t const value)
+{
+    checksum = (checksum * UINT32_C(31)) + value;
+}
+
+static connector_callback_status_t app_remote_config(connector_request_id_remote_config_t const request_id, connector_remote_config_t * const remote_config)
+{
+    if (request_id == connector_request_id_remote_config_element_process)
+    {
+        connector_element_value_t const * const value = remote_config->element.value;
+
+        values_seen++;
+        checksum_add(remote_config->group.id);
+        checksum_add(remote_config->element.id);
+
+        switch (remote_config->element.type)
+        {
+            case connector_element_type_uint32:
+            case connector_element_type_0x_hex32:
+                checksum_add(value->unsigned_integer_value);
+                break;
+            case connector_element_type_enum:
+                checksum_add(value->enum_value);
+                break;
+            case connector_element_type_on_off:
+                checksum_add(value->on_off_value);
+                break;
+            case connector_element_type_boolean:
+                checksum_add(value->boolean_value);
+                break;
+            default:
+            {
+                char const * string;
+
+                for (string = value->string_value; *string != '\0'; string++)
+                    checksum_add((uint8_t)*string);
+                break;
+            }
+        }
+    }
+
+    return connector_callback_continue;
+}
+
+static connector_callback_status_t app_callback(connector_class_id_t const class_id, connector_request_id_t const request_id, void * const data, void * const context)
+{
+    connector_callback_status_t status = connector_callback_unrecognized;
+
+    UNUSED_PARAMETER(context);
+
+    switch (class_id)
+    {
+        case connector_class_id_operating_system:
+            switch (request_id.os_request)
+            {
+                case connector_request_id_os_malloc:
+                {
+                    connector_os_malloc_t * const os_malloc = data;
+
+                    os_malloc->ptr = malloc(os_malloc->size);
+                    status = connector_callback_continue;
+                    break;
+                }
+                case connector_request_id_os_realloc:
+                {
+                    connector_os_realloc_t * const os_realloc = data;
+
+                    os_realloc->ptr = realloc(os_realloc->ptr, os_realloc->new_size);
+                    status = connector_callback_continue;
+                    break;
+                }
+                case connector_request_id_os_free:
+                {
+                    connector_os_free_t * const os_free = data;
+
+                    free(os_free->ptr);
+                    status = connector_callback_continue;
+                    break;
+                }
+                default:
+                    break;
+            }
+            break;
+
+        case connector_class_id_remote_config:
+            status = app_remote_config(request_id.remote_config_request, data);
+            break;
+
+        default:
+            break;
+    }
+
+    return status;
+}
+
+static void set_fragment(rci_service_data_t * const service_data, size_t const offset, size_t const fragment_bytes)
+{
+    size_t const remaining = request_bytes - offset;
+
+    service_data->input.data = request + offset;
+    service_data->input.bytes = (remaining > fragment_bytes) ? fragment_bytes : remaining;
+    service_data->input.flags = 0;
+    if (remaining <= fragment_bytes)
+        MsgSetLastData(service_data->input.flags);
+}
+
+/* returns the time one parse of the request took, in nanoseconds */
+static unsigned long parse_request(size_t const fragment_bytes)
+{
+    static uint8_t output[BENCH_OUTPUT_BYTES];
+    connector_data_t connector;
+    rci_service_data_t service_data;
+    size_t offset = 0;
+    rci_status_t status;
+    struct timespec start, end;
+
+    memset(&connector, 0, sizeof connector);
+    connector.callback = app_callback;
+    connector.rci_data = rci_descriptor_data;
+
+    service_data.connector_ptr = &connector;
+    service_data.output.data = output;
+    service_data.output.bytes = sizeof output;
+    service_data.output.flags = 0;
+    set_fragment(&service_data, offset, fragment_bytes);
+
+    values_seen = 0;
+    checksum = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    status = rci_binary(&connector, rci_session_start, &service_data);
+    for (;;)
+    {
+        switch (status)
+        {
+            case rci_status_busy:
+                break;
+
+            case rci_status_more_input:
+                offset += service_data.input.bytes;
+                set_fragment(&service_data, offset, fragment_bytes);
+                break;
+
+            case rci_status_flush_output:
+                service_data.output.data = output;
+                service_data.output.bytes = sizeof output;
+                break;
+
+            case rci_status_complete:
+                goto done;
+
+            case rci_status_error:
+            case rci_status_internal_error:
+                fprintf(stderr, "rci_binary failed with %d at offset %zu\n", status, offset);
+                exit(EXIT_FAILURE);
+        }
+        status = rci_binary(&connector, rci_session_active, &service_data);
+    }
+
+done:
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    free_rci_internal_data(&connector);
+
+    if (values_seen != request_values)
+    {
+        fprintf(stderr, "%zu values delivered, %zu in the request\n", values_seen, request_values);
+        exit(EXIT_FAILURE);
+    }
+
+    return (unsigned long)((end.tv_sec - start.tv_sec) * 1000000000L + (end.tv_nsec - start.tv_nsec));
+}
+
+int main(void)
+{
+    static size_t const fragment_sizes[] = { 0, 1497, 256, 64, 32, 16, 7 };
+    size_t i;
+
+    build_request();
+    printf("set_setting request: %zu bytes, %zu values\n", request_bytes, request_values);
+    printf("%-16s %12s %12s\n", "fragment bytes", "best us", "checksum");
+
+    for (i = 0; i < ARRAY_SIZE(fragment_sizes); i++)
+    {
+        size_t const fragment_bytes = (fragment_sizes[i] == 0) ? request_bytes : fragment_sizes[i];
+        unsigned long best = ULONG_MAX;
+        int run;
+
+        for (run = 0; run < BENCH_RUNS; run++)
+        {
+            unsigned long const elapsed = parse_request(fragment_bytes);
+
+            if (elapsed < best)
+                best = elapsed;
+        }
+
+        if (fragment_sizes[i] == 0)
+            printf("%-16s %12.1f %12" PRIx32 "\n", "whole request", best / 1000.0, checksum);
+        else
+            printf("%-16zu %12.1f %12" PRIx32 "\n", fragment_bytes, best / 1000.0, checksum);
+    }
+
+    free(request);
+
+    return EXIT_SUCCESS;
+}
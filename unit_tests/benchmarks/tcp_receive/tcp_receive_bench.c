@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * TCP receive benchmark.
+ *
+ * A writer thread sends BENCH_PACKETS EDP payload packets over a local stream
+ * socket, and tcp_receive_packet() takes them off the non-blocking other end
+ * through the network receive callback, the way edp_tcp_receive_process()
+ * does. Each packet's length and contents are checked. Reported per payload
+ * size: packets per network read that returned data (the receive_packet
+ * counters), receive callbacks per packet, and payload throughput.
+ *
+ * The read-ahead buffer is a build option, rebuild with
+ * "make CPPFLAGS=-DBENCH_RECEIVE_BUFFER_SIZE=0" to compare without it or with
+ * another size.
+ */
+#include "connector_api.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#define BENCH_PACKETS       200000UL
+#define BENCH_WRITE_SIZE    (64 * 1024)
+#define BENCH_POLL_TIMEOUT  1000
+
+typedef struct {
+    size_t payload;
+    int fd;
+} bench_writer_t;
+
+static unsigned long bench_callbacks;
+
+static uint8_t bench_payload_byte(unsigned long const packet, size_t const offset)
+{
+    return (uint8_t)(packet * 7 + offset);
+}
+
+static connector_callback_status_t app_network_receive(connector_network_receive_t * const data)
+{
+    int const * const fd = data->handle;
+    ssize_t const bytes = recv(*fd, data->buffer, data->bytes_available, 0);
+    connector_callback_status_t status = connector_callback_continue;
+
+    bench_callbacks++;
+    if (bytes > 0)
+        data->bytes_used = (size_t)bytes;
+    else if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        status = connector_callback_busy;
+    else
+        status = connector_callback_error;
+
+    return status;
+}
+
+static connector_callback_status_t app_callback(connector_class_id_t const class_id, connector_request_id_t const request_id, void * const data, void * const context)
+{
+    connector_callback_status_t status = connector_callback_unrecognized;
+
+    UNUSED_PARAMETER(context);
+    switch (class_id)
+    {
+        case connector_class_id_operating_system:
+            if (request_id.os_request == connector_request_id_os_system_up_time)
+            {
+                connector_os_system_up_time_t * const up_time = data;
+                struct timespec now;
+
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                up_time->sys_uptime = (unsigned long)now.tv_sec;
+                status = connector_callback_continue;
+            }
+            break;
+
+        case connector_class_id_network_tcp:
+            if (request_id.network_request == connector_request_id_network_receive)
+                status = app_network_receive(data);
+            break;
+
+        default:
+            break;
+    }
+
+    return status;
+}
+
+static void * bench_writer(void * const argument)
+{
+    bench_writer_t const * const writer = argument;
+    static uint8_t buffer[BENCH_WRITE_SIZE];
+    size_t const packet_size = PACKET_EDP_HEADER_SIZE + writer->payload;
+    unsigned long packet = 0;
+
+    while (packet < BENCH_PACKETS)
+    {
+        size_t length = 0;
+
+        while (packet < BENCH_PACKETS && length + packet_size <= sizeof buffer)
+        {
+            uint8_t * const edp_header = buffer + length;
+            size_t i;
+
+            message_store_be16(edp_header, type, E_MSG_MT2_TYPE_PAYLOAD);
+            message_store_be16(edp_header, length, writer->payload);
+            for (i = 0; i < writer->payload; i++)
+                edp_header[PACKET_EDP_HEADER_SIZE + i] = bench_payload_byte(packet, i);
+            length += packet_size;
+            packet++;
+        }
+
+        {
+            size_t sent = 0;
+
+            while (sent < length)
+            {
+                ssize_t const bytes = send(writer->fd, buffer + sent, length - sent, 0);
+
+                if (bytes <= 0)
+                    return NULL;
+                sent += (size_t)bytes;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static double bench_seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static int bench_run(size_t const payload)
+{
+    static connector_data_t connector;
+    int fds[2];
+    bench_writer_t writer;
+    pthread_t thread;
+    unsigned long received = 0;
+    double start_time;
+    double elapsed;
+    int result = -1;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        perror("socketpair");
+        return -1;
+    }
+
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+    memset(&connector, 0, sizeof connector);
+    connector.callback = app_callback;
+    connector.edp_data.network_handle = (connector_network_handle_t *)&fds[0];
+    connector.edp_data.receive_packet.free_packet_buffer = &connector.edp_data.receive_packet.packet_buffer;
+    edp_set_active_state(&connector, connector_transport_receive);
+    edp_set_edp_state(&connector, edp_facility_process);
+    bench_callbacks = 0;
+
+    writer.payload = payload;
+    writer.fd = fds[1];
+    start_time = bench_seconds();
+    pthread_create(&thread, NULL, bench_writer, &writer);
+
+    while (received < BENCH_PACKETS)
+    {
+        connector_buffer_t * packet;
+        connector_status_t const status = tcp_receive_packet(&connector, &packet);
+
+        if (status == connector_working)
+        {
+            uint8_t * const edp_header = packet->buffer;
+            uint8_t const * const data = edp_header + PACKET_EDP_HEADER_SIZE;
+            size_t i;
+
+            if (message_load_be16(edp_header, length) != payload)
+            {
+                fprintf(stderr, "packet %lu: length %u\n", received, (unsigned)message_load_be16(edp_header, length));
+                goto done;
+            }
+            for (i = 0; i < payload; i++)
+            {
+                if (data[i] != bench_payload_byte(received, i))
+                {
+                    fprintf(stderr, "packet %lu: byte %zu differs\n", received, i);
+                    goto done;
+                }
+            }
+            tcp_release_receive_packet(&connector, packet);
+            received++;
+        }
+        else if (status == connector_idle || status == connector_pending)
+        {
+            if (!tcp_receive_has_read_ahead(&connector))
+            {
+                struct pollfd fd;
+
+                fd.fd = fds[0];
+                fd.events = POLLIN;
+                poll(&fd, 1, BENCH_POLL_TIMEOUT);
+            }
+        }
+        else
+        {
+            fprintf(stderr, "packet %lu: tcp_receive_packet returned %d\n", received, status);
+            goto done;
+        }
+    }
+
+    elapsed = bench_seconds() - start_time;
+    printf("%5zu B %12.2f %14.2f %12.0f\n", payload,
+           (double)connector.edp_data.receive_packet.packets / connector.edp_data.receive_packet.reads,
+           (double)bench_callbacks / BENCH_PACKETS,
+           (double)(BENCH_PACKETS * payload) / elapsed / 1e6);
+    result = 0;
+
+done:
+    close(fds[0]);
+    pthread_join(thread, NULL);
+    close(fds[1]);
+    return result;
+}
+
+int main(void)
+{
+    static size_t const payloads[] = {64, 1400};
+    size_t i;
+
+#if (defined CONNECTOR_TCP_RECEIVE_BUFFER_SIZE)
+    printf("%lu packets, read-ahead buffer %d bytes\n", BENCH_PACKETS, CONNECTOR_TCP_RECEIVE_BUFFER_SIZE);
+#else
+    printf("%lu packets, no read-ahead buffer\n", BENCH_PACKETS);
+#endif
+    printf("%7s %12s %14s %12s\n", "payload", "packets/read", "callbacks/pkt", "MB/s");
+    for (i = 0; i < ARRAY_SIZE(payloads); i++)
+    {
+        if (bench_run(payloads[i]) != 0)
+            return 1;
+    }
+
+    return 0;
+}
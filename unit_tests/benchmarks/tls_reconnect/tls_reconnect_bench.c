@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/*
+ * TLS reconnect benchmark.
+ *
+ * Connects the connect_on_ssl network callbacks to a local "openssl s_server"
+ * standing in for Device Cloud, BENCH_CONNECTS times per case, and closes each
+ * connection once the session tickets sent after the handshake are read. The
+ * open callback is called through connect_to_cloud() and, while it returns
+ * busy, the socket is polled the way connector_get_wait_set() reports it.
+ * Reported per connect: wall time, CPU time of this process and how often the
+ * open callback was called, then how many of the connects resumed a session.
+ *
+ * The cases run with the session of the previous connect offered again, with
+ * it dropped before every connect (a full handshake), and with the socket
+ * always polled for sending as before wait_for_receive, which returns at once
+ * while the handshake waits for Device Cloud.
+ *
+ * The openssl command must be on the PATH. It makes a self-signed certificate,
+ * used as the CA certificate, and the server listens on CONNECTOR_SSL_PORT.
+ */
+#include "connector_api.c"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/wait.h>
+
+static char bench_dir[] = "/tmp/tls_reconnect_XXXXXX";
+static char bench_cert_path[sizeof bench_dir + 16];
+static char bench_key_path[sizeof bench_dir + 16];
+
+#define APP_SSL_CA_CERT_PATH    bench_cert_path
+#include "platform.h"
+
+/* the sample logs every connect */
+static int bench_quiet(char const * const format, ...)
+{
+    UNUSED_ARGUMENT(format);
+    return 0;
+}
+
+#undef APP_DEBUG
+#define APP_DEBUG   bench_quiet
+
+#include "network_tcp_ssl.c"
+
+#define BENCH_CONNECTS      200
+#define BENCH_URL           "localhost"
+#define BENCH_POLL_TIMEOUT  1000
+
+typedef struct {
+    char const * name;
+    connector_bool_t resume;
+    connector_bool_t always_send;
+} bench_case_t;
+
+static bench_case_t const bench_cases[] = {
+    {"resumed session",         connector_true,  connector_false},
+    {"full handshake",          connector_false, connector_false},
+    {"resumed, always POLLOUT", connector_true,  connector_true}
+};
+
+/* what the sample's network_dns.c and os.c provide */
+connector_callback_status_t app_dns_resolve(connector_class_id_t const class_id, char const * const domain_name, in_addr_t * const ip_addr)
+{
+    UNUSED_ARGUMENT(class_id);
+    UNUSED_ARGUMENT(domain_name);
+    *ip_addr = htonl(INADDR_LOOPBACK);
+    return connector_callback_continue;
+}
+
+void app_dns_set_redirected(connector_class_id_t const class_id, int const state)
+{
+    UNUSED_ARGUMENT(class_id);
+    UNUSED_ARGUMENT(state);
+}
+
+void app_dns_cache_invalidate(connector_class_id_t const class_id)
+{
+    UNUSED_ARGUMENT(class_id);
+}
+
+connector_bool_t app_connector_reconnect(connector_class_id_t const class_id, connector_close_status_t const status)
+{
+    UNUSED_ARGUMENT(class_id);
+    UNUSED_ARGUMENT(status);
+    return connector_false;
+}
+
+connector_callback_status_t app_os_get_system_time(unsigned long * const uptime)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    *uptime = (unsigned long)now.tv_sec;
+    return connector_callback_continue;
+}
+
+static connector_callback_status_t app_callback(connector_class_id_t const class_id, connector_request_id_t const request_id, void * const data, void * const context)
+{
+    connector_callback_status_t status = connector_callback_unrecognized;
+
+    UNUSED_ARGUMENT(context);
+    if (class_id == connector_class_id_network_tcp)
+        status = app_network_tcp_handler(request_id.network_request, data);
+
+    return status;
+}
+
+static double bench_seconds(clockid_t const clock)
+{
+    struct timespec now;
+
+    clock_gettime(clock, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static pid_t bench_start_server(void)
+{
+    char command[3 * sizeof bench_dir + 200];
+    pid_t pid;
+
+    snprintf(command, sizeof command,
+             "openssl req -x509 -newkey rsa:2048 -nodes -subj /CN=localhost -days 1 -keyout %s -out %s 2>/dev/null",
+             bench_key_path, bench_cert_path);
+    if (system(command) != 0)
+    {
+        fprintf(stderr, "openssl req failed\n");
+        return -1;
+    }
+
+    pid = fork();
+    if (pid == 0)
+    {
+        char port[16];
+
+        snprintf(port, sizeof port, "%d", CONNECTOR_SSL_PORT);
+        if (freopen("/dev/null", "w", stdout) == NULL || freopen("/dev/null", "w", stderr) == NULL)
+            _exit(1);
+        execlp("openssl", "openssl", "s_server", "-quiet", "-www", "-accept", port,
+               "-cert", bench_cert_path, "-key", bench_key_path, (char *)NULL);
+        _exit(1);
+    }
+
+    /* wait for the server to listen */
+    if (pid > 0)
+    {
+        int tries;
+
+        for (tries = 0; tries < 100; tries++)
+        {
+            struct sockaddr_in sin = {0};
+            int const fd = socket(AF_INET, SOCK_STREAM, 0);
+            int connected;
+
+            sin.sin_family = AF_INET;
+            sin.sin_port = htons(CONNECTOR_SSL_PORT);
+            sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            connected = connect(fd, (struct sockaddr *)&sin, sizeof sin) == 0;
+            close(fd);
+            if (connected)
+                break;
+            usleep(50 * 1000);
+        }
+    }
+
+    return pid;
+}
+
+/* sleeps on the socket the way connector_get_wait_set() reports it */
+static void bench_wait(connector_data_t * const connector_ptr, bench_case_t const * const bench)
+{
+    connector_wait_set_t wait_set;
+    connector_wait_network_t * const network = &wait_set.tcp;
+    connector_bool_t data_pending;
+    struct pollfd fd;
+
+    wait_set.timeout_in_milliseconds = BENCH_POLL_TIMEOUT;
+    edp_get_wait_set(connector_ptr, network, &wait_set, 0);
+
+    fd.fd = app_network_tcp_get_fd(network->handle, &data_pending);
+    fd.events = (network->send || bench->always_send) ? POLLOUT : POLLIN;
+    fd.revents = 0;
+    poll(&fd, 1, BENCH_POLL_TIMEOUT);
+}
+
+static int bench_run(bench_case_t const * const bench)
+{
+    static connector_data_t connector;
+    unsigned long calls = 0;
+    unsigned int resumed = 0;
+    double const start_time = bench_seconds(CLOCK_MONOTONIC);
+    double const start_cpu = bench_seconds(CLOCK_PROCESS_CPUTIME_ID);
+    double elapsed;
+    double cpu;
+    int i;
+
+    memset(&connector, 0, sizeof connector);
+    connector.callback = app_callback;
+    edp_set_active_state(&connector, connector_transport_open);
+    edp_set_edp_state(&connector, edp_communication_connect_to_cloud);
+
+    for (i = 0; i < BENCH_CONNECTS; i++)
+    {
+        connector_status_t status;
+        connector_network_close_t close_data;
+
+#if (APP_SSL_SESSION_RESUMPTION)
+        if (!bench->resume)
+            app_ssl_drop_session();
+#endif
+        for (;;)
+        {
+            status = connect_to_cloud(&connector, BENCH_URL);
+            calls++;
+            if (status != connector_pending)
+                break;
+            bench_wait(&connector, bench);
+        }
+
+        if (status != connector_working)
+        {
+            fprintf(stderr, "%s: connect %d failed, status %d\n", bench->name, i, status);
+            return -1;
+        }
+
+        {
+            app_ssl_t const * const ssl_ptr = (app_ssl_t const *)connector.edp_data.network_handle;
+            struct pollfd fd;
+            char buffer[16];
+
+            if (SSL_session_reused(ssl_ptr->ssl))
+                resumed++;
+
+            /* TLS 1.3 tickets follow the handshake, the first receive would take them */
+            fd.fd = ssl_ptr->sfd;
+            fd.events = POLLIN;
+            if (poll(&fd, 1, BENCH_POLL_TIMEOUT) > 0)
+                SSL_read(ssl_ptr->ssl, buffer, sizeof buffer);
+        }
+
+        close_data.handle = connector.edp_data.network_handle;
+        close_data.status = connector_close_status_device_stopped;
+        app_network_tcp_close(&close_data);
+        connector.edp_data.network_handle = NULL;
+    }
+
+    elapsed = bench_seconds(CLOCK_MONOTONIC) - start_time;
+    cpu = bench_seconds(CLOCK_PROCESS_CPUTIME_ID) - start_cpu;
+    printf("%-24s %8.2f %8.2f %11.1f %8u\n", bench->name,
+           elapsed * 1000 / BENCH_CONNECTS, cpu * 1000 / BENCH_CONNECTS, (double)calls / BENCH_CONNECTS, resumed);
+
+    return 0;
+}
+
+int main(void)
+{
+    int result = 1;
+    pid_t server;
+    size_t i;
+
+    if (mkdtemp(bench_dir) == NULL)
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(bench_cert_path, sizeof bench_cert_path, "%s/cert.pem", bench_dir);
+    snprintf(bench_key_path, sizeof bench_key_path, "%s/key.pem", bench_dir);
+
+    server = bench_start_server();
+    if (server <= 0)
+        goto done;
+
+    printf("%d connects per case against openssl s_server on port %d\n", BENCH_CONNECTS, CONNECTOR_SSL_PORT);
+    printf("%-24s %8s %8s %11s %8s\n", "case", "ms", "CPU ms", "open calls", "resumed");
+    result = 0;
+    for (i = 0; i < ARRAY_SIZE(bench_cases); i++)
+    {
+        if (bench_run(&bench_cases[i]) != 0)
+        {
+            result = 1;
+            break;
+        }
+    }
+
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+
+done:
+    remove(bench_cert_path);
+    remove(bench_key_path);
+    rmdir(bench_dir);
+    return result;
+}
@@ -1,12 +1,46 @@
 #include "CppUTest/CommandLineTestRunner.h"
 #include "CppUTestExt/MockSupport.h"
 
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+
 extern "C"
 {
 #include "connector_api.h"
+#include "network_dns.h"
+#include "platform.h"
 
 size_t dp_process_string(char * const string, char * const buffer, size_t const bytes_available, size_t * bytes_used_ptr, connector_bool_t need_quotes, connector_bool_t first_chunk);
 connector_bool_t string_needs_quotes(char const * const string);
+uint16_t sm_calculate_crc16(uint16_t crc, uint8_t const * const data, size_t const bytes);
+uint16_t sm_calculate_crc16_bitwise(uint16_t crc, uint8_t const * const data, size_t const bytes);
+uint16_t sm_calculate_crc16_table(uint16_t crc, uint8_t const * const data, size_t const bytes);
+uint16_t sm_calculate_crc16_slice_by_8(uint16_t crc, uint8_t const * const data, size_t const bytes);
+
+void sm_tracking_test_restart(void);
+void sm_tracking_test_reset(void);
+void sm_tracking_test_store_journal(uint16_t const * const request_ids, size_t const count);
+void sm_tracking_test_fail_journal_store(void);
+char const * sm_tracking_test_stores(void);
+size_t sm_tracking_test_journal_size(void);
+connector_bool_t sm_tracking_test_mark_seen(uint16_t const request_id);
+connector_bool_t sm_tracking_test_have_seen(uint16_t const request_id);
+connector_bool_t sm_tracking_test_clear_all_seen(void);
+
+connector_bool_t app_connector_reconnect(connector_class_id_t const class_id, connector_close_status_t const status)
+{
+    (void)class_id;
+    (void)status;
+    return connector_false;
+}
 
 }
 
@@ -215,3 +249,771 @@ TEST(dp_process_string_test, testBufferOverrun)
 
     CHECK(buffer[bytes_processed] != '\0');
 }
+
+TEST_GROUP(sm_calculate_crc16_test) {};
+
+static uint16_t crc16_bitwise(uint16_t crc, uint8_t const * const data, size_t const bytes)
+{
+    size_t i;
+
+    for (i = 0; i < bytes; i++)
+    {
+        int bit;
+
+        crc ^= data[i];
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc & 0x0001) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+    }
+
+    return crc;
+}
+
+/* the configured implementation and every selectable one */
+typedef uint16_t (* crc16_function_t)(uint16_t crc, uint8_t const * const data, size_t const bytes);
+
+static crc16_function_t const crc16_functions[] =
+{
+    sm_calculate_crc16,
+    sm_calculate_crc16_bitwise,
+    sm_calculate_crc16_table,
+    sm_calculate_crc16_slice_by_8
+};
+
+#define CRC16_FUNCTION_COUNT    (sizeof crc16_functions / sizeof crc16_functions[0])
+
+TEST(sm_calculate_crc16_test, testCheckValue)
+{
+    uint8_t const data[] = "123456789";
+    size_t i;
+
+    for (i = 0; i < CRC16_FUNCTION_COUNT; i++)
+    {
+        CHECK_EQUAL(0xBB3D, crc16_functions[i](0, data, 9));
+        CHECK_EQUAL(0, crc16_functions[i](0, data, 0));
+    }
+}
+
+TEST(sm_calculate_crc16_test, testMatchesBitwise)
+{
+    uint8_t data[100];
+    size_t offset;
+    size_t length;
+    size_t i;
+
+    for (offset = 0; offset < sizeof data; offset++)
+        data[offset] = (uint8_t)(offset * 37 + 11);
+
+    for (i = 0; i < CRC16_FUNCTION_COUNT; i++)
+    {
+        for (offset = 0; offset < 8; offset++)
+        {
+            for (length = 0; length <= sizeof data - offset; length++)
+            {
+                CHECK_EQUAL(crc16_bitwise(0, data + offset, length), crc16_functions[i](0, data + offset, length));
+                CHECK_EQUAL(crc16_bitwise(0xFFFF, data + offset, length), crc16_functions[i](0xFFFF, data + offset, length));
+            }
+        }
+    }
+}
+
+TEST(sm_calculate_crc16_test, testIncremental)
+{
+    uint8_t data[64];
+    size_t split;
+    size_t i;
+
+    for (split = 0; split < sizeof data; split++)
+        data[split] = (uint8_t)(split ^ 0x5A);
+
+    for (i = 0; i < CRC16_FUNCTION_COUNT; i++)
+    {
+        for (split = 0; split <= sizeof data; split++)
+        {
+            uint16_t const crc = crc16_functions[i](0, data, split);
+
+            CHECK_EQUAL(crc16_functions[i](0, data, sizeof data), crc16_functions[i](crc, data + split, sizeof data - split));
+        }
+    }
+}
+
+TEST_GROUP(sm_tracking_journal_test)
+{
+    void setup()
+    {
+        sm_tracking_test_reset();
+    }
+};
+
+/* sm_tracking_test_stores() lists what was stored since the last restart, 'J' for the journal and 'T' for the tracking data */
+TEST(sm_tracking_journal_test, testReplayAfterRestart)
+{
+    CHECK_EQUAL(connector_true, sm_tracking_test_mark_seen(3));
+    CHECK_EQUAL(connector_true, sm_tracking_test_mark_seen(700));
+
+    /* only the journal is stored until it's full */
+    STRCMP_EQUAL("JJ", sm_tracking_test_stores());
+
+    sm_tracking_test_restart();
+    CHECK_EQUAL(connector_true, sm_tracking_test_have_seen(3));
+    CHECK_EQUAL(connector_true, sm_tracking_test_have_seen(700));
+    CHECK_EQUAL(connector_false, sm_tracking_test_have_seen(4));
+}
+
+TEST(sm_tracking_journal_test, testReplayStoredJournal)
+{
+    uint16_t const request_ids[] = {0, 9, 1023};
+
+    sm_tracking_test_store_journal(request_ids, 3);
+    sm_tracking_test_restart();
+
+    CHECK_EQUAL(connector_true, sm_tracking_test_have_seen(0));
+    CHECK_EQUAL(connector_true, sm_tracking_test_have_seen(9));
+    CHECK_EQUAL(connector_true, sm_tracking_test_have_seen(1023));
+    CHECK_EQUAL(connector_false, sm_tracking_test_have_seen(8));
+}
+
+TEST(sm_tracking_journal_test, testIgnoreOversizedJournal)
+{
+    uint16_t const request_ids[] = {5, 6, 7, 8, 9, 10, 11, 12};
+
+    CHECK(sm_tracking_test_journal_size() < 8);
+    sm_tracking_test_store_journal(request_ids, sm_tracking_test_journal_size() + 1);
+    sm_tracking_test_restart();
+
+    CHECK_EQUAL(connector_false, sm_tracking_test_have_seen(5));
+}
+
+TEST(sm_tracking_journal_test, testReplayAfterFlush)
+{
+    uint16_t request_id;
+
+    /* a full journal stores the tracking data and empties the journal */
+    for (request_id = 0; request_id <= sm_tracking_test_journal_size(); request_id++)
+        CHECK_EQUAL(connector_true, sm_tracking_test_mark_seen(request_id));
+    STRCMP_EQUAL("JJJTJJ", sm_tracking_test_stores());
+
+    sm_tracking_test_restart();
+    for (request_id = 0; request_id <= sm_tracking_test_journal_size(); request_id++)
+        CHECK_EQUAL(connector_true, sm_tracking_test_have_seen(request_id));
+}
+
+TEST(sm_tracking_journal_test, testClearStoresJournalFirst)
+{
+    CHECK_EQUAL(connector_true, sm_tracking_test_mark_seen(3));
+    sm_tracking_test_restart();
+
+    CHECK_EQUAL(connector_true, sm_tracking_test_clear_all_seen());
+    CHECK_EQUAL(connector_false, sm_tracking_test_have_seen(3));
+    STRCMP_EQUAL("JT", sm_tracking_test_stores());
+
+    sm_tracking_test_restart();
+    CHECK_EQUAL(connector_false, sm_tracking_test_have_seen(3));
+}
+
+TEST(sm_tracking_journal_test, testClearKeepsTrackingWhenJournalFails)
+{
+    CHECK_EQUAL(connector_true, sm_tracking_test_mark_seen(3));
+    sm_tracking_test_restart();
+
+    /* the stale journal would be replayed over cleared tracking data, so that is not stored */
+    sm_tracking_test_fail_journal_store();
+    CHECK_EQUAL(connector_false, sm_tracking_test_clear_all_seen());
+    CHECK_EQUAL(connector_false, sm_tracking_test_have_seen(3));
+    STRCMP_EQUAL("J", sm_tracking_test_stores());
+}
+
+static char const * stand_in_addresses[APP_DNS_MAX_ADDRESSES];
+static size_t stand_in_count;
+static unsigned long stand_in_ttl;
+static int stand_in_calls;
+
+/* Resolver stand-in answering with the addresses set by the test, no address means the lookup fails */
+static int stand_in_resolver(char const * const domain_name, app_dns_address_t * const addresses,
+                             size_t * const count, unsigned long * const ttl)
+{
+    size_t i;
+
+    (void)domain_name;
+    stand_in_calls++;
+
+    for (i = 0; i < stand_in_count; i++)
+    {
+        struct sockaddr_in * const sin = (struct sockaddr_in *)(void *)&addresses[i].addr;
+        struct sockaddr_in6 * const sin6 = (struct sockaddr_in6 *)(void *)&addresses[i].addr;
+
+        memset(&addresses[i], 0, sizeof addresses[i]);
+        if (inet_pton(AF_INET, stand_in_addresses[i], &sin->sin_addr) == 1)
+        {
+            sin->sin_family = AF_INET;
+            addresses[i].length = sizeof *sin;
+        }
+        else
+        {
+            inet_pton(AF_INET6, stand_in_addresses[i], &sin6->sin6_addr);
+            sin6->sin6_family = AF_INET6;
+            addresses[i].length = sizeof *sin6;
+        }
+    }
+
+    *count = stand_in_count;
+    *ttl = stand_in_ttl;
+    return (stand_in_count > 0) ? 0 : -1;
+}
+
+static void stand_in_answer(char const * const first, char const * const second, unsigned long const ttl)
+{
+    stand_in_addresses[0] = first;
+    stand_in_addresses[1] = second;
+    stand_in_count = (first == NULL) ? 0 : ((second == NULL) ? 1 : 2);
+    stand_in_ttl = ttl;
+    stand_in_calls = 0;
+}
+
+static void check_address(app_dns_address_t const * const address, char const * const expected)
+{
+    char name[INET6_ADDRSTRLEN];
+    struct sockaddr_in const * const sin = (struct sockaddr_in const *)(void const *)&address->addr;
+    struct sockaddr_in6 const * const sin6 = (struct sockaddr_in6 const *)(void const *)&address->addr;
+    void const * const addr = (address->addr.ss_family == AF_INET) ? (void const *)&sin->sin_addr : (void const *)&sin6->sin6_addr;
+
+    CHECK(inet_ntop(address->addr.ss_family, addr, name, sizeof name) != NULL);
+    STRCMP_EQUAL(expected, name);
+}
+
+TEST_GROUP(app_dns_resolve_test)
+{
+    void setup()
+    {
+        app_dns_set_resolver(stand_in_resolver);
+    }
+
+    void teardown()
+    {
+        app_dns_set_resolver(NULL);
+    }
+};
+
+TEST(app_dns_resolve_test, testAllAddresses)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+
+    stand_in_answer("2001:db8::1", "2001:db8::2", 3600);
+    stand_in_addresses[2] = "192.0.2.1";
+    stand_in_addresses[3] = "192.0.2.2";
+    stand_in_count = 4;
+
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve_all(connector_class_id_network_tcp, "all.example.com", addresses, &count));
+    CHECK_EQUAL(4, count);
+
+    /* the families take turns */
+    check_address(&addresses[0], "2001:db8::1");
+    check_address(&addresses[1], "192.0.2.1");
+    check_address(&addresses[2], "2001:db8::2");
+    check_address(&addresses[3], "192.0.2.2");
+}
+
+TEST(app_dns_resolve_test, testFirstIPv4Address)
+{
+    in_addr_t ip_addr;
+
+    stand_in_answer("2001:db8::1", "192.0.2.7", 3600);
+
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve(connector_class_id_network_udp, "ipv4.example.com", &ip_addr));
+    CHECK_EQUAL(inet_addr("192.0.2.7"), ip_addr);
+}
+
+TEST(app_dns_resolve_test, testCachedWithinTtl)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+
+    stand_in_answer("192.0.2.10", NULL, 3600);
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve_all(connector_class_id_network_tcp, "cached.example.com", addresses, &count));
+
+    stand_in_answer("192.0.2.11", NULL, 3600);
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve_all(connector_class_id_network_tcp, "cached.example.com", addresses, &count));
+    CHECK_EQUAL(0, stand_in_calls);
+    CHECK_EQUAL(1, count);
+    check_address(&addresses[0], "192.0.2.10");
+}
+
+TEST(app_dns_resolve_test, testExpiredTtl)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+
+    stand_in_answer("192.0.2.20", NULL, 0);
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve_all(connector_class_id_network_tcp, "expired.example.com", addresses, &count));
+
+    stand_in_answer("192.0.2.21", NULL, 0);
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve_all(connector_class_id_network_tcp, "expired.example.com", addresses, &count));
+    CHECK_EQUAL(1, stand_in_calls);
+    check_address(&addresses[0], "192.0.2.21");
+}
+
+TEST(app_dns_resolve_test, testStaleFallback)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+
+    stand_in_answer("2001:db8::30", "192.0.2.30", 0);
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve_all(connector_class_id_network_tcp, "stale.example.com", addresses, &count));
+
+    stand_in_answer(NULL, NULL, 0);
+    count = 0;
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve_all(connector_class_id_network_tcp, "stale.example.com", addresses, &count));
+    CHECK_EQUAL(1, stand_in_calls);
+    CHECK_EQUAL(2, count);
+    check_address(&addresses[0], "2001:db8::30");
+    check_address(&addresses[1], "192.0.2.30");
+}
+
+TEST(app_dns_resolve_test, testInvalidateKeepsStaleAddresses)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+
+    stand_in_answer("192.0.2.40", NULL, 3600);
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve_all(connector_class_id_network_tcp, "invalid.example.com", addresses, &count));
+
+    app_dns_cache_invalidate(connector_class_id_network_tcp);
+
+    stand_in_answer(NULL, NULL, 0);
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve_all(connector_class_id_network_tcp, "invalid.example.com", addresses, &count));
+    CHECK_EQUAL(1, stand_in_calls);
+    check_address(&addresses[0], "192.0.2.40");
+}
+
+TEST(app_dns_resolve_test, testFailureWithoutCache)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+
+    stand_in_answer(NULL, NULL, 0);
+    CHECK_EQUAL(connector_callback_error, app_dns_resolve_all(connector_class_id_network_tcp, "unknown.example.com", addresses, &count));
+    CHECK_EQUAL(1, stand_in_calls);
+}
+
+TEST(app_dns_resolve_test, testNumericAddress)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+
+    stand_in_answer(NULL, NULL, 0);
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve_all(connector_class_id_network_tcp, "2001:db8::50", addresses, &count));
+    CHECK_EQUAL(1, count);
+    check_address(&addresses[0], "2001:db8::50");
+
+    CHECK_EQUAL(connector_callback_continue, app_dns_resolve_all(connector_class_id_network_tcp, "192.0.2.50", addresses, &count));
+    check_address(&addresses[0], "192.0.2.50");
+    CHECK_EQUAL(0, stand_in_calls);
+}
+
+static char const * lookup_addresses[APP_DNS_MAX_ADDRESSES];
+static int lookup_calls;
+static unsigned char canned_answer[512];
+static int canned_length;
+static int search_calls;
+static int search_type;
+
+/* getaddrinfo() stand-in answering with the numeric addresses set by the test */
+static int stand_in_getaddrinfo(char const * node, char const * service, struct addrinfo const * hints, struct addrinfo ** res)
+{
+    struct addrinfo ** next = res;
+    struct addrinfo numeric = *hints;
+    size_t i;
+
+    (void)node;
+    lookup_calls++;
+    *res = NULL;
+    numeric.ai_flags |= AI_NUMERICHOST;
+
+    for (i = 0; i < APP_DNS_MAX_ADDRESSES && lookup_addresses[i] != NULL; i++)
+    {
+        if (getaddrinfo(lookup_addresses[i], service, &numeric, next) != 0)
+            break;
+        while (*next != NULL)
+            next = &(*next)->ai_next;
+    }
+
+    return (*res != NULL) ? 0 : EAI_NONAME;
+}
+
+/* res_search() stand-in answering with the DNS response built by the test, a negative length means the query fails */
+static int stand_in_search(char const * domain_name, int class_, int type, unsigned char * answer, int length)
+{
+    (void)domain_name;
+    (void)class_;
+    search_calls++;
+    search_type = type;
+
+    if (canned_length > 0 && canned_length <= length)
+        memcpy(answer, canned_answer, (size_t)canned_length);
+
+    return canned_length;
+}
+
+static size_t canned_name(unsigned char * const buffer, char const * const name)
+{
+    size_t length = 0;
+    char const * label = name;
+
+    while (*label != '\0')
+    {
+        size_t const label_length = strcspn(label, ".");
+
+        buffer[length++] = (unsigned char)label_length;
+        memcpy(&buffer[length], label, label_length);
+        length += label_length;
+        label += label_length;
+        if (*label == '.')
+            label++;
+    }
+    buffer[length++] = 0;
+
+    return length;
+}
+
+static void canned_put16(unsigned int const value)
+{
+    canned_answer[canned_length++] = (unsigned char)(value >> 8);
+    canned_answer[canned_length++] = (unsigned char)value;
+}
+
+/* Starts a response to a query of name, the answer records are added by canned_record() */
+static void canned_response(char const * const name, int const type, unsigned int const answer_count)
+{
+    unsigned int const header[] = {0x1234, 0x8180, 1, answer_count, 0, 0};
+    size_t i;
+
+    canned_length = 0;
+    for (i = 0; i < sizeof header / sizeof header[0]; i++)
+        canned_put16(header[i]);
+
+    canned_length += (int)canned_name(&canned_answer[canned_length], name);
+    canned_put16((unsigned int)type);
+    canned_put16(ns_c_in);
+}
+
+static void canned_record(char const * const owner, int const type, unsigned long const ttl, void const * const rdata, size_t const rdlength)
+{
+    canned_length += (int)canned_name(&canned_answer[canned_length], owner);
+    canned_put16((unsigned int)type);
+    canned_put16(ns_c_in);
+    canned_put16((unsigned int)(ttl >> 16));
+    canned_put16((unsigned int)ttl);
+    canned_put16((unsigned int)rdlength);
+    memcpy(&canned_answer[canned_length], rdata, rdlength);
+    canned_length += (int)rdlength;
+}
+
+static void canned_cname_response(char const * const name, unsigned long const cname_ttl, char const * const target,
+                                  char const * const address, unsigned long const address_ttl)
+{
+    unsigned char rdata[64];
+    struct in_addr addr;
+
+    canned_response(name, ns_t_a, 2);
+    canned_record(name, ns_t_cname, cname_ttl, rdata, canned_name(rdata, target));
+    inet_pton(AF_INET, address, &addr);
+    canned_record(target, ns_t_a, address_ttl, &addr, sizeof addr);
+}
+
+static void lookup_answer(char const * const first, char const * const second)
+{
+    memset(lookup_addresses, 0, sizeof lookup_addresses);
+    lookup_addresses[0] = first;
+    lookup_addresses[1] = second;
+    lookup_calls = 0;
+    search_calls = 0;
+    search_type = 0;
+    canned_length = -1;
+}
+
+TEST_GROUP(app_dns_resolve_name_test)
+{
+    void setup()
+    {
+        app_dns_set_lookup(stand_in_getaddrinfo, stand_in_search);
+    }
+
+    void teardown()
+    {
+        app_dns_set_lookup(NULL, NULL);
+    }
+};
+
+TEST(app_dns_resolve_name_test, testAddressTtlIsLowest)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+    unsigned long ttl = 0;
+
+    lookup_answer("192.0.2.60", NULL);
+    canned_cname_response("www.example.com", 300, "edge.example.net", "192.0.2.60", 60);
+
+    CHECK_EQUAL(0, app_dns_resolve_name("www.example.com", addresses, &count, &ttl));
+    CHECK_EQUAL(1, count);
+    check_address(&addresses[0], "192.0.2.60");
+    CHECK_EQUAL(60, ttl);
+    CHECK_EQUAL(1, search_calls);
+    CHECK_EQUAL(ns_t_a, search_type);
+}
+
+TEST(app_dns_resolve_name_test, testCnameTtlIsLowest)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+    unsigned long ttl = 0;
+
+    lookup_answer("2001:db8::61", "192.0.2.61");
+    canned_cname_response("cname.example.com", 30, "edge.example.net", "192.0.2.61", 600);
+
+    CHECK_EQUAL(0, app_dns_resolve_name("cname.example.com", addresses, &count, &ttl));
+    CHECK_EQUAL(2, count);
+    check_address(&addresses[0], "2001:db8::61");
+    check_address(&addresses[1], "192.0.2.61");
+    CHECK_EQUAL(30, ttl);
+    CHECK_EQUAL(1, search_calls);
+    CHECK_EQUAL(ns_t_a, search_type);
+}
+
+TEST(app_dns_resolve_name_test, testIPv6OnlyQueriesAAAA)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+    unsigned long ttl = 0;
+    struct in6_addr addr;
+
+    lookup_answer("2001:db8::62", NULL);
+    canned_response("ipv6.example.com", ns_t_aaaa, 1);
+    inet_pton(AF_INET6, "2001:db8::62", &addr);
+    canned_record("ipv6.example.com", ns_t_aaaa, 90, &addr, sizeof addr);
+
+    CHECK_EQUAL(0, app_dns_resolve_name("ipv6.example.com", addresses, &count, &ttl));
+    CHECK_EQUAL(1, count);
+    CHECK_EQUAL(90, ttl);
+    CHECK_EQUAL(ns_t_aaaa, search_type);
+}
+
+TEST(app_dns_resolve_name_test, testTtlQueryFails)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+    unsigned long ttl = 0;
+
+    lookup_answer("192.0.2.63", NULL);
+
+    CHECK_EQUAL(0, app_dns_resolve_name("nottl.example.com", addresses, &count, &ttl));
+    CHECK_EQUAL(1, count);
+    check_address(&addresses[0], "192.0.2.63");
+    CHECK_EQUAL(24UL * 3600, ttl);
+    CHECK_EQUAL(1, search_calls);
+}
+
+TEST(app_dns_resolve_name_test, testTtlWithoutAnswer)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+    unsigned long ttl = 0;
+
+    lookup_answer("192.0.2.64", NULL);
+    canned_response("noanswer.example.com", ns_t_a, 0);
+
+    CHECK_EQUAL(0, app_dns_resolve_name("noanswer.example.com", addresses, &count, &ttl));
+    CHECK_EQUAL(24UL * 3600, ttl);
+}
+
+TEST(app_dns_resolve_name_test, testLookupFails)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+    unsigned long ttl = 0;
+
+    lookup_answer(NULL, NULL);
+    canned_cname_response("unknown.example.com", 30, "edge.example.net", "192.0.2.65", 30);
+
+    CHECK_EQUAL(-1, app_dns_resolve_name("unknown.example.com", addresses, &count, &ttl));
+    CHECK_EQUAL(0, count);
+    CHECK_EQUAL(1, lookup_calls);
+    CHECK_EQUAL(0, search_calls);
+}
+
+TEST(app_dns_resolve_name_test, testHostsFileNameNotQueried)
+{
+    app_dns_address_t addresses[APP_DNS_MAX_ADDRESSES];
+    size_t count = 0;
+    unsigned long ttl = 0;
+
+    lookup_answer(NULL, NULL);
+    app_dns_set_lookup(NULL, stand_in_search);
+
+    CHECK_EQUAL(0, app_dns_resolve_name("localhost", addresses, &count, &ttl));
+    CHECK(count > 0);
+    CHECK_EQUAL(24UL * 3600, ttl);
+    CHECK_EQUAL(0, search_calls);
+}
+
+static int listen_on(char const * const address, int const backlog)
+{
+    struct sockaddr_in sin;
+    int const fd = socket(AF_INET, SOCK_STREAM, 0);
+    int enabled = 1;
+
+    memset(&sin, 0, sizeof sin);
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(CONNECTOR_PORT);
+    inet_pton(AF_INET, address, &sin.sin_addr);
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof enabled);
+    CHECK_EQUAL(0, bind(fd, (struct sockaddr *)&sin, sizeof sin));
+    CHECK_EQUAL(0, listen(fd, backlog));
+
+    return fd;
+}
+
+/* A listener whose accept queue is full, connects to it get no answer */
+static int listen_full(char const * const address, int * const queued_fd)
+{
+    int const fd = listen_on(address, 0);
+    struct sockaddr_in sin;
+
+    memset(&sin, 0, sizeof sin);
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(CONNECTOR_PORT);
+    inet_pton(AF_INET, address, &sin.sin_addr);
+
+    *queued_fd = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK_EQUAL(0, connect(*queued_fd, (struct sockaddr *)&sin, sizeof sin));
+
+    return fd;
+}
+
+static size_t open_descriptors(void)
+{
+    DIR * const dir = opendir("/proc/self/fd");
+    size_t count = 0;
+
+    while (readdir(dir) != NULL)
+        count++;
+    closedir(dir);
+
+    return count;
+}
+
+static unsigned long elapsed_ms(struct timespec const * const start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)((now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000);
+}
+
+/* Calls the open callback until the connect is done or 5 seconds passed */
+static connector_callback_status_t open_connection(connector_network_open_t * const open_data, unsigned long * const time_ms)
+{
+    connector_callback_status_t status;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do
+    {
+        status = app_network_tcp_handler(connector_request_id_network_open, open_data);
+        if (status == connector_callback_busy)
+            poll(NULL, 0, 5);
+    } while (status == connector_callback_busy && elapsed_ms(&start) < 5000);
+
+    *time_ms = elapsed_ms(&start);
+    return status;
+}
+
+static void close_connection(connector_network_open_t const * const open_data)
+{
+    connector_network_close_t close_data = {open_data->handle, connector_close_status_device_terminated, connector_false};
+
+    CHECK_EQUAL(connector_callback_continue, app_network_tcp_handler(connector_request_id_network_close, &close_data));
+}
+
+static void check_peer(connector_network_open_t const * const open_data, char const * const expected)
+{
+    int const * const fd = (int const *)open_data->handle;
+    struct sockaddr_in peer;
+    socklen_t length = sizeof peer;
+    char name[INET_ADDRSTRLEN];
+
+    CHECK_EQUAL(0, getpeername(*fd, (struct sockaddr *)&peer, &length));
+    CHECK(inet_ntop(AF_INET, &peer.sin_addr, name, sizeof name) != NULL);
+    STRCMP_EQUAL(expected, name);
+}
+
+TEST_GROUP(app_network_tcp_open_test)
+{
+    void setup()
+    {
+        app_dns_set_resolver(stand_in_resolver);
+    }
+
+    void teardown()
+    {
+        app_dns_set_resolver(NULL);
+    }
+};
+
+TEST(app_network_tcp_open_test, testSecondAttemptAfterDelay)
+{
+    connector_network_open_t open_data = {{"delay.example.com"}, NULL, connector_false};
+    unsigned long time_ms;
+    int queued_fd;
+    int const hanging_fd = listen_full("127.0.0.2", &queued_fd);
+    int const listen_fd = listen_on("127.0.0.3", 1);
+    size_t const descriptors = open_descriptors();
+
+    stand_in_answer("127.0.0.2", "127.0.0.3", 3600);
+
+    CHECK_EQUAL(connector_callback_continue, open_connection(&open_data, &time_ms));
+    /* the second attempt waits APP_CONNECT_ATTEMPT_DELAY_MS for the first one */
+    CHECK(time_ms >= 250);
+    CHECK(time_ms < 1000);
+    check_peer(&open_data, "127.0.0.3");
+    /* the attempt still waiting on the first address was closed */
+    CHECK_EQUAL(descriptors + 1, open_descriptors());
+
+    close_connection(&open_data);
+    CHECK_EQUAL(descriptors, open_descriptors());
+
+    close(listen_fd);
+    close(queued_fd);
+    close(hanging_fd);
+}
+
+TEST(app_network_tcp_open_test, testRefusedAttemptStartsNext)
+{
+    connector_network_open_t open_data = {{"refused.example.com"}, NULL, connector_false};
+    unsigned long time_ms;
+    int const listen_fd = listen_on("127.0.0.3", 1);
+    size_t const descriptors = open_descriptors();
+
+    stand_in_answer("127.0.0.4", "127.0.0.3", 3600);
+
+    CHECK_EQUAL(connector_callback_continue, open_connection(&open_data, &time_ms));
+    CHECK(time_ms < 250);
+    check_peer(&open_data, "127.0.0.3");
+    CHECK_EQUAL(descriptors + 1, open_descriptors());
+
+    close_connection(&open_data);
+    close(listen_fd);
+}
+
+TEST(app_network_tcp_open_test, testAllAttemptsFail)
+{
+    connector_network_open_t open_data = {{"closed.example.com"}, NULL, connector_false};
+    unsigned long time_ms;
+    size_t const descriptors = open_descriptors();
+
+    stand_in_answer("127.0.0.4", "127.0.0.5", 3600);
+
+    CHECK_EQUAL(connector_callback_error, open_connection(&open_data, &time_ms));
+    CHECK(time_ms < 250);
+    CHECK_EQUAL(descriptors, open_descriptors());
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2014-2022 Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Digi International Inc. 11001 Bren Road East, Minnetonka, MN 55343
+ * =======================================================================
+ */
+
+/* Builds connector_api.c once more with short message encryption and a tracking journal, the
+ * UDP transport's tracking data is stored in memory so the tests can restart it from what was stored.
+ * Each store is recorded as 'J' for the journal and 'T' for the tracking data.
+ */
+#undef UNIT_TEST
+#define CONNECTOR_SM_ENCRYPTION
+#define CONNECTOR_SM_TRACKING_FLUSH_COUNT   4
+
+/* the tests link the library already, keep this copy's public functions apart */
+#define connector_init              sm_tracking_connector_init
+#define connector_run               sm_tracking_connector_run
+#define connector_step_report       sm_tracking_connector_step_report
+#define connector_get_wait_set      sm_tracking_connector_get_wait_set
+#define connector_initiate_action   sm_tracking_connector_initiate_action
+#define connector_edp_step          sm_tracking_connector_edp_step
+#define edp_initiate_action         sm_tracking_edp_initiate_action
+#define dp_generate_csv             sm_tracking_dp_generate_csv
+
+#include "connector_api.c"
+
+#define SM_TRACKING_TEST_MAX_STORES 16
+
+static struct
+{
+    uint8_t tracking[SM_TRACKING_BYTES];
+    uint16_t journal[CONNECTOR_SM_TRACKING_FLUSH_COUNT + 1];
+    connector_bool_t journal_stored;
+    connector_bool_t fail_journal_store;
+    char stores[SM_TRACKING_TEST_MAX_STORES + 1];
+    size_t store_count;
+} sm_tracking_storage;
+
+static connector_data_t sm_tracking_connector;
+
+static void * sm_tracking_stored_data(connector_sm_encryption_data_type_t const type, size_t * const bytes)
+{
+    void * data = NULL;
+
+    switch (type)
+    {
+        case connector_sm_encryption_data_type_tracking:
+            data = sm_tracking_storage.tracking;
+            *bytes = sizeof sm_tracking_storage.tracking;
+            break;
+        case connector_sm_encryption_data_type_tracking_journal:
+            data = sm_tracking_storage.journal;
+            *bytes = sizeof sm_tracking_storage.journal;
+            break;
+        default:
+            break;
+    }
+
+    return data;
+}
+
+static connector_callback_status_t sm_tracking_callback(connector_class_id_t const class_id, connector_request_id_t const request_id, void * const data, void * const context)
+{
+    connector_callback_status_t status = connector_callback_error;
+    size_t bytes;
+
+    UNUSED_PARAMETER(context);
+    if (class_id == connector_class_id_operating_system && request_id.os_request == connector_request_id_os_system_up_time)
+    {
+        connector_os_system_up_time_t * const up_time = data;
+
+        up_time->sys_uptime = 0;
+        status = connector_callback_continue;
+        goto done;
+    }
+
+    if (class_id != connector_class_id_short_message)
+        goto done;
+
+    switch (request_id.sm_request)
+    {
+        case connector_request_id_sm_encryption_load_data:
+        {
+            connector_sm_encryption_load_data_t * const load = data;
+            void const * const stored = sm_tracking_stored_data(load->type, &bytes);
+
+            if (stored == NULL || load->bytes_required != bytes)
+                break;
+            if (load->type == connector_sm_encryption_data_type_tracking_journal && !sm_tracking_storage.journal_stored)
+                break;
+
+            memcpy(load->data, stored, bytes);
+            status = connector_callback_continue;
+            break;
+        }
+
+        case connector_request_id_sm_encryption_store_data:
+        {
+            connector_sm_encryption_store_data_t * const store = data;
+            void * const stored = sm_tracking_stored_data(store->type, &bytes);
+
+            connector_bool_t const journal = connector_bool(store->type == connector_sm_encryption_data_type_tracking_journal);
+
+            if (stored == NULL || store->bytes_used != bytes)
+                break;
+
+            if (sm_tracking_storage.store_count < SM_TRACKING_TEST_MAX_STORES)
+                sm_tracking_storage.stores[sm_tracking_storage.store_count++] = journal ? 'J' : 'T';
+
+            if (journal && sm_tracking_storage.fail_journal_store)
+                break;
+
+            memcpy(stored, store->data, bytes);
+            if (journal)
+                sm_tracking_storage.journal_stored = connector_true;
+            status = connector_callback_continue;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+done:
+    return status;
+}
+
+void sm_tracking_test_restart(void)
+{
+    /* the same loads as connector_init() */
+    memset(&sm_tracking_connector, 0, sizeof sm_tracking_connector);
+    sm_tracking_connector.callback = sm_tracking_callback;
+    sm_configuration_load(&sm_tracking_connector, connector_transport_udp, connector_sm_encryption_data_type_tracking,
+        &sm_tracking_connector.sm_udp.request.tracking, sizeof sm_tracking_connector.sm_udp.request.tracking);
+    sm_load_tracking_journal(&sm_tracking_connector, connector_transport_udp);
+    memset(sm_tracking_storage.stores, 0, sizeof sm_tracking_storage.stores);
+    sm_tracking_storage.store_count = 0;
+}
+
+void sm_tracking_test_reset(void)
+{
+    memset(&sm_tracking_storage, 0, sizeof sm_tracking_storage);
+    sm_tracking_test_restart();
+}
+
+void sm_tracking_test_store_journal(uint16_t const * const request_ids, size_t const count)
+{
+    size_t i;
+
+    sm_tracking_storage.journal[0] = count;
+    for (i = 0; i < count && i < CONNECTOR_SM_TRACKING_FLUSH_COUNT; i++)
+        sm_tracking_storage.journal[i + 1] = request_ids[i];
+    sm_tracking_storage.journal_stored = connector_true;
+}
+
+void sm_tracking_test_fail_journal_store(void)
+{
+    sm_tracking_storage.fail_journal_store = connector_true;
+}
+
+char const * sm_tracking_test_stores(void)
+{
+    return sm_tracking_storage.stores;
+}
+
+size_t sm_tracking_test_journal_size(void)
+{
+    return CONNECTOR_SM_TRACKING_FLUSH_COUNT;
+}
+
+connector_bool_t sm_tracking_test_mark_seen(uint16_t const request_id)
+{
+    return sm_mark_request_seen(&sm_tracking_connector, connector_transport_udp, request_id);
+}
+
+connector_bool_t sm_tracking_test_have_seen(uint16_t const request_id)
+{
+    return sm_have_seen_request(&sm_tracking_connector, connector_transport_udp, request_id);
+}
+
+connector_bool_t sm_tracking_test_clear_all_seen(void)
+{
+    return sm_clear_all_seen(&sm_tracking_connector, connector_transport_udp);
+}